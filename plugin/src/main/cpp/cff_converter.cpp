@@ -0,0 +1,992 @@
+#include "cff_converter.h"
+#include "glyf_tables.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t TAG_CFF = sfnt_tag('C', 'F', 'F', ' ');
+constexpr uint32_t TAG_CFF2 = sfnt_tag('C', 'F', 'F', '2');
+constexpr uint32_t TAG_VORG = sfnt_tag('V', 'O', 'R', 'G');
+constexpr uint32_t TAG_HEAD = sfnt_tag('h', 'e', 'a', 'd');
+constexpr uint32_t TAG_MAXP = sfnt_tag('m', 'a', 'x', 'p');
+constexpr uint32_t TAG_HHEA = sfnt_tag('h', 'h', 'e', 'a');
+constexpr uint32_t TAG_HMTX = sfnt_tag('h', 'm', 't', 'x');
+constexpr uint32_t TAG_FVAR = sfnt_tag('f', 'v', 'a', 'r');
+constexpr uint32_t TAG_GVAR = sfnt_tag('g', 'v', 'a', 'r');
+
+constexpr size_t MAX_STACK = 513;
+constexpr int MAX_SUBR_DEPTH = 10;
+constexpr int MAX_QUADS_PER_CUBIC = 16;
+constexpr int ERROR_SAMPLES = 8;          // per quad, compared against the cubic piece
+constexpr double TOLERANCE_PER_EM = 1e-3;
+constexpr double EPSILON = 1e-6;
+
+constexpr uint16_t PHANTOM_POINTS = 4;
+
+// Top and Font DICT operators; escaped ones are 1200 + second byte
+constexpr uint16_t OP_CHARSTRINGS = 17;
+constexpr uint16_t OP_PRIVATE = 18;
+constexpr uint16_t OP_SUBRS = 19;
+constexpr uint16_t OP_VSINDEX = 22;
+constexpr uint16_t OP_VSTORE = 24;
+constexpr uint16_t OP_CHARSTRING_TYPE = 1206;
+constexpr uint16_t OP_FDARRAY = 1236;
+constexpr uint16_t OP_FDSELECT = 1237;
+
+struct Point {
+    double x, y;
+};
+
+Point operator+(Point a, Point b) { return {a.x + b.x, a.y + b.y}; }
+Point operator-(Point a, Point b) { return {a.x - b.x, a.y - b.y}; }
+Point operator*(Point a, double s) { return {a.x * s, a.y * s}; }
+double distance(Point a, Point b) { return std::hypot(a.x - b.x, a.y - b.y); }
+bool same_point(Point a, Point b) { return std::fabs(a.x - b.x) < EPSILON && std::fabs(a.y - b.y) < EPSILON; }
+
+// ---------------------------------------------------------------------------
+// CFF structures
+
+struct Span {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+struct CffIndex {
+    std::vector<Span> items;
+};
+
+// CFF INDEX at |pos|, which is moved past it; CFF2 counts are 32-bit
+bool read_index(const uint8_t* base, size_t size, size_t& pos, bool cff2, CffIndex& index) {
+    const size_t count_size = cff2 ? 4 : 2;
+    if (pos + count_size > size) return false;
+    const size_t count = cff2 ? sfnt_u32(base + pos) : sfnt_u16(base + pos);
+    pos += count_size;
+    index.items.clear();
+    if (!count) return true;
+
+    if (pos + 1 > size) return false;
+    const uint8_t off_size = base[pos++];
+    if (off_size < 1 || off_size > 4 || count > (size - pos) / off_size) return false;
+    const size_t offsets_end = pos + (count + 1) * off_size;
+    if (offsets_end > size) return false;
+
+    auto offset_at = [&](size_t i) {
+        uint32_t v = 0;
+        for (uint8_t b = 0; b < off_size; b++) v = (v << 8) | base[pos + i * off_size + b];
+        return size_t(v);
+    };
+    // Offsets are 1-based from the byte before the object data
+    const size_t data_start = offsets_end - 1;
+    index.items.resize(count);
+    size_t previous = offset_at(0);
+    if (previous != 1) return false;
+    for (size_t i = 0; i < count; i++) {
+        size_t next = offset_at(i + 1);
+        if (next < previous || data_start + next > size) return false;
+        index.items[i] = {base + data_start + previous, next - previous};
+        previous = next;
+    }
+    pos = data_start + previous;
+    return true;
+}
+
+struct DictEntry {
+    uint16_t op;
+    std::vector<double> operands;
+};
+
+double parse_real(const uint8_t* data, size_t size, size_t& pos) {
+    std::string text;
+    bool done = false;
+    while (!done && pos < size) {
+        uint8_t byte = data[pos++];
+        for (uint8_t nibble : {uint8_t(byte >> 4), uint8_t(byte & 0xF)}) {
+            if (nibble <= 9) text += char('0' + nibble);
+            else if (nibble == 0xA) text += '.';
+            else if (nibble == 0xB) text += 'E';
+            else if (nibble == 0xC) text += "E-";
+            else if (nibble == 0xE) text += '-';
+            else if (nibble == 0xF) { done = true; break; }
+        }
+    }
+    return text.empty() ? 0 : std::strtod(text.c_str(), nullptr);
+}
+
+bool parse_dict(Span dict, std::vector<DictEntry>& entries) {
+    const uint8_t* d = dict.data;
+    std::vector<double> operands;
+    size_t pos = 0;
+    while (pos < dict.size) {
+        uint8_t b0 = d[pos++];
+        if (b0 == 23) {
+            // CFF2 blend: only the default values matter for the keys read here
+            if (operands.empty()) return false;
+            size_t n = size_t(std::max(0.0, operands.back()));
+            if (n >= operands.size()) return false;
+            operands.resize(n);
+        } else if (b0 <= 27) {
+            uint16_t op = b0;
+            if (b0 == 12) {
+                if (pos >= dict.size) return false;
+                op = uint16_t(1200 + d[pos++]);
+            }
+            entries.push_back({op, std::move(operands)});
+            operands.clear();
+        } else if (b0 == 28) {
+            if (pos + 2 > dict.size) return false;
+            operands.push_back(sfnt_i16(d + pos));
+            pos += 2;
+        } else if (b0 == 29) {
+            if (pos + 4 > dict.size) return false;
+            operands.push_back(int32_t(sfnt_u32(d + pos)));
+            pos += 4;
+        } else if (b0 == 30) {
+            operands.push_back(parse_real(d, dict.size, pos));
+        } else if (b0 >= 32 && b0 <= 246) {
+            operands.push_back(b0 - 139);
+        } else if (b0 >= 247 && b0 <= 250) {
+            if (pos >= dict.size) return false;
+            operands.push_back((b0 - 247) * 256 + d[pos++] + 108);
+        } else if (b0 >= 251 && b0 <= 254) {
+            if (pos >= dict.size) return false;
+            operands.push_back(-(b0 - 251) * 256 - d[pos++] - 108);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<double>* dict_find(const std::vector<DictEntry>& entries, uint16_t op) {
+    for (const auto& e : entries) {
+        if (e.op == op) return &e.operands;
+    }
+    return nullptr;
+}
+
+uint32_t subr_bias(size_t count) {
+    if (count < 1240) return 107;
+    if (count < 33900) return 1131;
+    return 32768;
+}
+
+struct AxisSupport {
+    double start, peak, end;
+};
+
+struct CffFont {
+    bool cff2 = false;
+    CffIndex charstrings;
+    CffIndex global_subrs;
+    std::vector<CffIndex> local_subrs;      // per Font DICT
+    std::vector<uint16_t> private_vsindex;  // per Font DICT
+    std::vector<uint16_t> fd_select;        // per glyph, empty for a single Font DICT
+
+    // CFF2 ItemVariationStore
+    uint16_t axis_count = 0;
+    std::vector<std::vector<AxisSupport>> regions;
+    std::vector<std::vector<uint16_t>> region_indices;  // per ItemVariationData
+};
+
+bool read_private(const uint8_t* base, size_t size, const std::vector<DictEntry>& font_dict,
+                  CffFont& font) {
+    CffIndex subrs;
+    uint16_t vsindex = 0;
+    const std::vector<double>* priv = dict_find(font_dict, OP_PRIVATE);
+    if (priv && priv->size() == 2 && (*priv)[0] > 0) {
+        size_t priv_size = size_t((*priv)[0]), priv_offset = size_t((*priv)[1]);
+        if (priv_offset > size || priv_size > size - priv_offset) return false;
+        std::vector<DictEntry> entries;
+        if (!parse_dict({base + priv_offset, priv_size}, entries)) return false;
+        if (const auto* v = dict_find(entries, OP_VSINDEX); v && !v->empty()) vsindex = uint16_t((*v)[0]);
+        if (const auto* s = dict_find(entries, OP_SUBRS); s && !s->empty()) {
+            size_t pos = priv_offset + size_t((*s)[0]);
+            if (!read_index(base, size, pos, font.cff2, subrs)) return false;
+        }
+    }
+    font.local_subrs.push_back(std::move(subrs));
+    font.private_vsindex.push_back(vsindex);
+    return true;
+}
+
+bool read_fd_select(const uint8_t* base, size_t size, size_t pos, size_t glyph_count, CffFont& font) {
+    if (pos >= size) return false;
+    font.fd_select.assign(glyph_count, 0);
+    const uint8_t format = base[pos++];
+    if (format == 0) {
+        if (pos + glyph_count > size) return false;
+        for (size_t g = 0; g < glyph_count; g++) font.fd_select[g] = base[pos + g];
+        return true;
+    }
+    if (format != 3 && format != 4) return false;
+    const bool wide = format == 4;
+    const size_t id_size = wide ? 4 : 2, range_size = id_size + (wide ? 2 : 1);
+    if (pos + id_size > size) return false;
+    const size_t ranges = wide ? sfnt_u32(base + pos) : sfnt_u16(base + pos);
+    pos += id_size;
+    if (ranges > (size - pos) / range_size || pos + ranges * range_size + id_size > size) return false;
+    for (size_t r = 0; r < ranges; r++) {
+        const uint8_t* p = base + pos + r * range_size;
+        size_t first = wide ? sfnt_u32(p) : sfnt_u16(p);
+        uint16_t fd = wide ? sfnt_u16(p + 4) : p[2];
+        const uint8_t* n = p + range_size;
+        size_t last = wide ? sfnt_u32(n) : sfnt_u16(n);
+        for (size_t g = first; g < last && g < glyph_count; g++) font.fd_select[g] = fd;
+    }
+    return true;
+}
+
+bool read_variation_store(const uint8_t* base, size_t size, size_t offset, CffFont& font) {
+    // A uint16 length precedes the ItemVariationStore in CFF2
+    const size_t store = offset + 2;
+    if (store + 8 > size || sfnt_u16(base + store) != 1) return false;
+    const size_t region_list = store + sfnt_u32(base + store + 2);
+    const uint16_t data_count = sfnt_u16(base + store + 6);
+    if (region_list + 4 > size || store + 8 + size_t(data_count) * 4 > size) return false;
+
+    font.axis_count = sfnt_u16(base + region_list);
+    const uint16_t region_count = sfnt_u16(base + region_list + 2);
+    if (region_list + 4 + size_t(region_count) * font.axis_count * 6 > size) return false;
+    font.regions.resize(region_count);
+    for (size_t r = 0; r < region_count; r++) {
+        for (size_t a = 0; a < font.axis_count; a++) {
+            const uint8_t* p = base + region_list + 4 + (r * font.axis_count + a) * 6;
+            font.regions[r].push_back({sfnt_i16(p) / 16384.0, sfnt_i16(p + 2) / 16384.0,
+                                       sfnt_i16(p + 4) / 16384.0});
+        }
+    }
+
+    for (size_t i = 0; i < data_count; i++) {
+        const size_t data = store + sfnt_u32(base + store + 8 + i * 4);
+        if (data + 6 > size) return false;
+        const uint16_t count = sfnt_u16(base + data + 4);
+        if (data + 6 + size_t(count) * 2 > size) return false;
+        std::vector<uint16_t> indices(count);
+        for (size_t r = 0; r < count; r++) {
+            indices[r] = sfnt_u16(base + data + 6 + r * 2);
+            if (indices[r] >= region_count) return false;
+        }
+        font.region_indices.push_back(std::move(indices));
+    }
+    return true;
+}
+
+bool parse_cff(const std::vector<uint8_t>& table, bool cff2, CffFont& font) {
+    const uint8_t* base = table.data();
+    const size_t size = table.size();
+    font.cff2 = cff2;
+    if (size < 5 || base[0] != (cff2 ? 2 : 1)) return false;
+
+    std::vector<DictEntry> top;
+    size_t pos = base[2];
+    if (cff2) {
+        const size_t top_size = sfnt_u16(base + 3);
+        if (pos + top_size > size || !parse_dict({base + pos, top_size}, top)) return false;
+        pos += top_size;
+    } else {
+        CffIndex names, tops, strings;
+        if (!read_index(base, size, pos, false, names) || !read_index(base, size, pos, false, tops) ||
+            !read_index(base, size, pos, false, strings) || tops.items.empty()) {
+            return false;
+        }
+        if (!parse_dict(tops.items[0], top)) return false;
+    }
+    if (!read_index(base, size, pos, cff2, font.global_subrs)) return false;
+
+    const auto* type = dict_find(top, OP_CHARSTRING_TYPE);
+    if (type && !type->empty() && (*type)[0] != 2) return false;
+    const auto* charstrings = dict_find(top, OP_CHARSTRINGS);
+    if (!charstrings || charstrings->empty()) return false;
+    pos = size_t((*charstrings)[0]);
+    if (!read_index(base, size, pos, cff2, font.charstrings)) return false;
+
+    if (const auto* vstore = dict_find(top, OP_VSTORE); vstore && !vstore->empty()) {
+        if (!cff2 || !read_variation_store(base, size, size_t((*vstore)[0]), font)) return false;
+    }
+
+    const auto* fd_array = dict_find(top, OP_FDARRAY);
+    if (!fd_array || fd_array->empty()) {
+        // Name-keyed CFF: the Top DICT carries the Private DICT itself
+        return !cff2 && read_private(base, size, top, font);
+    }
+    CffIndex fonts;
+    pos = size_t((*fd_array)[0]);
+    if (!read_index(base, size, pos, cff2, fonts) || fonts.items.empty()) return false;
+    for (const Span& fd : fonts.items) {
+        std::vector<DictEntry> entries;
+        if (!parse_dict(fd, entries) || !read_private(base, size, entries, font)) return false;
+    }
+    if (const auto* select = dict_find(top, OP_FDSELECT); select && !select->empty()) {
+        if (!read_fd_select(base, size, size_t((*select)[0]), font.charstrings.items.size(), font)) {
+            return false;
+        }
+        for (uint16_t fd : font.fd_select) {
+            if (fd >= fonts.items.size()) return false;
+        }
+    } else if (fonts.items.size() > 1) {
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Type 2 charstrings
+
+struct PathSegment {
+    bool cubic;
+    Point c1, c2, end;
+};
+
+struct PathContour {
+    Point start;
+    std::vector<PathSegment> segments;
+};
+
+using CubicPath = std::vector<PathContour>;
+
+// Evaluates charstrings with fixed CFF2 region weights: all zero gives the
+// default outline, a single 1 the outline at that region's peak
+class CharstringInterpreter {
+public:
+    CharstringInterpreter(const CffFont& font, const std::vector<double>& weights)
+        : font_(font), weights_(weights) {}
+
+    bool run(uint32_t glyph, CubicPath& path, uint16_t& vsindex) {
+        const size_t fd = font_.fd_select.empty() ? 0 : font_.fd_select[glyph];
+        local_subrs_ = &font_.local_subrs[fd];
+        vsindex_ = font_.private_vsindex[fd];
+        path_ = &path;
+        path.clear();
+        stack_.clear();
+        current_ = {0, 0};
+        stems_ = 0;
+        width_parsed_ = false;
+        open_ = false;
+
+        const Span& code = font_.charstrings.items[glyph];
+        Flow flow = execute(code.data, code.size, 0);
+        if (flow == Flow::Error) return false;
+        if (flow == Flow::Return) return false;  // stray return at the top level
+        vsindex = vsindex_;
+        return true;
+    }
+
+private:
+    enum class Flow { Continue, Return, End, Error };
+
+    Flow execute(const uint8_t* code, size_t size, int depth) {
+        if (depth > MAX_SUBR_DEPTH) return Flow::Error;
+        size_t pos = 0;
+        while (pos < size) {
+            const uint8_t b0 = code[pos++];
+            if (b0 >= 32 || b0 == 28) {
+                double value;
+                if (b0 == 28) {
+                    if (pos + 2 > size) return Flow::Error;
+                    value = sfnt_i16(code + pos);
+                    pos += 2;
+                } else if (b0 <= 246) {
+                    value = b0 - 139;
+                } else if (b0 <= 250) {
+                    if (pos >= size) return Flow::Error;
+                    value = (b0 - 247) * 256 + code[pos++] + 108;
+                } else if (b0 <= 254) {
+                    if (pos >= size) return Flow::Error;
+                    value = -(b0 - 251) * 256 - code[pos++] - 108;
+                } else {
+                    if (pos + 4 > size) return Flow::Error;
+                    value = int32_t(sfnt_u32(code + pos)) / 65536.0;
+                    pos += 4;
+                }
+                if (stack_.size() >= MAX_STACK) return Flow::Error;
+                stack_.push_back(value);
+                continue;
+            }
+
+            switch (b0) {
+                case 1: case 3: case 18: case 23:  // hstem, vstem, hstemhm, vstemhm
+                    take_width(stack_.size() % 2 == 1);
+                    stems_ += stack_.size() / 2;
+                    stack_.clear();
+                    break;
+                case 19: case 20:  // hintmask, cntrmask
+                    take_width(stack_.size() % 2 == 1);
+                    stems_ += stack_.size() / 2;
+                    stack_.clear();
+                    pos += (stems_ + 7) / 8;
+                    if (pos > size) return Flow::Error;
+                    break;
+                case 21:  // rmoveto
+                    take_width(stack_.size() > 2);
+                    if (stack_.size() < 2) return Flow::Error;
+                    move_to(current_ + Point{stack_[0], stack_[1]});
+                    break;
+                case 22:  // hmoveto
+                    take_width(stack_.size() > 1);
+                    if (stack_.empty()) return Flow::Error;
+                    move_to(current_ + Point{stack_[0], 0});
+                    break;
+                case 4:  // vmoveto
+                    take_width(stack_.size() > 1);
+                    if (stack_.empty()) return Flow::Error;
+                    move_to(current_ + Point{0, stack_[0]});
+                    break;
+                case 5:  // rlineto
+                    for (size_t i = 0; i + 1 < stack_.size(); i += 2) line_by(stack_[i], stack_[i + 1]);
+                    break;
+                case 6: case 7:  // hlineto, vlineto alternate starting horizontal or vertical
+                    for (size_t i = 0; i < stack_.size(); i++) {
+                        if ((i % 2 == 0) == (b0 == 6)) line_by(stack_[i], 0);
+                        else line_by(0, stack_[i]);
+                    }
+                    break;
+                case 8:  // rrcurveto
+                    for (size_t i = 0; i + 5 < stack_.size(); i += 6) curve_args(i);
+                    break;
+                case 24: {  // rcurveline
+                    if (stack_.size() < 8) return Flow::Error;
+                    size_t i = 0;
+                    for (; i + 8 <= stack_.size(); i += 6) curve_args(i);
+                    line_by(stack_[i], stack_[i + 1]);
+                    break;
+                }
+                case 25: {  // rlinecurve
+                    if (stack_.size() < 8) return Flow::Error;
+                    size_t i = 0;
+                    for (; i + 6 < stack_.size(); i += 2) line_by(stack_[i], stack_[i + 1]);
+                    curve_args(i);
+                    break;
+                }
+                case 26: {  // vvcurveto
+                    size_t i = 0;
+                    double dx1 = 0;
+                    if (stack_.size() % 4 == 1) dx1 = stack_[i++];
+                    for (; i + 3 < stack_.size(); i += 4) {
+                        curve_by(dx1, stack_[i], stack_[i + 1], stack_[i + 2], 0, stack_[i + 3]);
+                        dx1 = 0;
+                    }
+                    break;
+                }
+                case 27: {  // hhcurveto
+                    size_t i = 0;
+                    double dy1 = 0;
+                    if (stack_.size() % 4 == 1) dy1 = stack_[i++];
+                    for (; i + 3 < stack_.size(); i += 4) {
+                        curve_by(stack_[i], dy1, stack_[i + 1], stack_[i + 2], stack_[i + 3], 0);
+                        dy1 = 0;
+                    }
+                    break;
+                }
+                case 30: case 31: {  // vhcurveto, hvcurveto alternate tangents
+                    bool horizontal = b0 == 31;
+                    for (size_t i = 0; i + 3 < stack_.size(); i += 4) {
+                        const bool last = i + 8 > stack_.size();
+                        const double extra = last && i + 5 == stack_.size() ? stack_[i + 4] : 0;
+                        if (horizontal) curve_by(stack_[i], 0, stack_[i + 1], stack_[i + 2], extra, stack_[i + 3]);
+                        else curve_by(0, stack_[i], stack_[i + 1], stack_[i + 2], stack_[i + 3], extra);
+                        horizontal = !horizontal;
+                    }
+                    break;
+                }
+                case 10: case 29: {  // callsubr, callgsubr
+                    if (stack_.empty()) return Flow::Error;
+                    const CffIndex& subrs = b0 == 10 ? *local_subrs_ : font_.global_subrs;
+                    const double index = stack_.back() + subr_bias(subrs.items.size());
+                    stack_.pop_back();
+                    if (index < 0 || index >= double(subrs.items.size())) return Flow::Error;
+                    const Span& subr = subrs.items[size_t(index)];
+                    Flow flow = execute(subr.data, subr.size, depth + 1);
+                    if (flow == Flow::End || flow == Flow::Error) return flow;
+                    continue;  // operands left by the subroutine stay on the stack
+                }
+                case 11:  // return
+                    if (font_.cff2) return Flow::Error;
+                    return Flow::Return;
+                case 14:  // endchar
+                    if (font_.cff2) return Flow::Error;
+                    take_width(stack_.size() == 1 || stack_.size() == 5);
+                    if (!stack_.empty()) return Flow::Error;  // seac accented characters
+                    close();
+                    return Flow::End;
+                case 15:  // vsindex
+                    if (!font_.cff2 || stack_.empty()) return Flow::Error;
+                    vsindex_ = uint16_t(stack_.back());
+                    break;
+                case 16:  // blend
+                    if (!font_.cff2 || !blend()) return Flow::Error;
+                    continue;
+                case 12: {
+                    if (pos >= size) return Flow::Error;
+                    if (!flex(code[pos++])) return Flow::Error;
+                    break;
+                }
+                default:
+                    return Flow::Error;
+            }
+            stack_.clear();
+        }
+        if (depth == 0) close();
+        return depth == 0 ? Flow::End : Flow::Return;
+    }
+
+    // The advance width is an optional first operand of the first
+    // stack-clearing operator; hmtx already has it, so it is dropped
+    void take_width(bool present) {
+        if (width_parsed_ || font_.cff2) return;
+        width_parsed_ = true;
+        if (present && !stack_.empty()) stack_.erase(stack_.begin());
+    }
+
+    bool blend() {
+        if (stack_.empty() || vsindex_ >= font_.region_indices.size()) return false;
+        const std::vector<uint16_t>& regions = font_.region_indices[vsindex_];
+        const double count_value = stack_.back();
+        stack_.pop_back();
+        if (count_value < 0) return false;
+        const size_t n = size_t(count_value), k = regions.size();
+        if (n * (k + 1) > stack_.size()) return false;
+        const size_t base = stack_.size() - n * (k + 1);
+        for (size_t i = 0; i < n; i++) {
+            double value = stack_[base + i];
+            for (size_t j = 0; j < k; j++) value += weights_[regions[j]] * stack_[base + n + i * k + j];
+            stack_[base + i] = value;
+        }
+        stack_.resize(base + n);
+        return true;
+    }
+
+    bool flex(uint8_t op) {
+        const std::vector<double>& s = stack_;
+        const Point start = current_;
+        switch (op) {
+            case 35:  // flex
+                if (s.size() < 13) return false;
+                curve_by(s[0], s[1], s[2], s[3], s[4], s[5]);
+                curve_by(s[6], s[7], s[8], s[9], s[10], s[11]);
+                return true;
+            case 34:  // hflex
+                if (s.size() < 7) return false;
+                curve_by(s[0], 0, s[1], s[2], s[3], 0);
+                curve_by(s[4], 0, s[5], -s[2], s[6], 0);
+                return true;
+            case 36:  // hflex1
+                if (s.size() < 9) return false;
+                curve_by(s[0], s[1], s[2], s[3], s[4], 0);
+                curve_by(s[5], 0, s[6], s[7], s[8], start.y - (current_.y + s[7]));
+                return true;
+            case 37: {  // flex1: the last delta runs along the dominant direction
+                if (s.size() < 11) return false;
+                const double dx = s[0] + s[2] + s[4] + s[6] + s[8];
+                const double dy = s[1] + s[3] + s[5] + s[7] + s[9];
+                curve_by(s[0], s[1], s[2], s[3], s[4], s[5]);
+                if (std::fabs(dx) > std::fabs(dy)) curve_by(s[6], s[7], s[8], s[9], s[10], -dy);
+                else curve_by(s[6], s[7], s[8], s[9], -dx, s[10]);
+                return true;
+            }
+            default:
+                return false;  // arithmetic and storage operators are not used by fonts in practice
+        }
+    }
+
+    void move_to(Point p) {
+        close();
+        current_ = p;
+    }
+
+    void ensure_open() {
+        if (open_) return;
+        path_->push_back({current_, {}});
+        open_ = true;
+    }
+
+    void close() { open_ = false; }
+
+    void line_by(double dx, double dy) {
+        ensure_open();
+        Point end = current_ + Point{dx, dy};
+        path_->back().segments.push_back({false, current_, end, end});
+        current_ = end;
+    }
+
+    void curve_args(size_t i) {
+        curve_by(stack_[i], stack_[i + 1], stack_[i + 2], stack_[i + 3], stack_[i + 4], stack_[i + 5]);
+    }
+
+    void curve_by(double dx1, double dy1, double dx2, double dy2, double dx3, double dy3) {
+        ensure_open();
+        Point c1 = current_ + Point{dx1, dy1};
+        Point c2 = c1 + Point{dx2, dy2};
+        Point end = c2 + Point{dx3, dy3};
+        path_->back().segments.push_back({true, c1, c2, end});
+        current_ = end;
+    }
+
+    const CffFont& font_;
+    const std::vector<double>& weights_;
+    const CffIndex* local_subrs_ = nullptr;
+    CubicPath* path_ = nullptr;
+    std::vector<double> stack_;
+    Point current_{0, 0};
+    size_t stems_ = 0;
+    uint16_t vsindex_ = 0;
+    bool width_parsed_ = false;
+    bool open_ = false;
+};
+
+bool same_structure(const CubicPath& a, const CubicPath& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t c = 0; c < a.size(); c++) {
+        if (a[c].segments.size() != b[c].segments.size()) return false;
+        for (size_t s = 0; s < a[c].segments.size(); s++) {
+            if (a[c].segments[s].cubic != b[c].segments[s].cubic) return false;
+        }
+    }
+    return true;
+}
+
+// |a| + |b| * scale, point by point
+CubicPath combine(const CubicPath& a, const CubicPath& b, double scale) {
+    CubicPath out = a;
+    for (size_t c = 0; c < out.size(); c++) {
+        out[c].start = out[c].start + b[c].start * scale;
+        for (size_t s = 0; s < out[c].segments.size(); s++) {
+            PathSegment& seg = out[c].segments[s];
+            const PathSegment& other = b[c].segments[s];
+            seg.c1 = seg.c1 + other.c1 * scale;
+            seg.c2 = seg.c2 + other.c2 * scale;
+            seg.end = seg.end + other.end * scale;
+        }
+    }
+    return out;
+}
+
+double region_scalar(const std::vector<AxisSupport>& region, const std::vector<double>& location) {
+    double scalar = 1;
+    for (size_t a = 0; a < region.size(); a++) {
+        const AxisSupport& s = region[a];
+        const double v = location[a];
+        if (s.peak == 0 || s.start > s.peak || s.peak > s.end || (s.start < 0 && s.end > 0)) continue;
+        if (v == s.peak) continue;
+        if (v <= s.start || v >= s.end) return 0;
+        scalar *= v < s.peak ? (v - s.start) / (s.peak - s.start) : (s.end - v) / (s.end - s.peak);
+    }
+    return scalar;
+}
+
+// ---------------------------------------------------------------------------
+// Cubic to quadratic
+
+struct Cubic {
+    Point p0, c1, c2, p3;
+};
+
+Point cubic_point(const Cubic& c, double t) {
+    const double u = 1 - t;
+    return c.p0 * (u * u * u) + c.c1 * (3 * u * u * t) + c.c2 * (3 * u * t * t) + c.p3 * (t * t * t);
+}
+
+Point cubic_derivative(const Cubic& c, double t) {
+    const double u = 1 - t;
+    return (c.c1 - c.p0) * (3 * u * u) + (c.c2 - c.c1) * (6 * u * t) + (c.p3 - c.c2) * (3 * t * t);
+}
+
+// The part of |c| between |a| and |b|; linear in the control points, so
+// it applies to delta outlines as well
+Cubic cubic_piece(const Cubic& c, double a, double b) {
+    const Point start = cubic_point(c, a), end = cubic_point(c, b);
+    const double third = (b - a) / 3;
+    return {start, start + cubic_derivative(c, a) * third, end - cubic_derivative(c, b) * third, end};
+}
+
+// The quadratic control point that matches the cubic's ends and midpoint
+Point quad_control(const Cubic& c) {
+    return ((c.c1 + c.c2) * 3 - c.p0 - c.p3) * 0.25;
+}
+
+// Control points of an n-quad spline through the cubic; the on-curve points
+// between them are implied midpoints
+std::vector<Point> quad_spline(const Cubic& c, int n) {
+    std::vector<Point> controls(static_cast<size_t>(n));
+    for (int k = 0; k < n; k++) controls[size_t(k)] = quad_control(cubic_piece(c, double(k) / n, double(k + 1) / n));
+    return controls;
+}
+
+bool spline_within(const Cubic& c, const std::vector<Point>& controls, double tolerance) {
+    const size_t n = controls.size();
+    for (size_t k = 0; k < n; k++) {
+        const Point from = k == 0 ? c.p0 : (controls[k - 1] + controls[k]) * 0.5;
+        const Point to = k + 1 == n ? c.p3 : (controls[k] + controls[k + 1]) * 0.5;
+        for (int i = 0; i <= ERROR_SAMPLES; i++) {
+            const double s = double(i) / ERROR_SAMPLES, u = 1 - s;
+            const Point q = from * (u * u) + controls[k] * (2 * u * s) + to * (s * s);
+            if (distance(q, cubic_point(c, (k + s) / n)) > tolerance) return false;
+        }
+    }
+    return true;
+}
+
+Cubic cubic_at(const PathContour& contour, size_t segment) {
+    const Point from = segment ? contour.segments[segment - 1].end : contour.start;
+    const PathSegment& s = contour.segments[segment];
+    return {from, s.c1, s.c2, s.end};
+}
+
+bool is_line(const Cubic& c) {
+    return same_point(c.c1, c.p0) && same_point(c.c2, c.p3);
+}
+
+// Quads needed so that every master shape of the cubic stays within tolerance
+int quads_needed(const std::vector<CubicPath>& shapes, size_t contour, size_t segment, double tolerance) {
+    for (int n = 1; n <= MAX_QUADS_PER_CUBIC; n++) {
+        bool fits = true;
+        for (const CubicPath& shape : shapes) {
+            const Cubic c = cubic_at(shape[contour], segment);
+            if (!spline_within(c, quad_spline(c, n), tolerance)) {
+                fits = false;
+                break;
+            }
+        }
+        if (fits) return n;
+    }
+    return -1;
+}
+
+// Quadratic points of one glyph, for the default outline (layer 0) and
+// each region's delta outline
+struct QuadGlyph {
+    std::vector<uint16_t> end_points;
+    std::vector<uint8_t> on_curve;
+    std::vector<std::vector<Point>> layers;
+};
+
+bool convert_glyph(const std::vector<CubicPath>& layers, const std::vector<CubicPath>& shapes,
+                   double tolerance, QuadGlyph& glyph, CffConversionStats& stats) {
+    glyph.layers.assign(layers.size(), {});
+    const CubicPath& base = layers[0];
+    for (size_t c = 0; c < base.size(); c++) {
+        const size_t segments = base[c].segments.size();
+        if (!segments) continue;
+
+        const size_t first = glyph.on_curve.size();
+        auto emit = [&](bool on, auto&& point_of) {
+            glyph.on_curve.push_back(on);
+            for (size_t l = 0; l < layers.size(); l++) glyph.layers[l].push_back(point_of(layers[l][c]));
+        };
+
+        // A closing segment that ends on the start point leaves a duplicate
+        bool closed = true;
+        for (const CubicPath& layer : layers) {
+            closed = closed && same_point(layer[c].segments.back().end, layer[c].start);
+        }
+
+        emit(true, [](const PathContour& contour) { return contour.start; });
+        for (size_t s = 0; s < segments; s++) {
+            const bool last_on_start = closed && s + 1 == segments;
+            if (base[c].segments[s].cubic) {
+                bool line = true;
+                for (const CubicPath& layer : layers) line = line && is_line(cubic_at(layer[c], s));
+                if (!line) {
+                    const int n = quads_needed(shapes, c, s, tolerance);
+                    if (n < 0) return false;
+                    stats.cubics++;
+                    stats.quads += size_t(n);
+                    for (int k = 0; k < n; k++) {
+                        emit(false, [&](const PathContour& contour) {
+                            const Cubic cubic = cubic_at(contour, s);
+                            return quad_control(cubic_piece(cubic, double(k) / n, double(k + 1) / n));
+                        });
+                    }
+                }
+            }
+            if (!last_on_start) {
+                emit(true, [&](const PathContour& contour) { return contour.segments[s].end; });
+            }
+        }
+
+        // CFF winds counter-clockwise, TrueType clockwise; keep the start point first
+        std::reverse(glyph.on_curve.begin() + long(first) + 1, glyph.on_curve.end());
+        for (auto& points : glyph.layers) std::reverse(points.begin() + long(first) + 1, points.end());
+
+        if (glyph.on_curve.size() - first < 2) {
+            glyph.on_curve.resize(first);
+            for (auto& points : glyph.layers) points.resize(first);
+            continue;
+        }
+        if (glyph.on_curve.size() > 0xFFFF) return false;
+        glyph.end_points.push_back(uint16_t(glyph.on_curve.size() - 1));
+    }
+    return true;
+}
+
+int32_t round_coordinate(double v) {
+    return int32_t(std::lround(v));
+}
+
+void append_f2dot14(std::vector<uint8_t>& out, double v) {
+    sfnt_append_u16(out, uint16_t(int16_t(std::lround(v * 16384))));
+}
+
+} // namespace
+
+bool convert_cff_to_glyf(SfntFont& font, CffConversionStats& stats) {
+    const bool cff2 = font.find(TAG_CFF2) != nullptr;
+    const std::vector<uint8_t>* table = cff2 ? font.find(TAG_CFF2) : font.find(TAG_CFF);
+    std::vector<uint8_t>* head = font.find(TAG_HEAD);
+    std::vector<uint8_t>* maxp = font.find(TAG_MAXP);
+    if (!table || !head || !maxp || head->size() < 54 || maxp->size() < 6) return false;
+
+    CffFont cff;
+    if (!parse_cff(*table, cff2, cff)) return false;
+    const uint16_t glyph_count = sfnt_u16(maxp->data() + 4);
+    if (cff.charstrings.items.size() != glyph_count) return false;
+
+    // gvar needs fvar's axes; a CFF2 font without them only keeps its default
+    const std::vector<uint8_t>* fvar = font.find(TAG_FVAR);
+    const bool variable = !cff.regions.empty() && cff.regions.size() < 0x1000 && fvar && fvar->size() >= 16 &&
+                          sfnt_u16(fvar->data() + 8) == cff.axis_count;
+    const size_t region_count = variable ? cff.regions.size() : 0;
+
+    const double tolerance = sfnt_u16(head->data() + 18) * TOLERANCE_PER_EM;
+    std::vector<double> weights(cff.regions.size(), 0.0);
+    CharstringInterpreter interpreter(cff, weights);
+
+    std::vector<std::vector<double>> peaks(region_count);
+    for (size_t r = 0; r < region_count; r++) {
+        for (const AxisSupport& s : cff.regions[r]) peaks[r].push_back(s.peak);
+    }
+
+    std::vector<std::vector<uint8_t>> glyphs(glyph_count);
+    std::vector<std::vector<uint8_t>> variations(glyph_count);
+    std::vector<int16_t> x_min(glyph_count, 0);
+    std::vector<bool> has_outline(glyph_count, false);
+    CffConversionStats counts;
+
+    for (uint32_t g = 0; g < glyph_count; g++) {
+        std::fill(weights.begin(), weights.end(), 0.0);
+        std::vector<CubicPath> layers(1);
+        uint16_t vsindex = 0;
+        if (!interpreter.run(g, layers[0], vsindex)) return false;
+
+        // One delta outline per region the glyph blends over
+        std::vector<uint16_t> regions;
+        if (variable && vsindex < cff.region_indices.size()) regions = cff.region_indices[vsindex];
+        for (uint16_t r : regions) {
+            std::fill(weights.begin(), weights.end(), 0.0);
+            weights[r] = 1;
+            CubicPath at_peak;
+            uint16_t unused;
+            if (!interpreter.run(g, at_peak, unused) || !same_structure(at_peak, layers[0])) return false;
+            layers.push_back(combine(at_peak, layers[0], -1));
+        }
+
+        // The outline at each region's peak, with every overlapping region applied
+        std::vector<CubicPath> shapes{layers[0]};
+        for (uint16_t r : regions) {
+            CubicPath shape = layers[0];
+            for (size_t j = 0; j < regions.size(); j++) {
+                double scalar = region_scalar(cff.regions[regions[j]], peaks[r]);
+                if (scalar != 0) shape = combine(shape, layers[j + 1], scalar);
+            }
+            shapes.push_back(std::move(shape));
+        }
+
+        QuadGlyph quad;
+        if (!convert_glyph(layers, shapes, tolerance, quad, counts)) return false;
+        if (quad.end_points.empty()) continue;
+
+        std::vector<GlyphPoint> points(quad.on_curve.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            points[i] = {round_coordinate(quad.layers[0][i].x), round_coordinate(quad.layers[0][i].y),
+                         quad.on_curve[i] != 0};
+        }
+        if (!encode_simple_glyph(quad.end_points, points, glyphs[g], x_min[g])) return false;
+        has_outline[g] = true;
+
+        std::vector<TupleDeltas> tuples;
+        for (size_t j = 0; j < regions.size(); j++) {
+            const std::vector<AxisSupport>& region = cff.regions[regions[j]];
+            TupleDeltas tuple;
+            tuple.index = regions[j];
+            // Regions with non-default start / end need intermediate coordinates
+            bool intermediate = false;
+            for (const AxisSupport& s : region) {
+                intermediate = intermediate || s.start != std::min(0.0, s.peak) || s.end != std::max(0.0, s.peak);
+            }
+            if (intermediate) {
+                tuple.index |= 0x4000;
+                for (const AxisSupport& s : region) append_f2dot14(tuple.coordinates, s.start);
+                for (const AxisSupport& s : region) append_f2dot14(tuple.coordinates, s.end);
+            }
+            for (const Point& p : quad.layers[j + 1]) {
+                tuple.x.push_back(round_coordinate(p.x));
+                tuple.y.push_back(round_coordinate(p.y));
+            }
+            tuple.x.resize(tuple.x.size() + PHANTOM_POINTS, 0);
+            tuple.y.resize(tuple.y.size() + PHANTOM_POINTS, 0);
+            tuples.push_back(std::move(tuple));
+        }
+        encode_glyph_variations(tuples, variations[g]);
+    }
+
+    // Everything converted; only now is the font touched
+    stats = counts;
+    stats.glyphs = glyph_count;
+    stats.regions = region_count;
+
+    font.tables.erase(TAG_CFF);
+    font.tables.erase(TAG_CFF2);
+    font.tables.erase(TAG_VORG);
+    font.version = 0x00010000;
+
+    // glyf needs maxp 1.0; the TrueType-only fields stay zero without hinting
+    std::vector<uint8_t> new_maxp(32, 0);
+    sfnt_put_u32(new_maxp.data(), 0x00010000);
+    sfnt_put_u16(new_maxp.data() + 4, glyph_count);
+    sfnt_put_u16(new_maxp.data() + 14, 2);  // maxZones
+    update_maxp_counts(new_maxp, glyphs);
+    font.tables[TAG_MAXP] = std::move(new_maxp);
+
+    head = font.find(TAG_HEAD);
+    bool any = false;
+    int16_t bounds[4] = {0, 0, 0, 0};
+    for (size_t g = 0; g < glyph_count; g++) {
+        if (!has_outline[g]) continue;
+        const uint8_t* p = glyphs[g].data() + 2;
+        for (int i = 0; i < 4; i++) {
+            int16_t v = sfnt_i16(p + i * 2);
+            if (!any) bounds[i] = v;
+            else bounds[i] = i < 2 ? std::min(bounds[i], v) : std::max(bounds[i], v);
+        }
+        any = true;
+    }
+    for (int i = 0; i < 4; i++) sfnt_put_u16(head->data() + 36 + i * 2, uint16_t(bounds[i]));
+    sfnt_put_u16(head->data() + 52, 0);  // glyphDataFormat
+    write_glyf_loca(font, glyphs);
+
+    if (region_count) {
+        std::vector<uint8_t> shared;
+        for (const auto& peak : peaks) {
+            for (double v : peak) append_f2dot14(shared, v);
+        }
+        font.tables[TAG_GVAR] = build_gvar(cff.axis_count, shared.data(), uint16_t(region_count), variations);
+    }
+
+    // CFF has no side bearings of its own; TrueType expects lsb == xMin
+    std::vector<uint8_t>* hhea = font.find(TAG_HHEA);
+    std::vector<uint8_t>* hmtx = font.find(TAG_HMTX);
+    if (hhea && hmtx && hhea->size() >= 36) {
+        const size_t metrics = sfnt_u16(hhea->data() + 34);
+        for (size_t g = 0; g < glyph_count; g++) {
+            if (!has_outline[g]) continue;
+            size_t pos = g < metrics ? g * 4 + 2 : metrics * 4 + (g - metrics) * 2;
+            if (pos + 2 > hmtx->size()) continue;
+            sfnt_put_u16(hmtx->data() + pos, uint16_t(x_min[g]));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef FONTSUBSETTING_CFF_CONVERTER_H
+#define FONTSUBSETTING_CFF_CONVERTER_H
+
+#include <cstddef>
+#include "sfnt_tables.h"
+
+struct CffConversionStats {
+    size_t glyphs = 0;
+    size_t cubics = 0;
+    size_t quads = 0;
+    size_t regions = 0;  // CFF2 variation regions carried over to gvar
+};
+
+// Replaces 'CFF ' or 'CFF2' outlines with quadratic glyf outlines, so the
+// font takes the TrueType path on devices whose HarfBuzz lacks CFF.
+//
+// Charstrings are interpreted directly (subroutines, hint masks, flex and
+// CFF2 blends). Every cubic becomes a quadratic spline within upem / 1000
+// of it; the number of quads per cubic is chosen so it holds at every
+// variation region's peak, letting CFF2 regions map one-to-one onto gvar
+// tuples. Contours are reversed to TrueType's clockwise direction and side
+// bearings are set to the new xMin.
+//
+// Returns false (and leaves |font| as is) when the font has no CFF table
+// or a charstring cannot be converted.
+bool convert_cff_to_glyf(SfntFont& font, CffConversionStats& stats);
+
+#endif // FONTSUBSETTING_CFF_CONVERTER_H
@@ -0,0 +1,250 @@
+#include "font_chunker.h"
+#include "glyf_tables.h"
+
+namespace {
+
+constexpr uint32_t TAG_GVAR = sfnt_tag('g', 'v', 'a', 'r');
+constexpr uint32_t TAG_CHUNKS = sfnt_tag('G', 'C', 'H', 'K');
+
+// Must match glyph_chunks.h in the runtime
+constexpr uint32_t CHUNK_MAGIC = TAG_CHUNKS;
+constexpr uint16_t CHUNK_VERSION = 1;
+constexpr uint16_t CHUNK_FLAG_GVAR = 0x0001;
+
+// Outlines that aren't glyf, and color glyphs whose layers the runtime
+// would have to load alongside them
+const uint32_t REJECTED_TABLES[] = {
+    sfnt_tag('C', 'F', 'F', ' '), sfnt_tag('C', 'F', 'F', '2'), sfnt_tag('C', 'O', 'L', 'R'),
+    sfnt_tag('S', 'V', 'G', ' '), sfnt_tag('s', 'b', 'i', 'x'), sfnt_tag('C', 'B', 'D', 'T'),
+    sfnt_tag('E', 'B', 'D', 'T'),
+};
+
+// Tables whose bytes identify a base; chunks of another build won't apply
+const uint32_t FONT_ID_TABLES[] = {
+    sfnt_tag('g', 'l', 'y', 'f'), sfnt_tag('l', 'o', 'c', 'a'), TAG_GVAR, sfnt_tag('c', 'm', 'a', 'p'),
+};
+
+constexpr int MAX_COMPONENT_DEPTH = 16;
+constexpr int UNREACHED = -1;
+constexpr int BASE = -2;
+
+std::string tag_name(uint32_t tag) {
+    return {char(tag >> 24), char(tag >> 16), char(tag >> 8), char(tag)};
+}
+
+std::vector<uint16_t> component_ids(const std::vector<uint8_t>& glyph) {
+    std::vector<uint16_t> ids;
+    if (glyph.size() < 10 || sfnt_i16(glyph.data()) >= 0) return ids;
+    size_t pos = 10;
+    while (pos + 4 <= glyph.size()) {
+        uint16_t flags = sfnt_u16(glyph.data() + pos);
+        ids.push_back(sfnt_u16(glyph.data() + pos + 2));
+        pos += 4 + ((flags & 0x0001) ? 4 : 2);
+        if (flags & 0x0008) pos += 2;
+        else if (flags & 0x0040) pos += 4;
+        else if (flags & 0x0080) pos += 8;
+        if (!(flags & 0x0020)) break;
+    }
+    return ids;
+}
+
+// Marks |glyph| and its components as reached from |group| (or BASE); a
+// glyph reached from two groups falls back to the base
+void reach(const std::vector<std::vector<uint8_t>>& glyphs, uint32_t glyph, int group,
+           std::vector<int>& owner, int depth) {
+    if (glyph >= glyphs.size() || depth > MAX_COMPONENT_DEPTH) return;
+    const int updated = owner[glyph] == UNREACHED || owner[glyph] == group ? group : BASE;
+    if (updated == owner[glyph]) return;
+    owner[glyph] = updated;
+    for (uint16_t component : component_ids(glyphs[glyph])) {
+        reach(glyphs, component, updated, owner, depth + 1);
+    }
+}
+
+// Per glyph GlyphVariationData of a gvar table
+struct GvarGlyphs {
+    uint16_t axis_count = 0;
+    uint16_t shared_count = 0;
+    const uint8_t* shared_tuples = nullptr;
+    std::vector<std::vector<uint8_t>> data;
+};
+
+bool read_gvar_glyphs(const std::vector<uint8_t>& table, size_t glyph_count, GvarGlyphs& gvar) {
+    const uint8_t* data = table.data();
+    const size_t size = table.size();
+    if (size < 20 || sfnt_u16(data + 12) != glyph_count) return false;
+
+    gvar.axis_count = sfnt_u16(data + 4);
+    gvar.shared_count = sfnt_u16(data + 6);
+    const uint32_t shared_offset = sfnt_u32(data + 8);
+    const bool long_offsets = sfnt_u16(data + 14) & 1;
+    const uint32_t array_offset = sfnt_u32(data + 16);
+    if (shared_offset > size ||
+        size_t(gvar.shared_count) * gvar.axis_count * 2 > size - shared_offset) {
+        return false;
+    }
+    gvar.shared_tuples = data + shared_offset;
+
+    const size_t entry = long_offsets ? 4 : 2;
+    if (20 + (glyph_count + 1) * entry > size) return false;
+    gvar.data.resize(glyph_count);
+    for (size_t g = 0; g < glyph_count; g++) {
+        const uint8_t* p = data + 20 + g * entry;
+        uint64_t start = uint64_t(array_offset) + (long_offsets ? sfnt_u32(p) : uint32_t(sfnt_u16(p)) * 2);
+        uint64_t end = uint64_t(array_offset) +
+                       (long_offsets ? sfnt_u32(p + entry) : uint32_t(sfnt_u16(p + entry)) * 2);
+        if (start > end || end > size) return false;
+        gvar.data[g].assign(data + start, data + end);
+    }
+    return true;
+}
+
+// FNV-1a over the tables that chunks patch or index into
+uint32_t font_id(const SfntFont& font) {
+    uint32_t hash = 0x811C9DC5u;
+    for (uint32_t tag : FONT_ID_TABLES) {
+        auto it = font.tables.find(tag);
+        if (it == font.tables.end()) continue;
+        for (uint8_t byte : it->second) {
+            hash = (hash ^ byte) * 0x01000193u;
+        }
+    }
+    return hash;
+}
+
+// glyph ids, glyf offsets, gvar offsets (if any), glyf data, gvar data
+std::vector<uint8_t> build_chunk(uint16_t index, uint32_t id, const std::vector<uint16_t>& ids,
+                                 const std::vector<std::vector<uint8_t>>& glyphs,
+                                 const std::vector<std::vector<uint8_t>>* variations) {
+    std::vector<uint8_t> out;
+    sfnt_append_u32(out, CHUNK_MAGIC);
+    sfnt_append_u16(out, CHUNK_VERSION);
+    sfnt_append_u16(out, index);
+    sfnt_append_u32(out, id);
+    sfnt_append_u16(out, uint16_t(ids.size()));
+    sfnt_append_u16(out, variations ? CHUNK_FLAG_GVAR : 0);
+    for (uint16_t g : ids) sfnt_append_u16(out, g);
+
+    auto append_offsets = [&](const std::vector<std::vector<uint8_t>>& blocks) {
+        uint32_t offset = 0;
+        sfnt_append_u32(out, 0);
+        for (uint16_t g : ids) {
+            offset += uint32_t(blocks[g].size());
+            sfnt_append_u32(out, offset);
+        }
+    };
+    append_offsets(glyphs);
+    if (variations) append_offsets(*variations);
+    for (uint16_t g : ids) out.insert(out.end(), glyphs[g].begin(), glyphs[g].end());
+    if (variations) {
+        for (uint16_t g : ids) out.insert(out.end(), (*variations)[g].begin(), (*variations)[g].end());
+    }
+    return out;
+}
+
+} // namespace
+
+bool split_font_chunks(SfntFont& font, const std::map<uint32_t, uint32_t>& cmap,
+                       const std::vector<ChunkGroup>& groups,
+                       std::vector<std::vector<uint8_t>>& chunks, ChunkStats& stats) {
+    for (uint32_t tag : REJECTED_TABLES) {
+        if (font.find(tag)) {
+            stats.error = "fonts with a '" + tag_name(tag) + "' table cannot be split into chunks";
+            return false;
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> glyphs;
+    if (!read_glyf_loca(font, glyphs)) {
+        stats.error = "the font has no readable glyf outlines";
+        return false;
+    }
+
+    GvarGlyphs gvar;
+    const std::vector<uint8_t>* gvar_table = font.find(TAG_GVAR);
+    if (gvar_table && !read_gvar_glyphs(*gvar_table, glyphs.size(), gvar)) {
+        stats.error = "the font's gvar table is malformed";
+        return false;
+    }
+
+    if (groups.size() > 0xFFFF) {
+        stats.error = "too many chunk groups";
+        return false;
+    }
+    std::map<uint32_t, int> group_of;
+    for (size_t i = 0; i < groups.size(); i++) {
+        if (groups[i].name.empty() || groups[i].name.size() > 0xFFFF ||
+            groups[i].name.find('/') != std::string::npos) {
+            stats.error = "invalid chunk name '" + groups[i].name + "'";
+            return false;
+        }
+        for (uint32_t codepoint : groups[i].codepoints) {
+            auto inserted = group_of.emplace(codepoint, int(i));
+            if (!inserted.second && inserted.first->second != int(i)) inserted.first->second = BASE;
+        }
+    }
+
+    std::vector<int> owner(glyphs.size(), UNREACHED);
+    std::vector<bool> grouped(glyphs.size());
+    owner[0] = BASE;
+    for (const auto& entry : cmap) {
+        auto it = group_of.find(entry.first);
+        if (it != group_of.end() && entry.second < glyphs.size()) grouped[entry.second] = true;
+        reach(glyphs, entry.second, it != group_of.end() ? it->second : BASE, owner, 0);
+    }
+
+    // Glyphs of each group, ascending; the base keeps an empty entry for them
+    std::vector<std::vector<uint16_t>> chunk_glyphs(groups.size());
+    for (size_t g = 0; g < glyphs.size(); g++) {
+        if (owner[g] >= 0) {
+            chunk_glyphs[owner[g]].push_back(uint16_t(g));
+            stats.chunked_glyphs++;
+        } else if (grouped[g]) {
+            stats.shared_glyphs++;
+        }
+    }
+
+    chunks.assign(groups.size(), {});
+    for (const auto& ids : chunk_glyphs) {
+        if (ids.empty()) stats.empty_groups++;
+    }
+    if (stats.chunked_glyphs == 0) return true;
+
+    std::vector<std::vector<uint8_t>> base_glyphs(glyphs);
+    std::vector<std::vector<uint8_t>> base_variations(gvar.data);
+    for (const auto& ids : chunk_glyphs) {
+        for (uint16_t g : ids) {
+            base_glyphs[g].clear();
+            if (gvar_table) base_variations[g].clear();
+        }
+    }
+    if (gvar_table) {
+        std::vector<uint8_t> rebuilt = build_gvar(gvar.axis_count, gvar.shared_tuples, gvar.shared_count,
+                                                  base_variations);
+        font.tables[TAG_GVAR] = std::move(rebuilt);
+    }
+    write_glyf_loca(font, base_glyphs);
+    const uint32_t id = font_id(font);
+
+    std::vector<uint8_t> table;
+    uint16_t chunk_count = 0;
+    for (const auto& ids : chunk_glyphs) {
+        if (!ids.empty()) chunk_count++;
+    }
+    sfnt_append_u16(table, CHUNK_VERSION);
+    sfnt_append_u16(table, chunk_count);
+    sfnt_append_u32(table, id);
+
+    uint16_t index = 0;
+    for (size_t i = 0; i < groups.size(); i++) {
+        const std::vector<uint16_t>& ids = chunk_glyphs[i];
+        if (ids.empty()) continue;
+        sfnt_append_u16(table, uint16_t(groups[i].name.size()));
+        table.insert(table.end(), groups[i].name.begin(), groups[i].name.end());
+        sfnt_append_u16(table, uint16_t(ids.size()));
+        for (uint16_t g : ids) sfnt_append_u16(table, g);
+        chunks[i] = build_chunk(index++, id, ids, glyphs, gvar_table ? &gvar.data : nullptr);
+    }
+    font.tables[TAG_CHUNKS] = std::move(table);
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef FONTSUBSETTING_FONT_CHUNKER_H
+#define FONTSUBSETTING_FONT_CHUNKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "sfnt_tables.h"
+
+// Icons that are loaded together, named by the file their chunk is shipped as
+struct ChunkGroup {
+    std::string name;
+    std::vector<uint32_t> codepoints;
+};
+
+struct ChunkStats {
+    size_t chunked_glyphs = 0;
+    size_t shared_glyphs = 0;   // reached from several groups, kept in the base
+    size_t empty_groups = 0;    // every glyph shared; no chunk written
+    std::string error;          // why the font was not split
+};
+
+// Splits the subset font |font| (nominal cmap |cmap|) into a base and one
+// chunk per group, in the format of the runtime's glyph_chunks.h. A glyph
+// moves to a group's chunk when only that group's codepoints reach it,
+// components included; everything else stays in the base. The base keeps
+// every glyph id with the chunked glyphs' glyf and gvar data emptied, and
+// lists the chunks in a 'GCHK' table.
+//
+// |chunks|[i] receives the chunk file of groups[i], empty when the group has
+// no glyphs of its own. Returns false (and leaves |font| as is) for fonts
+// without glyf outlines or with color tables; |stats.error| says why.
+bool split_font_chunks(SfntFont& font, const std::map<uint32_t, uint32_t>& cmap,
+                       const std::vector<ChunkGroup>& groups,
+                       std::vector<std::vector<uint8_t>>& chunks, ChunkStats& stats);
+
+#endif // FONTSUBSETTING_FONT_CHUNKER_H
@@ -0,0 +1,260 @@
+#include "font_delta.h"
+#include "sfnt_tables.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// Must match font_delta.h in the runtime
+constexpr uint32_t DELTA_MAGIC = sfnt_tag('F', 'D', 'L', 'T');
+constexpr uint16_t DELTA_VERSION = 1;
+constexpr size_t MAX_FONT_SIZE = size_t(64) << 20;
+constexpr uint8_t OP_COPY = 0;
+constexpr uint8_t OP_INSERT = 1;
+
+// A copy op takes 9 bytes; shorter matches are cheaper inserted
+constexpr uint32_t MIN_COPY = 9;
+
+constexpr uint32_t TAG_HEAD = sfnt_tag('h', 'e', 'a', 'd');
+constexpr uint32_t TAG_MAXP = sfnt_tag('m', 'a', 'x', 'p');
+constexpr uint32_t TAG_LOCA = sfnt_tag('l', 'o', 'c', 'a');
+constexpr uint32_t TAG_GLYF = sfnt_tag('g', 'l', 'y', 'f');
+constexpr uint32_t TAG_GVAR = sfnt_tag('g', 'v', 'a', 'r');
+
+struct TableRecord {
+    uint32_t tag, offset, length;
+};
+
+// A byte range of a font file
+struct Range {
+    uint32_t offset, length;
+};
+
+bool read_directory(const uint8_t* data, size_t size, std::vector<TableRecord>& tables) {
+    if (size < 12) return false;
+    const size_t count = sfnt_u16(data + 4);
+    if (12 + count * 16 > size) return false;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* record = data + 12 + i * 16;
+        TableRecord table = {sfnt_u32(record), sfnt_u32(record + 8), sfnt_u32(record + 12)};
+        if (uint64_t(table.offset) + table.length > size) return false;
+        tables.push_back(table);
+    }
+    return true;
+}
+
+const TableRecord* find_table(const std::vector<TableRecord>& tables, uint32_t tag) {
+    for (const TableRecord& table : tables) {
+        if (table.tag == tag) return &table;
+    }
+    return nullptr;
+}
+
+// Each glyph's glyf entry, through loca; false if the tables are missing,
+// malformed or out of order
+bool glyf_ranges(const uint8_t* data, const std::vector<TableRecord>& tables, std::vector<Range>& ranges) {
+    const TableRecord* head = find_table(tables, TAG_HEAD);
+    const TableRecord* maxp = find_table(tables, TAG_MAXP);
+    const TableRecord* loca = find_table(tables, TAG_LOCA);
+    const TableRecord* glyf = find_table(tables, TAG_GLYF);
+    if (!head || head->length < 54 || !maxp || maxp->length < 6 || !loca || !glyf) return false;
+
+    const size_t count = sfnt_u16(data + maxp->offset + 4);
+    const bool long_loca = sfnt_i16(data + head->offset + 50) == 1;
+    const size_t entry = long_loca ? 4 : 2;
+    if (loca->length < (count + 1) * entry) return false;
+
+    uint32_t previous = 0;
+    for (size_t g = 0; g < count; g++) {
+        const uint8_t* p = data + loca->offset + g * entry;
+        uint32_t start = long_loca ? sfnt_u32(p) : uint32_t(sfnt_u16(p)) * 2;
+        uint32_t end = long_loca ? sfnt_u32(p + entry) : uint32_t(sfnt_u16(p + entry)) * 2;
+        if (start < previous || start > end || end > glyf->length) return false;
+        ranges.push_back({glyf->offset + start, end - start});
+        previous = end;
+    }
+    return true;
+}
+
+// Each glyph's GlyphVariationData; false if gvar is missing, malformed or
+// out of order
+bool gvar_ranges(const uint8_t* data, const std::vector<TableRecord>& tables, std::vector<Range>& ranges) {
+    const TableRecord* gvar = find_table(tables, TAG_GVAR);
+    if (!gvar || gvar->length < 20) return false;
+    const uint8_t* table = data + gvar->offset;
+
+    const size_t count = sfnt_u16(table + 12);
+    const bool long_offsets = sfnt_u16(table + 14) & 1;
+    const uint32_t array_offset = sfnt_u32(table + 16);
+    const size_t entry = long_offsets ? 4 : 2;
+    if (20 + (count + 1) * entry > gvar->length) return false;
+
+    uint64_t previous = 0;
+    for (size_t g = 0; g < count; g++) {
+        const uint8_t* p = table + 20 + g * entry;
+        uint64_t start = uint64_t(array_offset) + (long_offsets ? sfnt_u32(p) : uint32_t(sfnt_u16(p)) * 2);
+        uint64_t end = uint64_t(array_offset) +
+                       (long_offsets ? sfnt_u32(p + entry) : uint32_t(sfnt_u16(p + entry)) * 2);
+        if (start < previous || start > end || end > gvar->length) return false;
+        ranges.push_back({uint32_t(gvar->offset + start), uint32_t(end - start)});
+        previous = end;
+    }
+    return true;
+}
+
+uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 0x811C9DC5u;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 0x01000193u;
+    return hash;
+}
+
+struct Op {
+    uint8_t kind;
+    uint32_t offset;    // in the old font for copies, the new one for inserts
+    uint32_t length;
+};
+
+// Appends ops, joining neighbours that continue each other
+class OpWriter {
+public:
+    void copy(uint32_t old_offset, uint32_t new_offset, uint32_t length) {
+        if (length < MIN_COPY) {
+            insert(new_offset, length);
+            return;
+        }
+        if (!ops_.empty() && ops_.back().kind == OP_COPY &&
+            ops_.back().offset + ops_.back().length == old_offset) {
+            ops_.back().length += length;
+        } else {
+            ops_.push_back({OP_COPY, old_offset, length});
+        }
+    }
+
+    void insert(uint32_t new_offset, uint32_t length) {
+        if (length == 0) return;
+        if (!ops_.empty() && ops_.back().kind == OP_INSERT &&
+            ops_.back().offset + ops_.back().length == new_offset) {
+            ops_.back().length += length;
+        } else {
+            ops_.push_back({OP_INSERT, new_offset, length});
+        }
+    }
+
+    const std::vector<Op>& ops() const { return ops_; }
+
+private:
+    std::vector<Op> ops_;
+};
+
+using ByteIndex = std::unordered_map<std::string_view, uint32_t>;
+
+std::string_view bytes_at(const uint8_t* data, uint32_t offset, uint32_t length) {
+    return {reinterpret_cast<const char*>(data) + offset, length};
+}
+
+} // namespace
+
+bool build_font_delta(const uint8_t* old_font, size_t old_size,
+                      const uint8_t* new_font, size_t new_size,
+                      std::vector<uint8_t>& delta, DeltaStats& stats) {
+    if (old_size > MAX_FONT_SIZE || new_size == 0 || new_size > MAX_FONT_SIZE) return false;
+
+    // Old tables and glyph records by content; the first occurrence wins
+    ByteIndex old_bytes;
+    std::vector<TableRecord> old_tables;
+    if (read_directory(old_font, old_size, old_tables)) {
+        for (const TableRecord& table : old_tables) {
+            if (table.length > 0) old_bytes.emplace(bytes_at(old_font, table.offset, table.length), table.offset);
+        }
+        std::vector<Range> records;
+        if (!glyf_ranges(old_font, old_tables, records)) records.clear();
+        const size_t glyf_count = records.size();
+        if (!gvar_ranges(old_font, old_tables, records)) records.resize(glyf_count);
+        for (const Range& r : records) {
+            if (r.length > 0) old_bytes.emplace(bytes_at(old_font, r.offset, r.length), r.offset);
+        }
+    }
+
+    std::vector<TableRecord> new_tables;
+    if (!read_directory(new_font, new_size, new_tables)) new_tables.clear();
+    std::sort(new_tables.begin(), new_tables.end(),
+              [](const TableRecord& a, const TableRecord& b) { return a.offset < b.offset; });
+    std::vector<Range> new_glyf, new_gvar;
+    if (!glyf_ranges(new_font, new_tables, new_glyf)) new_glyf.clear();
+    if (!gvar_ranges(new_font, new_tables, new_gvar)) new_gvar.clear();
+
+    // Copies |length| bytes at |offset| from the old font if it has them
+    OpWriter writer;
+    auto match = [&](uint32_t offset, uint32_t length) {
+        auto it = old_bytes.find(bytes_at(new_font, offset, length));
+        if (it == old_bytes.end()) return false;
+        writer.copy(it->second, offset, length);
+        return true;
+    };
+
+    // Header, directory and padding: copied if unmoved, otherwise inserted
+    auto gap = [&](uint32_t offset, uint32_t length) {
+        if (uint64_t(offset) + length <= old_size && std::equal(new_font + offset, new_font + offset + length,
+                                                                old_font + offset)) {
+            writer.copy(offset, offset, length);
+        } else {
+            writer.insert(offset, length);
+        }
+    };
+
+    uint32_t cursor = 0;
+    for (const TableRecord& table : new_tables) {
+        if (table.offset < cursor || table.length == 0) continue;   // overlapping or empty
+        gap(cursor, table.offset - cursor);
+        cursor = table.offset + table.length;
+
+        if (match(table.offset, table.length)) {
+            stats.tables_copied++;
+            continue;
+        }
+        const std::vector<Range>* records = table.tag == TAG_GLYF ? &new_glyf
+                                          : table.tag == TAG_GVAR ? &new_gvar : nullptr;
+        if (!records || records->empty()) {
+            writer.insert(table.offset, table.length);
+            continue;
+        }
+        uint32_t position = table.offset;
+        for (const Range& r : *records) {
+            if (r.length == 0) continue;
+            writer.insert(position, r.offset - position);
+            if (match(r.offset, r.length)) {
+                stats.glyphs_copied++;
+            } else {
+                writer.insert(r.offset, r.length);
+                stats.glyphs_inserted++;
+            }
+            position = r.offset + r.length;
+        }
+        writer.insert(position, cursor - position);
+    }
+    gap(cursor, uint32_t(new_size - cursor));
+
+    delta.clear();
+    sfnt_append_u32(delta, DELTA_MAGIC);
+    sfnt_append_u16(delta, DELTA_VERSION);
+    sfnt_append_u16(delta, 0);
+    sfnt_append_u32(delta, uint32_t(old_size));
+    sfnt_append_u32(delta, fnv1a(old_font, old_size));
+    sfnt_append_u32(delta, uint32_t(new_size));
+    sfnt_append_u32(delta, fnv1a(new_font, new_size));
+    sfnt_append_u32(delta, uint32_t(writer.ops().size()));
+    for (const Op& op : writer.ops()) {
+        delta.push_back(op.kind);
+        if (op.kind == OP_COPY) {
+            sfnt_append_u32(delta, op.offset);
+            sfnt_append_u32(delta, op.length);
+            stats.bytes_copied += op.length;
+        } else {
+            sfnt_append_u32(delta, op.length);
+            delta.insert(delta.end(), new_font + op.offset, new_font + op.offset + op.length);
+            stats.bytes_inserted += op.length;
+        }
+    }
+    return true;
+}
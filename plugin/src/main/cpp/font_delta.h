@@ -0,0 +1,25 @@
+#ifndef FONTSUBSETTING_FONT_DELTA_H
+#define FONTSUBSETTING_FONT_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct DeltaStats {
+    size_t tables_copied = 0;
+    size_t glyphs_copied = 0;     // glyf and gvar records found in the old font
+    size_t glyphs_inserted = 0;
+    size_t bytes_copied = 0;
+    size_t bytes_inserted = 0;
+};
+
+// Describes |new_font| as copies from |old_font| and inserted bytes, in the
+// format of the runtime's font_delta.h. Tables whose bytes are unchanged are
+// copied whole; glyf and gvar are matched glyph by glyph, so adding one icon
+// costs little more than its outline. Bytes that are not a well-formed sfnt
+// are inserted as is. Returns false only if a font is too large to describe.
+bool build_font_delta(const uint8_t* old_font, size_t old_size,
+                      const uint8_t* new_font, size_t new_size,
+                      std::vector<uint8_t>& delta, DeltaStats& stats);
+
+#endif // FONTSUBSETTING_FONT_DELTA_H
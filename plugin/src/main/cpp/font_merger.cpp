@@ -0,0 +1,979 @@
+#include "font_merger.h"
+#include "glyf_tables.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t TAG_HEAD = sfnt_tag('h', 'e', 'a', 'd');
+constexpr uint32_t TAG_HHEA = sfnt_tag('h', 'h', 'e', 'a');
+constexpr uint32_t TAG_MAXP = sfnt_tag('m', 'a', 'x', 'p');
+constexpr uint32_t TAG_HMTX = sfnt_tag('h', 'm', 't', 'x');
+constexpr uint32_t TAG_GLYF = sfnt_tag('g', 'l', 'y', 'f');
+constexpr uint32_t TAG_LOCA = sfnt_tag('l', 'o', 'c', 'a');
+constexpr uint32_t TAG_GVAR = sfnt_tag('g', 'v', 'a', 'r');
+constexpr uint32_t TAG_FVAR = sfnt_tag('f', 'v', 'a', 'r');
+constexpr uint32_t TAG_AVAR = sfnt_tag('a', 'v', 'a', 'r');
+constexpr uint32_t TAG_CMAP = sfnt_tag('c', 'm', 'a', 'p');
+constexpr uint32_t TAG_OS2 = sfnt_tag('O', 'S', '/', '2');
+constexpr uint32_t TAG_NAME = sfnt_tag('n', 'a', 'm', 'e');
+constexpr uint32_t TAG_POST = sfnt_tag('p', 'o', 's', 't');
+
+// Tables that stay valid, or are rebuilt, once other fonts' glyphs are
+// appended; hinting tables only serve the primary's own instructions
+const uint32_t KEPT_TABLES[] = {
+    TAG_HEAD, TAG_HHEA, TAG_MAXP, TAG_HMTX, TAG_GLYF, TAG_LOCA, TAG_GVAR, TAG_FVAR, TAG_AVAR,
+    TAG_CMAP, TAG_OS2, TAG_NAME, TAG_POST,
+    sfnt_tag('f', 'p', 'g', 'm'), sfnt_tag('p', 'r', 'e', 'p'), sfnt_tag('c', 'v', 't', ' '),
+    sfnt_tag('g', 'a', 's', 'p'),
+};
+
+// Outlines and color data that can't be appended glyph by glyph
+const uint32_t REJECTED_TABLES[] = {
+    sfnt_tag('C', 'F', 'F', ' '), sfnt_tag('C', 'F', 'F', '2'), sfnt_tag('C', 'O', 'L', 'R'),
+    sfnt_tag('C', 'P', 'A', 'L'), sfnt_tag('S', 'V', 'G', ' '), sfnt_tag('s', 'b', 'i', 'x'),
+    sfnt_tag('C', 'B', 'D', 'T'), sfnt_tag('E', 'B', 'D', 'T'),
+};
+
+constexpr uint16_t PHANTOM_POINTS = 4;
+constexpr size_t MAX_SHARED_TUPLES = 0x1000;    // tupleIndex has 12 bits
+constexpr uint32_t MAX_GLYPHS = 0xFFFF;
+
+std::string tag_name(uint32_t tag) {
+    return {char(tag >> 24), char(tag >> 16), char(tag >> 8), char(tag)};
+}
+
+const std::vector<uint8_t>* table(const SfntFont& font, uint32_t tag) {
+    auto it = font.tables.find(tag);
+    return it != font.tables.end() ? &it->second : nullptr;
+}
+
+bool fits_int16(int32_t v) { return v >= -32768 && v <= 32767; }
+
+int32_t scale_value(int32_t v, double scale) { return int32_t(std::lround(v * scale)); }
+
+// ---------------------------------------------------------------------------
+// glyf, hmtx
+
+struct Metric {
+    uint16_t advance = 0;
+    int16_t lsb = 0;
+};
+
+bool read_metrics(const SfntFont& font, size_t glyph_count, std::vector<Metric>& metrics) {
+    const std::vector<uint8_t>* hhea = table(font, TAG_HHEA);
+    const std::vector<uint8_t>* hmtx = table(font, TAG_HMTX);
+    if (!hhea || hhea->size() < 36 || !hmtx) return false;
+    const size_t long_count = std::min<size_t>(sfnt_u16(hhea->data() + 34), glyph_count);
+    if (long_count == 0 || hmtx->size() < long_count * 4 + (glyph_count - long_count) * 2) return false;
+
+    metrics.resize(glyph_count);
+    for (size_t g = 0; g < glyph_count; g++) {
+        if (g < long_count) {
+            metrics[g].advance = sfnt_u16(hmtx->data() + g * 4);
+            metrics[g].lsb = sfnt_i16(hmtx->data() + g * 4 + 2);
+        } else {
+            metrics[g].advance = metrics[long_count - 1].advance;
+            metrics[g].lsb = sfnt_i16(hmtx->data() + long_count * 4 + (g - long_count) * 2);
+        }
+    }
+    return true;
+}
+
+// Points a glyph's variation deltas cover: its outline points, or one per
+// component, then the four phantom points
+size_t variation_point_count(const std::vector<uint8_t>& glyph) {
+    if (glyph.size() < 10) return PHANTOM_POINTS;
+    int16_t contours = sfnt_i16(glyph.data());
+    if (contours > 0) {
+        size_t last = 10 + (size_t(contours) - 1) * 2;
+        return last + 2 <= glyph.size() ? size_t(sfnt_u16(glyph.data() + last)) + 1 + PHANTOM_POINTS
+                                        : PHANTOM_POINTS;
+    }
+    size_t components = 0;
+    size_t pos = 10;
+    while (contours < 0 && pos + 4 <= glyph.size()) {
+        uint16_t flags = sfnt_u16(glyph.data() + pos);
+        components++;
+        pos += 4 + ((flags & 0x0001) ? 4 : 2);
+        if (flags & 0x0008) pos += 2;
+        else if (flags & 0x0040) pos += 4;
+        else if (flags & 0x0080) pos += 8;
+        if (!(flags & 0x0020)) break;
+    }
+    return components + PHANTOM_POINTS;
+}
+
+// Re-targets a source glyph at the merged font: component ids move by
+// |gid_offset|, coordinates are scaled and instructions are dropped
+bool convert_glyph(const std::vector<uint8_t>& in, uint32_t gid_offset, double scale,
+                   std::vector<uint8_t>& out) {
+    out.clear();
+    if (in.empty()) return true;
+    if (in.size() < 10) return false;
+
+    const int16_t contours = sfnt_i16(in.data());
+    if (contours == 0) return true;
+    if (contours > 0) {
+        if (scale == 1.0) {
+            size_t pos = 10 + size_t(contours) * 2;
+            if (pos + 2 > in.size()) return false;
+            size_t instructions = sfnt_u16(in.data() + pos);
+            if (pos + 2 + instructions > in.size()) return false;
+            out.assign(in.begin(), in.begin() + pos);
+            sfnt_append_u16(out, 0);
+            out.insert(out.end(), in.begin() + pos + 2 + instructions, in.end());
+            return true;
+        }
+        std::vector<uint16_t> end_points;
+        std::vector<GlyphPoint> points;
+        if (!decode_simple_glyph(in.data(), in.size(), end_points, points)) return false;
+        for (GlyphPoint& p : points) {
+            p.x = scale_value(p.x, scale);
+            p.y = scale_value(p.y, scale);
+        }
+        int16_t x_min;
+        return encode_simple_glyph(end_points, points, out, x_min);
+    }
+
+    sfnt_append_u16(out, uint16_t(contours));
+    for (size_t i = 0; i < 4; i++) {
+        int32_t v = scale_value(sfnt_i16(in.data() + 2 + i * 2), scale);
+        if (!fits_int16(v)) return false;
+        sfnt_append_u16(out, uint16_t(int16_t(v)));
+    }
+    size_t pos = 10;
+    for (;;) {
+        if (pos + 4 > in.size()) return false;
+        const uint16_t flags = sfnt_u16(in.data() + pos);
+        const uint32_t component = sfnt_u16(in.data() + pos + 2);
+        const size_t arg_size = (flags & 0x0001) ? 4 : 2;
+        const size_t transform_size = (flags & 0x0008) ? 2 : (flags & 0x0040) ? 4 : (flags & 0x0080) ? 8 : 0;
+        if (pos + 4 + arg_size + transform_size > in.size()) return false;
+
+        const uint32_t new_component = component ? component + gid_offset : 0;
+        if (new_component > MAX_GLYPHS) return false;
+        uint16_t new_flags = flags & ~0x0100;   // WE_HAVE_INSTRUCTIONS
+        const uint8_t* args = in.data() + pos + 4;
+        if ((flags & 0x0002) && scale != 1.0) {
+            // Offsets scale with the outlines; point numbers stay as they are
+            int32_t dx = (flags & 0x0001) ? sfnt_i16(args) : int8_t(args[0]);
+            int32_t dy = (flags & 0x0001) ? sfnt_i16(args + 2) : int8_t(args[1]);
+            dx = scale_value(dx, scale);
+            dy = scale_value(dy, scale);
+            if (!fits_int16(dx) || !fits_int16(dy)) return false;
+            sfnt_append_u16(out, uint16_t(new_flags | 0x0001));
+            sfnt_append_u16(out, uint16_t(new_component));
+            sfnt_append_u16(out, uint16_t(int16_t(dx)));
+            sfnt_append_u16(out, uint16_t(int16_t(dy)));
+        } else {
+            sfnt_append_u16(out, new_flags);
+            sfnt_append_u16(out, uint16_t(new_component));
+            out.insert(out.end(), args, args + arg_size);
+        }
+        out.insert(out.end(), args + arg_size, args + arg_size + transform_size);
+        pos += 4 + arg_size + transform_size;
+        if (!(flags & 0x0020)) break;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// fvar, avar, name
+
+struct Axis {
+    uint32_t tag = 0;
+    uint32_t min = 0, def = 0, max = 0;             // Fixed, as stored
+    uint16_t flags = 0, name_id = 0;
+    std::vector<std::pair<int16_t, int16_t>> avar;  // empty for the identity
+};
+
+struct Instance {
+    uint16_t subfamily_id = 0, flags = 0;
+    std::vector<uint32_t> coordinates;
+    int32_t postscript_id = -1;
+};
+
+bool read_axes(const SfntFont& font, std::vector<Axis>& axes, std::vector<Instance>* instances,
+               std::string& error) {
+    axes.clear();
+    const std::vector<uint8_t>* fvar = table(font, TAG_FVAR);
+    if (!fvar) return true;
+    if (fvar->size() < 16) return false;
+
+    const uint8_t* data = fvar->data();
+    const size_t axes_offset = sfnt_u16(data + 4);
+    const size_t axis_count = sfnt_u16(data + 8);
+    const size_t axis_size = sfnt_u16(data + 10);
+    const size_t instance_count = sfnt_u16(data + 12);
+    const size_t instance_size = sfnt_u16(data + 14);
+    if (axis_size < 20 || axes_offset + axis_count * axis_size > fvar->size()) return false;
+
+    for (size_t a = 0; a < axis_count; a++) {
+        const uint8_t* p = data + axes_offset + a * axis_size;
+        Axis axis;
+        axis.tag = sfnt_u32(p);
+        axis.min = sfnt_u32(p + 4);
+        axis.def = sfnt_u32(p + 8);
+        axis.max = sfnt_u32(p + 12);
+        axis.flags = sfnt_u16(p + 16);
+        axis.name_id = sfnt_u16(p + 18);
+        axes.push_back(axis);
+    }
+
+    if (instances) {
+        const size_t instances_offset = axes_offset + axis_count * axis_size;
+        const size_t coordinates_end = 4 + axis_count * 4;
+        if (instance_size < coordinates_end ||
+            instances_offset + instance_count * instance_size > fvar->size()) {
+            return false;
+        }
+        for (size_t i = 0; i < instance_count; i++) {
+            const uint8_t* p = data + instances_offset + i * instance_size;
+            Instance instance;
+            instance.subfamily_id = sfnt_u16(p);
+            instance.flags = sfnt_u16(p + 2);
+            for (size_t a = 0; a < axis_count; a++) instance.coordinates.push_back(sfnt_u32(p + 4 + a * 4));
+            if (instance_size >= coordinates_end + 2) instance.postscript_id = sfnt_u16(p + coordinates_end);
+            instances->push_back(std::move(instance));
+        }
+    }
+
+    const std::vector<uint8_t>* avar = table(font, TAG_AVAR);
+    if (!avar) return true;
+    if (avar->size() < 8 || sfnt_u16(avar->data() + 6) != axis_count) return false;
+    if (sfnt_u16(avar->data()) != 1) {
+        error = "avar version " + std::to_string(sfnt_u16(avar->data())) + " cannot be merged";
+        return false;
+    }
+    size_t pos = 8;
+    for (Axis& axis : axes) {
+        if (pos + 2 > avar->size()) return false;
+        size_t count = sfnt_u16(avar->data() + pos);
+        pos += 2;
+        if (pos + count * 4 > avar->size()) return false;
+        bool identity = true;
+        for (size_t i = 0; i < count; i++, pos += 4) {
+            int16_t from = sfnt_i16(avar->data() + pos), to = sfnt_i16(avar->data() + pos + 2);
+            axis.avar.push_back({from, to});
+            identity = identity && from == to;
+        }
+        if (identity) axis.avar.clear();
+    }
+    return true;
+}
+
+std::vector<uint8_t> build_fvar(const std::vector<Axis>& axes, const std::vector<Instance>& instances) {
+    const bool postscript_ids = !instances.empty() && instances[0].postscript_id >= 0;
+    std::vector<uint8_t> out;
+    sfnt_append_u16(out, 1);
+    sfnt_append_u16(out, 0);
+    sfnt_append_u16(out, 16);  // axesArrayOffset
+    sfnt_append_u16(out, 2);
+    sfnt_append_u16(out, uint16_t(axes.size()));
+    sfnt_append_u16(out, 20);
+    sfnt_append_u16(out, uint16_t(instances.size()));
+    sfnt_append_u16(out, uint16_t(4 + axes.size() * 4 + (postscript_ids ? 2 : 0)));
+    for (const Axis& axis : axes) {
+        sfnt_append_u32(out, axis.tag);
+        sfnt_append_u32(out, axis.min);
+        sfnt_append_u32(out, axis.def);
+        sfnt_append_u32(out, axis.max);
+        sfnt_append_u16(out, axis.flags);
+        sfnt_append_u16(out, axis.name_id);
+    }
+    for (const Instance& instance : instances) {
+        sfnt_append_u16(out, instance.subfamily_id);
+        sfnt_append_u16(out, instance.flags);
+        for (size_t a = 0; a < axes.size(); a++) {
+            sfnt_append_u32(out, a < instance.coordinates.size() ? instance.coordinates[a] : axes[a].def);
+        }
+        if (postscript_ids) sfnt_append_u16(out, uint16_t(instance.postscript_id));
+    }
+    return out;
+}
+
+std::vector<uint8_t> build_avar(const std::vector<Axis>& axes) {
+    std::vector<uint8_t> out;
+    sfnt_append_u16(out, 1);
+    sfnt_append_u16(out, 0);
+    sfnt_append_u16(out, 0);
+    sfnt_append_u16(out, uint16_t(axes.size()));
+    for (const Axis& axis : axes) {
+        if (axis.avar.empty()) {
+            sfnt_append_u16(out, 3);
+            for (int16_t v : {int16_t(-16384), int16_t(0), int16_t(16384)}) {
+                sfnt_append_u16(out, uint16_t(v));
+                sfnt_append_u16(out, uint16_t(v));
+            }
+            continue;
+        }
+        sfnt_append_u16(out, uint16_t(axis.avar.size()));
+        for (const auto& [from, to] : axis.avar) {
+            sfnt_append_u16(out, uint16_t(from));
+            sfnt_append_u16(out, uint16_t(to));
+        }
+    }
+    return out;
+}
+
+struct NameRecord {
+    uint16_t platform, encoding, language, name_id;
+    std::vector<uint8_t> text;
+};
+
+std::vector<NameRecord> read_names(const SfntFont& font) {
+    std::vector<NameRecord> records;
+    const std::vector<uint8_t>* name = table(font, TAG_NAME);
+    if (!name || name->size() < 6) return records;
+    const size_t count = sfnt_u16(name->data() + 2);
+    const size_t storage = sfnt_u16(name->data() + 4);
+    for (size_t i = 0; i < count && 6 + i * 12 + 12 <= name->size(); i++) {
+        const uint8_t* p = name->data() + 6 + i * 12;
+        NameRecord record{sfnt_u16(p), sfnt_u16(p + 2), sfnt_u16(p + 4), sfnt_u16(p + 6), {}};
+        size_t length = sfnt_u16(p + 8), offset = storage + sfnt_u16(p + 10);
+        if (record.language >= 0x8000 || offset + length > name->size()) continue;  // language tags aren't kept
+        record.text.assign(name->begin() + offset, name->begin() + offset + length);
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+std::vector<uint8_t> build_name(std::vector<NameRecord>& records) {
+    std::sort(records.begin(), records.end(), [](const NameRecord& a, const NameRecord& b) {
+        return std::tie(a.platform, a.encoding, a.language, a.name_id) <
+               std::tie(b.platform, b.encoding, b.language, b.name_id);
+    });
+    std::vector<uint8_t> out, storage;
+    sfnt_append_u16(out, 0);
+    sfnt_append_u16(out, uint16_t(records.size()));
+    sfnt_append_u16(out, uint16_t(6 + records.size() * 12));
+    for (const NameRecord& record : records) {
+        sfnt_append_u16(out, record.platform);
+        sfnt_append_u16(out, record.encoding);
+        sfnt_append_u16(out, record.language);
+        sfnt_append_u16(out, record.name_id);
+        sfnt_append_u16(out, uint16_t(record.text.size()));
+        sfnt_append_u16(out, uint16_t(storage.size()));
+        storage.insert(storage.end(), record.text.begin(), record.text.end());
+    }
+    out.insert(out.end(), storage.begin(), storage.end());
+    return out;
+}
+
+// An axis name from |font| as a Windows English record's UTF-16BE text,
+// falling back to the tag itself
+std::vector<uint8_t> axis_name(const SfntFont& font, const Axis& axis) {
+    std::vector<uint8_t> text;
+    for (const NameRecord& record : read_names(font)) {
+        if (record.name_id != axis.name_id) continue;
+        if (record.platform == 3 || record.platform == 0) return record.text;
+        if (record.platform == 1 && text.empty()) {
+            for (uint8_t c : record.text) sfnt_append_u16(text, c < 0x80 ? c : '?');
+        }
+    }
+    if (text.empty()) {
+        for (char c : tag_name(axis.tag)) {
+            if (c != ' ') sfnt_append_u16(text, uint8_t(c));
+        }
+    }
+    return text;
+}
+
+// ---------------------------------------------------------------------------
+// gvar
+
+struct GvarData {
+    const uint8_t* data = nullptr;
+    uint16_t axis_count = 0;
+    std::vector<std::vector<int16_t>> shared_tuples;
+    std::vector<uint32_t> offsets;      // absolute, glyph_count + 1
+};
+
+bool read_gvar(const SfntFont& font, GvarData& gvar) {
+    const std::vector<uint8_t>* table_data = table(font, TAG_GVAR);
+    if (!table_data) return true;
+    const uint8_t* data = table_data->data();
+    const size_t size = table_data->size();
+    if (size < 20) return false;
+
+    gvar.data = data;
+    gvar.axis_count = sfnt_u16(data + 4);
+    const size_t shared_count = sfnt_u16(data + 6);
+    const uint32_t shared_offset = sfnt_u32(data + 8);
+    const size_t glyph_count = sfnt_u16(data + 12);
+    const bool long_offsets = sfnt_u16(data + 14) & 1;
+    const uint32_t array_offset = sfnt_u32(data + 16);
+
+    if (shared_offset > size || shared_count * gvar.axis_count * 2 > size - shared_offset) return false;
+    gvar.shared_tuples.assign(shared_count, std::vector<int16_t>(gvar.axis_count));
+    for (size_t i = 0; i < shared_count; i++) {
+        for (size_t a = 0; a < gvar.axis_count; a++) {
+            gvar.shared_tuples[i][a] = sfnt_i16(data + shared_offset + (i * gvar.axis_count + a) * 2);
+        }
+    }
+
+    const size_t entry = long_offsets ? 4 : 2;
+    if (20 + (glyph_count + 1) * entry > size) return false;
+    gvar.offsets.resize(glyph_count + 1);
+    for (size_t g = 0; g <= glyph_count; g++) {
+        const uint8_t* p = data + 20 + g * entry;
+        uint64_t offset = uint64_t(array_offset) + (long_offsets ? sfnt_u32(p) : uint32_t(sfnt_u16(p)) * 2);
+        if (offset > size || (g && offset < gvar.offsets[g - 1])) return false;
+        gvar.offsets[g] = uint32_t(offset);
+    }
+    return true;
+}
+
+std::vector<int16_t> read_tuple(const uint8_t* data, size_t axes) {
+    std::vector<int16_t> values(axes);
+    for (size_t a = 0; a < axes; a++) values[a] = sfnt_i16(data + a * 2);
+    return values;
+}
+
+// Appends |values| (in the source's axis order) in merged axis order, with
+// zeros for axes the source lacks
+void append_tuple(std::vector<uint8_t>& out, const std::vector<int16_t>& values,
+                  const std::vector<size_t>& axis_map, size_t merged_axes) {
+    std::vector<int16_t> merged(merged_axes, 0);
+    for (size_t a = 0; a < values.size() && a < axis_map.size(); a++) merged[axis_map[a]] = values[a];
+    for (int16_t v : merged) sfnt_append_u16(out, uint16_t(v));
+}
+
+// Re-encodes one glyph's GlyphVariationData for the merged font: embedded
+// coordinates move to their merged axes, shared tuples are renumbered
+// through |shared_map| (embedded where it holds -1) and deltas are scaled
+bool convert_variations(const GvarData& gvar, size_t glyph_id, const std::vector<size_t>& axis_map,
+                        size_t merged_axes, const std::vector<int32_t>& shared_map,
+                        size_t point_count, double scale, std::vector<uint8_t>& out) {
+    out.clear();
+    if (glyph_id + 1 >= gvar.offsets.size()) return true;
+    const uint8_t* data = gvar.data + gvar.offsets[glyph_id];
+    const size_t size = gvar.offsets[glyph_id + 1] - gvar.offsets[glyph_id];
+    if (size == 0) return true;
+    if (size < 4) return false;
+
+    const uint16_t count_field = sfnt_u16(data);
+    const size_t axes = gvar.axis_count;
+    size_t pos = 4;
+    size_t data_pos = sfnt_u16(data + 2);
+    if (data_pos > size) return false;
+
+    std::vector<uint8_t> headers, body;
+    std::vector<uint16_t> points;
+    bool shared_all = false, all = false;
+    size_t shared_count = 0;
+    if (count_field & 0x8000) {
+        size_t start = data_pos;
+        if (!read_packed_points(data, size, data_pos, points, shared_all)) return false;
+        shared_count = points.size();
+        body.insert(body.end(), data + start, data + data_pos);
+    }
+
+    std::vector<int32_t> xs, ys;
+    for (uint16_t t = 0; t < (count_field & 0x0FFF); t++) {
+        if (pos + 4 > size) return false;
+        const uint16_t data_size = sfnt_u16(data + pos);
+        const uint16_t index = sfnt_u16(data + pos + 2);
+        pos += 4;
+
+        uint16_t new_index = index & 0x6000;   // intermediate region, private points
+        std::vector<uint8_t> coordinates;
+        if (index & 0x8000) {
+            if (pos + axes * 2 > size) return false;
+            append_tuple(coordinates, read_tuple(data + pos, axes), axis_map, merged_axes);
+            pos += axes * 2;
+            new_index |= 0x8000;
+        } else {
+            size_t shared = index & 0x0FFF;
+            if (shared >= shared_map.size()) return false;
+            if (shared_map[shared] >= 0) {
+                new_index |= uint16_t(shared_map[shared]);
+            } else {
+                append_tuple(coordinates, gvar.shared_tuples[shared], axis_map, merged_axes);
+                new_index |= 0x8000;
+            }
+        }
+        if (index & 0x4000) {
+            if (pos + axes * 4 > size) return false;
+            append_tuple(coordinates, read_tuple(data + pos, axes), axis_map, merged_axes);
+            append_tuple(coordinates, read_tuple(data + pos + axes * 2, axes), axis_map, merged_axes);
+            pos += axes * 4;
+        }
+
+        if (data_pos + data_size > size) return false;
+        const size_t tuple_end = data_pos + data_size;
+        size_t tuple_start = body.size();
+        if (scale == 1.0) {
+            body.insert(body.end(), data + data_pos, data + tuple_end);
+        } else {
+            size_t p = data_pos;
+            size_t n = shared_all ? point_count : shared_count;
+            if (index & 0x2000) {
+                if (!read_packed_points(data, tuple_end, p, points, all)) return false;
+                body.insert(body.end(), data + data_pos, data + p);
+                n = all ? point_count : points.size();
+            }
+            if (!read_packed_deltas(data, tuple_end, p, n, xs) ||
+                !read_packed_deltas(data, tuple_end, p, n, ys)) {
+                return false;
+            }
+            for (int32_t& d : xs) d = scale_value(d, scale);
+            for (int32_t& d : ys) d = scale_value(d, scale);
+            append_packed_deltas(body, xs);
+            append_packed_deltas(body, ys);
+        }
+        data_pos = tuple_end;
+
+        if (body.size() - tuple_start > 0xFFFF) return false;
+        sfnt_append_u16(headers, uint16_t(body.size() - tuple_start));
+        sfnt_append_u16(headers, new_index);
+        headers.insert(headers.end(), coordinates.begin(), coordinates.end());
+    }
+
+    if (4 + headers.size() > 0xFFFF) return false;
+    sfnt_append_u16(out, count_field);
+    sfnt_append_u16(out, uint16_t(4 + headers.size()));
+    out.insert(out.end(), headers.begin(), headers.end());
+    out.insert(out.end(), body.begin(), body.end());
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// cmap
+
+// Format 4 for the BMP and, when needed, format 12 for everything; each
+// run of consecutive codepoints on consecutive glyphs is one segment
+std::vector<uint8_t> build_cmap(const std::map<uint32_t, uint32_t>& mapping) {
+    struct Run {
+        uint32_t first, last, glyph;
+    };
+    std::vector<Run> runs;
+    for (const auto& [codepoint, glyph] : mapping) {
+        if (glyph == 0) continue;
+        if (!runs.empty() && codepoint == runs.back().last + 1 &&
+            glyph == runs.back().glyph + (codepoint - runs.back().first)) {
+            runs.back().last = codepoint;
+        } else {
+            runs.push_back({codepoint, codepoint, glyph});
+        }
+    }
+
+    std::vector<Run> bmp;
+    for (Run run : runs) {
+        if (run.first >= 0xFFFF) break;
+        run.last = std::min<uint32_t>(run.last, 0xFFFE);
+        bmp.push_back(run);
+    }
+    const size_t seg_count = bmp.size() + 1;
+    const bool format4 = 16 + seg_count * 8 <= 0xFFFF;
+    const bool format12 = !format4 || (!runs.empty() && runs.back().last > 0xFFFE);
+
+    std::vector<uint8_t> subtable4;
+    if (format4) {
+        uint16_t entry_selector = 0;
+        while ((2u << entry_selector) <= seg_count) entry_selector++;
+        const uint16_t search_range = uint16_t(2u << entry_selector);
+        sfnt_append_u16(subtable4, 4);
+        sfnt_append_u16(subtable4, uint16_t(16 + seg_count * 8));
+        sfnt_append_u16(subtable4, 0);
+        sfnt_append_u16(subtable4, uint16_t(seg_count * 2));
+        sfnt_append_u16(subtable4, search_range);
+        sfnt_append_u16(subtable4, entry_selector);
+        sfnt_append_u16(subtable4, uint16_t(seg_count * 2 - search_range));
+        for (const Run& run : bmp) sfnt_append_u16(subtable4, uint16_t(run.last));
+        sfnt_append_u16(subtable4, 0xFFFF);
+        sfnt_append_u16(subtable4, 0);  // reservedPad
+        for (const Run& run : bmp) sfnt_append_u16(subtable4, uint16_t(run.first));
+        sfnt_append_u16(subtable4, 0xFFFF);
+        for (const Run& run : bmp) sfnt_append_u16(subtable4, uint16_t(run.glyph - run.first));  // mod 65536
+        sfnt_append_u16(subtable4, 1);
+        for (size_t i = 0; i < seg_count; i++) sfnt_append_u16(subtable4, 0);  // idRangeOffset
+    }
+
+    std::vector<uint8_t> subtable12;
+    if (format12) {
+        sfnt_append_u16(subtable12, 12);
+        sfnt_append_u16(subtable12, 0);
+        sfnt_append_u32(subtable12, uint32_t(16 + runs.size() * 12));
+        sfnt_append_u32(subtable12, 0);
+        sfnt_append_u32(subtable12, uint32_t(runs.size()));
+        for (const Run& run : runs) {
+            sfnt_append_u32(subtable12, run.first);
+            sfnt_append_u32(subtable12, run.last);
+            sfnt_append_u32(subtable12, run.glyph);
+        }
+    }
+
+    // (0, 3) and (3, 1) share format 4; (0, 4) and (3, 10) share format 12
+    struct Record {
+        uint16_t platform, encoding;
+        bool wide;
+    };
+    std::vector<Record> records;
+    if (format4) records.push_back({0, 3, false});
+    if (format12) records.push_back({0, 4, true});
+    if (format4) records.push_back({3, 1, false});
+    if (format12) records.push_back({3, 10, true});
+
+    const uint32_t offset4 = uint32_t(4 + records.size() * 8);
+    const uint32_t offset12 = offset4 + uint32_t(subtable4.size());
+    std::vector<uint8_t> out;
+    sfnt_append_u16(out, 0);
+    sfnt_append_u16(out, uint16_t(records.size()));
+    for (const Record& record : records) {
+        sfnt_append_u16(out, record.platform);
+        sfnt_append_u16(out, record.encoding);
+        sfnt_append_u32(out, record.wide ? offset12 : offset4);
+    }
+    out.insert(out.end(), subtable4.begin(), subtable4.end());
+    out.insert(out.end(), subtable12.begin(), subtable12.end());
+    return out;
+}
+
+// The next Private Use Area codepoint after |codepoint| that nothing maps
+uint32_t next_free_codepoint(uint32_t& codepoint, const std::map<uint32_t, uint32_t>& mapping,
+                             const std::set<uint32_t>& reserved) {
+    for (;; codepoint++) {
+        if (codepoint == 0xF900) codepoint = 0xF0000;
+        if ((codepoint & 0xFFFE) == 0xFFFE) continue;  // noncharacters
+        if (codepoint > 0x10FFFD) return 0;
+        if (!mapping.count(codepoint) && !reserved.count(codepoint)) return codepoint++;
+    }
+}
+
+} // namespace
+
+bool merge_fonts(MergeFont& primary, const std::vector<MergeFont>& sources,
+                 std::vector<std::vector<uint32_t>>& codepoints, MergeStats& stats) {
+    std::vector<const MergeFont*> fonts = {&primary};
+    for (const MergeFont& source : sources) fonts.push_back(&source);
+    auto font_label = [&fonts](size_t f) { return fonts[f]->name; };
+
+    if (codepoints.size() != sources.size()) {
+        stats.error = "codepoints are needed for every merged font";
+        return false;
+    }
+
+    std::vector<std::vector<std::vector<uint8_t>>> glyphs(fonts.size());
+    std::vector<std::vector<Metric>> metrics(fonts.size());
+    std::vector<double> scales(fonts.size(), 1.0);
+    for (size_t f = 0; f < fonts.size(); f++) {
+        for (uint32_t tag : REJECTED_TABLES) {
+            if (table(fonts[f]->font, tag)) {
+                stats.error = font_label(f) + " has a '" + tag_name(tag) + "' table, which cannot be merged";
+                return false;
+            }
+        }
+        if (!read_glyf_loca(fonts[f]->font, glyphs[f])) {
+            stats.error = font_label(f) + " has no glyf outlines";
+            return false;
+        }
+        if (!read_metrics(fonts[f]->font, glyphs[f].size(), metrics[f])) {
+            stats.error = font_label(f) + " has no horizontal metrics";
+            return false;
+        }
+        const uint16_t upem = sfnt_u16(table(fonts[f]->font, TAG_HEAD)->data() + 18);
+        if (upem == 0) {
+            stats.error = font_label(f) + " has no unitsPerEm";
+            return false;
+        }
+        scales[f] = double(sfnt_u16(table(primary.font, TAG_HEAD)->data() + 18)) / upem;
+    }
+
+    // Axes: the primary's first, then the ones only sources have
+    std::vector<Axis> axes;
+    std::vector<Instance> instances;
+    std::vector<std::vector<size_t>> axis_maps(fonts.size());
+    std::vector<size_t> axis_origin;    // font each merged axis came from
+    for (size_t f = 0; f < fonts.size(); f++) {
+        std::vector<Axis> font_axes;
+        std::string error;
+        if (!read_axes(fonts[f]->font, font_axes, f ? nullptr : &instances, error)) {
+            stats.error = font_label(f) + ": " + (error.empty() ? "malformed fvar or avar" : error);
+            return false;
+        }
+        for (const Axis& axis : font_axes) {
+            auto it = std::find_if(axes.begin(), axes.end(), [&](const Axis& a) { return a.tag == axis.tag; });
+            if (it == axes.end()) {
+                axis_maps[f].push_back(axes.size());
+                axis_origin.push_back(f);
+                axes.push_back(axis);
+                if (f) stats.axes_added++;
+                continue;
+            }
+            if (it->min != axis.min || it->def != axis.def || it->max != axis.max) {
+                stats.error = "axis '" + tag_name(axis.tag) + "' of " + font_label(f) +
+                              " has a different range or default than in " +
+                              font_label(axis_origin[size_t(it - axes.begin())]) +
+                              "; configure it the same way for both fonts";
+                return false;
+            }
+            if (it->avar != axis.avar) {
+                stats.error = "axis '" + tag_name(axis.tag) + "' of " + font_label(f) +
+                              " has a different avar mapping than in " +
+                              font_label(axis_origin[size_t(it - axes.begin())]);
+                return false;
+            }
+            axis_maps[f].push_back(size_t(it - axes.begin()));
+        }
+    }
+
+    size_t total_glyphs = glyphs[0].size();
+    std::vector<uint32_t> gid_offsets(fonts.size(), 0);
+    for (size_t f = 1; f < fonts.size(); f++) {
+        gid_offsets[f] = uint32_t(total_glyphs - 1);   // source .notdef is dropped
+        total_glyphs += glyphs[f].size() - 1;
+    }
+    if (total_glyphs > MAX_GLYPHS) {
+        stats.error = "the merged font would have " + std::to_string(total_glyphs) + " glyphs";
+        return false;
+    }
+
+    // Glyphs and metrics
+    std::vector<std::vector<uint8_t>> merged_glyphs = glyphs[0];
+    std::vector<Metric> merged_metrics = metrics[0];
+    for (size_t f = 1; f < fonts.size(); f++) {
+        for (size_t g = 1; g < glyphs[f].size(); g++) {
+            std::vector<uint8_t> converted;
+            if (!convert_glyph(glyphs[f][g], gid_offsets[f], scales[f], converted)) {
+                stats.error = "glyph " + std::to_string(g) + " of " + font_label(f) + " could not be converted";
+                return false;
+            }
+            merged_glyphs.push_back(std::move(converted));
+            Metric metric;
+            metric.advance = uint16_t(std::clamp(scale_value(metrics[f][g].advance, scales[f]), 0, 0xFFFF));
+            metric.lsb = int16_t(std::clamp(scale_value(metrics[f][g].lsb, scales[f]), -32768, 32767));
+            merged_metrics.push_back(metric);
+        }
+    }
+
+    // Variations over the merged axes; the primary's shared tuples keep their indices
+    std::vector<uint8_t> gvar_table;
+    if (!axes.empty()) {
+        std::vector<GvarData> gvars(fonts.size());
+        std::vector<std::vector<int16_t>> shared_tuples;
+        std::vector<std::vector<int32_t>> shared_maps(fonts.size());
+        for (size_t f = 0; f < fonts.size(); f++) {
+            if (!read_gvar(fonts[f]->font, gvars[f]) ||
+                (gvars[f].data && gvars[f].axis_count != axis_maps[f].size())) {
+                stats.error = font_label(f) + " has a malformed gvar table";
+                return false;
+            }
+            for (const std::vector<int16_t>& peak : gvars[f].shared_tuples) {
+                std::vector<int16_t> merged(axes.size(), 0);
+                for (size_t a = 0; a < peak.size(); a++) merged[axis_maps[f][a]] = peak[a];
+                auto it = f ? std::find(shared_tuples.begin(), shared_tuples.end(), merged) : shared_tuples.end();
+                if (it != shared_tuples.end()) {
+                    shared_maps[f].push_back(int32_t(it - shared_tuples.begin()));
+                } else if (shared_tuples.size() < MAX_SHARED_TUPLES) {
+                    shared_maps[f].push_back(int32_t(shared_tuples.size()));
+                    shared_tuples.push_back(std::move(merged));
+                } else {
+                    shared_maps[f].push_back(-1);
+                }
+            }
+        }
+
+        std::vector<std::vector<uint8_t>> variations;
+        for (size_t f = 0; f < fonts.size(); f++) {
+            for (size_t g = f ? 1 : 0; g < glyphs[f].size(); g++) {
+                std::vector<uint8_t> data;
+                if (!convert_variations(gvars[f], g, axis_maps[f], axes.size(), shared_maps[f],
+                                        variation_point_count(glyphs[f][g]), scales[f], data)) {
+                    stats.error = "variations of glyph " + std::to_string(g) + " of " + font_label(f) +
+                                  " could not be converted";
+                    return false;
+                }
+                variations.push_back(std::move(data));
+            }
+        }
+        std::vector<uint8_t> shared_bytes;
+        for (const auto& peak : shared_tuples) {
+            for (int16_t v : peak) sfnt_append_u16(shared_bytes, uint16_t(v));
+        }
+        gvar_table = build_gvar(uint16_t(axes.size()), shared_bytes.data(), uint16_t(shared_tuples.size()),
+                                variations);
+    }
+
+    // cmap: the primary keeps its codepoints, later fonts move off taken ones
+    std::map<uint32_t, uint32_t> mapping;
+    for (const auto& [codepoint, glyph] : primary.cmap) {
+        if (glyph > 0 && glyph < glyphs[0].size()) mapping[codepoint] = glyph;
+    }
+    std::set<uint32_t> reserved;
+    for (const MergeFont* font : fonts) {
+        for (const auto& entry : font->cmap) reserved.insert(entry.first);
+    }
+    uint32_t next_codepoint = 0xE000;
+    std::vector<std::vector<uint32_t>> merged_codepoints = codepoints;
+    for (size_t f = 1; f < fonts.size(); f++) {
+        const auto& cmap = fonts[f]->cmap;
+        std::map<uint32_t, uint32_t> assigned;
+        for (uint32_t& codepoint : merged_codepoints[f - 1]) {
+            if (auto seen = assigned.find(codepoint); seen != assigned.end()) {
+                codepoint = seen->second;
+                continue;
+            }
+            auto it = cmap.find(codepoint);
+            if (it == cmap.end() || it->second == 0 || it->second >= glyphs[f].size()) {
+                assigned[codepoint] = 0;
+                codepoint = 0;
+                continue;
+            }
+            uint32_t target = codepoint;
+            if (mapping.count(codepoint)) {
+                target = next_free_codepoint(next_codepoint, mapping, reserved);
+                if (!target) {
+                    stats.error = "no free Private Use Area codepoints are left";
+                    return false;
+                }
+                stats.codepoints_remapped++;
+            }
+            mapping[target] = it->second + gid_offsets[f];
+            assigned[codepoint] = target;
+            codepoint = target;
+        }
+        for (const auto& [codepoint, glyph] : cmap) {
+            if (glyph > 0 && glyph < glyphs[f].size() && !mapping.count(codepoint) && !assigned.count(codepoint)) {
+                mapping[codepoint] = glyph + gid_offsets[f];
+            }
+        }
+    }
+
+    // Assemble into a copy, so |primary| stays intact until everything fits
+    SfntFont merged = primary.font;
+    for (auto it = merged.tables.begin(); it != merged.tables.end();) {
+        if (std::find(std::begin(KEPT_TABLES), std::end(KEPT_TABLES), it->first) == std::end(KEPT_TABLES)) {
+            stats.dropped_tables.push_back(tag_name(it->first));
+            it = merged.tables.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    int32_t x_min = 0, y_min = 0, x_max = 0, y_max = 0;
+    int32_t min_lsb = 0, min_rsb = 0, max_extent = 0;
+    uint16_t max_advance = 0;
+    bool any_outline = false;
+    std::vector<uint8_t> hmtx;
+    for (size_t g = 0; g < merged_glyphs.size(); g++) {
+        const Metric& metric = merged_metrics[g];
+        sfnt_append_u16(hmtx, metric.advance);
+        sfnt_append_u16(hmtx, uint16_t(metric.lsb));
+        max_advance = std::max(max_advance, metric.advance);
+
+        const std::vector<uint8_t>& glyph = merged_glyphs[g];
+        if (glyph.size() < 10 || sfnt_i16(glyph.data()) == 0) continue;
+        int32_t gx_min = sfnt_i16(glyph.data() + 2), gy_min = sfnt_i16(glyph.data() + 4);
+        int32_t gx_max = sfnt_i16(glyph.data() + 6), gy_max = sfnt_i16(glyph.data() + 8);
+        int32_t lsb = metric.lsb, rsb = metric.advance - lsb - (gx_max - gx_min);
+        int32_t extent = lsb + (gx_max - gx_min);
+        if (!any_outline) {
+            x_min = gx_min; y_min = gy_min; x_max = gx_max; y_max = gy_max;
+            min_lsb = lsb; min_rsb = rsb; max_extent = extent;
+            any_outline = true;
+        }
+        x_min = std::min(x_min, gx_min);
+        y_min = std::min(y_min, gy_min);
+        x_max = std::max(x_max, gx_max);
+        y_max = std::max(y_max, gy_max);
+        min_lsb = std::min(min_lsb, lsb);
+        min_rsb = std::min(min_rsb, rsb);
+        max_extent = std::max(max_extent, extent);
+    }
+
+    uint16_t max_component_elements = 0, max_component_depth = 0;
+    for (const MergeFont* font : fonts) {
+        const std::vector<uint8_t>* maxp = table(font->font, TAG_MAXP);
+        if (maxp && maxp->size() >= 32) {
+            max_component_elements = std::max(max_component_elements, sfnt_u16(maxp->data() + 28));
+            max_component_depth = std::max(max_component_depth, sfnt_u16(maxp->data() + 30));
+        }
+    }
+
+    write_glyf_loca(merged, merged_glyphs);
+    merged.tables[TAG_HMTX] = std::move(hmtx);
+    std::vector<uint8_t>& head = merged.tables[TAG_HEAD];
+    sfnt_put_u16(head.data() + 36, uint16_t(int16_t(x_min)));
+    sfnt_put_u16(head.data() + 38, uint16_t(int16_t(y_min)));
+    sfnt_put_u16(head.data() + 40, uint16_t(int16_t(x_max)));
+    sfnt_put_u16(head.data() + 42, uint16_t(int16_t(y_max)));
+    std::vector<uint8_t>& hhea = merged.tables[TAG_HHEA];
+    sfnt_put_u16(hhea.data() + 10, max_advance);
+    sfnt_put_u16(hhea.data() + 12, uint16_t(int16_t(std::clamp(min_lsb, -32768, 32767))));
+    sfnt_put_u16(hhea.data() + 14, uint16_t(int16_t(std::clamp(min_rsb, -32768, 32767))));
+    sfnt_put_u16(hhea.data() + 16, uint16_t(int16_t(std::clamp(max_extent, -32768, 32767))));
+    sfnt_put_u16(hhea.data() + 34, uint16_t(merged_glyphs.size()));
+    std::vector<uint8_t>& maxp = merged.tables[TAG_MAXP];
+    sfnt_put_u16(maxp.data() + 4, uint16_t(merged_glyphs.size()));
+    update_maxp_counts(maxp, merged_glyphs);
+    if (maxp.size() >= 32) {
+        sfnt_put_u16(maxp.data() + 28, max_component_elements);
+        sfnt_put_u16(maxp.data() + 30, max_component_depth);
+    }
+
+    if (axes.empty()) {
+        merged.tables.erase(TAG_GVAR);
+        merged.tables.erase(TAG_FVAR);
+        merged.tables.erase(TAG_AVAR);
+    } else {
+        // Axes only a source has need its name in the primary's name table
+        std::vector<NameRecord> names = read_names(merged);
+        uint16_t next_name_id = 255;
+        for (const NameRecord& record : names) next_name_id = std::max(next_name_id, record.name_id);
+        bool names_added = false;
+        for (size_t a = 0; a < axes.size(); a++) {
+            if (axis_origin[a] == 0) continue;
+            std::vector<uint8_t> text = axis_name(fonts[axis_origin[a]]->font, axes[a]);
+            axes[a].name_id = ++next_name_id;
+            names.push_back({3, 1, 0x0409, axes[a].name_id, std::move(text)});
+            names_added = true;
+        }
+        if (names_added) merged.tables[TAG_NAME] = build_name(names);
+
+        merged.tables[TAG_GVAR] = std::move(gvar_table);
+        merged.tables[TAG_FVAR] = build_fvar(axes, instances);
+        bool mapped = std::any_of(axes.begin(), axes.end(), [](const Axis& a) { return !a.avar.empty(); });
+        if (mapped) merged.tables[TAG_AVAR] = build_avar(axes);
+        else merged.tables.erase(TAG_AVAR);
+    }
+
+    merged.tables[TAG_CMAP] = build_cmap(mapping);
+
+    if (std::vector<uint8_t>* os2 = merged.find(TAG_OS2); os2 && os2->size() >= 68) {
+        for (size_t f = 1; f < fonts.size(); f++) {
+            const std::vector<uint8_t>* source = table(fonts[f]->font, TAG_OS2);
+            if (!source || source->size() < 58) continue;
+            for (size_t i = 0; i < 4; i++) {
+                sfnt_put_u32(os2->data() + 42 + i * 4,
+                             sfnt_u32(os2->data() + 42 + i * 4) | sfnt_u32(source->data() + 42 + i * 4));
+            }
+        }
+        if (!mapping.empty()) {
+            if (mapping.lower_bound(0xE000) != mapping.lower_bound(0xF900)) {
+                sfnt_put_u32(os2->data() + 46, sfnt_u32(os2->data() + 46) | (1u << 28));  // bit 60
+            }
+            if (mapping.lower_bound(0xF0000) != mapping.end()) {
+                sfnt_put_u32(os2->data() + 50, sfnt_u32(os2->data() + 50) | (1u << 26));  // bit 90
+            }
+            sfnt_put_u16(os2->data() + 64, uint16_t(std::min<uint32_t>(mapping.begin()->first, 0xFFFF)));
+            sfnt_put_u16(os2->data() + 66, uint16_t(std::min<uint32_t>(mapping.rbegin()->first, 0xFFFF)));
+        }
+    }
+
+    // Glyph names would no longer line up with the glyphs
+    if (std::vector<uint8_t>* post = merged.find(TAG_POST); post && post->size() >= 32) {
+        post->resize(32);
+        sfnt_put_u32(post->data(), 0x00030000);
+    }
+
+    stats.glyphs_added = total_glyphs - glyphs[0].size();
+    primary.font = std::move(merged);
+    primary.cmap = std::move(mapping);
+    codepoints = std::move(merged_codepoints);
+    return true;
+}
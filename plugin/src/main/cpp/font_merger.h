@@ -0,0 +1,43 @@
+#ifndef FONTSUBSETTING_FONT_MERGER_H
+#define FONTSUBSETTING_FONT_MERGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "sfnt_tables.h"
+
+// A subset font to merge, with its nominal cmap (codepoint -> glyph id)
+struct MergeFont {
+    std::string name;   // for error messages
+    SfntFont font;
+    std::map<uint32_t, uint32_t> cmap;
+};
+
+struct MergeStats {
+    size_t glyphs_added = 0;
+    size_t codepoints_remapped = 0;
+    size_t axes_added = 0;
+    std::vector<std::string> dropped_tables;
+    std::string error;  // why the merge was rejected
+};
+
+// Appends the glyphs of |sources| to |primary|, so one face serves them all.
+// |codepoints|[i] lists codepoints of sources[i]; on success each becomes
+// its codepoint in the merged font, 0 where the source has no glyph for it.
+// Codepoints already taken by the primary or an earlier source move to free
+// Private Use Area codepoints; the primary's never move.
+//
+// Sources are scaled to the primary's unitsPerEm and lose their hinting
+// instructions. Axes are united by tag: an axis in several fonts must have
+// the same range, default and avar mapping, and a glyph does not vary along
+// axes its font lacks. Tables that cannot be combined (layout, HVAR, MVAR,
+// STAT, ...) are dropped.
+//
+// Returns false (and leaves |primary| as is) when a font is not a glyf font,
+// has color tables, or the axes conflict; |stats.error| says why.
+bool merge_fonts(MergeFont& primary, const std::vector<MergeFont>& sources,
+                 std::vector<std::vector<uint32_t>>& codepoints, MergeStats& stats);
+
+#endif // FONTSUBSETTING_FONT_MERGER_H
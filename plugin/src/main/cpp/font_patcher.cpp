@@ -0,0 +1,46 @@
+#include "font_patcher.h"
+#include "sfnt_tables.h"
+#include "cpp/glyph_chunks.h"
+#include "cpp/font_delta.h"
+#include <cstdlib>
+
+bool apply_font_chunks(const std::vector<uint8_t>& base,
+                       const std::vector<std::vector<uint8_t>>& chunks,
+                       std::vector<uint8_t>& patched) {
+    SfntFont font;
+    if (!sfnt_parse(base.data(), base.size(), font)) return false;
+    const std::vector<uint8_t>* table = font.find(GLYPH_CHUNKS_TAG);
+    const std::vector<uint8_t>* maxp = font.find(sfnt_tag('m', 'a', 'x', 'p'));
+    if (!table || !maxp || maxp->size() < 6) return false;
+
+    GlyphChunks* index = glyph_chunks_create(table->data(), table->size(), sfnt_u16(maxp->data() + 4));
+    if (!index) return false;
+
+    patched = base;
+    bool success = true;
+    for (const auto& chunk : chunks) {
+        if (chunk.empty()) continue;
+        size_t size = 0;
+        unsigned int chunk_index = 0;
+        uint8_t* data = glyph_chunks_patch(index, patched.data(), patched.size(),
+                                           chunk.data(), chunk.size(), &size, &chunk_index);
+        if (!data) {
+            success = false;
+            break;
+        }
+        glyph_chunks_mark_applied(index, chunk_index);
+        patched.assign(data, data + size);
+        free(data);
+    }
+    glyph_chunks_destroy(index);
+    return success;
+}
+
+bool apply_font_delta(const uint8_t* old_font, size_t old_size,
+                      const uint8_t* delta, size_t delta_size,
+                      std::vector<uint8_t>& font) {
+    size_t size = font_delta_output_size(delta, delta_size);
+    if (size == 0) return false;
+    font.resize(size);
+    return font_delta_apply(old_font, old_size, delta, delta_size, font.data(), font.size()) == 0;
+}
@@ -0,0 +1,26 @@
+#ifndef FONTSUBSETTING_FONT_PATCHER_H
+#define FONTSUBSETTING_FONT_PATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reads back what the chunk splitter and delta writer produce with the
+// runtime's own C code (runtime/src/main/cpp), so output the runtime would
+// reject never ships.
+
+// Applies |chunks| to the split base font |base| in order, as the runtime
+// does when their icons are first drawn; empty chunks are skipped. False if
+// the base has no chunk table or a chunk is rejected.
+bool apply_font_chunks(const std::vector<uint8_t>& base,
+                       const std::vector<std::vector<uint8_t>>& chunks,
+                       std::vector<uint8_t>& patched);
+
+// Rebuilds a font from |old_font| and |delta| as the runtime's
+// applyFontDelta does; false if the delta is malformed or |old_font| is not
+// its base.
+bool apply_font_delta(const uint8_t* old_font, size_t old_size,
+                      const uint8_t* delta, size_t delta_size,
+                      std::vector<uint8_t>& font);
+
+#endif // FONTSUBSETTING_FONT_PATCHER_H
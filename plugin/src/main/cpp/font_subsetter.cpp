@@ -3,6 +3,12 @@
 #include "harfbuzz_wrappers.h"
 #include "font_metrics.h"
 #include "jni_utils.h"
+#include "cff_converter.h"
+#include "overlap_remover.h"
+#include "font_merger.h"
+#include "font_chunker.h"
+#include "font_patcher.h"
+#include "sfnt_tables.h"
 #include <hb-ot.h>
 #include <hb-subset.h>
 #include <sstream>
@@ -10,12 +16,282 @@
 #include <algorithm>
 #include <vector>
 
+// Tables only consulted for shaping, vertical layout or font naming, none of
+// which apply when icons are drawn by codepoint
+static const hb_tag_t LAYOUT_TABLES[] = {
+    HB_TAG('G', 'S', 'U', 'B'), HB_TAG('G', 'P', 'O', 'S'), HB_TAG('G', 'D', 'E', 'F'),
+    HB_TAG('B', 'A', 'S', 'E'), HB_TAG('J', 'S', 'T', 'F'), HB_TAG('M', 'A', 'T', 'H'),
+    HB_TAG('k', 'e', 'r', 'n'), HB_TAG('k', 'e', 'r', 'x'), HB_TAG('m', 'o', 'r', 't'),
+    HB_TAG('m', 'o', 'r', 'x'), HB_TAG('f', 'e', 'a', 't'), HB_TAG('t', 'r', 'a', 'k'),
+    HB_TAG('v', 'h', 'e', 'a'), HB_TAG('v', 'm', 't', 'x'), HB_TAG('V', 'V', 'A', 'R'),
+    HB_TAG('S', 'T', 'A', 'T'), HB_TAG('m', 'e', 't', 'a'), HB_TAG('l', 't', 'a', 'g'),
+    HB_TAG('D', 'S', 'I', 'G'),
+};
+
+// Dense codepoints start the Private Use Area and must stay inside it
+static constexpr uint32_t DENSE_FIRST_CODEPOINT = 0xE000;
+static constexpr uint32_t DENSE_MAX_ICONS = 0xF8FF - DENSE_FIRST_CODEPOINT + 1;
+
+// Data order of a locality layout: what HarfBuzz reads to open the face, then
+// the per-glyph tables, so the first draws touch as few pages as possible
+static const uint32_t LOCALITY_TABLE_ORDER[] = {
+    sfnt_tag('h', 'e', 'a', 'd'), sfnt_tag('m', 'a', 'x', 'p'), sfnt_tag('c', 'm', 'a', 'p'),
+    sfnt_tag('h', 'h', 'e', 'a'), sfnt_tag('h', 'm', 't', 'x'), sfnt_tag('f', 'v', 'a', 'r'),
+    sfnt_tag('a', 'v', 'a', 'r'), sfnt_tag('l', 'o', 'c', 'a'), sfnt_tag('g', 'l', 'y', 'f'),
+    sfnt_tag('g', 'v', 'a', 'r'), sfnt_tag('C', 'O', 'L', 'R'), sfnt_tag('C', 'P', 'A', 'L'),
+};
+static constexpr size_t LOCALITY_PAGE_SIZE = 4096;
+
+// Reads the whole subset face back into tables; false if it is not a
+// well-formed sfnt
+static bool read_subset_font(hb_face_t* subset_face, SfntFont& font) {
+    HBBlob blob(hb_face_reference_blob(subset_face));
+    unsigned int length = 0;
+    const char* data = hb_blob_get_data(blob, &length);
+    return sfnt_parse(reinterpret_cast<const uint8_t*>(data), length, font);
+}
+
+// A face over |bytes|, or null if HarfBuzz cannot read them
+static hb_face_t* create_face(const std::vector<uint8_t>& bytes) {
+    hb_blob_t* blob = hb_blob_create(
+        reinterpret_cast<const char*>(bytes.data()),
+        static_cast<unsigned int>(bytes.size()),
+        HB_MEMORY_MODE_DUPLICATE,
+        nullptr,
+        nullptr
+    );
+    hb_face_t* face = hb_face_create(blob, 0);
+    hb_blob_destroy(blob);
+    if (face && hb_face_get_glyph_count(face) == 0) {
+        hb_face_destroy(face);
+        return nullptr;
+    }
+    return face;
+}
+
+// A face over the serialized |font|, or null if HarfBuzz cannot read it
+static hb_face_t* create_face(const SfntFont& font) {
+    return create_face(sfnt_serialize(font));
+}
+
+static bool has_table(hb_face_t* face, hb_tag_t tag) {
+    HBBlob blob(hb_face_reference_table(face, tag));
+    return hb_blob_get_length(blob) > 0;
+}
+
+// Converts CFF / CFF2 outlines to glyf (and gvar), since the runtime is
+// built without CFF support. Returns a new face on success; otherwise
+// |subset_face| is returned unchanged.
+static hb_face_t* convert_cff_outlines(hb_face_t* subset_face) {
+    if (!has_table(subset_face, HB_TAG('C', 'F', 'F', ' ')) &&
+        !has_table(subset_face, HB_TAG('C', 'F', 'F', '2'))) {
+        return subset_face;
+    }
+
+    SfntFont font;
+    CffConversionStats stats;
+    if (!read_subset_font(subset_face, font) || !convert_cff_to_glyf(font, stats)) {
+        log_warn("Could not convert CFF outlines to glyf; the runtime will not be able to draw this font");
+        return subset_face;
+    }
+    hb_face_t* converted_face = create_face(font);
+    if (!converted_face) {
+        log_warn("CFF conversion produced an unreadable font; keeping CFF outlines");
+        return subset_face;
+    }
+
+    log_info("Converted CFF outlines to glyf: " + std::to_string(stats.cubics) + " cubics -> " +
+             std::to_string(stats.quads) + " quadratic curves" +
+             (stats.regions ? ", " + std::to_string(stats.regions) + " variation regions" : ""));
+    hb_face_destroy(subset_face);
+    return converted_face;
+}
+
+// Rewrites the cmap so glyph g (g >= 1) is reached by DENSE_FIRST_CODEPOINT + g - 1,
+// one format 4 segment the runtime resolves by subtraction. |dense| receives
+// the new codepoint of each entry of |codepoints|, 0 where it has no glyph.
+// Returns a new face on success; otherwise |subset_face| is returned unchanged.
+static hb_face_t* remap_dense_codepoints(hb_face_t* subset_face,
+                                         const std::vector<unsigned int>& codepoints,
+                                         std::vector<unsigned int>& dense) {
+    const unsigned int glyph_count = hb_face_get_glyph_count(subset_face);
+    const unsigned int icon_count = glyph_count > 0 ? glyph_count - 1 : 0;
+    if (icon_count == 0 || icon_count > DENSE_MAX_ICONS) {
+        log_warn("Dense codepoints skipped: " + std::to_string(icon_count) +
+                 " glyphs do not fit the Private Use Area");
+        return subset_face;
+    }
+
+    SfntFont font;
+    if (!read_subset_font(subset_face, font)) {
+        log_warn("Dense codepoints skipped: could not read subset font");
+        return subset_face;
+    }
+
+    std::vector<unsigned int> remapped(codepoints.size(), 0);
+    hb_font_t* font_funcs = hb_font_create(subset_face);
+    for (size_t i = 0; i < codepoints.size(); i++) {
+        hb_codepoint_t gid = 0;
+        if (hb_font_get_nominal_glyph(font_funcs, codepoints[i], &gid) && gid > 0) {
+            remapped[i] = DENSE_FIRST_CODEPOINT + gid - 1;
+        }
+    }
+    hb_font_destroy(font_funcs);
+
+    const uint32_t last = DENSE_FIRST_CODEPOINT + icon_count - 1;
+    std::vector<uint8_t> subtable;
+    sfnt_append_u16(subtable, 4);       // format
+    sfnt_append_u16(subtable, 32);      // length
+    sfnt_append_u16(subtable, 0);       // language
+    sfnt_append_u16(subtable, 4);       // segCountX2
+    sfnt_append_u16(subtable, 4);       // searchRange
+    sfnt_append_u16(subtable, 1);       // entrySelector
+    sfnt_append_u16(subtable, 0);       // rangeShift
+    sfnt_append_u16(subtable, uint16_t(last));
+    sfnt_append_u16(subtable, 0xFFFF);
+    sfnt_append_u16(subtable, 0);       // reservedPad
+    sfnt_append_u16(subtable, uint16_t(DENSE_FIRST_CODEPOINT));
+    sfnt_append_u16(subtable, 0xFFFF);
+    sfnt_append_u16(subtable, uint16_t(1 - DENSE_FIRST_CODEPOINT));  // idDelta, mod 65536
+    sfnt_append_u16(subtable, 1);
+    sfnt_append_u16(subtable, 0);       // idRangeOffset
+    sfnt_append_u16(subtable, 0);
+
+    // Unicode BMP (0, 3) and Windows BMP (3, 1) share the subtable
+    std::vector<uint8_t> cmap;
+    sfnt_append_u16(cmap, 0);
+    sfnt_append_u16(cmap, 2);
+    for (uint16_t platform : {0, 3}) {
+        sfnt_append_u16(cmap, platform);
+        sfnt_append_u16(cmap, platform == 0 ? 3 : 1);
+        sfnt_append_u32(cmap, 20);
+    }
+    cmap.insert(cmap.end(), subtable.begin(), subtable.end());
+    font.tables[sfnt_tag('c', 'm', 'a', 'p')] = std::move(cmap);
+
+    // OS/2 character range: only the Private Use Area is left
+    if (std::vector<uint8_t>* os2 = font.find(sfnt_tag('O', 'S', '/', '2')); os2 && os2->size() >= 68) {
+        sfnt_put_u32(os2->data() + 42, 0);
+        sfnt_put_u32(os2->data() + 46, 1u << 28);  // bit 60: Private Use Area
+        sfnt_put_u32(os2->data() + 50, 0);
+        sfnt_put_u32(os2->data() + 54, 0);
+        sfnt_put_u16(os2->data() + 64, uint16_t(DENSE_FIRST_CODEPOINT));
+        sfnt_put_u16(os2->data() + 66, uint16_t(last));
+    }
+
+    hb_face_t* remapped_face = create_face(font);
+    if (!remapped_face) {
+        log_warn("Dense codepoints produced an unreadable font; keeping original codepoints");
+        return subset_face;
+    }
+
+    std::stringstream range;
+    range << std::hex << std::uppercase << "U+" << DENSE_FIRST_CODEPOINT << "..U+" << last;
+    log_info("Remapped " + std::to_string(icon_count) + " glyphs to " + range.str());
+    dense = std::move(remapped);
+    hb_face_destroy(subset_face);
+    return remapped_face;
+}
+
+// Maps the glyphs of |priority| (in order, after .notdef) to the lowest new
+// glyph ids; the subsetter numbers the remaining glyphs after them. Codepoints
+// outside |codepoints| or without a glyph are ignored. Returns the glyphs mapped.
+static unsigned int prioritize_glyphs(hb_subset_input_t* input, hb_face_t* face,
+                                      const std::vector<unsigned int>& codepoints,
+                                      const std::vector<unsigned int>& priority) {
+    hb_map_t* mapping = hb_subset_input_old_to_new_glyph_mapping(input);
+    hb_map_set(mapping, 0, 0);
+
+    hb_font_t* font = hb_font_create(face);
+    hb_codepoint_t next = 1;
+    for (unsigned int codepoint : priority) {
+        hb_codepoint_t gid = 0;
+        if (std::find(codepoints.begin(), codepoints.end(), codepoint) == codepoints.end() ||
+            !hb_font_get_nominal_glyph(font, codepoint, &gid) || gid == 0 ||
+            hb_map_has(mapping, gid)) {
+            continue;
+        }
+        hb_map_set(mapping, gid, next++);
+    }
+    hb_font_destroy(font);
+    return next - 1;
+}
+
+// Re-serializes the subset with LOCALITY_TABLE_ORDER and large hot tables
+// page-aligned. Returns a new face on success; otherwise |subset_face| is
+// returned unchanged.
+static hb_face_t* apply_locality_layout(hb_face_t* subset_face) {
+    SfntFont font;
+    if (!read_subset_font(subset_face, font)) {
+        log_warn("Locality layout skipped: could not read subset font");
+        return subset_face;
+    }
+
+    size_t data_size = 12 + font.tables.size() * 16;
+    for (const auto& entry : font.tables) data_size += (entry.second.size() + 3) & ~size_t(3);
+
+    std::vector<uint8_t> bytes = sfnt_serialize(
+        font,
+        std::vector<uint32_t>(std::begin(LOCALITY_TABLE_ORDER), std::end(LOCALITY_TABLE_ORDER)),
+        LOCALITY_PAGE_SIZE);
+    hb_face_t* laid_out_face = create_face(bytes);
+    if (!laid_out_face) {
+        log_warn("Locality layout produced an unreadable font; keeping tag order");
+        return subset_face;
+    }
+
+    log_info("Laid out tables for locality (" + format_file_size(bytes.size() - data_size) +
+             " page alignment)");
+    hb_face_destroy(subset_face);
+    return laid_out_face;
+}
+
+// Merges overlapping contours of the subset's glyf outlines. Returns a new
+// face on success; otherwise |subset_face| is returned unchanged.
+static hb_face_t* merge_overlapping_contours(hb_face_t* subset_face) {
+    SfntFont font;
+    if (!read_subset_font(subset_face, font)) {
+        log_warn("Overlap removal skipped: could not read subset font");
+        return subset_face;
+    }
+
+    OverlapRemovalStats stats;
+    if (!remove_overlaps(font, stats)) {
+        log_info("Overlap removal skipped: no glyf outlines");
+        return subset_face;
+    }
+    if (stats.glyphs_skipped > 0) {
+        log_debug("Kept overlaps in " + std::to_string(stats.glyphs_skipped) +
+                  " glyphs whose union changes shape across the design space");
+    }
+    if (stats.glyphs_merged == 0) {
+        log_info("No overlapping contours to merge");
+        return subset_face;
+    }
+
+    hb_face_t* merged_face = create_face(font);
+    if (!merged_face) {
+        log_warn("Overlap removal produced an unreadable font; keeping overlaps");
+        return subset_face;
+    }
+
+    log_info("Merged overlaps in " + std::to_string(stats.glyphs_merged) + " glyphs (" +
+             std::to_string(stats.contours_before) + " -> " +
+             std::to_string(stats.contours_after) + " contours)");
+    hb_face_destroy(subset_face);
+    return merged_face;
+}
+
 hb_face_t* perform_subsetting(
     const FontData& font_data,
     const std::vector<unsigned int>& codepoints,
     const std::vector<AxisConfig>& axis_configs,
     bool strip_hinting,
-    bool strip_glyph_names
+    bool strip_glyph_names,
+    bool remove_overlaps,
+    bool codepoint_only,
+    std::vector<unsigned int>* dense_codepoints,
+    const std::vector<unsigned int>& priority_codepoints
 ) {
     // Create HarfBuzz blob from font data
     // Use READONLY mode for better performance
@@ -126,6 +402,22 @@ hb_face_t* perform_subsetting(
         optimizations.push_back("hinting (" + format_file_size(metrics_before.total_hinting_size()) + ")");
     }
 
+    if (codepoint_only) {
+        // Icons are looked up by codepoint, so ligature closure only pulls in
+        // glyphs nobody draws, and the layout tables themselves go unused
+        flags |= HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE;
+        hb_set_t* drop_tables = hb_subset_input_set(input, HB_SUBSET_SETS_DROP_TABLE_TAG);
+        size_t layout_size = 0;
+        for (hb_tag_t tag : LAYOUT_TABLES) {
+            hb_set_add(drop_tables, tag);
+            auto it = metrics_before.table_sizes.find(tag_to_string(tag));
+            if (it != metrics_before.table_sizes.end()) layout_size += it->second;
+        }
+        if (layout_size > 0) {
+            optimizations.push_back("layout tables (" + format_file_size(layout_size) + ")");
+        }
+    }
+
     // Note: GLYPH_NAMES flag has inverted logic - setting it KEEPS glyph names
     if (strip_glyph_names && metrics_before.post_size > 0) {
         // By NOT setting the flag, we remove glyph names
@@ -151,6 +443,15 @@ hb_face_t* perform_subsetting(
         hb_set_add(unicodes, codepoint);
     }
     log_info("Subsetting to " + std::to_string(codepoints.size()) + " codepoints");
+
+    if (!priority_codepoints.empty() && !codepoint_only) {
+        // GSUB/GPOS/GDEF Coverage must stay sorted by glyph id, which a
+        // reordered glyph set breaks, and with it every ligature
+        log_warn("Priority glyph order skipped: it needs codepointOnly, as layout tables are kept");
+    } else if (!priority_codepoints.empty()) {
+        unsigned int prioritized = prioritize_glyphs(input, face, codepoints, priority_codepoints);
+        log_info("Placing " + std::to_string(prioritized) + " priority glyphs first");
+    }
     
     // Apply axis configurations
     std::vector<std::string> removed_axes;
@@ -168,6 +469,11 @@ hb_face_t* perform_subsetting(
             if (axis.remove) {
                 hb_subset_input_pin_axis_to_default(input, face, tag);
                 removed_axes.push_back(axis.tag);
+            } else if (axis.min_value == axis.max_value) {
+                hb_subset_input_pin_axis_location(input, face, tag, axis.min_value);
+                std::stringstream ss;
+                ss << axis.tag << "=" << axis.min_value;
+                removed_axes.push_back(ss.str());
             } else {
                 hb_subset_input_set_axis_range(input, face, tag,
                                               axis.min_value, axis.max_value, axis.default_value);
@@ -205,6 +511,21 @@ hb_face_t* perform_subsetting(
         log_error("Subset operation failed");
         return nullptr;
     }
+
+    subset_face = convert_cff_outlines(subset_face);
+
+    if (remove_overlaps) {
+        subset_face = merge_overlapping_contours(subset_face);
+    }
+
+    if (dense_codepoints) {
+        subset_face = remap_dense_codepoints(subset_face, codepoints, *dense_codepoints);
+    }
+
+    // Last, since every other pass re-serializes in tag order
+    if (!priority_codepoints.empty()) {
+        subset_face = apply_locality_layout(subset_face);
+    }
     
     // Collect metrics after subsetting
     // Get the blob to determine final size
@@ -288,4 +609,150 @@ hb_face_t* perform_subsetting(
     }
 
     return subset_face;
-}
\ No newline at end of file
+}
+
+// Reads a subset font's tables and nominal cmap (codepoint -> glyph id)
+static bool read_font_with_cmap(const FontData& data, SfntFont& font, std::map<uint32_t, uint32_t>& cmap) {
+    if (!sfnt_parse(reinterpret_cast<const uint8_t*>(data.data.data()), data.size, font)) {
+        return false;
+    }
+
+    HBBlob blob(hb_blob_create(data.data.data(), static_cast<unsigned int>(data.size),
+                               HB_MEMORY_MODE_READONLY, nullptr, nullptr));
+    HBFace face(hb_face_create(blob, 0));
+    if (!face.valid()) {
+        return false;
+    }
+
+    hb_map_t* mapping = hb_map_create();
+    hb_face_collect_nominal_glyph_mapping(face, mapping, nullptr);
+    int index = -1;
+    hb_codepoint_t codepoint = 0;
+    hb_codepoint_t gid = 0;
+    while (hb_map_next(mapping, &index, &codepoint, &gid)) {
+        cmap[codepoint] = gid;
+    }
+    hb_map_destroy(mapping);
+    return true;
+}
+
+static bool read_merge_font(const FontData& data, const std::string& name, MergeFont& font) {
+    font.name = name;
+    return read_font_with_cmap(data, font.font, font.cmap);
+}
+
+hb_face_t* merge_subset_fonts(
+    const FontData& primary,
+    const std::vector<FontData>& sources,
+    const std::vector<std::string>& source_names,
+    std::vector<std::vector<unsigned int>>& codepoints,
+    bool locality_layout) {
+
+    MergeFont merged;
+    if (!read_merge_font(primary, "primary font", merged)) {
+        log_error("Font merge failed: could not read the primary subset font");
+        return nullptr;
+    }
+
+    std::vector<MergeFont> merge_sources(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (!read_merge_font(sources[i], source_names[i], merge_sources[i])) {
+            log_error("Font merge failed: could not read " + source_names[i]);
+            return nullptr;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> merge_codepoints(codepoints.begin(), codepoints.end());
+    MergeStats stats;
+    if (!merge_fonts(merged, merge_sources, merge_codepoints, stats)) {
+        log_error("Font merge failed: " + stats.error);
+        return nullptr;
+    }
+
+    hb_face_t* merged_face = create_face(merged.font);
+    if (!merged_face) {
+        log_error("Font merge produced an unreadable font");
+        return nullptr;
+    }
+
+    log_info("Merged " + std::to_string(sources.size()) + " fonts: " +
+             std::to_string(stats.glyphs_added) + " glyphs added, " +
+             std::to_string(stats.codepoints_remapped) + " codepoints moved to the Private Use Area");
+    if (stats.axes_added > 0) {
+        log_info("Merged font gained " + std::to_string(stats.axes_added) + " axes");
+    }
+    if (!stats.dropped_tables.empty()) {
+        std::string msg = "Tables dropped by merge: ";
+        for (size_t i = 0; i < stats.dropped_tables.size(); i++) {
+            if (i > 0) msg += ", ";
+            msg += stats.dropped_tables[i];
+        }
+        log_info(msg);
+    }
+
+    for (size_t i = 0; i < codepoints.size(); i++) {
+        codepoints[i].assign(merge_codepoints[i].begin(), merge_codepoints[i].end());
+    }
+
+    if (locality_layout) {
+        merged_face = apply_locality_layout(merged_face);
+    }
+    return merged_face;
+}
+
+hb_face_t* split_subset_font(
+    const FontData& font_data,
+    const std::vector<std::string>& chunk_names,
+    const std::vector<std::vector<unsigned int>>& chunk_codepoints,
+    std::vector<std::vector<uint8_t>>& chunks,
+    bool locality_layout) {
+
+    SfntFont font;
+    std::map<uint32_t, uint32_t> cmap;
+    if (!read_font_with_cmap(font_data, font, cmap)) {
+        log_error("Chunk split failed: could not read the subset font");
+        return nullptr;
+    }
+
+    std::vector<ChunkGroup> groups(chunk_names.size());
+    for (size_t i = 0; i < groups.size(); i++) {
+        groups[i].name = chunk_names[i];
+        groups[i].codepoints.assign(chunk_codepoints[i].begin(), chunk_codepoints[i].end());
+    }
+
+    ChunkStats stats;
+    if (!split_font_chunks(font, cmap, groups, chunks, stats)) {
+        log_error("Chunk split failed: " + stats.error);
+        return nullptr;
+    }
+
+    std::vector<uint8_t> patched;
+    if (!apply_font_chunks(sfnt_serialize(font), chunks, patched)) {
+        log_error("Chunk split failed: the runtime rejects the chunks written");
+        return nullptr;
+    }
+
+    hb_face_t* base_face = create_face(font);
+    if (!base_face) {
+        log_error("Chunk split produced an unreadable base font");
+        return nullptr;
+    }
+
+    size_t chunk_bytes = 0;
+    for (const auto& chunk : chunks) chunk_bytes += chunk.size();
+    log_info("Split " + std::to_string(stats.chunked_glyphs) + " glyphs into " +
+             std::to_string(groups.size() - stats.empty_groups) + " chunks (" +
+             format_file_size(chunk_bytes) + ")");
+    if (stats.shared_glyphs > 0) {
+        log_info(std::to_string(stats.shared_glyphs) +
+                 " grouped glyphs are shared between groups and stay in the base font");
+    }
+    if (stats.empty_groups > 0) {
+        log_warn(std::to_string(stats.empty_groups) + " chunk groups have no glyphs of their own");
+    }
+
+    if (locality_layout) {
+        base_face = apply_locality_layout(base_face);
+    }
+    return base_face;
+}
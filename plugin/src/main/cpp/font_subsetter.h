@@ -1,6 +1,7 @@
 #ifndef FONTSUBSETTING_FONT_SUBSETTER_H
 #define FONTSUBSETTING_FONT_SUBSETTER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <hb.h>
@@ -14,13 +15,48 @@ struct AxisConfig {
     bool remove;
 };
 
-// Core font subsetting function
+// Core font subsetting function. With |dense_codepoints| set, the subset's
+// cmap is remapped to a contiguous Private Use Area run and the new codepoint
+// of each entry of |codepoints| is stored there (0 if it has no glyph).
+// Glyphs of |priority_codepoints| get the lowest glyph ids, in order, when
+// |codepoint_only| drops the layout tables, and the output is then laid out
+// for locality: hot tables first, large ones page-aligned.
 hb_face_t* perform_subsetting(
     const FontData& font_data,
     const std::vector<unsigned int>& codepoints,
     const std::vector<AxisConfig>& axis_configs,
     bool strip_hinting = true,
-    bool strip_glyph_names = true
+    bool strip_glyph_names = true,
+    bool remove_overlaps = false,
+    bool codepoint_only = false,
+    std::vector<unsigned int>* dense_codepoints = nullptr,
+    const std::vector<unsigned int>& priority_codepoints = {}
+);
+
+// Merges the subset fonts |sources| (named by |source_names| in messages) into
+// the subset font |primary|. |codepoints|[i] lists the codepoints used from
+// sources[i]; each is replaced by its codepoint in the merged font, 0 where
+// it has no glyph. With |locality_layout| the merged font is laid out like a
+// prioritized subset. Returns null if the fonts cannot be merged.
+hb_face_t* merge_subset_fonts(
+    const FontData& primary,
+    const std::vector<FontData>& sources,
+    const std::vector<std::string>& source_names,
+    std::vector<std::vector<unsigned int>>& codepoints,
+    bool locality_layout = false
+);
+
+// Splits the subset font |font_data| into a base font (returned) and one
+// chunk per group, which the runtime applies when a missing glyph is drawn.
+// |chunk_codepoints|[i] lists the codepoints of the group whose chunk is
+// shipped as |chunk_names|[i]; chunks[i] receives its bytes, empty when the
+// group has no glyphs of its own. Returns null if the font cannot be split.
+hb_face_t* split_subset_font(
+    const FontData& font_data,
+    const std::vector<std::string>& chunk_names,
+    const std::vector<std::vector<unsigned int>>& chunk_codepoints,
+    std::vector<std::vector<uint8_t>>& chunks,
+    bool locality_layout = false
 );
 
 #endif // FONTSUBSETTING_FONT_SUBSETTER_H
\ No newline at end of file
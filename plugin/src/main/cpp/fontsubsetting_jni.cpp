@@ -1,4 +1,5 @@
 #include <jni.h>
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 
@@ -7,6 +8,8 @@
 #include "jni_utils.h"
 #include "font_io.h"
 #include "font_subsetter.h"
+#include "font_delta.h"
+#include "font_patcher.h"
 #include "font_metrics.h"
 #include "harfbuzz_wrappers.h"
 #include <hb-ot.h>
@@ -65,7 +68,11 @@ Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeSubsetFontW
     jfloatArray axisDefaultValues,
     jbooleanArray axisRemove,
     jboolean stripHinting,
-    jboolean stripGlyphNames) {
+    jboolean stripGlyphNames,
+    jboolean removeOverlaps,
+    jboolean codepointOnly,
+    jintArray denseCodepoints,
+    jintArray priorityCodepoints) {
 
     std::string input_path = jstring_to_string(env, inputPath);
     std::string output_path = jstring_to_string(env, outputPath);
@@ -124,16 +131,43 @@ Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeSubsetFontW
         return JNI_FALSE;
     }
 
+    std::vector<unsigned int> priority;
+    if (priorityCodepoints != nullptr) {
+        jsize len = env->GetArrayLength(priorityCodepoints);
+        jint* elements = env->GetIntArrayElements(priorityCodepoints, nullptr);
+        priority.reserve(len);
+        for (jsize i = 0; i < len; i++) {
+            priority.push_back(static_cast<unsigned int>(elements[i]));
+        }
+        env->ReleaseIntArrayElements(priorityCodepoints, elements, JNI_ABORT);
+    }
+
+    // Dense remapping writes one new codepoint per requested codepoint
+    std::vector<unsigned int> dense;
+    const bool remap_dense = denseCodepoints != nullptr &&
+        env->GetArrayLength(denseCodepoints) == static_cast<jsize>(codepoints.size());
+
     // Perform subsetting with axes and custom flags
     hb_face_t* subset_face = perform_subsetting(
         font_data, codepoints, axis_configs,
         stripHinting == JNI_TRUE,
-        stripGlyphNames == JNI_TRUE
+        stripGlyphNames == JNI_TRUE,
+        removeOverlaps == JNI_TRUE,
+        codepointOnly == JNI_TRUE,
+        remap_dense ? &dense : nullptr,
+        priority
     );
     if (!subset_face) {
         return JNI_FALSE;
     }
 
+    if (remap_dense) {
+        // A skipped remap keeps the original cmap, so each codepoint stays itself
+        const std::vector<unsigned int>& remapped = dense.size() == codepoints.size() ? dense : codepoints;
+        std::vector<jint> values(remapped.begin(), remapped.end());
+        env->SetIntArrayRegion(denseCodepoints, 0, static_cast<jsize>(values.size()), values.data());
+    }
+
     // Get subset data
     HBBlob subset_blob(hb_face_reference_blob(subset_face));
     unsigned int subset_length;
@@ -153,6 +187,269 @@ Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeSubsetFontW
     return success ? JNI_TRUE : JNI_FALSE;
 }
 
+JNI_EXPORT JNIEXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeMergeFonts(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring primaryPath,
+    jstring outputPath,
+    jobjectArray sourcePaths,
+    jobjectArray sourceCodepoints,
+    jboolean localityLayout) {
+
+    std::string primary_path = jstring_to_string(env, primaryPath);
+    std::string output_path = jstring_to_string(env, outputPath);
+    std::vector<std::string> source_paths = jarray_to_vector(env, sourcePaths);
+
+    if (sourceCodepoints == nullptr ||
+        env->GetArrayLength(sourceCodepoints) != static_cast<jsize>(source_paths.size())) {
+        log_error("Font merge needs one codepoint list per source font");
+        return JNI_FALSE;
+    }
+
+    log_info("Merging " + std::to_string(source_paths.size()) + " fonts into " + primary_path);
+
+    FontData primary = read_font_file(primary_path);
+    if (!primary.valid) {
+        return JNI_FALSE;
+    }
+
+    std::vector<FontData> sources;
+    std::vector<std::vector<unsigned int>> codepoints(source_paths.size());
+    for (size_t i = 0; i < source_paths.size(); i++) {
+        sources.push_back(read_font_file(source_paths[i]));
+        if (!sources.back().valid) {
+            return JNI_FALSE;
+        }
+
+        jintArray array = static_cast<jintArray>(env->GetObjectArrayElement(sourceCodepoints, static_cast<jsize>(i)));
+        if (array != nullptr) {
+            jsize len = env->GetArrayLength(array);
+            jint* elements = env->GetIntArrayElements(array, nullptr);
+            for (jsize j = 0; j < len; j++) {
+                codepoints[i].push_back(static_cast<unsigned int>(elements[j]));
+            }
+            env->ReleaseIntArrayElements(array, elements, JNI_ABORT);
+            env->DeleteLocalRef(array);
+        }
+    }
+
+    hb_face_t* merged_face = merge_subset_fonts(
+        primary, sources, source_paths, codepoints, localityLayout == JNI_TRUE);
+    if (!merged_face) {
+        return JNI_FALSE;
+    }
+
+    // Hand back each source's codepoints in the merged font
+    for (size_t i = 0; i < codepoints.size(); i++) {
+        jintArray array = static_cast<jintArray>(env->GetObjectArrayElement(sourceCodepoints, static_cast<jsize>(i)));
+        if (array != nullptr && env->GetArrayLength(array) == static_cast<jsize>(codepoints[i].size())) {
+            std::vector<jint> values(codepoints[i].begin(), codepoints[i].end());
+            env->SetIntArrayRegion(array, 0, static_cast<jsize>(values.size()), values.data());
+        }
+        if (array != nullptr) {
+            env->DeleteLocalRef(array);
+        }
+    }
+
+    HBBlob merged_blob(hb_face_reference_blob(merged_face));
+    unsigned int merged_length;
+    const char* merged_data = hb_blob_get_data(merged_blob, &merged_length);
+
+    bool success = write_font_file(output_path, merged_data, merged_length);
+    hb_face_destroy(merged_face);
+
+    if (success) {
+        log_info("Successfully merged fonts: " + format_file_size(primary.size) +
+                " -> " + format_file_size(merged_length));
+    }
+
+    return success ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT JNIEXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeSplitChunks(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring fontPath,
+    jstring outputPath,
+    jstring chunkDirectory,
+    jobjectArray chunkNames,
+    jobjectArray chunkCodepoints,
+    jboolean localityLayout) {
+
+    std::string font_path = jstring_to_string(env, fontPath);
+    std::string output_path = jstring_to_string(env, outputPath);
+    std::string chunk_directory = jstring_to_string(env, chunkDirectory);
+    std::vector<std::string> chunk_names = jarray_to_vector(env, chunkNames);
+
+    if (chunkCodepoints == nullptr ||
+        env->GetArrayLength(chunkCodepoints) != static_cast<jsize>(chunk_names.size())) {
+        log_error("Chunk split needs one codepoint list per chunk");
+        return JNI_FALSE;
+    }
+
+    log_info("Splitting " + font_path + " into " + std::to_string(chunk_names.size()) + " chunks");
+
+    FontData font_data = read_font_file(font_path);
+    if (!font_data.valid) {
+        return JNI_FALSE;
+    }
+
+    std::vector<std::vector<unsigned int>> codepoints(chunk_names.size());
+    for (size_t i = 0; i < chunk_names.size(); i++) {
+        jintArray array = static_cast<jintArray>(env->GetObjectArrayElement(chunkCodepoints, static_cast<jsize>(i)));
+        if (array != nullptr) {
+            jsize len = env->GetArrayLength(array);
+            jint* elements = env->GetIntArrayElements(array, nullptr);
+            for (jsize j = 0; j < len; j++) {
+                codepoints[i].push_back(static_cast<unsigned int>(elements[j]));
+            }
+            env->ReleaseIntArrayElements(array, elements, JNI_ABORT);
+            env->DeleteLocalRef(array);
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> chunks;
+    hb_face_t* base_face = split_subset_font(
+        font_data, chunk_names, codepoints, chunks, localityLayout == JNI_TRUE);
+    if (!base_face) {
+        return JNI_FALSE;
+    }
+
+    HBBlob base_blob(hb_face_reference_blob(base_face));
+    unsigned int base_length;
+    const char* base_data = hb_blob_get_data(base_blob, &base_length);
+
+    bool success = write_font_file(output_path, base_data, base_length);
+    hb_face_destroy(base_face);
+
+    // Groups without glyphs of their own have no chunk to ship
+    for (size_t i = 0; success && i < chunks.size(); i++) {
+        if (chunks[i].empty()) continue;
+        success = write_font_file(chunk_directory + "/" + chunk_names[i],
+                                  reinterpret_cast<const char*>(chunks[i].data()), chunks[i].size());
+    }
+
+    if (success) {
+        log_info("Successfully split font: " + format_file_size(font_data.size) +
+                " -> " + format_file_size(base_length) + " base font");
+    }
+
+    return success ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT JNIEXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeApplyChunks(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring basePath,
+    jobjectArray chunkPaths,
+    jstring outputPath) {
+
+    std::string base_path = jstring_to_string(env, basePath);
+    std::string output_path = jstring_to_string(env, outputPath);
+
+    FontData base = read_font_file(base_path);
+    if (!base.valid) {
+        return JNI_FALSE;
+    }
+
+    std::vector<std::vector<uint8_t>> chunks;
+    for (const std::string& path : jarray_to_vector(env, chunkPaths)) {
+        FontData chunk = read_font_file(path);
+        if (!chunk.valid) {
+            return JNI_FALSE;
+        }
+        chunks.emplace_back(chunk.data.begin(), chunk.data.end());
+    }
+
+    std::vector<uint8_t> patched;
+    if (!apply_font_chunks(std::vector<uint8_t>(base.data.begin(), base.data.end()), chunks, patched)) {
+        log_error("Chunks do not apply to " + base_path);
+        return JNI_FALSE;
+    }
+
+    return write_font_file(output_path, reinterpret_cast<const char*>(patched.data()), patched.size())
+        ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT JNIEXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeCreateFontDelta(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring previousPath,
+    jstring fontPath,
+    jstring deltaPath) {
+
+    std::string previous_path = jstring_to_string(env, previousPath);
+    std::string font_path = jstring_to_string(env, fontPath);
+    std::string delta_path = jstring_to_string(env, deltaPath);
+
+    FontData previous = read_font_file(previous_path);
+    FontData font_data = read_font_file(font_path);
+    if (!previous.valid || !font_data.valid) {
+        return JNI_FALSE;
+    }
+
+    std::vector<uint8_t> delta;
+    DeltaStats stats;
+    if (!build_font_delta(reinterpret_cast<const uint8_t*>(previous.data.data()), previous.size,
+                          reinterpret_cast<const uint8_t*>(font_data.data.data()), font_data.size,
+                          delta, stats)) {
+        log_error("Font delta failed: fonts larger than 64 MB are not supported");
+        return JNI_FALSE;
+    }
+
+    std::vector<uint8_t> rebuilt;
+    if (!apply_font_delta(reinterpret_cast<const uint8_t*>(previous.data.data()), previous.size,
+                          delta.data(), delta.size(), rebuilt) ||
+        rebuilt.size() != font_data.size ||
+        !std::equal(rebuilt.begin(), rebuilt.end(), reinterpret_cast<const uint8_t*>(font_data.data.data()))) {
+        log_error("Font delta failed: the runtime does not rebuild " + font_path + " from it");
+        return JNI_FALSE;
+    }
+
+    if (!write_font_file(delta_path, reinterpret_cast<const char*>(delta.data()), delta.size())) {
+        return JNI_FALSE;
+    }
+
+    log_info("Font delta: " + format_file_size(font_data.size) + " -> " + format_file_size(delta.size()) +
+             " (" + std::to_string(stats.tables_copied) + " tables and " +
+             std::to_string(stats.glyphs_copied) + " glyph records reused, " +
+             std::to_string(stats.glyphs_inserted) + " new)");
+    return JNI_TRUE;
+}
+
+JNI_EXPORT JNIEXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeApplyFontDelta(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring previousPath,
+    jstring deltaPath,
+    jstring outputPath) {
+
+    std::string previous_path = jstring_to_string(env, previousPath);
+    std::string delta_path = jstring_to_string(env, deltaPath);
+    std::string output_path = jstring_to_string(env, outputPath);
+
+    FontData previous = read_font_file(previous_path);
+    FontData delta = read_font_file(delta_path);
+    if (!previous.valid || !delta.valid) {
+        return JNI_FALSE;
+    }
+
+    std::vector<uint8_t> font;
+    if (!apply_font_delta(reinterpret_cast<const uint8_t*>(previous.data.data()), previous.size,
+                          reinterpret_cast<const uint8_t*>(delta.data.data()), delta.size, font)) {
+        log_error("Delta " + delta_path + " does not apply to " + previous_path);
+        return JNI_FALSE;
+    }
+
+    return write_font_file(output_path, reinterpret_cast<const char*>(font.data()), font.size())
+        ? JNI_TRUE : JNI_FALSE;
+}
+
 JNI_EXPORT JNIEXPORT jboolean JNICALL
 Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeValidateFont(
     JNIEnv* env,
@@ -235,6 +532,16 @@ Java_com_davidmedenjak_fontsubsetting_native_HarfBuzzSubsetter_nativeGetFontInfo
     info << "glyphCount=" << glyph_count << "\n";
     info << "unitsPerEm=" << upem << "\n";
     info << "fileSize=" << font_data.size << "\n";
+
+    // Output format: tables=<tag>,<tag>,... in directory order
+    unsigned int table_count = hb_face_get_table_tags(face, 0, nullptr, nullptr);
+    std::vector<hb_tag_t> table_tags(table_count);
+    hb_face_get_table_tags(face, 0, &table_count, table_tags.data());
+    info << "tables=";
+    for (unsigned int i = 0; i < table_count; i++) {
+        info << (i > 0 ? "," : "") << tag_to_string(table_tags[i]);
+    }
+    info << "\n";
     
     // Get variable font axis information
     unsigned int axis_count = hb_ot_var_get_axis_count(face);
@@ -0,0 +1,356 @@
+#include "glyf_tables.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int MAX_COMPONENT_DEPTH = 16;
+
+const std::vector<uint8_t>* find_table(const SfntFont& font, uint32_t tag) {
+    auto it = font.tables.find(tag);
+    return it != font.tables.end() ? &it->second : nullptr;
+}
+
+// Points and contours of a glyph, composites summed over their components
+struct GlyphCounts {
+    uint32_t points = 0, contours = 0;
+};
+
+GlyphCounts count_glyph(const std::vector<std::vector<uint8_t>>& glyphs, uint16_t glyph_id, int depth) {
+    GlyphCounts counts;
+    if (glyph_id >= glyphs.size() || depth > MAX_COMPONENT_DEPTH) return counts;
+    const std::vector<uint8_t>& g = glyphs[glyph_id];
+    if (g.size() < 10) return counts;
+    int16_t contours = sfnt_i16(g.data());
+    if (contours >= 0) {
+        counts.contours = uint32_t(contours);
+        if (contours > 0 && g.size() >= 10 + size_t(contours) * 2) {
+            counts.points = uint32_t(sfnt_u16(g.data() + 10 + (size_t(contours) - 1) * 2)) + 1;
+        }
+        return counts;
+    }
+    size_t pos = 10;
+    while (pos + 4 <= g.size()) {
+        uint16_t flags = sfnt_u16(g.data() + pos);
+        GlyphCounts c = count_glyph(glyphs, sfnt_u16(g.data() + pos + 2), depth + 1);
+        counts.points += c.points;
+        counts.contours += c.contours;
+        pos += 4 + ((flags & 0x0001) ? 4 : 2);
+        if (flags & 0x0008) pos += 2;
+        else if (flags & 0x0040) pos += 4;
+        else if (flags & 0x0080) pos += 8;
+        if (!(flags & 0x0020)) break;
+    }
+    return counts;
+}
+
+} // namespace
+
+bool read_packed_points(const uint8_t* data, size_t size, size_t& pos,
+                        std::vector<uint16_t>& points, bool& all) {
+    points.clear();
+    if (pos >= size) return false;
+    size_t count = data[pos++];
+    if (count & 0x80) {
+        if (pos >= size) return false;
+        count = ((count & 0x7F) << 8) | data[pos++];
+    }
+    all = count == 0;
+    uint32_t value = 0;
+    while (points.size() < count) {
+        if (pos >= size) return false;
+        uint8_t control = data[pos++];
+        size_t run = (control & 0x7F) + 1;
+        bool words = control & 0x80;
+        for (size_t i = 0; i < run && points.size() < count; i++) {
+            if (pos + (words ? 2 : 1) > size) return false;
+            value += words ? sfnt_u16(data + pos) : data[pos];
+            pos += words ? 2 : 1;
+            if (value > 0xFFFF) return false;
+            points.push_back(uint16_t(value));
+        }
+    }
+    return true;
+}
+
+bool read_packed_deltas(const uint8_t* data, size_t size, size_t& pos, size_t count,
+                        std::vector<int32_t>& deltas) {
+    deltas.clear();
+    while (deltas.size() < count) {
+        if (pos >= size) return false;
+        uint8_t control = data[pos++];
+        size_t run = (control & 0x3F) + 1;
+        size_t width = (control & 0xC0) == 0xC0 ? 4 : (control & 0x80) ? 0 : (control & 0x40) ? 2 : 1;
+        for (size_t i = 0; i < run && deltas.size() < count; i++) {
+            if (pos + width > size) return false;
+            switch (width) {
+                case 0: deltas.push_back(0); break;
+                case 1: deltas.push_back(int8_t(data[pos])); break;
+                case 2: deltas.push_back(sfnt_i16(data + pos)); break;
+                default: deltas.push_back(int32_t(sfnt_u32(data + pos))); break;
+            }
+            pos += width;
+        }
+    }
+    return true;
+}
+
+void append_packed_deltas(std::vector<uint8_t>& out, const std::vector<int32_t>& deltas) {
+    auto fits_byte = [](int32_t v) { return v >= -128 && v <= 127; };
+    auto fits_word = [](int32_t v) { return v >= -32768 && v <= 32767; };
+    for (size_t i = 0; i < deltas.size();) {
+        size_t run = 0;
+        if (deltas[i] == 0) {
+            while (i + run < deltas.size() && deltas[i + run] == 0 && run < 64) run++;
+            out.push_back(uint8_t(0x80 | (run - 1)));
+        } else if (fits_byte(deltas[i])) {
+            while (i + run < deltas.size() && deltas[i + run] != 0 && fits_byte(deltas[i + run]) && run < 64) run++;
+            out.push_back(uint8_t(run - 1));
+            for (size_t k = 0; k < run; k++) out.push_back(uint8_t(int8_t(deltas[i + k])));
+        } else if (fits_word(deltas[i])) {
+            while (i + run < deltas.size() && !fits_byte(deltas[i + run]) && fits_word(deltas[i + run]) && run < 64) run++;
+            out.push_back(uint8_t(0x40 | (run - 1)));
+            for (size_t k = 0; k < run; k++) sfnt_append_u16(out, uint16_t(int16_t(deltas[i + k])));
+        } else {
+            while (i + run < deltas.size() && !fits_word(deltas[i + run]) && run < 64) run++;
+            out.push_back(uint8_t(0xC0 | (run - 1)));
+            for (size_t k = 0; k < run; k++) sfnt_append_u32(out, uint32_t(deltas[i + k]));
+        }
+        i += run;
+    }
+}
+
+bool decode_simple_glyph(const uint8_t* data, size_t size, std::vector<uint16_t>& end_points,
+                         std::vector<GlyphPoint>& points) {
+    if (size < 12) return false;
+    int16_t contours = sfnt_i16(data);
+    if (contours <= 0) return false;
+
+    size_t pos = 10;
+    if (pos + size_t(contours) * 2 + 2 > size) return false;
+    end_points.resize(size_t(contours));
+    size_t point_count = 0;
+    for (int16_t i = 0; i < contours; i++) {
+        uint16_t end = sfnt_u16(data + pos);
+        pos += 2;
+        if (size_t(end) + 1 < point_count) return false;
+        end_points[size_t(i)] = end;
+        point_count = size_t(end) + 1;
+    }
+    pos += 2 + sfnt_u16(data + pos);
+    if (pos > size) return false;
+
+    std::vector<uint8_t> flags(point_count);
+    for (size_t i = 0; i < point_count;) {
+        if (pos >= size) return false;
+        uint8_t flag = data[pos++];
+        flags[i++] = flag;
+        if (flag & 0x08) {
+            if (pos >= size) return false;
+            for (uint8_t repeat = data[pos++]; repeat && i < point_count; repeat--) flags[i++] = flag;
+        }
+    }
+
+    points.resize(point_count);
+    for (int axis = 0; axis < 2; axis++) {
+        const uint8_t short_bit = axis ? 0x04 : 0x02;
+        const uint8_t same_bit = axis ? 0x20 : 0x10;
+        int32_t value = 0;
+        for (size_t i = 0; i < point_count; i++) {
+            uint8_t flag = flags[i];
+            if (flag & short_bit) {
+                if (pos >= size) return false;
+                value += (flag & same_bit) ? data[pos] : -int32_t(data[pos]);
+                pos++;
+            } else if (!(flag & same_bit)) {
+                if (pos + 2 > size) return false;
+                value += sfnt_i16(data + pos);
+                pos += 2;
+            }
+            (axis ? points[i].y : points[i].x) = value;
+            points[i].on_curve = flag & 0x01;
+        }
+    }
+    return true;
+}
+
+
+bool encode_simple_glyph(const std::vector<uint16_t>& end_points,
+                         const std::vector<GlyphPoint>& points,
+                         std::vector<uint8_t>& out, int16_t& x_min) {
+    int32_t bounds[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < points.size(); i++) {
+        const GlyphPoint& p = points[i];
+        if (p.x < -32768 || p.x > 32767 || p.y < -32768 || p.y > 32767) return false;
+        if (i == 0 || p.x < bounds[0]) bounds[0] = p.x;
+        if (i == 0 || p.y < bounds[1]) bounds[1] = p.y;
+        if (i == 0 || p.x > bounds[2]) bounds[2] = p.x;
+        if (i == 0 || p.y > bounds[3]) bounds[3] = p.y;
+    }
+    x_min = int16_t(bounds[0]);
+
+    out.clear();
+    sfnt_append_u16(out, uint16_t(end_points.size()));
+    for (int32_t b : bounds) sfnt_append_u16(out, uint16_t(int16_t(b)));
+    for (uint16_t end : end_points) sfnt_append_u16(out, end);
+    sfnt_append_u16(out, 0);
+
+    std::vector<uint8_t> flags, xs, ys;
+    int32_t last_x = 0, last_y = 0;
+    for (const GlyphPoint& p : points) {
+        uint8_t flag = p.on_curve ? 0x01 : 0x00;
+        int32_t dx = p.x - last_x, dy = p.y - last_y;
+        last_x = p.x;
+        last_y = p.y;
+        if (dx == 0) {
+            flag |= 0x10;
+        } else if (dx > -256 && dx < 256) {
+            flag |= 0x02 | (dx > 0 ? 0x10 : 0);
+            xs.push_back(uint8_t(dx > 0 ? dx : -dx));
+        } else {
+            sfnt_append_u16(xs, uint16_t(int16_t(dx)));
+        }
+        if (dy == 0) {
+            flag |= 0x20;
+        } else if (dy > -256 && dy < 256) {
+            flag |= 0x04 | (dy > 0 ? 0x20 : 0);
+            ys.push_back(uint8_t(dy > 0 ? dy : -dy));
+        } else {
+            sfnt_append_u16(ys, uint16_t(int16_t(dy)));
+        }
+        flags.push_back(flag);
+    }
+
+    for (size_t i = 0; i < flags.size();) {
+        size_t run = 1;
+        while (i + run < flags.size() && flags[i + run] == flags[i] && run < 256) run++;
+        if (run > 2) {
+            out.push_back(flags[i] | 0x08);
+            out.push_back(uint8_t(run - 1));
+        } else {
+            out.insert(out.end(), run, flags[i]);
+        }
+        i += run;
+    }
+    out.insert(out.end(), xs.begin(), xs.end());
+    out.insert(out.end(), ys.begin(), ys.end());
+    return true;
+}
+
+
+void encode_glyph_variations(const std::vector<TupleDeltas>& tuples, std::vector<uint8_t>& out) {
+    std::vector<uint8_t> headers, body;
+    body.push_back(0);  // shared point numbers: all points
+    uint16_t written = 0;
+    for (const TupleDeltas& tuple : tuples) {
+        bool zero = true;
+        for (size_t i = 0; i < tuple.x.size() && zero; i++) zero = tuple.x[i] == 0 && tuple.y[i] == 0;
+        if (zero) continue;
+        size_t start = body.size();
+        append_packed_deltas(body, tuple.x);
+        append_packed_deltas(body, tuple.y);
+        sfnt_append_u16(headers, uint16_t(body.size() - start));
+        sfnt_append_u16(headers, uint16_t(tuple.index & ~0x2000));
+        headers.insert(headers.end(), tuple.coordinates.begin(), tuple.coordinates.end());
+        written++;
+    }
+    out.clear();
+    if (!written) return;
+    sfnt_append_u16(out, uint16_t(0x8000 | written));
+    sfnt_append_u16(out, uint16_t(4 + headers.size()));
+    out.insert(out.end(), headers.begin(), headers.end());
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+bool read_glyf_loca(const SfntFont& font, std::vector<std::vector<uint8_t>>& glyphs) {
+    const std::vector<uint8_t>* head = find_table(font, sfnt_tag('h', 'e', 'a', 'd'));
+    const std::vector<uint8_t>* maxp = find_table(font, sfnt_tag('m', 'a', 'x', 'p'));
+    const std::vector<uint8_t>* loca = find_table(font, sfnt_tag('l', 'o', 'c', 'a'));
+    const std::vector<uint8_t>* glyf = find_table(font, sfnt_tag('g', 'l', 'y', 'f'));
+    if (!head || head->size() < 54 || !maxp || maxp->size() < 6 || !loca || !glyf) return false;
+
+    const size_t count = sfnt_u16(maxp->data() + 4);
+    const bool long_loca = sfnt_i16(head->data() + 50) == 1;
+    const size_t entry = long_loca ? 4 : 2;
+    if (count == 0 || loca->size() < (count + 1) * entry) return false;
+
+    glyphs.resize(count);
+    for (size_t g = 0; g < count; g++) {
+        const uint8_t* p = loca->data() + g * entry;
+        uint32_t start = long_loca ? sfnt_u32(p) : uint32_t(sfnt_u16(p)) * 2;
+        uint32_t end = long_loca ? sfnt_u32(p + entry) : uint32_t(sfnt_u16(p + entry)) * 2;
+        if (start > end || end > glyf->size()) return false;
+        glyphs[g].assign(glyf->begin() + start, glyf->begin() + end);
+    }
+    return true;
+}
+
+void write_glyf_loca(SfntFont& font, std::vector<std::vector<uint8_t>>& glyphs) {
+    std::vector<uint8_t> glyf;
+    std::vector<uint32_t> offsets;
+    for (auto& g : glyphs) {
+        if (g.size() % 2) g.push_back(0);
+        offsets.push_back(uint32_t(glyf.size()));
+        glyf.insert(glyf.end(), g.begin(), g.end());
+    }
+    offsets.push_back(uint32_t(glyf.size()));
+
+    const bool long_loca = glyf.size() > 0x1FFFE;
+    std::vector<uint8_t> loca;
+    for (uint32_t offset : offsets) {
+        if (long_loca) sfnt_append_u32(loca, offset);
+        else sfnt_append_u16(loca, uint16_t(offset / 2));
+    }
+    font.tables[sfnt_tag('g', 'l', 'y', 'f')] = std::move(glyf);
+    font.tables[sfnt_tag('l', 'o', 'c', 'a')] = std::move(loca);
+    if (std::vector<uint8_t>* head = font.find(sfnt_tag('h', 'e', 'a', 'd')); head && head->size() >= 54) {
+        sfnt_put_u16(head->data() + 50, long_loca ? 1 : 0);
+    }
+}
+
+std::vector<uint8_t> build_gvar(uint16_t axis_count, const uint8_t* shared_tuples, uint16_t shared_count,
+                                std::vector<std::vector<uint8_t>>& data) {
+    size_t total = 0;
+    for (auto& d : data) {
+        if (d.size() % 2) d.push_back(0);
+        total += d.size();
+    }
+    const bool long_offsets = total > 0x1FFFE;
+    const size_t shared_size = size_t(shared_count) * axis_count * 2;
+    const size_t shared_offset = 20 + (data.size() + 1) * (long_offsets ? 4 : 2);
+
+    std::vector<uint8_t> out;
+    sfnt_append_u16(out, 1);
+    sfnt_append_u16(out, 0);
+    sfnt_append_u16(out, axis_count);
+    sfnt_append_u16(out, shared_count);
+    sfnt_append_u32(out, uint32_t(shared_offset));
+    sfnt_append_u16(out, uint16_t(data.size()));
+    sfnt_append_u16(out, long_offsets ? 1 : 0);
+    sfnt_append_u32(out, uint32_t(shared_offset + shared_size));
+    size_t offset = 0;
+    for (size_t g = 0; g <= data.size(); g++) {
+        if (long_offsets) sfnt_append_u32(out, uint32_t(offset));
+        else sfnt_append_u16(out, uint16_t(offset / 2));
+        if (g < data.size()) offset += data[g].size();
+    }
+    if (shared_size) out.insert(out.end(), shared_tuples, shared_tuples + shared_size);
+    for (const auto& d : data) out.insert(out.end(), d.begin(), d.end());
+    return out;
+}
+
+void update_maxp_counts(std::vector<uint8_t>& maxp, const std::vector<std::vector<uint8_t>>& glyphs) {
+    if (maxp.size() < 14 || sfnt_u32(maxp.data()) != 0x00010000) return;
+    uint32_t max_points = 0, max_contours = 0, max_composite_points = 0, max_composite_contours = 0;
+    for (size_t g = 0; g < glyphs.size(); g++) {
+        GlyphCounts c = count_glyph(glyphs, uint16_t(g), 0);
+        bool composite = glyphs[g].size() >= 10 && sfnt_i16(glyphs[g].data()) < 0;
+        uint32_t& points = composite ? max_composite_points : max_points;
+        uint32_t& contours = composite ? max_composite_contours : max_contours;
+        points = std::max(points, c.points);
+        contours = std::max(contours, c.contours);
+    }
+    sfnt_put_u16(maxp.data() + 6, uint16_t(std::min<uint32_t>(max_points, 0xFFFF)));
+    sfnt_put_u16(maxp.data() + 8, uint16_t(std::min<uint32_t>(max_contours, 0xFFFF)));
+    sfnt_put_u16(maxp.data() + 10, uint16_t(std::min<uint32_t>(max_composite_points, 0xFFFF)));
+    sfnt_put_u16(maxp.data() + 12, uint16_t(std::min<uint32_t>(max_composite_contours, 0xFFFF)));
+}
@@ -0,0 +1,64 @@
+#ifndef FONTSUBSETTING_GLYF_TABLES_H
+#define FONTSUBSETTING_GLYF_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "sfnt_tables.h"
+
+// Writers for TrueType outline tables, shared by the passes that rebuild
+// glyf and gvar after subsetting.
+
+struct GlyphPoint {
+    int32_t x, y;
+    bool on_curve;
+};
+
+// Encodes a simple glyph without instructions, setting |x_min| from its
+// bounding box; false if a coordinate leaves the int16 range
+bool encode_simple_glyph(const std::vector<uint16_t>& end_points,
+                         const std::vector<GlyphPoint>& points,
+                         std::vector<uint8_t>& out, int16_t& x_min);
+
+// Decodes a simple glyph's contours, skipping its instructions; false for
+// composites, empty glyphs and truncated data
+bool decode_simple_glyph(const uint8_t* data, size_t size, std::vector<uint16_t>& end_points,
+                         std::vector<GlyphPoint>& points);
+
+// Packed point numbers and deltas of GlyphVariationData, read from |pos|
+// (advanced past them); false on truncated data. |all| is set for the
+// "all points" encoding.
+bool read_packed_points(const uint8_t* data, size_t size, size_t& pos,
+                        std::vector<uint16_t>& points, bool& all);
+bool read_packed_deltas(const uint8_t* data, size_t size, size_t& pos, size_t count,
+                        std::vector<int32_t>& deltas);
+void append_packed_deltas(std::vector<uint8_t>& out, const std::vector<int32_t>& deltas);
+
+// One gvar tuple of a glyph: deltas for every point, phantoms last
+struct TupleDeltas {
+    uint16_t index;                     // tupleIndex; PRIVATE_POINT_NUMBERS is ignored
+    std::vector<uint8_t> coordinates;   // embedded peak / intermediate F2Dot14s
+    std::vector<int32_t> x, y;
+};
+
+// GlyphVariationData with shared "all points" numbers; tuples whose deltas
+// are all zero are dropped, and no tuples leave |out| empty
+void encode_glyph_variations(const std::vector<TupleDeltas>& tuples, std::vector<uint8_t>& out);
+
+// Reads every glyph's glyf data through loca; false if the tables are
+// missing or an offset leaves glyf
+bool read_glyf_loca(const SfntFont& font, std::vector<std::vector<uint8_t>>& glyphs);
+
+// Replaces glyf and loca with |glyphs| (padded to even lengths in place)
+// and sets head.indexToLocFormat to the smallest loca that fits
+void write_glyf_loca(SfntFont& font, std::vector<std::vector<uint8_t>>& glyphs);
+
+// A gvar table over |data| (one GlyphVariationData per glyph, padded in
+// place); |shared_tuples| holds |shared_count| peaks of |axis_count| F2Dot14s
+std::vector<uint8_t> build_gvar(uint16_t axis_count, const uint8_t* shared_tuples, uint16_t shared_count,
+                                std::vector<std::vector<uint8_t>>& data);
+
+// Sets the maxp 1.0 point and contour maxima, composites included
+void update_maxp_counts(std::vector<uint8_t>& maxp, const std::vector<std::vector<uint8_t>>& glyphs);
+
+#endif // FONTSUBSETTING_GLYF_TABLES_H
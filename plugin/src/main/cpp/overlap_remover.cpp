@@ -0,0 +1,1112 @@
+#include "overlap_remover.h"
+#include "glyf_tables.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t TAG_GLYF = sfnt_tag('g', 'l', 'y', 'f');
+constexpr uint32_t TAG_LOCA = sfnt_tag('l', 'o', 'c', 'a');
+constexpr uint32_t TAG_HEAD = sfnt_tag('h', 'e', 'a', 'd');
+constexpr uint32_t TAG_MAXP = sfnt_tag('m', 'a', 'x', 'p');
+constexpr uint32_t TAG_HHEA = sfnt_tag('h', 'h', 'e', 'a');
+constexpr uint32_t TAG_HMTX = sfnt_tag('h', 'm', 't', 'x');
+constexpr uint32_t TAG_GVAR = sfnt_tag('g', 'v', 'a', 'r');
+
+// Distances in font units
+constexpr double SNAP = 1e-2;           // crossings this close to a vertex land on it
+constexpr double CHAIN_TOLERANCE = 4 * SNAP;
+constexpr double SIDE_OFFSET = 2e-3;    // how far beside a piece its coverage is sampled
+constexpr double FLATNESS = 1e-3;
+
+constexpr size_t MAX_SEGMENTS = 1024;
+constexpr size_t MAX_LEAVES = 4096;     // quad/quad subdivision budget per glyph
+constexpr size_t MAX_PROBES = 64;
+
+constexpr uint16_t PHANTOM_POINTS = 4;
+
+struct Point {
+    double x, y;
+};
+
+Point operator+(Point a, Point b) { return {a.x + b.x, a.y + b.y}; }
+Point operator-(Point a, Point b) { return {a.x - b.x, a.y - b.y}; }
+Point operator*(Point a, double s) { return {a.x * s, a.y * s}; }
+double dot(Point a, Point b) { return a.x * b.x + a.y * b.y; }
+double cross(Point a, Point b) { return a.x * b.y - a.y * b.x; }
+double length(Point a) { return std::sqrt(dot(a, a)); }
+double distance(Point a, Point b) { return length(a - b); }
+Point midpoint(Point a, Point b) { return {(a.x + b.x) * 0.5, (a.y + b.y) * 0.5}; }
+
+// ---------------------------------------------------------------------------
+// glyf
+
+struct SimpleGlyph {
+    std::vector<uint16_t> end_points;
+    std::vector<Point> points;
+    std::vector<uint8_t> on_curve;
+    int16_t x_min = 0;
+};
+
+bool parse_simple_glyph(const uint8_t* data, size_t size, SimpleGlyph& glyph) {
+    if (size < 10) return false;
+    int16_t contours = sfnt_i16(data);
+    if (contours <= 0) return false;
+    glyph.x_min = sfnt_i16(data + 2);
+
+    size_t pos = 10;
+    if (pos + size_t(contours) * 2 + 2 > size) return false;
+    glyph.end_points.resize(size_t(contours));
+    size_t point_count = 0;
+    for (int16_t i = 0; i < contours; i++) {
+        uint16_t end = sfnt_u16(data + pos);
+        pos += 2;
+        if (size_t(end) + 1 < point_count) return false;
+        glyph.end_points[size_t(i)] = end;
+        point_count = size_t(end) + 1;
+    }
+    pos += 2 + sfnt_u16(data + pos);
+    if (pos > size) return false;
+
+    std::vector<uint8_t> flags(point_count);
+    for (size_t i = 0; i < point_count;) {
+        if (pos >= size) return false;
+        uint8_t flag = data[pos++];
+        flags[i++] = flag;
+        if (flag & 0x08) {
+            if (pos >= size) return false;
+            for (uint8_t repeat = data[pos++]; repeat && i < point_count; repeat--) flags[i++] = flag;
+        }
+    }
+
+    glyph.points.resize(point_count);
+    glyph.on_curve.resize(point_count);
+    for (int axis = 0; axis < 2; axis++) {
+        const uint8_t short_bit = axis ? 0x04 : 0x02;
+        const uint8_t same_bit = axis ? 0x20 : 0x10;
+        int32_t value = 0;
+        for (size_t i = 0; i < point_count; i++) {
+            uint8_t flag = flags[i];
+            if (flag & short_bit) {
+                if (pos >= size) return false;
+                value += (flag & same_bit) ? data[pos] : -int32_t(data[pos]);
+                pos++;
+            } else if (!(flag & same_bit)) {
+                if (pos + 2 > size) return false;
+                value += sfnt_i16(data + pos);
+                pos += 2;
+            }
+            if (axis) glyph.points[i].y = value; else glyph.points[i].x = value;
+            glyph.on_curve[i] = flag & 0x01;
+        }
+    }
+    return true;
+}
+
+// Glyph ids that composites attach by point number (ARGS_ARE_XY_VALUES
+// clear); renumbering their points would move the composite's parts
+void collect_point_anchored(const uint8_t* data, size_t size, std::vector<bool>& anchored) {
+    if (size < 10 || sfnt_i16(data) >= 0) return;
+    size_t pos = 10;
+    for (;;) {
+        if (pos + 4 > size) return;
+        uint16_t flags = sfnt_u16(data + pos);
+        uint16_t component = sfnt_u16(data + pos + 2);
+        pos += 4 + ((flags & 0x0001) ? 4 : 2);
+        if (flags & 0x0008) pos += 2;
+        else if (flags & 0x0040) pos += 4;
+        else if (flags & 0x0080) pos += 8;
+        if (!(flags & 0x0002) && component < anchored.size()) anchored[component] = true;
+        if (!(flags & 0x0020)) return;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// gvar
+
+struct Tuple {
+    uint16_t index = 0;                 // tupleIndex as stored
+    std::vector<uint8_t> coordinates;   // embedded peak / intermediate F2Dot14s
+    std::vector<double> peak, start, end;
+    bool intermediate = false;
+    std::vector<Point> deltas;          // every point, phantoms last, after IUP
+};
+
+struct Gvar {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    uint16_t axis_count = 0;
+    std::vector<std::vector<double>> shared_tuples;
+    std::vector<uint32_t> offsets;      // absolute, glyph_count + 1
+};
+
+double f2dot14(const uint8_t* p) { return sfnt_i16(p) / 16384.0; }
+
+bool parse_gvar(const std::vector<uint8_t>& table, Gvar& gvar) {
+    const uint8_t* data = table.data();
+    size_t size = table.size();
+    if (size < 20) return false;
+    gvar.data = data;
+    gvar.size = size;
+    gvar.axis_count = sfnt_u16(data + 4);
+    uint16_t shared_count = sfnt_u16(data + 6);
+    uint32_t shared_offset = sfnt_u32(data + 8);
+    uint16_t glyph_count = sfnt_u16(data + 12);
+    bool long_offsets = sfnt_u16(data + 14) & 1;
+    uint32_t array_offset = sfnt_u32(data + 16);
+
+    size_t shared_size = size_t(shared_count) * gvar.axis_count * 2;
+    if (shared_offset > size || shared_size > size - shared_offset) return false;
+    gvar.shared_tuples.assign(shared_count, std::vector<double>(gvar.axis_count));
+    for (size_t i = 0; i < shared_count; i++) {
+        for (size_t a = 0; a < gvar.axis_count; a++) {
+            gvar.shared_tuples[i][a] = f2dot14(data + shared_offset + (i * gvar.axis_count + a) * 2);
+        }
+    }
+
+    size_t entry = long_offsets ? 4 : 2;
+    if (20 + (size_t(glyph_count) + 1) * entry > size) return false;
+    gvar.offsets.resize(size_t(glyph_count) + 1);
+    for (size_t i = 0; i <= glyph_count; i++) {
+        const uint8_t* p = data + 20 + i * entry;
+        uint64_t offset = uint64_t(array_offset) + (long_offsets ? sfnt_u32(p) : uint32_t(sfnt_u16(p)) * 2);
+        if (offset > size || (i && offset < gvar.offsets[i - 1])) return false;
+        gvar.offsets[i] = uint32_t(offset);
+    }
+    return true;
+}
+
+// Infers deltas of untouched contour points, per axis, from the touched
+// points around them (gvar's IUP)
+void interpolate_untouched(const SimpleGlyph& glyph, std::vector<Point>& deltas,
+                           const std::vector<bool>& touched) {
+    size_t first = 0;
+    for (uint16_t end : glyph.end_points) {
+        size_t last = end;
+        std::vector<size_t> refs;
+        for (size_t i = first; i <= last; i++) {
+            if (touched[i]) refs.push_back(i);
+        }
+        if (refs.size() == 1) {
+            for (size_t i = first; i <= last; i++) deltas[i] = deltas[refs[0]];
+        } else if (refs.size() > 1) {
+            for (size_t r = 0; r < refs.size(); r++) {
+                size_t a = refs[r], b = refs[(r + 1) % refs.size()];
+                for (size_t i = a + 1;; i++) {
+                    if (i > last) i = first;
+                    if (i == b) break;
+                    for (int axis = 0; axis < 2; axis++) {
+                        auto coord = [axis](Point p) { return axis ? p.y : p.x; };
+                        double x1 = coord(glyph.points[a]), x2 = coord(glyph.points[b]);
+                        double d1 = coord(deltas[a]), d2 = coord(deltas[b]);
+                        if (x1 > x2) {
+                            std::swap(x1, x2);
+                            std::swap(d1, d2);
+                        }
+                        double x = coord(glyph.points[i]), d;
+                        if (x1 == x2) d = d1 == d2 ? d1 : 0;
+                        else if (x <= x1) d = d1;
+                        else if (x >= x2) d = d2;
+                        else d = d1 + (x - x1) * (d2 - d1) / (x2 - x1);
+                        (axis ? deltas[i].y : deltas[i].x) = d;
+                    }
+                }
+            }
+        }
+        first = last + 1;
+    }
+}
+
+bool parse_glyph_variations(const Gvar& gvar, uint32_t glyph_id, const SimpleGlyph& glyph,
+                            std::vector<Tuple>& tuples) {
+    tuples.clear();
+    if (glyph_id + 1 >= gvar.offsets.size()) return true;
+    const uint8_t* data = gvar.data + gvar.offsets[glyph_id];
+    size_t size = gvar.offsets[glyph_id + 1] - gvar.offsets[glyph_id];
+    if (size == 0) return true;
+    if (size < 4) return false;
+
+    const size_t point_count = glyph.points.size() + PHANTOM_POINTS;
+    uint16_t count = sfnt_u16(data) & 0x0FFF;
+    bool has_shared_points = sfnt_u16(data) & 0x8000;
+    size_t pos = 4;
+    size_t data_pos = sfnt_u16(data + 2);
+
+    std::vector<uint16_t> shared_points, points;
+    bool shared_all = false, all = false;
+    if (has_shared_points && !read_packed_points(data, size, data_pos, shared_points, shared_all)) return false;
+
+    std::vector<int32_t> xs, ys;
+    for (uint16_t t = 0; t < count; t++) {
+        if (pos + 4 > size) return false;
+        Tuple tuple;
+        uint16_t data_size = sfnt_u16(data + pos);
+        tuple.index = sfnt_u16(data + pos + 2);
+        pos += 4;
+
+        size_t coords_start = pos;
+        if (tuple.index & 0x8000) {
+            if (pos + size_t(gvar.axis_count) * 2 > size) return false;
+            for (size_t a = 0; a < gvar.axis_count; a++) tuple.peak.push_back(f2dot14(data + pos + a * 2));
+            pos += size_t(gvar.axis_count) * 2;
+        } else {
+            size_t shared = tuple.index & 0x0FFF;
+            if (shared >= gvar.shared_tuples.size()) return false;
+            tuple.peak = gvar.shared_tuples[shared];
+        }
+        if (tuple.index & 0x4000) {
+            if (pos + size_t(gvar.axis_count) * 4 > size) return false;
+            tuple.intermediate = true;
+            for (size_t a = 0; a < gvar.axis_count; a++) tuple.start.push_back(f2dot14(data + pos + a * 2));
+            pos += size_t(gvar.axis_count) * 2;
+            for (size_t a = 0; a < gvar.axis_count; a++) tuple.end.push_back(f2dot14(data + pos + a * 2));
+            pos += size_t(gvar.axis_count) * 2;
+        }
+        tuple.coordinates.assign(data + coords_start, data + pos);
+
+        if (data_pos + data_size > size) return false;
+        size_t tuple_pos = data_pos;
+        size_t tuple_end = data_pos + data_size;
+        if (tuple.index & 0x2000) {
+            if (!read_packed_points(data, tuple_end, tuple_pos, points, all)) return false;
+        } else {
+            points = shared_points;
+            all = shared_all;
+        }
+        size_t n = all ? point_count : points.size();
+        if (!read_packed_deltas(data, tuple_end, tuple_pos, n, xs) ||
+            !read_packed_deltas(data, tuple_end, tuple_pos, n, ys)) {
+            return false;
+        }
+        data_pos = tuple_end;
+
+        tuple.deltas.assign(point_count, Point{0, 0});
+        if (all) {
+            for (size_t i = 0; i < point_count; i++) tuple.deltas[i] = {double(xs[i]), double(ys[i])};
+        } else {
+            std::vector<bool> touched(point_count, false);
+            for (size_t i = 0; i < points.size(); i++) {
+                if (points[i] >= point_count) continue;
+                tuple.deltas[points[i]] = {double(xs[i]), double(ys[i])};
+                touched[points[i]] = true;
+            }
+            interpolate_untouched(glyph, tuple.deltas, touched);
+        }
+        tuples.push_back(std::move(tuple));
+    }
+    return true;
+}
+
+double tuple_scalar(const Tuple& tuple, const std::vector<double>& location) {
+    double scalar = 1.0;
+    for (size_t a = 0; a < tuple.peak.size(); a++) {
+        double peak = tuple.peak[a];
+        if (peak == 0) continue;
+        double lower = std::min(0.0, peak), upper = std::max(0.0, peak);
+        if (tuple.intermediate) {
+            lower = tuple.start[a];
+            upper = tuple.end[a];
+            if (lower > peak || peak > upper || (lower < 0 && upper > 0)) continue;
+        }
+        double v = location[a];
+        if (v == peak) continue;
+        if (v <= lower || v >= upper) return 0;
+        scalar *= v < peak ? (v - lower) / (peak - lower) : (upper - v) / (upper - peak);
+    }
+    return scalar;
+}
+
+// ---------------------------------------------------------------------------
+// Outline union
+
+struct Segment {
+    Point p0, c, p1;
+    bool quad;
+    bool implied_start;  // p0 is the on-curve point implied between two off-curves
+    int prev, next;      // neighbours within the contour
+};
+
+void build_segments(const SimpleGlyph& glyph, const Point* points, std::vector<Segment>& segments) {
+    segments.clear();
+    size_t first = 0;
+    for (uint16_t end : glyph.end_points) {
+        const size_t n = size_t(end) + 1 - first;
+        const size_t base = segments.size();
+        auto point = [&](size_t k) { return points[first + k % n]; };
+        auto on = [&](size_t k) { return glyph.on_curve[first + k % n] != 0; };
+        auto push = [&](Point p0, const Point* c, Point p1, bool implied) {
+            segments.push_back({p0, c ? *c : p0, p1, c != nullptr, implied, 0, 0});
+        };
+
+        size_t start = n;
+        for (size_t k = 0; k < n; k++) {
+            if (on(k)) {
+                start = k;
+                break;
+            }
+        }
+        if (n < 2) {
+            // a lone point encloses nothing
+        } else if (start < n) {
+            Point current = point(start);
+            bool implied = false;
+            bool pending = false;
+            Point control{0, 0};
+            for (size_t k = 1; k <= n; k++) {
+                Point p = point(start + k);
+                if (on(start + k)) {
+                    push(current, pending ? &control : nullptr, p, implied);
+                    current = p;
+                    implied = pending = false;
+                } else if (pending) {
+                    Point m = midpoint(control, p);
+                    push(current, &control, m, implied);
+                    current = m;
+                    implied = true;
+                    control = p;
+                } else {
+                    control = p;
+                    pending = true;
+                }
+            }
+        } else {
+            Point origin = midpoint(point(n - 1), point(0));
+            Point current = origin;
+            for (size_t k = 1; k < n; k++) {
+                Point control = point(k - 1);
+                Point m = midpoint(control, point(k));
+                push(current, &control, m, true);
+                current = m;
+            }
+            Point control = point(n - 1);
+            push(current, &control, origin, true);
+        }
+
+        const size_t count = segments.size() - base;
+        for (size_t i = 0; i < count; i++) {
+            segments[base + i].prev = int(base + (i + count - 1) % count);
+            segments[base + i].next = int(base + (i + 1) % count);
+        }
+        first = size_t(end) + 1;
+    }
+}
+
+Point evaluate(const Segment& s, double t) {
+    if (!s.quad) return s.p0 + (s.p1 - s.p0) * t;
+    double u = 1 - t;
+    return s.p0 * (u * u) + s.c * (2 * u * t) + s.p1 * (t * t);
+}
+
+bool degenerate(const Segment& s) {
+    return distance(s.p0, s.p1) < 1e-9 && (!s.quad || distance(s.p0, s.c) < 1e-9);
+}
+
+// Signed crossings of the ray from |q| towards +x
+int winding_number(const std::vector<Segment>& segments, Point q) {
+    int winding = 0;
+    auto cross_monotonic = [&](const Segment& s, double ta, double tb) {
+        double ya = evaluate(s, ta).y, yb = evaluate(s, tb).y;
+        if (ya == yb) return;
+        bool up = ya < yb;
+        if (up ? (q.y < ya || q.y >= yb) : (q.y < yb || q.y >= ya)) return;
+        double lo = ta, hi = tb;
+        for (int i = 0; i < 52; i++) {
+            double t = (lo + hi) * 0.5;
+            if ((evaluate(s, t).y < q.y) == up) lo = t; else hi = t;
+        }
+        if (evaluate(s, (lo + hi) * 0.5).x > q.x) winding += up ? 1 : -1;
+    };
+    for (const Segment& s : segments) {
+        if (!s.quad) {
+            cross_monotonic(s, 0, 1);
+            continue;
+        }
+        double denominator = s.p0.y - 2 * s.c.y + s.p1.y;
+        double t = denominator != 0 ? (s.p0.y - s.c.y) / denominator : -1;
+        if (t > 0 && t < 1) {
+            cross_monotonic(s, 0, t);
+            cross_monotonic(s, t, 1);
+        } else {
+            cross_monotonic(s, 0, 1);
+        }
+    }
+    return winding;
+}
+
+struct Cut {
+    double t;
+    Point p;
+    int partner;
+};
+
+class Intersector {
+public:
+    explicit Intersector(const std::vector<Segment>& segments)
+        : segments_(segments), cuts_(segments.size()) {}
+
+    bool run() {
+        for (size_t i = 0; i < segments_.size(); i++) {
+            if (degenerate(segments_[i])) continue;
+            for (size_t j = i + 1; j < segments_.size() && !failed_; j++) {
+                if (degenerate(segments_[j]) || !boxes_overlap(segments_[i], segments_[j])) continue;
+                candidates_.clear();
+                const Segment& a = segments_[i];
+                const Segment& b = segments_[j];
+                if (!a.quad && !b.quad) line_line(int(i), int(j));
+                else if (!a.quad) line_quad(int(i), int(j), false);
+                else if (!b.quad) line_quad(int(j), int(i), true);
+                else quad_quad(a, 0, 1, b, 0, 1, 0);
+                for (const Candidate& c : candidates_) record(int(i), c.ta, int(j), c.tb, c.p);
+            }
+        }
+        return !failed_;
+    }
+
+    std::vector<std::vector<Cut>>& cuts() { return cuts_; }
+
+private:
+    struct Candidate {
+        double ta, tb;
+        Point p;
+    };
+
+    static void bounds(const Segment& s, double box[4]) {
+        box[0] = std::min(s.p0.x, s.p1.x);
+        box[1] = std::min(s.p0.y, s.p1.y);
+        box[2] = std::max(s.p0.x, s.p1.x);
+        box[3] = std::max(s.p0.y, s.p1.y);
+        if (s.quad) {
+            box[0] = std::min(box[0], s.c.x);
+            box[1] = std::min(box[1], s.c.y);
+            box[2] = std::max(box[2], s.c.x);
+            box[3] = std::max(box[3], s.c.y);
+        }
+    }
+
+    static bool boxes_overlap(const Segment& a, const Segment& b) {
+        double ba[4], bb[4];
+        bounds(a, ba);
+        bounds(b, bb);
+        return ba[0] <= bb[2] + SNAP && bb[0] <= ba[2] + SNAP &&
+               ba[1] <= bb[3] + SNAP && bb[1] <= ba[3] + SNAP;
+    }
+
+    void add_candidate(double ta, double tb, Point p) {
+        for (const Candidate& c : candidates_) {
+            if (distance(c.p, p) < SNAP) return;
+        }
+        candidates_.push_back({ta, tb, p});
+    }
+
+    // Cuts both segments at a crossing, unless it falls on a vertex of one
+    void record(int i, double ti, int j, double tj, Point p) {
+        int end_i = vertex_at(segments_[i], ti, p);
+        int end_j = vertex_at(segments_[j], tj, p);
+        if (end_i >= 0 && end_j >= 0) return;
+        if (end_i >= 0) p = end_i ? segments_[i].p1 : segments_[i].p0;
+        if (end_j >= 0) p = end_j ? segments_[j].p1 : segments_[j].p0;
+        if (end_i < 0) cuts_[size_t(i)].push_back({ti, p, j});
+        if (end_j < 0) cuts_[size_t(j)].push_back({tj, p, i});
+    }
+
+    static int vertex_at(const Segment& s, double t, Point p) {
+        double d0 = distance(p, s.p0), d1 = distance(p, s.p1);
+        if (t <= 0 || t >= 1 || d0 <= SNAP || d1 <= SNAP) return d0 <= d1 ? 0 : 1;
+        return -1;
+    }
+
+    // Parameters where two chords cross, allowing SNAP past their ends
+    static bool chord_crossing(Point a0, Point a1, Point b0, Point b1, double& t, double& s) {
+        Point da = a1 - a0, db = b1 - b0;
+        double la = length(da), lb = length(db);
+        double denominator = cross(da, db);
+        if (la == 0 || lb == 0 || std::fabs(denominator) <= 1e-12 * la * lb) return false;
+        Point w = b0 - a0;
+        t = cross(w, db) / denominator;
+        s = cross(w, da) / denominator;
+        double ma = SNAP / la, mb = SNAP / lb;
+        return t >= -ma && t <= 1 + ma && s >= -mb && s <= 1 + mb;
+    }
+
+    // Parameter of |p| projected onto the line a, or -1 when off the line
+    static double project(Point p, Point a0, Point a1) {
+        Point d = a1 - a0;
+        double l2 = dot(d, d);
+        if (l2 == 0) return -1;
+        if (std::fabs(cross(d, p - a0)) / std::sqrt(l2) > SNAP) return -1;
+        return dot(p - a0, d) / l2;
+    }
+
+    void line_line(int i, int j) {
+        const Segment& a = segments_[size_t(i)];
+        const Segment& b = segments_[size_t(j)];
+        double t, s;
+        if (chord_crossing(a.p0, a.p1, b.p0, b.p1, t, s)) {
+            add_candidate(t, s, a.p0 + (a.p1 - a.p0) * std::clamp(t, 0.0, 1.0));
+            return;
+        }
+        // Parallel: collinear overlaps cut each line where the other ends
+        for (int end = 0; end < 2; end++) {
+            Point pb = end ? b.p1 : b.p0;
+            double tb = project(pb, a.p0, a.p1);
+            if (tb > 0 && tb < 1) add_candidate(tb, end, pb);
+            Point pa = end ? a.p1 : a.p0;
+            double ta = project(pa, b.p0, b.p1);
+            if (ta > 0 && ta < 1) add_candidate(end, ta, pa);
+        }
+    }
+
+    // |line| against |quad|; |swapped| when the quad is the pair's first segment
+    void line_quad(int line, int quad, bool swapped) {
+        const Segment& l = segments_[size_t(line)];
+        const Segment& q = segments_[size_t(quad)];
+        Point d = l.p1 - l.p0;
+        double len = length(d);
+        if (len == 0) return;
+        Point normal = {-d.y / len, d.x / len};
+        double d0 = dot(q.p0 - l.p0, normal);
+        double dc = dot(q.c - l.p0, normal);
+        double d1 = dot(q.p1 - l.p0, normal);
+        auto add = [&](double tl, double tq, Point p) {
+            if (swapped) add_candidate(tq, tl, p); else add_candidate(tl, tq, p);
+        };
+        double roots[2];
+
+        if (std::fabs(d0) <= SNAP && std::fabs(dc) <= SNAP && std::fabs(d1) <= SNAP) {
+            // A flat quad along the line: cut each where the other ends
+            double s0 = dot(q.p0 - l.p0, d) / (len * len);
+            double sc = dot(q.c - l.p0, d) / (len * len);
+            double s1 = dot(q.p1 - l.p0, d) / (len * len);
+            if (s0 > 0 && s0 < 1) add(s0, 0, q.p0);
+            if (s1 > 0 && s1 < 1) add(s1, 1, q.p1);
+            for (int end = 0; end < 2; end++) {
+                int count = solve_quadratic(s0 - 2 * sc + s1, 2 * (sc - s0), s0 - end, roots);
+                for (int r = 0; r < count; r++) {
+                    if (roots[r] > 0 && roots[r] < 1) add(end, roots[r], end ? l.p1 : l.p0);
+                }
+            }
+            return;
+        }
+
+        int count = solve_quadratic(d0 - 2 * dc + d1, 2 * (dc - d0), d0, roots);
+        double margin = SNAP / std::max(len, 1.0);
+        for (int r = 0; r < count; r++) {
+            double tq = roots[r];
+            if (tq < -margin || tq > 1 + margin) continue;
+            Point p = evaluate(q, std::clamp(tq, 0.0, 1.0));
+            double tl = dot(p - l.p0, d) / (len * len);
+            if (tl < -SNAP / len || tl > 1 + SNAP / len) continue;
+            add(tl, tq, p);
+        }
+    }
+
+    static int solve_quadratic(double a, double b, double c, double roots[2]) {
+        if (std::fabs(a) < 1e-12) {
+            if (b == 0) return 0;
+            roots[0] = -c / b;
+            return 1;
+        }
+        double disc = b * b - 4 * a * c;
+        if (disc < 0 && disc > -1e-9 * b * b) disc = 0;
+        if (disc < 0) return 0;
+        double r = std::sqrt(disc);
+        double k = -0.5 * (b + (b < 0 ? -r : r));
+        if (k == 0) {
+            roots[0] = -b / (2 * a);
+            return 1;
+        }
+        roots[0] = k / a;
+        roots[1] = c / k;
+        return 2;
+    }
+
+    static Segment sub_quad(const Segment& s, double ta, double tb) {
+        auto blossom = [&](double u, double v) {
+            return s.p0 * ((1 - u) * (1 - v)) + s.c * ((1 - u) * v + u * (1 - v)) + s.p1 * (u * v);
+        };
+        Segment r = s;
+        r.p0 = blossom(ta, ta);
+        r.c = blossom(ta, tb);
+        r.p1 = blossom(tb, tb);
+        return r;
+    }
+
+    static bool flat(const Segment& s) {
+        Point d = s.p1 - s.p0;
+        double len = length(d);
+        if (len < FLATNESS) return distance(s.c, s.p0) < FLATNESS;
+        return std::fabs(cross(d, s.c - s.p0)) / len < FLATNESS;
+    }
+
+    void quad_quad(const Segment& a, double a0, double a1,
+                   const Segment& b, double b0, double b1, int depth) {
+        Segment sa = sub_quad(a, a0, a1), sb = sub_quad(b, b0, b1);
+        if (!boxes_overlap(sa, sb) || failed_) return;
+        if ((flat(sa) && flat(sb)) || depth > 48) {
+            if (++leaves_ > MAX_LEAVES) {
+                failed_ = true;
+                return;
+            }
+            double t, s;
+            if (chord_crossing(sa.p0, sa.p1, sb.p0, sb.p1, t, s)) {
+                t = std::clamp(t, 0.0, 1.0);
+                s = std::clamp(s, 0.0, 1.0);
+                double ta = a0 + (a1 - a0) * t;
+                add_candidate(ta, b0 + (b1 - b0) * s, evaluate(a, ta));
+            }
+            return;
+        }
+        double size_a = distance(sa.p0, sa.c) + distance(sa.c, sa.p1);
+        double size_b = distance(sb.p0, sb.c) + distance(sb.c, sb.p1);
+        if (size_a >= size_b) {
+            double m = (a0 + a1) * 0.5;
+            quad_quad(a, a0, m, b, b0, b1, depth + 1);
+            quad_quad(a, m, a1, b, b0, b1, depth + 1);
+        } else {
+            double m = (b0 + b1) * 0.5;
+            quad_quad(a, a0, a1, b, b0, m, depth + 1);
+            quad_quad(a, a0, a1, b, m, b1, depth + 1);
+        }
+    }
+
+    const std::vector<Segment>& segments_;
+    std::vector<std::vector<Cut>> cuts_;
+    std::vector<Candidate> candidates_;
+    size_t leaves_ = 0;
+    bool failed_ = false;
+};
+
+// A kept part of a segment, oriented with the filled side on its right
+struct Piece {
+    int segment;
+    int ordinal;
+    bool last;       // ends where the segment ends
+    bool reversed;
+    bool quad;
+    Point p0, c, p1;
+};
+
+struct UnionOutline {
+    std::vector<std::vector<Piece>> contours;
+    std::vector<int> signature;  // the topology, compared across locations
+    bool changed = false;
+};
+
+bool straight(const Piece& p) {
+    if (!p.quad) return true;
+    Point d = p.p1 - p.p0;
+    double len = length(d);
+    return len > 0 && std::fabs(cross(d, p.c - p.p0)) / len < CHAIN_TOLERANCE &&
+           dot(p.c - p.p0, d) >= 0 && dot(p.p1 - p.c, d) >= 0;
+}
+
+bool same_edge(const Piece& a, const Piece& b) {
+    if (distance(a.p0, b.p0) >= CHAIN_TOLERANCE || distance(a.p1, b.p1) >= CHAIN_TOLERANCE) return false;
+    if (a.quad && b.quad && distance(a.c, b.c) < CHAIN_TOLERANCE) return true;
+    return straight(a) && straight(b);
+}
+
+bool union_outline(const std::vector<Segment>& segments, UnionOutline& result) {
+    result.contours.clear();
+    result.signature.clear();
+    result.changed = false;
+
+    Intersector intersector(segments);
+    if (!intersector.run()) return false;
+
+    std::vector<Piece> kept;
+    for (size_t i = 0; i < segments.size(); i++) {
+        const Segment& s = segments[i];
+        std::vector<Cut>& cuts = intersector.cuts()[i];
+        std::sort(cuts.begin(), cuts.end(), [](const Cut& a, const Cut& b) { return a.t < b.t; });
+        std::vector<Cut> merged;
+        for (const Cut& cut : cuts) {
+            if (merged.empty() || distance(merged.back().p, cut.p) >= SNAP) merged.push_back(cut);
+        }
+
+        bool is_degenerate = degenerate(s);
+        result.signature.push_back(is_degenerate ? -1 : int(merged.size()));
+        for (const Cut& cut : merged) result.signature.push_back(cut.partner);
+        if (is_degenerate) continue;
+        if (!merged.empty()) result.changed = true;
+
+        for (size_t k = 0; k <= merged.size(); k++) {
+            double ta = k ? merged[k - 1].t : 0.0;
+            double tb = k < merged.size() ? merged[k].t : 1.0;
+            Piece piece;
+            piece.segment = int(i);
+            piece.ordinal = int(k);
+            piece.last = k == merged.size();
+            piece.reversed = false;
+            piece.quad = s.quad;
+            piece.p0 = k ? merged[k - 1].p : s.p0;
+            piece.p1 = k < merged.size() ? merged[k].p : s.p1;
+            piece.c = s.p0 * ((1 - ta) * (1 - tb)) + s.c * ((1 - ta) * tb + ta * (1 - tb)) + s.p1 * (ta * tb);
+
+            Point tangent = piece.p1 - piece.p0;
+            double len = length(tangent);
+            if (len < 1e-9) return false;
+            Point mid = piece.quad ? piece.p0 * 0.25 + piece.c * 0.5 + piece.p1 * 0.25
+                                   : midpoint(piece.p0, piece.p1);
+            Point left = {-tangent.y / len * SIDE_OFFSET, tangent.x / len * SIDE_OFFSET};
+            bool filled_left = winding_number(segments, mid + left) != 0;
+            bool filled_right = winding_number(segments, mid - left) != 0;
+            if (filled_left == filled_right) {
+                result.changed = true;
+                continue;
+            }
+            if (filled_left) {
+                piece.reversed = true;
+                std::swap(piece.p0, piece.p1);
+            }
+            kept.push_back(piece);
+        }
+    }
+
+    // Coincident edges running the same way survive twice; keep one
+    std::vector<bool> used(kept.size(), false);
+    for (size_t i = 0; i < kept.size(); i++) {
+        for (size_t j = i + 1; j < kept.size() && !used[i]; j++) {
+            if (!used[j] && same_edge(kept[i], kept[j])) {
+                used[j] = true;
+                result.changed = true;
+            }
+        }
+    }
+    if (!result.changed) return true;
+
+    // Chain pieces end to start; a vertex with several ways on is ambiguous
+    for (size_t first = 0; first < kept.size(); first++) {
+        if (used[first]) continue;
+        std::vector<Piece> contour;
+        used[first] = true;
+        contour.push_back(kept[first]);
+        for (;;) {
+            Point end = contour.back().p1;
+            size_t next = kept.size();
+            int options = 0;
+            for (size_t k = 0; k < kept.size(); k++) {
+                if ((!used[k] || k == first) && distance(kept[k].p0, end) < CHAIN_TOLERANCE) {
+                    options++;
+                    next = k;
+                }
+            }
+            if (options != 1) return false;
+            if (next == first) break;
+            used[next] = true;
+            contour.push_back(kept[next]);
+        }
+
+        auto key = [](const Piece& p) { return std::make_pair(p.segment, p.ordinal); };
+        auto lowest = std::min_element(contour.begin(), contour.end(),
+            [&](const Piece& a, const Piece& b) { return key(a) < key(b); });
+        std::rotate(contour.begin(), lowest, contour.end());
+        result.contours.push_back(std::move(contour));
+    }
+    std::sort(result.contours.begin(), result.contours.end(),
+        [](const std::vector<Piece>& a, const std::vector<Piece>& b) {
+            return std::make_pair(a[0].segment, a[0].ordinal) < std::make_pair(b[0].segment, b[0].ordinal);
+        });
+
+    for (const auto& contour : result.contours) {
+        result.signature.push_back(int(contour.size()));
+        for (const Piece& p : contour) {
+            result.signature.push_back(p.segment);
+            result.signature.push_back(p.ordinal * 2 + (p.reversed ? 1 : 0));
+        }
+    }
+    return true;
+}
+
+// Whether |piece| starts on the on-curve point implied between its control
+// and |prev|'s, as in the source outline
+bool starts_implied(const std::vector<Segment>& segments, const Piece& prev, const Piece& piece) {
+    if (!piece.quad || !prev.quad) return false;
+    const Segment& s = segments[size_t(piece.segment)];
+    if (!piece.reversed) {
+        return piece.ordinal == 0 && s.implied_start && !prev.reversed &&
+               prev.segment == s.prev && prev.last;
+    }
+    return piece.last && segments[size_t(s.next)].implied_start && prev.reversed &&
+           prev.segment == s.next && prev.ordinal == 0;
+}
+
+void outline_points(const std::vector<Segment>& segments, const UnionOutline& outline,
+                    std::vector<uint16_t>* end_points, std::vector<bool>* on_curve,
+                    std::vector<Point>& points) {
+    points.clear();
+    for (const auto& contour : outline.contours) {
+        for (size_t i = 0; i < contour.size(); i++) {
+            const Piece& piece = contour[i];
+            const Piece& prev = contour[(i + contour.size() - 1) % contour.size()];
+            if (!starts_implied(segments, prev, piece)) {
+                points.push_back(piece.p0);
+                if (on_curve) on_curve->push_back(true);
+            }
+            if (piece.quad) {
+                points.push_back(piece.c);
+                if (on_curve) on_curve->push_back(false);
+            }
+        }
+        if (end_points) end_points->push_back(uint16_t(points.size() - 1));
+    }
+}
+
+// Solves |matrix| X = |rhs| in place (rows x rows, rhs rows x columns)
+bool solve(std::vector<std::vector<double>> matrix, std::vector<std::vector<double>>& rhs) {
+    const size_t n = matrix.size();
+    for (size_t col = 0; col < n; col++) {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < n; r++) {
+            if (std::fabs(matrix[r][col]) > std::fabs(matrix[pivot][col])) pivot = r;
+        }
+        if (std::fabs(matrix[pivot][col]) < 1e-9) return false;
+        std::swap(matrix[col], matrix[pivot]);
+        std::swap(rhs[col], rhs[pivot]);
+        for (size_t r = 0; r < n; r++) {
+            if (r == col || matrix[r][col] == 0) continue;
+            double f = matrix[r][col] / matrix[col][col];
+            for (size_t k = col; k < n; k++) matrix[r][k] -= f * matrix[col][k];
+            for (size_t k = 0; k < rhs[r].size(); k++) rhs[r][k] -= f * rhs[col][k];
+        }
+    }
+    for (size_t r = 0; r < n; r++) {
+        for (double& v : rhs[r]) v /= matrix[r][r];
+    }
+    return true;
+}
+
+struct MergedGlyph {
+    std::vector<uint8_t> glyf;
+    std::vector<uint8_t> gvar;
+    int16_t x_min = 0;
+    size_t contours = 0;
+};
+
+class GlyphMerger {
+public:
+    GlyphMerger(const Gvar* gvar, double units_per_em) : gvar_(gvar), tolerance_(units_per_em / 256.0) {}
+
+    // 1 merged, 0 nothing to merge, -1 left as is
+    int merge(uint32_t glyph_id, const SimpleGlyph& glyph, MergedGlyph& out) {
+        build_segments(glyph, glyph.points.data(), segments_);
+        if (segments_.size() > MAX_SEGMENTS) return -1;
+        UnionOutline base;
+        if (!union_outline(segments_, base)) return -1;
+        if (!base.changed) return 0;
+
+        std::vector<Tuple> tuples;
+        if (gvar_ && !parse_glyph_variations(*gvar_, glyph_id, glyph, tuples)) return -1;
+        const size_t axis_count = gvar_ ? gvar_->axis_count : 0;
+
+        std::vector<uint16_t> end_points;
+        std::vector<bool> on_curve;
+        std::vector<Point> points;
+        outline_points(segments_, base, &end_points, &on_curve, points);
+        const size_t count = points.size();
+        if (count > 0xFFFF - PHANTOM_POINTS) return -1;
+
+        std::vector<GlyphPoint> rounded(count);
+        for (size_t i = 0; i < count; i++) {
+            rounded[i] = {int32_t(std::lround(points[i].x)), int32_t(std::lround(points[i].y)), bool(on_curve[i])};
+        }
+        if (!encode_simple_glyph(end_points, rounded, out.glyf, out.x_min)) return -1;
+        out.contours = end_points.size();
+        out.gvar.clear();
+        if (tuples.empty()) return 1;
+
+        // Deltas reproducing the union at every tuple's peak
+        const size_t n = tuples.size();
+        const size_t columns = (count + PHANTOM_POINTS) * 2;
+        std::vector<std::vector<double>> scalars(n, std::vector<double>(n));
+        std::vector<std::vector<double>> deltas(n, std::vector<double>(columns));
+        for (size_t t = 0; t < n; t++) {
+            for (size_t u = 0; u < n; u++) scalars[t][u] = tuple_scalar(tuples[u], tuples[t].peak);
+            if (!outline_at(glyph, tuples, tuples[t].peak, base, points)) return -1;
+            for (size_t i = 0; i < count; i++) {
+                deltas[t][i * 2] = points[i].x - rounded[i].x;
+                deltas[t][i * 2 + 1] = points[i].y - rounded[i].y;
+            }
+            for (size_t i = 0; i < PHANTOM_POINTS; i++) {
+                Point d = phantom_delta(glyph, tuples, tuples[t].peak, i);
+                deltas[t][(count + i) * 2] = d.x;
+                deltas[t][(count + i) * 2 + 1] = d.y;
+            }
+        }
+        if (!solve(scalars, deltas)) return -1;
+        for (auto& row : deltas) {
+            for (double& v : row) v = std::round(v);
+        }
+
+        // Between peaks the union moves nonlinearly; check it stays close
+        std::vector<std::vector<double>> probes;
+        for (size_t t = 0; t < n; t++) {
+            probes.push_back(tuples[t].peak);
+            std::vector<double> half(axis_count);
+            for (size_t a = 0; a < axis_count; a++) half[a] = tuples[t].peak[a] * 0.5;
+            probes.push_back(half);
+        }
+        for (size_t t = 0; t < n && probes.size() < MAX_PROBES; t++) {
+            for (size_t u = t + 1; u < n && probes.size() < MAX_PROBES; u++) {
+                std::vector<double> mid(axis_count);
+                for (size_t a = 0; a < axis_count; a++) mid[a] = (tuples[t].peak[a] + tuples[u].peak[a]) * 0.5;
+                probes.push_back(mid);
+            }
+        }
+        for (const auto& location : probes) {
+            if (!outline_at(glyph, tuples, location, base, points)) return -1;
+            std::vector<double> weights(n);
+            for (size_t u = 0; u < n; u++) weights[u] = tuple_scalar(tuples[u], location);
+            for (size_t i = 0; i < count; i++) {
+                double x = rounded[i].x, y = rounded[i].y;
+                for (size_t u = 0; u < n; u++) {
+                    x += weights[u] * deltas[u][i * 2];
+                    y += weights[u] * deltas[u][i * 2 + 1];
+                }
+                if (std::fabs(x - points[i].x) > tolerance_ || std::fabs(y - points[i].y) > tolerance_) return -1;
+            }
+        }
+
+        encode_variations(tuples, deltas, out.gvar);
+        return 1;
+    }
+
+private:
+    // Glyph points (phantoms last, from zero) at a normalized location
+    static void points_at(const SimpleGlyph& glyph, const std::vector<Tuple>& tuples,
+                          const std::vector<double>& location, std::vector<Point>& points) {
+        points = glyph.points;
+        points.resize(glyph.points.size() + PHANTOM_POINTS, Point{0, 0});
+        for (const Tuple& tuple : tuples) {
+            double scalar = tuple_scalar(tuple, location);
+            if (scalar == 0) continue;
+            for (size_t i = 0; i < points.size(); i++) points[i] = points[i] + tuple.deltas[i] * scalar;
+        }
+    }
+
+    static Point phantom_delta(const SimpleGlyph& glyph, const std::vector<Tuple>& tuples,
+                               const std::vector<double>& location, size_t phantom) {
+        Point delta{0, 0};
+        for (const Tuple& tuple : tuples) {
+            delta = delta + tuple.deltas[glyph.points.size() + phantom] * tuple_scalar(tuple, location);
+        }
+        return delta;
+    }
+
+    // The union's points at |location|, if its topology matches |base|
+    bool outline_at(const SimpleGlyph& glyph, const std::vector<Tuple>& tuples,
+                    const std::vector<double>& location, const UnionOutline& base,
+                    std::vector<Point>& out) {
+        points_at(glyph, tuples, location, located_);
+        build_segments(glyph, located_.data(), varied_);
+        UnionOutline outline;
+        if (!union_outline(varied_, outline) || outline.signature != base.signature) return false;
+        outline_points(varied_, outline, nullptr, nullptr, out);
+        return true;
+    }
+
+    static void encode_variations(const std::vector<Tuple>& tuples,
+                                  const std::vector<std::vector<double>>& deltas,
+                                  std::vector<uint8_t>& out) {
+        std::vector<TupleDeltas> encoded(tuples.size());
+        for (size_t t = 0; t < tuples.size(); t++) {
+            encoded[t].index = tuples[t].index;
+            encoded[t].coordinates = tuples[t].coordinates;
+            for (size_t k = 0; k < deltas[t].size(); k += 2) {
+                encoded[t].x.push_back(int32_t(deltas[t][k]));
+                encoded[t].y.push_back(int32_t(deltas[t][k + 1]));
+            }
+        }
+        encode_glyph_variations(encoded, out);
+    }
+
+    const Gvar* gvar_;
+    double tolerance_;
+    std::vector<Segment> segments_, varied_;
+    std::vector<Point> located_;
+};
+
+} // namespace
+
+bool remove_overlaps(SfntFont& font, OverlapRemovalStats& stats) {
+    std::vector<uint8_t>* glyf = font.find(TAG_GLYF);
+    std::vector<uint8_t>* loca = font.find(TAG_LOCA);
+    std::vector<uint8_t>* head = font.find(TAG_HEAD);
+    std::vector<uint8_t>* maxp = font.find(TAG_MAXP);
+    if (!glyf || !loca || !head || !maxp || head->size() < 54 || maxp->size() < 6) return false;
+
+    const uint16_t glyph_count = sfnt_u16(maxp->data() + 4);
+    const bool long_loca = sfnt_i16(head->data() + 50) != 0;
+    if (loca->size() < (size_t(glyph_count) + 1) * (long_loca ? 4 : 2)) return false;
+
+    std::vector<std::vector<uint8_t>> glyphs(glyph_count);
+    for (size_t g = 0; g < glyph_count; g++) {
+        const uint8_t* p = loca->data() + g * (long_loca ? 4 : 2);
+        size_t start = long_loca ? sfnt_u32(p) : size_t(sfnt_u16(p)) * 2;
+        size_t end = long_loca ? sfnt_u32(p + 4) : size_t(sfnt_u16(p + 2)) * 2;
+        if (start > end || end > glyf->size()) return false;
+        glyphs[g].assign(glyf->begin() + long(start), glyf->begin() + long(end));
+    }
+
+    Gvar gvar;
+    std::vector<uint8_t>* gvar_table = font.find(TAG_GVAR);
+    if (gvar_table && (!parse_gvar(*gvar_table, gvar) || gvar.offsets.size() != size_t(glyph_count) + 1)) {
+        return false;
+    }
+
+    std::vector<bool> anchored(glyph_count, false);
+    for (const auto& g : glyphs) collect_point_anchored(g.data(), g.size(), anchored);
+
+    GlyphMerger merger(gvar_table ? &gvar : nullptr, sfnt_u16(head->data() + 18));
+    std::vector<std::vector<uint8_t>> variations(glyph_count);
+    std::vector<bool> rewritten(glyph_count, false);
+    std::vector<int16_t> x_shift(glyph_count, 0);
+    for (uint32_t g = 0; g < glyph_count; g++) {
+        SimpleGlyph glyph;
+        if (!parse_simple_glyph(glyphs[g].data(), glyphs[g].size(), glyph)) continue;
+        MergedGlyph merged;
+        int result = anchored[g] ? -1 : merger.merge(g, glyph, merged);
+        if (result < 0) {
+            stats.glyphs_skipped++;
+        } else if (result > 0) {
+            stats.glyphs_merged++;
+            stats.contours_before += glyph.end_points.size();
+            stats.contours_after += merged.contours;
+            x_shift[g] = int16_t(merged.x_min - glyph.x_min);
+            glyphs[g] = std::move(merged.glyf);
+            variations[g] = std::move(merged.gvar);
+            rewritten[g] = true;
+        }
+    }
+    if (!stats.glyphs_merged) return true;
+
+    write_glyf_loca(font, glyphs);
+
+    if (gvar_table) {
+        std::vector<std::vector<uint8_t>> data(glyph_count);
+        for (size_t g = 0; g < glyph_count; g++) {
+            if (rewritten[g]) data[g] = std::move(variations[g]);
+            else data[g].assign(gvar.data + gvar.offsets[g], gvar.data + gvar.offsets[g + 1]);
+        }
+        *gvar_table = build_gvar(gvar.axis_count, gvar.data + sfnt_u32(gvar.data + 8),
+                                 uint16_t(gvar.shared_tuples.size()), data);
+    }
+
+    update_maxp_counts(*maxp, glyphs);
+
+    // Left side bearings follow xMin, keeping the phantom points in place
+    std::vector<uint8_t>* hhea = font.find(TAG_HHEA);
+    std::vector<uint8_t>* hmtx = font.find(TAG_HMTX);
+    if (hhea && hmtx && hhea->size() >= 36) {
+        const size_t metrics = sfnt_u16(hhea->data() + 34);
+        for (size_t g = 0; g < glyph_count; g++) {
+            if (!x_shift[g]) continue;
+            size_t pos = g < metrics ? g * 4 + 2 : metrics * 4 + (g - metrics) * 2;
+            if (pos + 2 > hmtx->size()) continue;
+            sfnt_put_u16(hmtx->data() + pos, uint16_t(int16_t(sfnt_i16(hmtx->data() + pos) + x_shift[g])));
+        }
+    }
+    return true;
+}
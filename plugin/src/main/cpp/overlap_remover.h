@@ -0,0 +1,27 @@
+#ifndef FONTSUBSETTING_OVERLAP_REMOVER_H
+#define FONTSUBSETTING_OVERLAP_REMOVER_H
+
+#include <cstddef>
+#include "sfnt_tables.h"
+
+struct OverlapRemovalStats {
+    size_t glyphs_merged = 0;
+    size_t glyphs_skipped = 0;
+    size_t contours_before = 0;
+    size_t contours_after = 0;
+};
+
+// Replaces overlapping contours of simple glyf glyphs by their nonzero
+// union, rewriting glyf, loca, gvar, maxp and the hmtx side bearings.
+//
+// The union is taken at the default location and at every gvar tuple's
+// peak; new tuple deltas are solved so the merged outline reproduces each
+// of those unions exactly. A glyph is left untouched when the union's
+// topology differs between locations, when the interpolated result strays
+// from the true union at in-between locations, or when a composite
+// attaches to it by point number. Merged glyphs lose their instructions.
+//
+// Returns false (and leaves |font| as is) for fonts without glyf outlines.
+bool remove_overlaps(SfntFont& font, OverlapRemovalStats& stats);
+
+#endif // FONTSUBSETTING_OVERLAP_REMOVER_H
@@ -0,0 +1,111 @@
+#include "sfnt_tables.h"
+#include <algorithm>
+
+static uint32_t table_checksum(const uint8_t* data, size_t size) {
+    uint32_t sum = 0;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) sum += sfnt_u32(data + i);
+    if (i < size) {
+        uint8_t tail[4] = {0, 0, 0, 0};
+        for (size_t j = 0; i + j < size; j++) tail[j] = data[i + j];
+        sum += sfnt_u32(tail);
+    }
+    return sum;
+}
+
+bool sfnt_parse(const uint8_t* data, size_t size, SfntFont& font) {
+    if (!data || size < 12) return false;
+    uint32_t version = sfnt_u32(data);
+    if (version != 0x00010000 && version != sfnt_tag('O', 'T', 'T', 'O') &&
+        version != sfnt_tag('t', 'r', 'u', 'e')) {
+        return false;
+    }
+
+    uint16_t num_tables = sfnt_u16(data + 4);
+    if (12 + size_t(num_tables) * 16 > size) return false;
+
+    font.version = version;
+    font.tables.clear();
+    for (uint16_t i = 0; i < num_tables; i++) {
+        const uint8_t* record = data + 12 + size_t(i) * 16;
+        uint32_t tag = sfnt_u32(record);
+        uint32_t offset = sfnt_u32(record + 8);
+        uint32_t length = sfnt_u32(record + 12);
+        if (offset > size || length > size - offset) return false;
+        font.tables[tag].assign(data + offset, data + offset + length);
+    }
+    return true;
+}
+
+std::vector<uint8_t> sfnt_serialize(const SfntFont& font) {
+    return sfnt_serialize(font, {}, 0);
+}
+
+std::vector<uint8_t> sfnt_serialize(const SfntFont& font, const std::vector<uint32_t>& order,
+                                    size_t page_size) {
+    const uint16_t num_tables = uint16_t(font.tables.size());
+    uint16_t entry_selector = 0;
+    while ((2u << entry_selector) <= num_tables) entry_selector++;
+    const uint16_t search_range = uint16_t((1u << entry_selector) * 16);
+
+    std::vector<uint8_t> out;
+    sfnt_append_u32(out, font.version);
+    sfnt_append_u16(out, num_tables);
+    sfnt_append_u16(out, search_range);
+    sfnt_append_u16(out, entry_selector);
+    sfnt_append_u16(out, uint16_t(num_tables * 16 - search_range));
+
+    size_t directory = out.size();
+    out.resize(directory + size_t(num_tables) * 16);
+
+    // Data order: listed tables first, then the rest by tag
+    std::vector<uint32_t> data_order;
+    for (uint32_t tag : order) {
+        if (font.tables.count(tag) &&
+            std::find(data_order.begin(), data_order.end(), tag) == data_order.end()) {
+            data_order.push_back(tag);
+        }
+    }
+    const size_t listed = data_order.size();
+    for (const auto& entry : font.tables) {
+        if (std::find(data_order.begin(), data_order.begin() + listed, entry.first) ==
+            data_order.begin() + listed) {
+            data_order.push_back(entry.first);
+        }
+    }
+
+    std::map<uint32_t, size_t> offsets;
+    size_t head_offset = 0;
+    for (size_t i = 0; i < data_order.size(); i++) {
+        const uint32_t tag = data_order[i];
+        const std::vector<uint8_t>& bytes = font.tables.at(tag);
+        if (i < listed && page_size > 0 && bytes.size() > page_size) {
+            out.resize((out.size() + page_size - 1) / page_size * page_size, 0);
+        }
+        size_t offset = out.size();
+        out.insert(out.end(), bytes.begin(), bytes.end());
+        while (out.size() % 4) out.push_back(0);
+        offsets[tag] = offset;
+        if (tag == sfnt_tag('h', 'e', 'a', 'd') && bytes.size() >= 12) {
+            head_offset = offset;
+            sfnt_put_u32(out.data() + offset + 8, 0);
+        }
+    }
+
+    size_t index = 0;
+    for (const auto& [tag, bytes] : font.tables) {
+        size_t offset = offsets[tag];
+        uint8_t* record = out.data() + directory + index * 16;
+        sfnt_put_u32(record, tag);
+        sfnt_put_u32(record + 4, table_checksum(out.data() + offset, bytes.size()));
+        sfnt_put_u32(record + 8, uint32_t(offset));
+        sfnt_put_u32(record + 12, uint32_t(bytes.size()));
+        index++;
+    }
+
+    if (head_offset) {
+        uint32_t adjustment = 0xB1B0AFBAu - table_checksum(out.data(), out.size());
+        sfnt_put_u32(out.data() + head_offset + 8, adjustment);
+    }
+    return out;
+}
@@ -0,0 +1,58 @@
+#ifndef FONTSUBSETTING_SFNT_TABLES_H
+#define FONTSUBSETTING_SFNT_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// An sfnt font split into its tables, for passes that rewrite table bytes
+// directly after HarfBuzz has produced the subset.
+struct SfntFont {
+    uint32_t version = 0x00010000;
+    std::map<uint32_t, std::vector<uint8_t>> tables;
+
+    std::vector<uint8_t>* find(uint32_t tag) {
+        auto it = tables.find(tag);
+        return it != tables.end() ? &it->second : nullptr;
+    }
+};
+
+constexpr uint32_t sfnt_tag(char a, char b, char c, char d) {
+    return (uint32_t(uint8_t(a)) << 24) | (uint32_t(uint8_t(b)) << 16) |
+           (uint32_t(uint8_t(c)) << 8) | uint32_t(uint8_t(d));
+}
+
+// Big-endian field access; callers bounds-check
+inline uint16_t sfnt_u16(const uint8_t* p) { return uint16_t((p[0] << 8) | p[1]); }
+inline int16_t sfnt_i16(const uint8_t* p) { return int16_t(sfnt_u16(p)); }
+inline uint32_t sfnt_u32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+inline void sfnt_put_u16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v >> 8); p[1] = uint8_t(v); }
+inline void sfnt_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16); p[2] = uint8_t(v >> 8); p[3] = uint8_t(v);
+}
+inline void sfnt_append_u16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(uint8_t(v >> 8));
+    out.push_back(uint8_t(v));
+}
+inline void sfnt_append_u32(std::vector<uint8_t>& out, uint32_t v) {
+    sfnt_append_u16(out, uint16_t(v >> 16));
+    sfnt_append_u16(out, uint16_t(v));
+}
+
+// Splits a single-font sfnt (not a collection) into tables
+bool sfnt_parse(const uint8_t* data, size_t size, SfntFont& font);
+
+// Writes tables in tag order with 4-byte padding, fresh checksums and
+// head.checkSumAdjustment
+std::vector<uint8_t> sfnt_serialize(const SfntFont& font);
+
+// Like sfnt_serialize, but table data follows |order| (unlisted tables come
+// after, in tag order) and listed tables larger than |page_size| start on a
+// page boundary; 0 disables alignment. The directory stays sorted by tag.
+std::vector<uint8_t> sfnt_serialize(const SfntFont& font, const std::vector<uint32_t>& order,
+                                    size_t page_size);
+
+#endif // FONTSUBSETTING_SFNT_TABLES_H
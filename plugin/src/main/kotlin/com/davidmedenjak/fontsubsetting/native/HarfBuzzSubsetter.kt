@@ -159,13 +159,29 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
     
     private external fun nativeSetLogger(logger: NativeLogger)
 
+    /**
+     * With [denseCodepoints] (same size as [codepoints]), the subset's glyphs are
+     * remapped to a contiguous run from U+E000 and the new codepoint of each
+     * requested codepoint is written to it, 0 where it has no glyph. When the
+     * remap is skipped (too many glyphs for the Private Use Area, or a subset
+     * that can't be re-read), the font keeps its cmap and each entry receives
+     * its original codepoint.
+     *
+     * With [priorityCodepoints], their glyphs get the lowest glyph ids in that
+     * order if [codepointOnly] drops the layout tables, and the output is laid
+     * out for locality (hot tables first, large ones page-aligned).
+     */
     fun subsetFontWithAxesAndFlags(
         inputFontPath: String,
         outputFontPath: String,
         codepoints: IntArray,
         axisConfigs: List<AxisConfig>,
         stripHinting: Boolean = true,
-        stripGlyphNames: Boolean = true
+        stripGlyphNames: Boolean = true,
+        removeOverlaps: Boolean = false,
+        codepointOnly: Boolean = false,
+        denseCodepoints: IntArray? = null,
+        priorityCodepoints: IntArray? = null
     ): Boolean {
         ensureLibraryLoaded()
 
@@ -180,7 +196,11 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
                 floatArrayOf(),
                 booleanArrayOf(),
                 stripHinting,
-                stripGlyphNames
+                stripGlyphNames,
+                removeOverlaps,
+                codepointOnly,
+                denseCodepoints,
+                priorityCodepoints
             )
         }
 
@@ -200,7 +220,11 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
             axisDefaultValues,
             axisRemove,
             stripHinting,
-            stripGlyphNames
+            stripGlyphNames,
+            removeOverlaps,
+            codepointOnly,
+            denseCodepoints,
+            priorityCodepoints
         )
     }
 
@@ -214,9 +238,128 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
         axisDefaultValues: FloatArray,
         axisRemove: BooleanArray,
         stripHinting: Boolean,
-        stripGlyphNames: Boolean
+        stripGlyphNames: Boolean,
+        removeOverlaps: Boolean,
+        codepointOnly: Boolean,
+        denseCodepoints: IntArray?,
+        priorityCodepoints: IntArray?
     ): Boolean
     
+    /**
+     * Merges the subset fonts [sourceFontPaths] into [primaryFontPath] and writes the
+     * result to [outputFontPath]. [sourceCodepoints] holds one array per source; each
+     * codepoint is replaced by its codepoint in the merged font, 0 where it has no glyph.
+     * Codepoints the primary (or an earlier source) already uses move to the Private
+     * Use Area.
+     */
+    fun mergeFonts(
+        primaryFontPath: String,
+        outputFontPath: String,
+        sourceFontPaths: List<String>,
+        sourceCodepoints: Array<IntArray>,
+        localityLayout: Boolean = false
+    ): Boolean {
+        ensureLibraryLoaded()
+        return nativeMergeFonts(
+            primaryFontPath,
+            outputFontPath,
+            sourceFontPaths.toTypedArray(),
+            sourceCodepoints,
+            localityLayout
+        )
+    }
+
+    private external fun nativeMergeFonts(
+        primaryFontPath: String,
+        outputFontPath: String,
+        sourceFontPaths: Array<String>,
+        sourceCodepoints: Array<IntArray>,
+        localityLayout: Boolean
+    ): Boolean
+
+    /**
+     * Splits the subset font [fontPath] into a base font, written to [outputFontPath],
+     * and one chunk per entry of [chunkNames], written to [chunkDirectory] under that
+     * name. [chunkCodepoints] holds the codepoints of each chunk's group; glyphs only
+     * one group reaches move to its chunk, the rest stay in the base. Groups without
+     * glyphs of their own get no chunk file.
+     */
+    fun splitChunks(
+        fontPath: String,
+        outputFontPath: String,
+        chunkDirectory: String,
+        chunkNames: List<String>,
+        chunkCodepoints: Array<IntArray>,
+        localityLayout: Boolean = false
+    ): Boolean {
+        ensureLibraryLoaded()
+        return nativeSplitChunks(
+            fontPath,
+            outputFontPath,
+            chunkDirectory,
+            chunkNames.toTypedArray(),
+            chunkCodepoints,
+            localityLayout
+        )
+    }
+
+    private external fun nativeSplitChunks(
+        fontPath: String,
+        outputFontPath: String,
+        chunkDirectory: String,
+        chunkNames: Array<String>,
+        chunkCodepoints: Array<IntArray>,
+        localityLayout: Boolean
+    ): Boolean
+
+    /**
+     * Applies the chunk files [chunkPaths] to the split base font [baseFontPath] in
+     * order, with the runtime's own chunk reader, and writes the result to
+     * [outputFontPath]. False if a chunk doesn't belong to the base.
+     */
+    fun applyChunks(baseFontPath: String, chunkPaths: List<String>, outputFontPath: String): Boolean {
+        ensureLibraryLoaded()
+        return nativeApplyChunks(baseFontPath, chunkPaths.toTypedArray(), outputFontPath)
+    }
+
+    private external fun nativeApplyChunks(
+        baseFontPath: String,
+        chunkPaths: Array<String>,
+        outputFontPath: String
+    ): Boolean
+
+    /**
+     * Writes a delta that rebuilds [fontPath] from [previousFontPath] to [deltaPath]:
+     * unchanged tables and glyph records are copied from the previous font, the rest
+     * is carried in the delta. The runtime applies it with `applyFontDelta`.
+     */
+    fun createFontDelta(previousFontPath: String, fontPath: String, deltaPath: String): Boolean {
+        ensureLibraryLoaded()
+        return nativeCreateFontDelta(previousFontPath, fontPath, deltaPath)
+    }
+
+    private external fun nativeCreateFontDelta(
+        previousFontPath: String,
+        fontPath: String,
+        deltaPath: String
+    ): Boolean
+
+    /**
+     * Rebuilds the font [deltaPath] describes from [previousFontPath] with the
+     * runtime's own delta code and writes it to [outputFontPath]. False if the
+     * delta is malformed or was made against another font.
+     */
+    fun applyFontDelta(previousFontPath: String, deltaPath: String, outputFontPath: String): Boolean {
+        ensureLibraryLoaded()
+        return nativeApplyFontDelta(previousFontPath, deltaPath, outputFontPath)
+    }
+
+    private external fun nativeApplyFontDelta(
+        previousFontPath: String,
+        deltaPath: String,
+        outputFontPath: String
+    ): Boolean
+
     fun validateFont(fontPath: String): Boolean {
         ensureLibraryLoaded()
         return nativeValidateFont(fontPath)
@@ -249,6 +392,7 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
         val glyphCount = props.getProperty("glyphCount")?.toInt() ?: 0
         val unitsPerEm = props.getProperty("unitsPerEm")?.toInt() ?: 0
         val fileSize = props.getProperty("fileSize")?.toLong() ?: 0L
+        val tables = props.getProperty("tables")?.split(",")?.filter { it.isNotEmpty() } ?: emptyList()
         
         val axes = mutableListOf<FontInfo.AxisInfo>()
         var index = 0
@@ -270,6 +414,7 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
             glyphCount = glyphCount,
             unitsPerEm = unitsPerEm,
             fileSize = fileSize,
+            tables = tables,
             axes = if (axes.isNotEmpty()) axes else null
         )
     }
@@ -278,6 +423,7 @@ internal class HarfBuzzSubsetter(private val logger: NativeLogger? = null) {
         val glyphCount: Int,
         val unitsPerEm: Int,
         val fileSize: Long,
+        val tables: List<String> = emptyList(),
         val axes: List<AxisInfo>? = null
     ) {
         data class AxisInfo(
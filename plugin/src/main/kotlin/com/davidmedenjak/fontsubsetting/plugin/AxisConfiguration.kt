@@ -35,4 +35,12 @@ interface AxisConfiguration : Named {
     fun remove() {
         remove.set(true)
     }
+
+    /**
+     * Instances the font at [value] and drops the axis, like [remove] but at a value of
+     * your choosing, e.g. `axis("wght").pin(400f)` with synthetic emboldening at runtime.
+     */
+    fun pin(value: Float) {
+        range(value, value, value)
+    }
 }
\ No newline at end of file
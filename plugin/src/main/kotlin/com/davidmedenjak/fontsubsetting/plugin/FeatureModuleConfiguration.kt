@@ -0,0 +1,17 @@
+package com.davidmedenjak.fontsubsetting.plugin
+
+import org.gradle.api.Named
+import org.gradle.api.file.ConfigurableFileCollection
+import org.gradle.api.provider.ListProperty
+
+interface FeatureModuleConfiguration : Named {
+
+    /** Kotlin sources of the module, scanned for icon references */
+    val sourceDirectories: ConfigurableFileCollection
+
+    /**
+     * Objects whose properties the module's sources reference icons through;
+     * defaults to the font's generated class.
+     */
+    val iconClasses: ListProperty<String>
+}
@@ -30,6 +30,75 @@ abstract class FontConfiguration @Inject constructor(
 
     abstract val stripGlyphNames: Property<Boolean>
 
+    /**
+     * Merges overlapping contours into one outline per glyph, at every master, so
+     * runtime fills cover fewer edges. Glyphs whose overlaps change shape across
+     * the design space keep them. Off by default.
+     */
+    abstract val removeOverlaps: Property<Boolean>
+
+    /**
+     * Subsets by codepoint alone: skips GSUB closure and drops the layout tables
+     * (GSUB, GPOS, GDEF, ...), which also removes ligature lookups by icon name.
+     * Off by default.
+     */
+    abstract val codepointOnly: Property<Boolean>
+
+    /**
+     * Remaps the used icons to one contiguous run from U+E000, so the runtime
+     * resolves a codepoint to its glyph by subtraction. The generated constants
+     * follow the new codepoints. Off by default.
+     */
+    abstract val denseCodepoints: Property<Boolean>
+
+    /**
+     * Icon names, one per line, most important first (e.g. the icons drawn at
+     * startup). With [codepointOnly], their glyphs get the lowest glyph ids, so
+     * their outlines sit together; the font's tables are ordered and
+     * page-aligned for the runtime's first draws either way. Unused or unknown
+     * names are ignored.
+     */
+    abstract val glyphPriorityFile: RegularFileProperty
+
+    /**
+     * Name of another font configuration to merge this font's used icons into, so
+     * one font file (the target's resource) serves both. Icons whose codepoint the
+     * target already uses move to free Private Use Area codepoints, and this font's
+     * generated constants follow them. The fonts' axes must agree; see the README.
+     */
+    abstract val mergeInto: Property<String>
+
+    /**
+     * Splits the subset into a base font and one chunk file per group, which the
+     * runtime applies when one of the group's icons is first drawn. Format:
+     * "icon_name group" per line; group names use letters, digits, '_' and '-'.
+     * Chunks are written to build/fontSubsetting/chunks/<variant>/<font>/ as
+     * "<resource>_<group>.chunk". Ungrouped icons, and glyphs several groups
+     * share, stay in the base.
+     */
+    abstract val chunkGroupsFile: RegularFileProperty
+
+    /**
+     * The subset font the app shipped last. When set, a delta that rebuilds the
+     * new subset from it is written to build/fontSubsetting/delta/<variant>/
+     * as "<resource file>.fdelta", for over-the-air updates; unchanged tables
+     * and glyphs are not repeated in it.
+     */
+    abstract val previousFontFile: RegularFileProperty
+
+    /**
+     * Dynamic feature modules that draw icons of this font. One subset covers the app
+     * and every module; icons only one module uses are then split off into that
+     * module's chunk (see [chunkGroupsFile]), while icons the app or several modules
+     * use stay in the shared base font.
+     */
+    val featureModules: NamedDomainObjectContainer<FeatureModuleConfiguration> =
+        objectFactory.domainObjectContainer(FeatureModuleConfiguration::class.java)
+
+    fun featureModule(name: String, action: Action<FeatureModuleConfiguration>) {
+        action.execute(featureModules.maybeCreate(name))
+    }
+
     val axes: NamedDomainObjectContainer<AxisConfiguration> =
         objectFactory.domainObjectContainer(AxisConfiguration::class.java)
     
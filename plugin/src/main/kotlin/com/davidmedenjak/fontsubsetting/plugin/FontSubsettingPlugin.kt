@@ -7,6 +7,7 @@ import com.android.build.gradle.LibraryPlugin
 import com.davidmedenjak.fontsubsetting.plugin.tasks.AnalyzeIconUsageTask
 import com.davidmedenjak.fontsubsetting.plugin.tasks.FontSubsettingTask
 import com.davidmedenjak.fontsubsetting.plugin.tasks.GenerateIconConstantsTask
+import org.gradle.api.GradleException
 import org.gradle.api.Plugin
 import org.gradle.api.Project
 import org.gradle.api.file.Directory
@@ -75,6 +76,7 @@ class FontSubsettingPlugin : Plugin<Project> {
             extension.fonts.configureEach { fontConfig ->
                 val variantName = variant.name.replaceFirstChar { it.uppercase() }
                 val fontName = fontConfig.name.replaceFirstChar { it.uppercase() }
+                val mergeTarget = findMergeTarget(extension, fontConfig)
 
                 val generateTask =
                     registerGenerateTask(project, variant, fontConfig, variantName, fontName)
@@ -87,20 +89,46 @@ class FontSubsettingPlugin : Plugin<Project> {
                     fontName,
                     kotlinCompilerClasspath
                 )
+                val moduleAnalyzeTasks = registerModuleAnalyzeTasks(
+                    project,
+                    variant,
+                    fontConfig,
+                    variantName,
+                    fontName,
+                    kotlinCompilerClasspath
+                )
                 val subsetTask = registerSubsetTask(
                     project,
                     extension,
                     variant,
                     fontConfig,
                     analyzeTask,
+                    moduleAnalyzeTasks,
                     variantName,
                     fontName
                 )
 
-                variant.sources.res?.addGeneratedSourceDirectory(
-                    subsetTask,
-                    FontSubsettingTask::outputDirectory
-                )
+                // A merged font only reaches the resources inside its target
+                if (mergeTarget == null) {
+                    variant.sources.res?.addGeneratedSourceDirectory(
+                        subsetTask,
+                        FontSubsettingTask::outputDirectory
+                    )
+                }
+
+                generateTask.configure { task ->
+                    if (mergeTarget != null) {
+                        val targetTask = project.tasks.named(
+                            subsetTaskName(variantName, mergeTarget.name),
+                            FontSubsettingTask::class.java
+                        )
+                        task.remappedCodepointsFile.set(
+                            targetTask.flatMap { it.mergeMappingDirectory.file("${fontConfig.name}.txt") }
+                        )
+                    } else if (fontConfig.denseCodepoints.getOrElse(false)) {
+                        task.remappedCodepointsFile.set(subsetTask.flatMap { it.codepointMappingFile })
+                    }
+                }
             }
         }
     }
@@ -159,13 +187,16 @@ class FontSubsettingPlugin : Plugin<Project> {
 
             configureSourceSets(variant, project, task)
 
-            task.sourceFiles.from(
-                generateTask.map { genTask ->
-                    project.fileTree(genTask.outputDirectory) {
-                        it.include("**/*.kt")
+            // Dense and merged constants are generated from the subset's output, so they can't feed its analysis
+            if (!fontConfig.denseCodepoints.getOrElse(false) && !fontConfig.mergeInto.isPresent) {
+                task.sourceFiles.from(
+                    generateTask.map { genTask ->
+                        project.fileTree(genTask.outputDirectory) {
+                            it.include("**/*.kt")
+                        }
                     }
-                }
-            )
+                )
+            }
 
             val outputFile = project.layout.buildDirectory.file(
                 "fontSubsetting/usage_${variant.name}_${fontConfig.name}.txt"
@@ -174,6 +205,45 @@ class FontSubsettingPlugin : Plugin<Project> {
         }
     }
 
+    /** One usage analysis per feature module of [fontConfig], over that module's sources */
+    private fun registerModuleAnalyzeTasks(
+        project: Project,
+        variant: Variant,
+        fontConfig: FontConfiguration,
+        variantName: String,
+        fontName: String,
+        kotlinCompilerClasspath: org.gradle.api.file.FileCollection
+    ): List<TaskProvider<AnalyzeIconUsageTask>> {
+        return fontConfig.featureModules.map { module ->
+            val moduleName = module.name.replaceFirstChar { it.uppercase() }
+            project.tasks.register(
+                "analyze${variantName}${fontName}${moduleName}ModuleUsage",
+                AnalyzeIconUsageTask::class.java
+            ) { task ->
+                task.group = Constants.PLUGIN_GROUP
+                task.description = "Analyze usage of $fontName icons in feature module ${module.name} ($variantName)"
+
+                task.targetClasses.set(
+                    module.iconClasses.orElse(emptyList())
+                        .zip(fontConfig.className) { classes, className -> classes.ifEmpty { listOf(className) } }
+                )
+                task.kotlinCompilerClasspath.from(kotlinCompilerClasspath)
+                task.sourceFiles.from(
+                    module.sourceDirectories.elements.map { directories ->
+                        directories.map { dir ->
+                            project.fileTree(dir.asFile) { it.include("**/*.kt") }
+                        }
+                    }
+                )
+                task.outputFile.set(
+                    project.layout.buildDirectory.file(
+                        "fontSubsetting/usage_${variant.name}_${fontConfig.name}_${module.name}.txt"
+                    )
+                )
+            }
+        }
+    }
+
     private fun configureSourceSets(variant: Variant, project: Project, task: AnalyzeIconUsageTask) {
         fun addStaticSources(sourcesProvider: Provider<out Collection<Directory>>) {
             task.sourceFiles.from(
@@ -195,11 +265,14 @@ class FontSubsettingPlugin : Plugin<Project> {
         variant: Variant,
         fontConfig: FontConfiguration,
         analyzeTask: TaskProvider<AnalyzeIconUsageTask>,
+        moduleAnalyzeTasks: List<TaskProvider<AnalyzeIconUsageTask>>,
         variantName: String,
         fontName: String
     ): TaskProvider<FontSubsettingTask> {
+        val mergeSources = extension.fonts.filter { it.mergeInto.orNull == fontConfig.name }
+
         return project.tasks.register(
-            "subset${variantName}${fontName}Font",
+            subsetTaskName(variantName, fontConfig.name),
             FontSubsettingTask::class.java
         ) { task ->
             task.group = Constants.PLUGIN_GROUP
@@ -211,6 +284,48 @@ class FontSubsettingPlugin : Plugin<Project> {
 
             task.stripHinting.set(fontConfig.stripHinting.orElse(true))
             task.stripGlyphNames.set(fontConfig.stripGlyphNames.orElse(true))
+            task.removeOverlaps.set(fontConfig.removeOverlaps.orElse(false))
+            task.codepointOnly.set(fontConfig.codepointOnly.orElse(false))
+            task.denseCodepoints.set(fontConfig.denseCodepoints.orElse(false))
+            task.glyphPriorityFile.set(fontConfig.glyphPriorityFile)
+            if (fontConfig.denseCodepoints.getOrElse(false) || fontConfig.mergeInto.isPresent) {
+                task.codepointMappingFile.set(
+                    project.layout.buildDirectory.file(
+                        "fontSubsetting/codepoints_${variant.name}_${fontConfig.name}.txt"
+                    )
+                )
+            }
+
+            task.mergeSourceNames.set(mergeSources.map { it.name })
+            mergeSources.forEach { source ->
+                val sourceTask = project.tasks.named(
+                    subsetTaskName(variantName, source.name),
+                    FontSubsettingTask::class.java
+                )
+                task.mergeFontFiles.add(sourceTask.flatMap { sourceSubset ->
+                    sourceSubset.outputDirectory.file(sourceSubset.outputFileName.map { "font/$it" })
+                })
+                task.mergeCodepointFiles.add(sourceTask.flatMap { it.codepointMappingFile })
+            }
+            if (mergeSources.isNotEmpty()) {
+                task.mergeMappingDirectory.set(
+                    project.layout.buildDirectory.dir(
+                        "fontSubsetting/merge/${variant.name}/${fontConfig.name}-mappings"
+                    )
+                )
+            }
+
+            task.moduleNames.set(fontConfig.featureModules.map { it.name })
+            moduleAnalyzeTasks.forEach { moduleTask ->
+                task.moduleUsageFiles.add(moduleTask.flatMap { it.outputFile })
+            }
+
+            task.chunkGroupsFile.set(fontConfig.chunkGroupsFile)
+            if (fontConfig.chunkGroupsFile.isPresent || moduleAnalyzeTasks.isNotEmpty()) {
+                task.chunkDirectory.set(
+                    project.layout.buildDirectory.dir("fontSubsetting/chunks/${variant.name}/${fontConfig.name}")
+                )
+            }
 
             task.axes.set(createAxesProvider(project, fontConfig))
 
@@ -219,11 +334,67 @@ class FontSubsettingPlugin : Plugin<Project> {
                 if (originalExtension.isNotEmpty()) "$name.$originalExtension" else name
             }.orElse(fontConfig.fontFile.map { it.asFile.name })
 
-            task.outputDirectory.set(
-                extension.outputDirectory.dir(variant.name)
-            )
+            if (fontConfig.mergeInto.isPresent) {
+                task.outputDirectory.set(
+                    project.layout.buildDirectory.dir("fontSubsetting/merge/${variant.name}/${fontConfig.name}")
+                )
+            } else {
+                task.outputDirectory.set(
+                    extension.outputDirectory.dir(variant.name)
+                )
+            }
             task.outputFileName.set(outputFileName)
+
+            if (fontConfig.previousFontFile.isPresent) {
+                task.previousFontFile.set(fontConfig.previousFontFile)
+                task.deltaFile.set(
+                    project.layout.buildDirectory.file(
+                        outputFileName.map { "fontSubsetting/delta/${variant.name}/$it.fdelta" }
+                    )
+                )
+            }
+        }
+    }
+
+    private fun subsetTaskName(variantName: String, fontName: String): String =
+        "subset${variantName}${fontName.replaceFirstChar { it.uppercase() }}Font"
+
+    /** The font [fontConfig] merges into, or null; merges must name another font that is not merged itself */
+    private fun findMergeTarget(
+        extension: FontSubsettingExtension,
+        fontConfig: FontConfiguration
+    ): FontConfiguration? {
+        val targetName = fontConfig.mergeInto.orNull ?: return null
+        val target = extension.fonts.findByName(targetName)
+            ?: throw GradleException("Font '${fontConfig.name}' merges into unknown font '$targetName'")
+        if (target.name == fontConfig.name) {
+            throw GradleException("Font '${fontConfig.name}' cannot merge into itself")
+        }
+        if (fontConfig.chunkGroupsFile.isPresent) {
+            throw GradleException(
+                "Font '${fontConfig.name}' merges into '$targetName' and cannot be split into chunks; " +
+                "set chunkGroupsFile on '$targetName'"
+            )
+        }
+        if (fontConfig.previousFontFile.isPresent) {
+            throw GradleException(
+                "Font '${fontConfig.name}' merges into '$targetName' and is not shipped on its own; " +
+                "set previousFontFile on '$targetName'"
+            )
+        }
+        if (fontConfig.featureModules.isNotEmpty()) {
+            throw GradleException(
+                "Font '${fontConfig.name}' merges into '$targetName' and cannot be split per feature module; " +
+                "declare the modules on '$targetName'"
+            )
+        }
+        target.mergeInto.orNull?.let { next ->
+            throw GradleException(
+                "Font '${fontConfig.name}' merges into '$targetName', which merges into '$next'; " +
+                "merge into '$next' directly"
+            )
         }
+        return target
     }
 
     private fun createAxesProvider(
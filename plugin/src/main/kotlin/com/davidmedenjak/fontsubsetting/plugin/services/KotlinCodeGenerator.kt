@@ -7,7 +7,8 @@ internal object KotlinCodeGenerator {
     fun generate(
         packageName: String,
         className: String,
-        mappings: List<IconMapping>
+        mappings: List<IconMapping>,
+        remapped: Map<String, String> = emptyMap()
     ): String {
         val sortedMappings = mappings.sortedBy { it.name }
 
@@ -22,7 +23,8 @@ internal object KotlinCodeGenerator {
 
             sortedMappings.forEach { icon ->
                 val propertyName = KotlinNamingService.toPropertyName(icon.name)
-                val unicodeValue = icon.toUnicodeEscape()
+                val unicodeValue = (remapped[icon.name]?.let { icon.copy(codepoint = it) } ?: icon)
+                    .toUnicodeEscape()
 
                 if (propertyName != icon.name) {
                     appendLine("    /** Original name: ${icon.name} */")
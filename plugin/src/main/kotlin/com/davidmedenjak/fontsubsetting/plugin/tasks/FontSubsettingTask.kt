@@ -5,14 +5,19 @@ import com.davidmedenjak.fontsubsetting.native.HarfBuzzSubsetter
 import com.davidmedenjak.fontsubsetting.plugin.NativeSubsetterFactory
 import com.davidmedenjak.fontsubsetting.plugin.services.KotlinNamingService
 import org.gradle.api.DefaultTask
+import org.gradle.api.GradleException
 import org.gradle.api.file.DirectoryProperty
+import org.gradle.api.file.RegularFile
 import org.gradle.api.file.RegularFileProperty
 import org.gradle.api.provider.ListProperty
 import org.gradle.api.provider.Property
 import org.gradle.api.tasks.CacheableTask
 import org.gradle.api.tasks.Input
 import org.gradle.api.tasks.InputFile
+import org.gradle.api.tasks.InputFiles
+import org.gradle.api.tasks.Optional
 import org.gradle.api.tasks.OutputDirectory
+import org.gradle.api.tasks.OutputFile
 import org.gradle.api.tasks.PathSensitive
 import org.gradle.api.tasks.PathSensitivity
 import org.gradle.api.tasks.TaskAction
@@ -40,6 +45,74 @@ abstract class FontSubsettingTask : DefaultTask() {
     @get:Input
     abstract val stripGlyphNames: Property<Boolean>
 
+    @get:Input
+    abstract val removeOverlaps: Property<Boolean>
+
+    @get:Input
+    abstract val codepointOnly: Property<Boolean>
+
+    @get:Input
+    abstract val denseCodepoints: Property<Boolean>
+
+    @get:InputFile
+    @get:Optional
+    @get:PathSensitive(PathSensitivity.NONE)
+    abstract val glyphPriorityFile: RegularFileProperty
+
+    /** Used icons with their codepoints in the output font, in codepoints file format; written when set */
+    @get:OutputFile
+    @get:Optional
+    abstract val codepointMappingFile: RegularFileProperty
+
+    /** Names of the fonts merged into this one; [mergeFontFiles] and [mergeCodepointFiles] follow this order */
+    @get:Input
+    abstract val mergeSourceNames: ListProperty<String>
+
+    /** Subset fonts merged into this one */
+    @get:InputFiles
+    @get:PathSensitive(PathSensitivity.NAME_ONLY)
+    abstract val mergeFontFiles: ListProperty<RegularFile>
+
+    /** Used icons of each merged font, in codepoints file format */
+    @get:InputFiles
+    @get:PathSensitive(PathSensitivity.NAME_ONLY)
+    abstract val mergeCodepointFiles: ListProperty<RegularFile>
+
+    /** Receives `<source name>.txt`: the merged font's codepoints of each source's used icons */
+    @get:OutputDirectory
+    @get:Optional
+    abstract val mergeMappingDirectory: DirectoryProperty
+
+    /** Feature modules drawing icons of this font; [moduleUsageFiles] follows this order */
+    @get:Input
+    abstract val moduleNames: ListProperty<String>
+
+    /** Icons each feature module uses, in usage file format */
+    @get:InputFiles
+    @get:PathSensitive(PathSensitivity.NAME_ONLY)
+    abstract val moduleUsageFiles: ListProperty<RegularFile>
+
+    /** "icon_name group" per line; each group's glyphs are split off into a chunk file */
+    @get:InputFile
+    @get:Optional
+    @get:PathSensitive(PathSensitivity.NONE)
+    abstract val chunkGroupsFile: RegularFileProperty
+
+    /** Receives `<output name>_<group>.chunk` per group and feature module */
+    @get:OutputDirectory
+    @get:Optional
+    abstract val chunkDirectory: DirectoryProperty
+
+    /** Subset font shipped before this one; [deltaFile] rebuilds the output from it */
+    @get:InputFile
+    @get:Optional
+    @get:PathSensitive(PathSensitivity.NONE)
+    abstract val previousFontFile: RegularFileProperty
+
+    @get:OutputFile
+    @get:Optional
+    abstract val deltaFile: RegularFileProperty
+
     @get:Input
     abstract val axes: ListProperty<AxisConfig>
 
@@ -51,25 +124,217 @@ abstract class FontSubsettingTask : DefaultTask() {
 
     @TaskAction
     fun subsetFont() {
+        val outputFile = prepareOutputFile()
+        val appIcons = loadUsedIcons(usageDataFile.get().asFile)
+        val moduleIcons = moduleNames.get().zip(moduleUsageFiles.get()) { name, file ->
+            name to loadUsedIcons(file.asFile)
+        }
+        val icons = subsetFont(outputFile, appIcons + moduleIcons.flatMap { it.second })
+        val mergedIcons = if (mergeSourceNames.get().isNotEmpty()) mergeSourceFonts(outputFile) else emptyList()
+        if (chunkGroupsFile.isPresent || moduleIcons.isNotEmpty()) {
+            // An icon the app draws itself is needed before any module is installed
+            val moduleGroups = moduleIcons.associate { (name, used) -> name to used - appIcons }
+            splitChunks(outputFile, icons + mergedIcons, moduleGroups)
+        }
+        if (previousFontFile.isPresent) {
+            writeFontDelta(previousFontFile.get().asFile, outputFile)
+        }
+    }
+
+    /**
+     * Subsets the font to [usedIcons] into [outputFile]; returns the used icons with
+     * their codepoints in it
+     */
+    private fun subsetFont(outputFile: File, usedIcons: Set<String>): List<Pair<String, Int>> {
         val fontFile = fontFile.get().asFile
         val codepointsFile = codepointsFile.get().asFile
-        val usageFile = usageDataFile.get().asFile
-        val outputFile = prepareOutputFile()
 
-        val usedIcons = loadUsedIcons(usageFile)
         if (usedIcons.isEmpty()) {
             copyFontWithoutSubsetting(fontFile, outputFile, "no icons used")
-            return
+            writeCodepointMapping(emptyList())
+            return emptyList()
         }
 
         val codepoints = loadCodepoints(codepointsFile, usedIcons)
         if (codepoints.isEmpty()) {
             logger.warn("No matching codepoints found")
             copyFontWithoutSubsetting(fontFile, outputFile, "no matching codepoints")
+            writeCodepointMapping(emptyList())
+            return emptyList()
+        }
+
+        val requested = codepoints.toIntArray()
+        val remapped = if (denseCodepoints.get()) IntArray(requested.size) else null
+        val priority = glyphPriorityFile.orNull?.asFile?.let { loadPriorityCodepoints(it, codepointsFile, usedIcons) }
+        performSubsetting(fontFile, outputFile, requested, remapped, priority)
+
+        val icons = loadIconCodepoints(codepointsFile, usedIcons)
+        // A skipped remap hands back the original codepoints, so this is then the same as icons
+        val mapping = if (remapped != null) {
+            val newCodepoints = requested.indices
+                .filter { remapped[it] != 0 }
+                .associate { requested[it] to remapped[it] }
+            icons.mapNotNull { (name, codepoint) -> newCodepoints[codepoint]?.let { name to it } }
+        } else {
+            icons
+        }
+        writeCodepointMapping(mapping)
+        return mapping
+    }
+
+    private fun writeCodepointMapping(mapping: List<Pair<String, Int>>) {
+        val file = codepointMappingFile.orNull?.asFile ?: return
+        writeMappingFile(file, mapping)
+    }
+
+    private fun writeMappingFile(file: File, mapping: List<Pair<String, Int>>) {
+        file.parentFile?.mkdirs()
+        file.writeText(mapping.joinToString("") { (name, codepoint) -> "$name ${codepoint.toString(16)}\n" })
+    }
+
+    /**
+     * Appends the glyphs of the [mergeFontFiles] to [outputFile] and writes each
+     * source's icons with their codepoints in the merged font to [mergeMappingDirectory].
+     * Sources without used icons are skipped. Returns the merged icons with their codepoints.
+     */
+    private fun mergeSourceFonts(outputFile: File): List<Pair<String, Int>> {
+        val names = mergeSourceNames.get()
+        val fontFiles = mergeFontFiles.get().map { it.asFile }
+        val mappings = mergeCodepointFiles.get().map { file ->
+            file.asFile.readLines().mapNotNull { line ->
+                val parts = line.split(' ', '\t', limit = 2)
+                if (parts.size < 2) null else parts[0] to parts[1].trim().toInt(16)
+            }
+        }
+        val mappingDir = mergeMappingDirectory.get().asFile
+        mappingDir.mkdirs()
+
+        val merged = names.indices.filter { mappings[it].isNotEmpty() }
+        names.indices.filter { it !in merged }.forEach { index ->
+            logger.lifecycle("Nothing to merge from '${names[index]}' (no icons used)")
+            writeMappingFile(File(mappingDir, "${names[index]}.txt"), emptyList())
+        }
+        if (merged.isEmpty()) return emptyList()
+
+        val codepoints = merged.map { index -> mappings[index].map { it.second }.toIntArray() }.toTypedArray()
+        val success = try {
+            NativeSubsetterFactory(logger).getSubsetter().mergeFonts(
+                primaryFontPath = outputFile.absolutePath,
+                outputFontPath = outputFile.absolutePath,
+                sourceFontPaths = merged.map { fontFiles[it].absolutePath },
+                sourceCodepoints = codepoints,
+                localityLayout = glyphPriorityFile.isPresent
+            )
+        } catch (e: Exception) {
+            throw GradleException("Failed to merge fonts into '${outputFile.name}': ${e.message}", e)
+        }
+        if (!success) {
+            throw GradleException(
+                "Failed to merge ${merged.joinToString { "'${names[it]}'" }} into '${outputFile.name}'; see the log for the reason"
+            )
+        }
+
+        val mergedIcons = merged.flatMapIndexed { i, index ->
+            val mapping = mappings[index].zip(codepoints[i].toList())
+                .filter { (_, codepoint) -> codepoint != 0 }
+                .map { (icon, codepoint) -> icon.first to codepoint }
+            writeMappingFile(File(mappingDir, "${names[index]}.txt"), mapping)
+            mapping
+        }
+        logger.lifecycle("Merged ${merged.size} fonts: ${outputFile.length() / 1024}KB")
+        return mergedIcons
+    }
+
+    /**
+     * Splits [outputFile] into a base font and one chunk per group of [chunkGroupsFile]
+     * and of [moduleGroups] (module name to icons), written to [chunkDirectory]. [icons]
+     * are the used icons with their codepoints in [outputFile]; names in the groups file
+     * may be raw or property names, and unused ones are ignored. Icons in several groups
+     * stay in the base.
+     */
+    private fun splitChunks(
+        outputFile: File,
+        icons: List<Pair<String, Int>>,
+        moduleGroups: Map<String, Set<String>>
+    ) {
+        val chunkDir = chunkDirectory.get().asFile
+        chunkDir.deleteRecursively()
+        chunkDir.mkdirs()
+
+        val byName = icons.toMap() + icons.associate { (name, codepoint) ->
+            KotlinNamingService.toPropertyName(name) to codepoint
+        }
+        val groups = linkedMapOf<String, MutableSet<Int>>()
+        chunkGroupsFile.orNull?.asFile?.readLines().orEmpty()
+            .map { it.trim() }
+            .filter { it.isNotEmpty() && !it.startsWith("#") }
+            .forEach { line ->
+                val parts = line.split(' ', '\t').filter { it.isNotEmpty() }
+                if (parts.size != 2) {
+                    throw GradleException("Invalid chunk group line '$line'; expected 'icon_name group'")
+                }
+                val (name, group) = parts
+                if (!CHUNK_GROUP_NAME.matches(group)) {
+                    throw GradleException("Invalid chunk group '$group'; use letters, digits, '_' and '-'")
+                }
+                byName[name]?.let { groups.getOrPut(group) { mutableSetOf() }.add(it) }
+            }
+        moduleGroups.forEach { (module, used) ->
+            if (!CHUNK_GROUP_NAME.matches(module)) {
+                throw GradleException("Invalid feature module name '$module'; use letters, digits, '_' and '-'")
+            }
+            used.mapNotNullTo(groups.getOrPut(module) { mutableSetOf() }) { byName[it] }
+        }
+        groups.values.removeAll { it.isEmpty() }
+        if (groups.isEmpty()) {
+            logger.lifecycle("No chunks split off '${outputFile.name}' (no grouped icons used)")
             return
         }
 
-        performSubsetting(fontFile, outputFile, codepoints)
+        val chunkNames = groups.keys.map { "${outputFile.nameWithoutExtension}_$it.chunk" }
+        val success = try {
+            NativeSubsetterFactory(logger).getSubsetter().splitChunks(
+                fontPath = outputFile.absolutePath,
+                outputFontPath = outputFile.absolutePath,
+                chunkDirectory = chunkDir.absolutePath,
+                chunkNames = chunkNames,
+                chunkCodepoints = groups.values.map { it.toIntArray() }.toTypedArray(),
+                localityLayout = glyphPriorityFile.isPresent
+            )
+        } catch (e: Exception) {
+            throw GradleException("Failed to split '${outputFile.name}' into chunks: ${e.message}", e)
+        }
+        if (!success) {
+            throw GradleException("Failed to split '${outputFile.name}' into chunks; see the log for the reason")
+        }
+
+        val chunks = chunkDir.listFiles().orEmpty()
+        logger.lifecycle(
+            "Split ${chunks.size} chunks off '${outputFile.name}': ${outputFile.length() / 1024}KB base, " +
+            "${chunks.sumOf { it.length() } / 1024}KB in chunks"
+        )
+    }
+
+    /** Writes [deltaFile], which rebuilds [outputFile] from [previousFile] */
+    private fun writeFontDelta(previousFile: File, outputFile: File) {
+        val deltaFile = deltaFile.get().asFile
+        deltaFile.parentFile?.mkdirs()
+        val success = try {
+            NativeSubsetterFactory(logger).getSubsetter().createFontDelta(
+                previousFontPath = previousFile.absolutePath,
+                fontPath = outputFile.absolutePath,
+                deltaPath = deltaFile.absolutePath
+            )
+        } catch (e: Exception) {
+            throw GradleException("Failed to create a delta for '${outputFile.name}': ${e.message}", e)
+        }
+        if (!success) {
+            throw GradleException("Failed to create a delta for '${outputFile.name}'; see the log for the reason")
+        }
+        logger.lifecycle(
+            "Font delta from '${previousFile.name}': ${deltaFile.length() / 1024}KB " +
+            "instead of ${outputFile.length() / 1024}KB"
+        )
     }
 
     private fun prepareOutputFile(): File {
@@ -89,7 +354,13 @@ abstract class FontSubsettingTask : DefaultTask() {
         logger.lifecycle("Copied font without subsetting ($reason)")
     }
 
-    private fun performSubsetting(fontFile: File, outputFile: File, codepoints: Set<Int>) {
+    private fun performSubsetting(
+        fontFile: File,
+        outputFile: File,
+        codepoints: IntArray,
+        remapped: IntArray?,
+        priority: IntArray?
+    ) {
         try {
             val subsetter = NativeSubsetterFactory(logger).getSubsetter()
             val axisConfigs = convertAxisConfigs()
@@ -97,10 +368,14 @@ abstract class FontSubsettingTask : DefaultTask() {
             subsetter.subsetFontWithAxesAndFlags(
                 inputFontPath = fontFile.absolutePath,
                 outputFontPath = outputFile.absolutePath,
-                codepoints = codepoints.toIntArray(),
+                codepoints = codepoints,
                 axisConfigs = axisConfigs,
                 stripHinting = stripHinting.get(),
-                stripGlyphNames = stripGlyphNames.get()
+                stripGlyphNames = stripGlyphNames.get(),
+                removeOverlaps = removeOverlaps.get(),
+                codepointOnly = codepointOnly.get(),
+                denseCodepoints = remapped,
+                priorityCodepoints = priority
             )
 
             logSubsettingResults(fontFile, outputFile, codepoints.size)
@@ -133,7 +408,11 @@ abstract class FontSubsettingTask : DefaultTask() {
     }
 
     private fun loadCodepoints(codepointsFile: File, usedIcons: Set<String>): Set<Int> {
-        val codepoints = mutableSetOf<Int>()
+        return loadIconCodepoints(codepointsFile, usedIcons).mapTo(mutableSetOf()) { it.second }
+    }
+
+    private fun loadIconCodepoints(codepointsFile: File, usedIcons: Set<String>): List<Pair<String, Int>> {
+        val icons = mutableListOf<Pair<String, Int>>()
 
         codepointsFile.readLines().forEach { line ->
             val parts = line.split(' ', '\t', limit = 2)
@@ -143,11 +422,30 @@ abstract class FontSubsettingTask : DefaultTask() {
 
             val propertyName = KotlinNamingService.toPropertyName(codepointName)
             if (propertyName in usedIcons) {
-                codepoints.add(codepointHex.toInt(16))
+                icons.add(codepointName to codepointHex.toInt(16))
             }
         }
 
-        return codepoints
+        return icons
+    }
+
+    /** Codepoints of the used icons listed in [priorityFile], in its order; names may be raw or property names */
+    private fun loadPriorityCodepoints(priorityFile: File, codepointsFile: File, usedIcons: Set<String>): IntArray {
+        val icons = loadIconCodepoints(codepointsFile, usedIcons)
+        val byName = icons.toMap() + icons.associate { (name, codepoint) ->
+            KotlinNamingService.toPropertyName(name) to codepoint
+        }
+
+        val names = priorityFile.readLines().map { it.trim() }.filter { it.isNotEmpty() && !it.startsWith("#") }
+        val unknown = names.filter { it !in byName }
+        if (unknown.isNotEmpty()) {
+            logger.info("Ignoring ${unknown.size} priority icons that are not used: ${unknown.take(5).joinToString()}")
+        }
+        return names.mapNotNull { byName[it] }.distinct().toIntArray()
+    }
+
+    private companion object {
+        val CHUNK_GROUP_NAME = Regex("[A-Za-z0-9_-]+")
     }
 
     data class AxisConfig(
@@ -9,6 +9,7 @@ import org.gradle.api.provider.Property
 import org.gradle.api.tasks.CacheableTask
 import org.gradle.api.tasks.Input
 import org.gradle.api.tasks.InputFile
+import org.gradle.api.tasks.Optional
 import org.gradle.api.tasks.OutputDirectory
 import org.gradle.api.tasks.PathSensitive
 import org.gradle.api.tasks.PathSensitivity
@@ -22,6 +23,12 @@ abstract class GenerateIconConstantsTask : DefaultTask() {
     @get:PathSensitive(PathSensitivity.RELATIVE)
     abstract val codepointsFile: RegularFileProperty
 
+    /** Dense codepoints written by the subset task; they replace [codepointsFile]'s for the icons listed */
+    @get:InputFile
+    @get:Optional
+    @get:PathSensitive(PathSensitivity.NONE)
+    abstract val remappedCodepointsFile: RegularFileProperty
+
     @get:Input
     abstract val fullyQualifiedClassName: Property<String>
 
@@ -39,8 +46,12 @@ abstract class GenerateIconConstantsTask : DefaultTask() {
 
         val provider = CodepointsFileProvider(codepointsFile)
         val mappings = provider.provideMappings()
+        val remapped = remappedCodepointsFile.orNull?.asFile
+            ?.let { CodepointsFileProvider(it).provideMappings() }
+            .orEmpty()
+            .associate { it.name to it.codepoint }
 
-        val kotlinCode = KotlinCodeGenerator.generate(packageName, className, mappings)
+        val kotlinCode = KotlinCodeGenerator.generate(packageName, className, mappings, remapped)
         val outputDir = outputDirectory.get().asFile
         val packageDir = if (packageName.isNotEmpty()) {
             File(outputDir, packageName.replace('.', '/'))
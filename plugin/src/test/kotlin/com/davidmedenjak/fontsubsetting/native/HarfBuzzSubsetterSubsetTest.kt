@@ -7,6 +7,7 @@ import org.junit.Rule
 import org.junit.Test
 import org.junit.rules.TemporaryFolder
 import java.io.File
+import java.nio.ByteBuffer
 
 /**
  * Tests for low-level font subsetting via subsetFontWithAxesAndFlags().
@@ -50,6 +51,159 @@ class HarfBuzzSubsetterSubsetTest {
     private fun outputFile(name: String = "output.ttf"): File =
         File(tempFolder.root, name)
 
+    /** Each glyph's record in [tag] ("glyf" through loca, or "gvar"), for comparing outlines */
+    private fun glyphRecords(font: ByteArray, tag: String): List<List<Byte>> {
+        val buffer = ByteBuffer.wrap(font)
+        fun u16(offset: Int) = buffer.getShort(offset).toInt() and 0xFFFF
+        val tables = (0 until u16(4)).associate { i ->
+            String(font, 12 + i * 16, 4, Charsets.US_ASCII) to buffer.getInt(12 + i * 16 + 8)
+        }
+        val glyphCount = u16(tables.getValue("maxp") + 4)
+        val offsets = if (tag == "glyf") {
+            val loca = tables.getValue("loca")
+            val longLoca = buffer.getShort(tables.getValue("head") + 50).toInt() == 1
+            (0..glyphCount).map {
+                tables.getValue("glyf") + if (longLoca) buffer.getInt(loca + it * 4) else u16(loca + it * 2) * 2
+            }
+        } else {
+            val gvar = tables.getValue("gvar")
+            val longOffsets = u16(gvar + 14) and 1 == 1
+            val data = gvar + buffer.getInt(gvar + 16)
+            (0..glyphCount).map {
+                data + if (longOffsets) buffer.getInt(gvar + 20 + it * 4) else u16(gvar + 20 + it * 2) * 2
+            }
+        }
+        return (0 until glyphCount).map { font.copyOfRange(offsets[it], offsets[it + 1]).toList() }
+    }
+
+    /** The bytes of table [tag] of [font] */
+    private fun tableBytes(font: ByteArray, tag: String): ByteArray {
+        val buffer = ByteBuffer.wrap(font)
+        val entry = (0 until (buffer.getShort(4).toInt() and 0xFFFF)).map { 12 + it * 16 }
+            .first { String(font, it, 4, Charsets.US_ASCII) == tag }
+        val offset = buffer.getInt(entry + 8)
+        return font.copyOfRange(offset, offset + buffer.getInt(entry + 12))
+    }
+
+    /** Copies the test resource fonts/[name] into the temp folder */
+    private fun fixture(name: String): File = outputFile(name).also { file ->
+        javaClass.getResourceAsStream("/fonts/$name")!!.use { input -> file.outputStream().use { input.copyTo(it) } }
+    }
+
+    private data class GlyphPoint(val x: Int, val y: Int, val onCurve: Boolean)
+
+    /** The contours of simple glyph [glyphId] */
+    private fun contours(font: ByteArray, glyphId: Int): List<List<GlyphPoint>> {
+        val glyph = ByteBuffer.wrap(glyphRecords(font, "glyf")[glyphId].toByteArray())
+        val contourCount = glyph.getShort(0).toInt()
+        val ends = (0 until contourCount).map { glyph.getShort(10 + it * 2).toInt() and 0xFFFF }
+        val pointCount = (ends.lastOrNull() ?: -1) + 1
+        var pos = 10 + contourCount * 2
+        pos += 2 + (glyph.getShort(pos).toInt() and 0xFFFF)
+
+        val flags = IntArray(pointCount)
+        var i = 0
+        while (i < pointCount) {
+            val flag = glyph.get(pos++).toInt() and 0xFF
+            val repeats = if (flag and 0x08 != 0) glyph.get(pos++).toInt() and 0xFF else 0
+            repeat(repeats + 1) { flags[i++] = flag }
+        }
+        fun coordinates(shortBit: Int, sameBit: Int) = IntArray(pointCount).also { values ->
+            var value = 0
+            for (p in 0 until pointCount) {
+                value += when {
+                    flags[p] and shortBit != 0 -> (glyph.get(pos++).toInt() and 0xFF).let { if (flags[p] and sameBit != 0) it else -it }
+                    flags[p] and sameBit != 0 -> 0
+                    else -> glyph.getShort(pos).toInt().also { pos += 2 }
+                }
+                values[p] = value
+            }
+        }
+        val xs = coordinates(0x02, 0x10)
+        val ys = coordinates(0x04, 0x20)
+        return ends.indices.map { c ->
+            ((if (c == 0) 0 else ends[c - 1] + 1)..ends[c]).map { GlyphPoint(xs[it], ys[it], flags[it] and 0x01 != 0) }
+        }
+    }
+
+    /**
+     * Cells of a 10-unit grid filled by straight-edged glyph [glyphId] under the
+     * nonzero rule; exact for outlines on that grid, overlapping or not
+     */
+    private fun filledCells(font: ByteArray, glyphId: Int): Int {
+        val edges = contours(font, glyphId).flatMap { points -> points.indices.map { points[it] to points[(it + 1) % points.size] } }
+        var filled = 0
+        for (x in 5 until 1000 step 10) {
+            for (y in 5 until 1000 step 10) {
+                val winding = edges.sumOf { (a, b) ->
+                    val side = (b.x - a.x) * (y - a.y) - (x - a.x) * (b.y - a.y)
+                    when {
+                        a.y <= y && y < b.y && side < 0 -> 1
+                        b.y <= y && y < a.y && side > 0 -> -1
+                        else -> 0
+                    }
+                }
+                if (winding != 0) filled++
+            }
+        }
+        return filled
+    }
+
+    /** Points along the quadratic spline of [contour], off-curve pairs implying the on-curve point between them */
+    private fun splinePoints(contour: List<GlyphPoint>): List<Pair<Double, Double>> {
+        val start = contour.indexOfFirst { it.onCurve }
+        val points = (contour.indices.map { contour[(start + it) % contour.size] } + contour[start])
+            .map { Triple(it.x.toDouble(), it.y.toDouble(), it.onCurve) }
+        val samples = mutableListOf<Pair<Double, Double>>()
+        var from = points[0].first to points[0].second
+        var control: Pair<Double, Double>? = null
+        fun curveTo(to: Pair<Double, Double>) {
+            val c = control ?: (from.first + to.first) / 2 to (from.second + to.second) / 2
+            for (step in 0..10) {
+                val t = step / 10.0
+                val u = 1 - t
+                samples += (u * u * from.first + 2 * u * t * c.first + t * t * to.first) to
+                    (u * u * from.second + 2 * u * t * c.second + t * t * to.second)
+            }
+            from = to
+            control = null
+        }
+        for ((x, y, onCurve) in points.drop(1)) {
+            val current = control
+            when {
+                onCurve -> curveTo(x to y)
+                current != null -> {
+                    curveTo((current.first + x) / 2 to (current.second + y) / 2)
+                    control = x to y
+                }
+                else -> control = x to y
+            }
+        }
+        return samples
+    }
+
+    /**
+     * Points along the circle fixtures' outline: radius [radius] around (500, 400)
+     * from four cubics with handles of round(0.5523 * radius), as in their charstrings
+     */
+    private fun circleCubicPoints(radius: Int): List<Pair<Double, Double>> {
+        val k = Math.round(radius * 0.5522847498).toInt()
+        val (x, y, r) = Triple(500, 400, radius)
+        val p = listOf(
+            x + r to y, x + r to y + k, x + k to y + r, x to y + r, x - k to y + r, x - r to y + k,
+            x - r to y, x - r to y - k, x - k to y - r, x to y - r, x + k to y - r, x + r to y - k, x + r to y
+        ).map { (px, py) -> px.toDouble() to py.toDouble() }
+        return (0 until 4).flatMap { c ->
+            val (a, b, d, e) = p.subList(c * 3, c * 3 + 4)
+            (0..2000).map { step ->
+                val t = step / 2000.0
+                val u = 1 - t
+                (u * u * u * a.first + 3 * u * u * t * b.first + 3 * u * t * t * d.first + t * t * t * e.first) to
+                    (u * u * u * a.second + 3 * u * u * t * b.second + 3 * u * t * t * d.second + t * t * t * e.second)
+            }
+        }
+    }
+
     // --- Basic subsetting ---
 
     @Test
@@ -253,6 +407,348 @@ class HarfBuzzSubsetterSubsetTest {
         assertThat(restricted.length()).isLessThan(full.length())
     }
 
+    @Test
+    fun `pin axis at non-default value drops it`() {
+        val output = outputFile()
+        val axes = listOf(
+            HarfBuzzSubsetter.AxisConfig(tag = "wght", minValue = 600f, maxValue = 600f, defaultValue = 600f)
+        )
+        val result = subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, output.absolutePath,
+            TEN_ICONS, axes
+        )
+        assertThat(result).isTrue()
+        val info = subsetter.getFontInfoDetailed(output.absolutePath)!!
+        assertThat(info.axes).hasSize(3)
+        assertThat(info.axes!!.map { it.tag }).doesNotContain("wght")
+    }
+
+    @Test
+    fun `remove overlaps keeps glyphs and axes`() {
+        val plain = outputFile("plain.ttf")
+        val merged = outputFile("merged.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, plain.absolutePath, TEN_ICONS, emptyList()
+        )).isTrue()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, merged.absolutePath, TEN_ICONS, emptyList(),
+            removeOverlaps = true
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(merged.absolutePath)).isTrue()
+        val plainInfo = subsetter.getFontInfoDetailed(plain.absolutePath)!!
+        val mergedInfo = subsetter.getFontInfoDetailed(merged.absolutePath)!!
+        assertThat(mergedInfo.glyphCount).isEqualTo(plainInfo.glyphCount)
+        assertThat(mergedInfo.axes!!.map { it.tag }).isEqualTo(plainInfo.axes!!.map { it.tag })
+    }
+
+    @Test
+    fun `remove overlaps merges contours without changing the filled area`() {
+        // Two overlapping squares; at wght 700 the second one moves 100 units right
+        val font = fixture("overlap.ttf")
+        val plain = outputFile("plain.ttf")
+        val merged = outputFile("merged.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            font.absolutePath, plain.absolutePath, intArrayOf(0xE000), emptyList()
+        )).isTrue()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            font.absolutePath, merged.absolutePath, intArrayOf(0xE000), emptyList(),
+            removeOverlaps = true
+        )).isTrue()
+        assertThat(contours(merged.readBytes(), 1).size).isLessThan(contours(plain.readBytes(), 1).size)
+
+        // At the default and at the gvar peak, each instanced from the variable font
+        val areas = listOf(400f, 700f).map { wght ->
+            val pin = listOf(HarfBuzzSubsetter.AxisConfig(tag = "wght", minValue = wght, maxValue = wght, defaultValue = wght))
+            val plainInstance = outputFile("plain-$wght.ttf")
+            val mergedInstance = outputFile("merged-$wght.ttf")
+            assertThat(subsetter.subsetFontWithAxesAndFlags(
+                plain.absolutePath, plainInstance.absolutePath, intArrayOf(0xE000), pin
+            )).isTrue()
+            assertThat(subsetter.subsetFontWithAxesAndFlags(
+                merged.absolutePath, mergedInstance.absolutePath, intArrayOf(0xE000), pin
+            )).isTrue()
+            assertThat(filledCells(mergedInstance.readBytes(), 1)).isEqualTo(filledCells(plainInstance.readBytes(), 1))
+            filledCells(mergedInstance.readBytes(), 1)
+        }
+        assertThat(areas).containsExactly(2800, 3000)
+    }
+
+    // The circle fixtures' upem / 1000
+    private val CIRCLE_TOLERANCE = 1.0
+
+    /** How far the outline of glyph 1 of [font] strays from the circle fixtures' cubics of [radius] */
+    private fun circleDeviation(font: File, radius: Int): Double {
+        val reference = circleCubicPoints(radius)
+        return contours(font.readBytes(), 1).flatMap { splinePoints(it) }.maxOf { (x, y) ->
+            reference.minOf { (rx, ry) -> Math.hypot(x - rx, y - ry) }
+        }
+    }
+
+    /** Shoelace area of [contour]'s points; negative for TrueType's clockwise contours */
+    private fun signedArea(contour: List<GlyphPoint>): Long =
+        contour.indices.sumOf { i ->
+            val a = contour[i]
+            val b = contour[(i + 1) % contour.size]
+            a.x.toLong() * b.y - b.x.toLong() * a.y
+        } / 2
+
+    @Test
+    fun `CFF outlines become clockwise glyf outlines within a thousandth of an em`() {
+        // A circle of radius 300 from four cubics, drawn counter-clockwise as CFF does
+        val output = outputFile()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fixture("circle.otf").absolutePath, output.absolutePath, intArrayOf(0xE000), emptyList()
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(output.absolutePath)).isTrue()
+        val info = subsetter.getFontInfoDetailed(output.absolutePath)!!
+        assertThat(info.tables).contains("glyf", "loca")
+        assertThat(info.tables).doesNotContain("CFF ")
+        assertThat(circleDeviation(output, 300)).isLessThanOrEqualTo(CIRCLE_TOLERANCE)
+        assertThat(contours(output.readBytes(), 1).map { signedArea(it) }).isNotEmpty().allMatch { it < 0 }
+    }
+
+    @Test
+    fun `CFF2 blends become gvar tuples`() {
+        // The circle's radius blends from 300 at wght 400 to 350 at wght 700
+        val output = outputFile()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fixture("circle-variable.otf").absolutePath, output.absolutePath, intArrayOf(0xE000), emptyList()
+        )).isTrue()
+
+        val info = subsetter.getFontInfoDetailed(output.absolutePath)!!
+        assertThat(info.tables).contains("glyf", "loca", "gvar")
+        assertThat(info.tables).doesNotContain("CFF2")
+        val tupleCount = ByteBuffer.wrap(glyphRecords(output.readBytes(), "gvar")[1].toByteArray()).getShort(0).toInt() and 0x0FFF
+        assertThat(tupleCount).isGreaterThan(0)
+
+        val bold = outputFile("bold.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            output.absolutePath, bold.absolutePath, intArrayOf(0xE000),
+            listOf(HarfBuzzSubsetter.AxisConfig(tag = "wght", minValue = 700f, maxValue = 700f, defaultValue = 700f))
+        )).isTrue()
+        assertThat(circleDeviation(output, 300)).isLessThanOrEqualTo(CIRCLE_TOLERANCE)
+        assertThat(circleDeviation(bold, 350)).isLessThanOrEqualTo(CIRCLE_TOLERANCE)
+    }
+
+    @Test
+    fun `codepoint only drops layout tables and ligature glyphs`() {
+        val full = outputFile("full.ttf")
+        val bare = outputFile("bare.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, full.absolutePath, TEN_ICONS, emptyList()
+        )).isTrue()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, bare.absolutePath, TEN_ICONS, emptyList(),
+            codepointOnly = true
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(bare.absolutePath)).isTrue()
+        val fullInfo = subsetter.getFontInfoDetailed(full.absolutePath)!!
+        val bareInfo = subsetter.getFontInfoDetailed(bare.absolutePath)!!
+        assertThat(fullInfo.tables).contains("GSUB")
+        assertThat(bareInfo.tables).contains("cmap", "glyf", "gvar")
+        assertThat(bareInfo.tables).doesNotContain("GSUB", "GPOS", "GDEF", "STAT")
+        assertThat(bareInfo.glyphCount).isLessThanOrEqualTo(fullInfo.glyphCount)
+        assertThat(bare.length()).isLessThan(full.length())
+    }
+
+    @Test
+    fun `dense codepoints are contiguous from the private use area`() {
+        val output = outputFile()
+        val dense = IntArray(TEN_ICONS.size)
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, output.absolutePath, TEN_ICONS, emptyList(),
+            codepointOnly = true,
+            denseCodepoints = dense
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(output.absolutePath)).isTrue()
+        val info = subsetter.getFontInfoDetailed(output.absolutePath)!!
+        assertThat(dense).doesNotContain(0)
+        assertThat(dense.toSet()).isEqualTo((0xE000 until 0xE000 + info.glyphCount - 1).toSet())
+    }
+
+    @Test
+    fun `dense codepoints that do not fit keep the original codepoints`() {
+        // 6401 cmapped glyphs at U+F0000.., one more than U+E000..U+F8FF holds
+        val codepoints = IntArray(6401) { 0xF0000 + it }
+        val dense = IntArray(codepoints.size)
+        val output = outputFile()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fixture("many-glyphs.ttf").absolutePath, output.absolutePath, codepoints, emptyList(),
+            codepointOnly = true,
+            denseCodepoints = dense
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(output.absolutePath)).isTrue()
+        assertThat(dense).isEqualTo(codepoints)
+    }
+
+    @Test
+    fun `priority glyphs take the lowest glyph ids in order`() {
+        val output = outputFile()
+        val dense = IntArray(TEN_ICONS.size)
+        val priority = TEN_ICONS.reversedArray().copyOf(3)
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, output.absolutePath, TEN_ICONS, emptyList(),
+            codepointOnly = true,
+            denseCodepoints = dense,
+            priorityCodepoints = priority
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(output.absolutePath)).isTrue()
+        // Dense codepoints follow glyph order, so they reveal the new glyph ids
+        val byCodepoint = TEN_ICONS.indices.associate { TEN_ICONS[it] to dense[it] }
+        assertThat(priority.map { byCodepoint[it] }).containsExactly(0xE000, 0xE001, 0xE002)
+    }
+
+    @Test
+    fun `priority glyphs keep the glyph order while layout tables are kept`() {
+        val plain = outputFile("plain.ttf")
+        val prioritized = outputFile("prioritized.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, plain.absolutePath, TEN_ICONS, emptyList()
+        )).isTrue()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, prioritized.absolutePath, TEN_ICONS, emptyList(),
+            priorityCodepoints = TEN_ICONS.reversedArray().copyOf(3)
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(prioritized.absolutePath)).isTrue()
+        // Reordered glyphs would leave the ligatures' Coverage tables unsorted
+        val expected = plain.readBytes()
+        val actual = prioritized.readBytes()
+        assertThat(tableBytes(actual, "GSUB")).isEqualTo(tableBytes(expected, "GSUB"))
+        assertThat(glyphRecords(actual, "glyf")).isEqualTo(glyphRecords(expected, "glyf"))
+    }
+
+    @Test
+    fun `merged font moves colliding codepoints of the source`() {
+        val primary = outputFile("primary.ttf")
+        val source = outputFile("source.ttf")
+        val merged = outputFile("merged.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, primary.absolutePath, intArrayOf(HOME, SEARCH), emptyList(),
+            codepointOnly = true
+        )).isTrue()
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, source.absolutePath, intArrayOf(HOME, CLOSE), emptyList(),
+            codepointOnly = true
+        )).isTrue()
+
+        val codepoints = arrayOf(intArrayOf(HOME, CLOSE))
+        assertThat(subsetter.mergeFonts(
+            primary.absolutePath, merged.absolutePath, listOf(source.absolutePath), codepoints
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(merged.absolutePath)).isTrue()
+        val primaryInfo = subsetter.getFontInfoDetailed(primary.absolutePath)!!
+        val sourceInfo = subsetter.getFontInfoDetailed(source.absolutePath)!!
+        val mergedInfo = subsetter.getFontInfoDetailed(merged.absolutePath)!!
+        assertThat(mergedInfo.glyphCount).isEqualTo(primaryInfo.glyphCount + sourceInfo.glyphCount - 1)
+        assertThat(mergedInfo.axes?.map { it.tag }).isEqualTo(primaryInfo.axes?.map { it.tag })
+        assertThat(codepoints[0][0]).isNotEqualTo(HOME).isBetween(0xE000, 0xF8FF)
+        assertThat(codepoints[0][1]).isEqualTo(CLOSE)
+    }
+
+    @Test
+    fun `split font moves grouped glyphs into chunks`() {
+        val subset = outputFile("subset.ttf")
+        val base = outputFile("base.ttf")
+        val chunkDir = tempFolder.newFolder("chunks")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, subset.absolutePath, TEN_ICONS, emptyList(),
+            codepointOnly = true
+        )).isTrue()
+
+        assertThat(subsetter.splitChunks(
+            subset.absolutePath, base.absolutePath, chunkDir.absolutePath,
+            listOf("nav.chunk", "edit.chunk"),
+            arrayOf(intArrayOf(HOME, SEARCH, MENU), intArrayOf(ADD, DELETE))
+        )).isTrue()
+
+        assertThat(subsetter.validateFont(base.absolutePath)).isTrue()
+        val subsetInfo = subsetter.getFontInfoDetailed(subset.absolutePath)!!
+        val baseInfo = subsetter.getFontInfoDetailed(base.absolutePath)!!
+        assertThat(baseInfo.glyphCount).isEqualTo(subsetInfo.glyphCount)
+        assertThat(baseInfo.tables).contains("GCHK")
+        assertThat(base.length()).isLessThan(subset.length())
+        assertThat(chunkDir.list()).containsExactlyInAnyOrder("nav.chunk", "edit.chunk")
+    }
+
+    @Test
+    fun `split font chunks patch back to the unsplit outlines`() {
+        val subset = outputFile("subset.ttf")
+        val base = outputFile("base.ttf")
+        val patched = outputFile("patched.ttf")
+        val chunkDir = tempFolder.newFolder("chunks")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, subset.absolutePath, TEN_ICONS, emptyList(),
+            codepointOnly = true
+        )).isTrue()
+        assertThat(subsetter.splitChunks(
+            subset.absolutePath, base.absolutePath, chunkDir.absolutePath,
+            listOf("nav.chunk", "edit.chunk"),
+            arrayOf(intArrayOf(HOME, SEARCH, MENU), intArrayOf(ADD, DELETE))
+        )).isTrue()
+
+        // Out of order, as icons are drawn
+        val chunks = listOf("edit.chunk", "nav.chunk").map { File(chunkDir, it).absolutePath }
+        assertThat(subsetter.applyChunks(base.absolutePath, chunks, patched.absolutePath)).isTrue()
+
+        val expected = subset.readBytes()
+        val actual = patched.readBytes()
+        assertThat(glyphRecords(actual, "glyf")).isEqualTo(glyphRecords(expected, "glyf"))
+        assertThat(glyphRecords(actual, "gvar")).isEqualTo(glyphRecords(expected, "gvar"))
+        assertThat(glyphRecords(base.readBytes(), "glyf")).isNotEqualTo(glyphRecords(expected, "glyf"))
+        // Only the base they were split from takes them
+        assertThat(subsetter.applyChunks(subset.absolutePath, chunks, outputFile("other.ttf").absolutePath)).isFalse()
+    }
+
+    @Test
+    fun `delta to a subset with one more icon is much smaller than the font`() {
+        val previous = outputFile("previous.ttf")
+        val current = outputFile("current.ttf")
+        val delta = outputFile("current.fdelta")
+        subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, previous.absolutePath, TEN_ICONS.copyOf(9), emptyList()
+        )
+        subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, current.absolutePath, TEN_ICONS, emptyList()
+        )
+
+        assertThat(subsetter.createFontDelta(previous.absolutePath, current.absolutePath, delta.absolutePath)).isTrue()
+        assertThat(delta.readBytes().copyOf(4).decodeToString()).isEqualTo("FDLT")
+        assertThat(delta.length()).isLessThan(current.length() / 2)
+    }
+
+    @Test
+    fun `delta rebuilds the new font only from its base`() {
+        val previous = outputFile("previous.ttf")
+        val current = outputFile("current.ttf")
+        val delta = outputFile("current.fdelta")
+        val rebuilt = outputFile("rebuilt.ttf")
+        subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, previous.absolutePath, TEN_ICONS.copyOf(9), emptyList()
+        )
+        subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, current.absolutePath, TEN_ICONS, emptyList()
+        )
+        assertThat(subsetter.createFontDelta(previous.absolutePath, current.absolutePath, delta.absolutePath)).isTrue()
+
+        assertThat(subsetter.applyFontDelta(previous.absolutePath, delta.absolutePath, rebuilt.absolutePath)).isTrue()
+        assertThat(rebuilt.readBytes()).isEqualTo(current.readBytes())
+
+        val wrongBase = outputFile("wrong.ttf")
+        subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, wrongBase.absolutePath, TEN_ICONS.copyOf(8), emptyList()
+        )
+        assertThat(subsetter.applyFontDelta(wrongBase.absolutePath, delta.absolutePath, outputFile("wrong-rebuilt.ttf").absolutePath))
+            .isFalse()
+    }
+
     @Test
     fun `remove all axes creates static font`() {
         val output = outputFile()
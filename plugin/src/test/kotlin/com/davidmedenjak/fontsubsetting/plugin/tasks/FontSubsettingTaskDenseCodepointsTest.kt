@@ -0,0 +1,66 @@
+package com.davidmedenjak.fontsubsetting.plugin.tasks
+
+import com.davidmedenjak.fontsubsetting.native.HarfBuzzSubsetter
+import com.davidmedenjak.fontsubsetting.plugin.services.KotlinNamingService
+import org.assertj.core.api.Assertions.assertThat
+import org.gradle.testfixtures.ProjectBuilder
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+
+/**
+ * Tests the codepoint mapping written for dense codepoints when the subset
+ * has too many glyphs to be renumbered.
+ */
+class FontSubsettingTaskDenseCodepointsTest {
+
+    @get:Rule
+    val tempFolder = TemporaryFolder()
+
+    @Before
+    fun setUp() {
+        assumeTrue(
+            "Native library not available on this platform",
+            HarfBuzzSubsetter.isNativeLibraryAvailable()
+        )
+    }
+
+    @Test
+    fun `icons keep their original codepoints when the remap is skipped`() {
+        // 6401 cmapped glyphs at U+F0000.., one more than U+E000..U+F8FF holds
+        val fontFile = File(tempFolder.root, "many-glyphs.ttf")
+        javaClass.getResourceAsStream("/fonts/many-glyphs.ttf")!!.use { input ->
+            fontFile.outputStream().use { input.copyTo(it) }
+        }
+        val icons = (0 until 6401).map { "icon_$it" to 0xF0000 + it }
+        val codepointsFile = File(tempFolder.root, "many-glyphs.codepoints").apply {
+            writeText(icons.joinToString("") { (name, codepoint) -> "$name ${codepoint.toString(16)}\n" })
+        }
+        val usageFile = File(tempFolder.root, "usage.txt").apply {
+            writeText(icons.joinToString("\n") { KotlinNamingService.toPropertyName(it.first) })
+        }
+        val mappingFile = File(tempFolder.root, "mapping.txt")
+
+        val project = ProjectBuilder.builder().withProjectDir(tempFolder.newFolder("project")).build()
+        val task = project.tasks.register("subsetIcons", FontSubsettingTask::class.java).get()
+        task.fontFile.set(fontFile)
+        task.codepointsFile.set(codepointsFile)
+        task.usageDataFile.set(usageFile)
+        task.stripHinting.set(true)
+        task.stripGlyphNames.set(true)
+        task.removeOverlaps.set(false)
+        task.codepointOnly.set(true)
+        task.denseCodepoints.set(true)
+        task.codepointMappingFile.set(mappingFile)
+        task.outputFileName.set("icons.ttf")
+        task.outputDirectory.set(File(tempFolder.root, "res"))
+        task.subsetFont()
+
+        assertThat(mappingFile.readLines()).isEqualTo(
+            icons.map { (name, codepoint) -> "$name ${codepoint.toString(16)}" }
+        )
+    }
+}
@@ -0,0 +1,114 @@
+package com.davidmedenjak.fontsubsetting.plugin.tasks
+
+import com.davidmedenjak.fontsubsetting.native.HarfBuzzSubsetter
+import org.assertj.core.api.Assertions.assertThat
+import org.gradle.testfixtures.ProjectBuilder
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+
+/**
+ * Tests splitting the subset font into one chunk per feature module.
+ */
+class FontSubsettingTaskModuleChunkTest {
+
+    @get:Rule
+    val tempFolder = TemporaryFolder()
+
+    private lateinit var subsetter: HarfBuzzSubsetter
+    private lateinit var fontFile: File
+    private lateinit var codepointsFile: File
+
+    // Codepoints from MaterialSymbolsOutlined.codepoints
+    private val HOME = 0xE9B2
+    private val SEARCH = 0xE8B6
+    private val ADD = 0xE145
+    private val MENU = 0xE5D2
+    private val DELETE = 0xE92E
+
+    @Before
+    fun setUp() {
+        assumeTrue(
+            "Native library not available on this platform",
+            HarfBuzzSubsetter.isNativeLibraryAvailable()
+        )
+        subsetter = HarfBuzzSubsetter()
+
+        fontFile = File(System.getProperty("test.font.path") ?: error("System property 'test.font.path' not set"))
+        codepointsFile = File(
+            System.getProperty("test.codepoints.path") ?: error("System property 'test.codepoints.path' not set")
+        )
+        assumeTrue("Font file not found: $fontFile", fontFile.exists())
+        assumeTrue("Codepoints file not found: $codepointsFile", codepointsFile.exists())
+    }
+
+    private fun usageFile(name: String, vararg icons: String): File =
+        File(tempFolder.root, name).apply { writeText(icons.joinToString("\n")) }
+
+    /** Runs the task for an app using home, a "profile" module and a "cart" module */
+    private fun runTask(): File {
+        val project = ProjectBuilder.builder().withProjectDir(tempFolder.newFolder("project")).build()
+        val task = project.tasks.register("subsetIcons", FontSubsettingTask::class.java).get()
+        task.fontFile.set(fontFile)
+        task.codepointsFile.set(codepointsFile)
+        task.usageDataFile.set(usageFile("app.txt", "home"))
+        task.stripHinting.set(true)
+        task.stripGlyphNames.set(true)
+        task.removeOverlaps.set(false)
+        task.codepointOnly.set(true)
+        task.denseCodepoints.set(false)
+        task.moduleNames.set(listOf("profile", "cart"))
+        task.moduleUsageFiles.set(listOf(
+            project.layout.file(project.provider { usageFile("profile.txt", "home", "search", "add") }),
+            project.layout.file(project.provider { usageFile("cart.txt", "add", "menu", "delete") })
+        ))
+        task.chunkDirectory.set(File(tempFolder.root, "chunks"))
+        task.outputFileName.set("symbols.ttf")
+        task.outputDirectory.set(File(tempFolder.root, "res"))
+
+        task.subsetFont()
+        return File(tempFolder.root, "res/font/symbols.ttf")
+    }
+
+    @Test
+    fun `each module gets a chunk named after it`() {
+        runTask()
+
+        assertThat(File(tempFolder.root, "chunks").list())
+            .containsExactlyInAnyOrder("symbols_profile.chunk", "symbols_cart.chunk")
+    }
+
+    @Test
+    fun `icons of the app or of several modules stay in the base`() {
+        val base = runTask()
+
+        // The same split with home and add left out of every group
+        val subset = File(tempFolder.root, "subset.ttf")
+        val expected = File(tempFolder.root, "expected.ttf")
+        assertThat(subsetter.subsetFontWithAxesAndFlags(
+            fontFile.absolutePath, subset.absolutePath, intArrayOf(HOME, SEARCH, ADD, MENU, DELETE), emptyList(),
+            codepointOnly = true
+        )).isTrue()
+        assertThat(subsetter.splitChunks(
+            subset.absolutePath, expected.absolutePath, tempFolder.newFolder("expected").absolutePath,
+            listOf("symbols_profile.chunk", "symbols_cart.chunk"),
+            arrayOf(intArrayOf(SEARCH), intArrayOf(MENU, DELETE))
+        )).isTrue()
+
+        assertThat(base.readBytes()).isEqualTo(expected.readBytes())
+    }
+
+    @Test
+    fun `module chunks patch the base back to the unsplit font`() {
+        val base = runTask()
+        val patched = File(tempFolder.root, "patched.ttf")
+
+        val chunks = listOf("symbols_cart.chunk", "symbols_profile.chunk")
+            .map { File(tempFolder.root, "chunks/$it").absolutePath }
+        assertThat(subsetter.applyChunks(base.absolutePath, chunks, patched.absolutePath)).isTrue()
+        assertThat(subsetter.validateFont(patched.absolutePath)).isTrue()
+    }
+}
@@ -12,6 +12,10 @@ version = providers.gradleProperty("version").getOrElse("1.0.0-SNAPSHOT")
 
 val harfbuzzVersion = providers.gradleProperty("harfbuzzVersion").get()
 val harfbuzzSha256 = providers.gradleProperty("harfbuzzSha256").get()
+// -PglyphRuntimeSfntReader=true swaps HarfBuzz for the built-in glyf/gvar reader.
+val sfntReader = providers.gradleProperty("glyphRuntimeSfntReader").map { it.toBoolean() }.getOrElse(false)
+// -PglyphRuntimeTracing=true compiles in native trace slices (ATrace on device).
+val nativeTracing = providers.gradleProperty("glyphRuntimeTracing").map { it.toBoolean() }.getOrElse(false)
 
 android {
     namespace = "com.davidmedenjak.fontsubsetting.runtime"
@@ -20,6 +24,7 @@ android {
     defaultConfig {
         minSdk = 24
         consumerProguardFiles("consumer-rules.pro")
+        testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
 
         externalNativeBuild {
             cmake {
@@ -28,6 +33,8 @@ android {
                     "-DCMAKE_BUILD_TYPE=MinSizeRel",
                     "-DHARFBUZZ_VERSION=$harfbuzzVersion",
                     "-DHARFBUZZ_SHA256=$harfbuzzSha256",
+                    "-DGLYPHRUNTIME_SFNT_READER=${if (sfntReader) "ON" else "OFF"}",
+                    "-DGLYPHRUNTIME_TRACING=${if (nativeTracing) "ON" else "OFF"}",
                 )
                 abiFilters("armeabi-v7a", "arm64-v8a", "x86_64")
             }
@@ -117,5 +124,8 @@ dependencies {
     implementation(libs.androidx.ui)
     implementation(libs.androidx.ui.graphics)
     implementation("androidx.compose.animation:animation-core")
+
+    androidTestImplementation(libs.androidx.junit)
+    androidTestImplementation(libs.androidx.runner)
 }
 
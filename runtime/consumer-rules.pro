@@ -1,3 +1,4 @@
 -keep class com.davidmedenjak.fontsubsetting.runtime.HarfBuzzGlyphExtractor {
     private native <methods>;
+    private void onNativeResult(long, int, float[]);
 }
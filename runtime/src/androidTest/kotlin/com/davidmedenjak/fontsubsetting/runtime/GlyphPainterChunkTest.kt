@@ -0,0 +1,77 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+import androidx.compose.ui.geometry.Size
+import androidx.compose.ui.graphics.Canvas
+import androidx.compose.ui.graphics.ImageBitmap
+import androidx.compose.ui.graphics.drawscope.CanvasDrawScope
+import androidx.compose.ui.unit.Density
+import androidx.compose.ui.unit.LayoutDirection
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/**
+ * Draws an icon whose outline was split into a chunk before and after the chunk
+ * is applied. The fixtures are two Material Symbols icons, add (U+E145) in the
+ * base font and search (U+E8B6) split off into its chunk.
+ */
+@RunWith(AndroidJUnit4::class)
+class GlyphPainterChunkTest {
+
+    private lateinit var extractor: HarfBuzzGlyphExtractor
+
+    @Before
+    fun setUp() {
+        assumeTrue(HarfBuzzGlyphExtractor.isNativeLibraryAvailable())
+        extractor = HarfBuzzGlyphExtractor.create(asset("chunked_base.ttf"))
+    }
+
+    @After
+    fun tearDown() {
+        if (::extractor.isInitialized) extractor.close()
+    }
+
+    private fun asset(name: String): ByteArray =
+        InstrumentationRegistry.getInstrumentation().context.assets.open(name).use { it.readBytes() }
+
+    /** Draws [painter] into a fresh bitmap and returns the number of painted pixels */
+    private fun paintedPixels(painter: GlyphPainter): Int {
+        val bitmap = ImageBitmap(SIZE, SIZE)
+        CanvasDrawScope().draw(Density(1f), LayoutDirection.Ltr, Canvas(bitmap), Size(SIZE.toFloat(), SIZE.toFloat())) {
+            with(painter) { draw(size) }
+        }
+        val pixels = IntArray(SIZE * SIZE)
+        bitmap.readPixels(pixels)
+        return pixels.count { it ushr 24 != 0 }
+    }
+
+    @Test
+    fun glyphOfAnAppliedChunkIsDrawnByAPainterThatDrewItMissing() {
+        val font = GlyphFont(extractor)
+        val painter = GlyphPainter(SEARCH, String(Character.toChars(SEARCH)), font)
+        assertEquals(0, paintedPixels(painter))
+
+        assertTrue(font.applyChunk(asset("chunked_search.chunk")))
+
+        assertTrue(paintedPixels(painter) > 0)
+    }
+
+    @Test
+    fun glyphOfTheBaseFontIsDrawnBeforeAnyChunk() {
+        val painter = GlyphPainter(ADD, String(Character.toChars(ADD)), GlyphFont(extractor))
+
+        assertTrue(paintedPixels(painter) > 0)
+    }
+
+    private companion object {
+        const val SIZE = 48
+        const val ADD = 0xE145
+        const val SEARCH = 0xE8B6
+    }
+}
@@ -0,0 +1,61 @@
+#include "font_delta.h"
+#include <string.h>
+
+#define DELTA_VERSION 1
+#define DELTA_HEADER  28
+
+#define OP_COPY   0
+#define OP_INSERT 1
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static uint32_t rd32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 0x811C9DC5u;
+    size_t i;
+    for (i = 0; i < size; i++) hash = (hash ^ data[i]) * 0x01000193u;
+    return hash;
+}
+
+size_t font_delta_output_size(const uint8_t* delta, size_t delta_size) {
+    if (!delta || delta_size < DELTA_HEADER) return 0;
+    if (rd32(delta) != FONT_DELTA_MAGIC || rd16(delta + 4) != DELTA_VERSION) return 0;
+    uint32_t size = rd32(delta + 16);
+    return size <= FONT_DELTA_MAX_SIZE ? size : 0;
+}
+
+int font_delta_apply(const uint8_t* old, size_t old_size, const uint8_t* delta, size_t delta_size,
+                     uint8_t* out, size_t out_size) {
+    if (!out || out_size == 0 || font_delta_output_size(delta, delta_size) != out_size) return -1;
+    if (!old || rd32(delta + 8) != old_size || rd32(delta + 12) != fnv1a(old, old_size)) return -1;
+
+    uint32_t op_count = rd32(delta + 24);
+    size_t pos = DELTA_HEADER, written = 0;
+    uint32_t i;
+    for (i = 0; i < op_count; i++) {
+        if (pos >= delta_size) return -1;
+        uint8_t kind = delta[pos++];
+        if (kind == OP_COPY) {
+            if (delta_size - pos < 8) return -1;
+            uint32_t offset = rd32(delta + pos), length = rd32(delta + pos + 4);
+            pos += 8;
+            if ((uint64_t)offset + length > old_size || length > out_size - written) return -1;
+            memcpy(out + written, old + offset, length);
+            written += length;
+        } else if (kind == OP_INSERT) {
+            if (delta_size - pos < 4) return -1;
+            uint32_t length = rd32(delta + pos);
+            pos += 4;
+            if (length > delta_size - pos || length > out_size - written) return -1;
+            memcpy(out + written, delta + pos, length);
+            pos += length;
+            written += length;
+        } else {
+            return -1;
+        }
+    }
+    if (written != out_size || pos != delta_size) return -1;
+    return fnv1a(out, out_size) == rd32(delta + 20) ? 0 : -1;
+}
@@ -0,0 +1,46 @@
+#ifndef FONT_DELTA_H
+#define FONT_DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Font deltas. The plugin can describe a new subset font as a delta against
+ * the previously shipped one, so an update only carries the tables and glyphs
+ * that changed (big-endian):
+ *
+ *   header: magic u32 ("FDLT"), version u16 (1), reserved u16,
+ *           old_size u32, old_hash u32, new_size u32, new_hash u32, op_count u32
+ *   op:     kind u8, then
+ *             0 (copy):   offset u32, length u32   bytes of the old font
+ *             1 (insert): length u32, data         bytes carried by the delta
+ *
+ * The ops write the new font front to back. Hashes are FNV-1a 32 over the
+ * whole file: a delta refuses any base but the one it was made from, and the
+ * rebuilt font is checked before it is returned.
+ */
+
+#define FONT_DELTA_MAGIC    0x46444C54u /* 'FDLT' */
+#define FONT_DELTA_MAX_SIZE (64u << 20)
+
+/* Size of the font |delta| rebuilds; 0 if the header is malformed or too large */
+size_t font_delta_output_size(const uint8_t* delta, size_t delta_size);
+
+/*
+ * Rebuilds the new font into |out|, which must hold exactly
+ * font_delta_output_size() bytes. Allocates nothing. Returns 0, or -1 if
+ * |old| is not the delta's base, an op is out of bounds, or the result
+ * doesn't match.
+ */
+int font_delta_apply(const uint8_t* old, size_t old_size, const uint8_t* delta, size_t delta_size,
+                     uint8_t* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_DELTA_H */
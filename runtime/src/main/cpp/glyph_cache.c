@@ -0,0 +1,318 @@
+#define _DEFAULT_SOURCE
+
+#include "glyph_cache.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC   0x43594C47u /* "GLYC" */
+#define CACHE_VERSION 1
+
+/* Icon subsets stay far below this; past it new outlines are simply not persisted */
+#define CACHE_MAX_BYTES ((size_t)8 << 20)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t axis_count;
+    uint64_t font_hash;
+} CacheHeader;
+
+typedef struct {
+    uint32_t glyph_id;
+    uint16_t kind;
+    uint16_t reserved;
+    uint32_t param;
+    uint32_t num_floats;
+} RecordHeader;
+
+_Static_assert(sizeof(CacheHeader) == 16, "CacheHeader layout");
+_Static_assert(sizeof(RecordHeader) == 16, "RecordHeader layout");
+
+/* Open addressing; offset 0 marks an empty slot since the file header lives there */
+typedef struct {
+    uint64_t hash;
+    uint32_t offset;
+} IndexSlot;
+
+struct GlyphCache {
+    int fd;
+    const uint8_t* map;
+    size_t map_size;
+    size_t end;                /* end of the records this instance knows about */
+    unsigned int axis_count;
+    size_t coords_bytes;       /* i16 coords padded to 4 bytes */
+
+    IndexSlot* slots;
+    unsigned int slot_mask;
+    unsigned int count;
+
+    uint8_t* scratch;          /* record assembly buffer for put */
+    size_t scratch_capacity;
+};
+
+/* --- Hashing --- */
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME  0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t h, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+uint64_t glyph_cache_hash(const uint8_t* data, size_t size) {
+    return fnv1a(FNV_OFFSET, data, size);
+}
+
+static int16_t coord_at(const int* coords, unsigned int i) {
+    return coords ? (int16_t)coords[i] : 0;
+}
+
+static uint64_t key_hash(const GlyphCache* c, uint32_t glyph_id, unsigned int kind,
+                         uint32_t param, const int* coords) {
+    uint32_t head[3] = { glyph_id, (uint32_t)kind, param };
+    uint64_t h = fnv1a(FNV_OFFSET, head, sizeof(head));
+    unsigned int i;
+    for (i = 0; i < c->axis_count; i++) {
+        int16_t v = coord_at(coords, i);
+        h = fnv1a(h, &v, sizeof(v));
+    }
+    return h;
+}
+
+/* --- Index --- */
+
+static int index_grow(GlyphCache* c) {
+    unsigned int cap = c->slots ? (c->slot_mask + 1) * 2 : 256;
+    IndexSlot* slots = (IndexSlot*)calloc(cap, sizeof(IndexSlot));
+    if (!slots) return -1;
+    if (c->slots) {
+        unsigned int i;
+        for (i = 0; i <= c->slot_mask; i++) {
+            if (!c->slots[i].offset) continue;
+            unsigned int j = (unsigned int)c->slots[i].hash & (cap - 1);
+            while (slots[j].offset) j = (j + 1) & (cap - 1);
+            slots[j] = c->slots[i];
+        }
+        free(c->slots);
+    }
+    c->slots = slots;
+    c->slot_mask = cap - 1;
+    return 0;
+}
+
+static int index_insert(GlyphCache* c, uint64_t hash, size_t offset) {
+    if ((c->count + 1) * 2 > (c->slots ? c->slot_mask + 1 : 0) && index_grow(c) != 0) return -1;
+    unsigned int j = (unsigned int)hash & c->slot_mask;
+    while (c->slots[j].offset) j = (j + 1) & c->slot_mask;
+    c->slots[j].hash = hash;
+    c->slots[j].offset = (uint32_t)offset;
+    c->count++;
+    return 0;
+}
+
+/* --- Mapping --- */
+
+static int remap(GlyphCache* c, size_t size) {
+    if (c->map) munmap((void*)c->map, c->map_size);
+    c->map = NULL;
+    c->map_size = 0;
+    if (!size) return 0;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    c->map = (const uint8_t*)map;
+    c->map_size = size;
+    return 0;
+}
+
+static size_t record_size(const GlyphCache* c, uint32_t num_floats) {
+    return sizeof(RecordHeader) + c->coords_bytes + (size_t)num_floats * sizeof(float);
+}
+
+static int record_matches(const GlyphCache* c, const uint8_t* record, uint32_t glyph_id,
+                          unsigned int kind, uint32_t param, const int* coords) {
+    RecordHeader rh;
+    memcpy(&rh, record, sizeof(rh));
+    if (rh.glyph_id != glyph_id || rh.kind != kind || rh.param != param) return 0;
+    const int16_t* stored = (const int16_t*)(record + sizeof(RecordHeader));
+    unsigned int i;
+    for (i = 0; i < c->axis_count; i++) {
+        if (stored[i] != coord_at(coords, i)) return 0;
+    }
+    return 1;
+}
+
+/* Indexes every complete record; returns the end of the last one */
+static size_t scan_records(GlyphCache* c, size_t file_size) {
+    size_t offset = sizeof(CacheHeader);
+    while (offset + sizeof(RecordHeader) <= file_size) {
+        RecordHeader rh;
+        memcpy(&rh, c->map + offset, sizeof(rh));
+        size_t len = record_size(c, rh.num_floats);
+        if (len > CACHE_MAX_BYTES || offset + len > file_size) break;
+
+        const int16_t* stored = (const int16_t*)(c->map + offset + sizeof(RecordHeader));
+        uint32_t head[3] = { rh.glyph_id, rh.kind, rh.param };
+        uint64_t h = fnv1a(FNV_OFFSET, head, sizeof(head));
+        h = fnv1a(h, stored, c->axis_count * sizeof(int16_t));
+        if (index_insert(c, h, offset) != 0) break;
+        offset += len;
+    }
+    return offset;
+}
+
+static int write_header(GlyphCache* c, uint64_t font_hash) {
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, (uint16_t)c->axis_count, font_hash };
+    if (ftruncate(c->fd, 0) != 0) return -1;
+    if (pwrite(c->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) return -1;
+    return 0;
+}
+
+/* --- Public API --- */
+
+GlyphCache* glyph_cache_open(const char* dir, uint64_t font_hash, unsigned int axis_count) {
+    char path[1024];
+    int n = snprintf(path, sizeof(path), "%s/glyphcache-%016llx.bin",
+                     dir, (unsigned long long)font_hash);
+    if (n < 0 || (size_t)n >= sizeof(path)) return NULL;
+
+    GlyphCache* c = (GlyphCache*)calloc(1, sizeof(GlyphCache));
+    if (!c) return NULL;
+    c->axis_count = axis_count;
+    c->coords_bytes = (axis_count * sizeof(int16_t) + 3) & ~(size_t)3;
+
+    c->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (c->fd < 0) {
+        free(c);
+        return NULL;
+    }
+
+    /* Exclusive while validating so a concurrent appender can't be mistaken for a torn record */
+    flock(c->fd, LOCK_EX);
+    struct stat st;
+    int ok = fstat(c->fd, &st) == 0;
+    size_t file_size = ok ? (size_t)st.st_size : 0;
+
+    int valid = 0;
+    if (ok && file_size >= sizeof(CacheHeader)) {
+        CacheHeader header;
+        valid = pread(c->fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+                header.magic == CACHE_MAGIC && header.version == CACHE_VERSION &&
+                header.axis_count == axis_count && header.font_hash == font_hash;
+    }
+
+    if (valid && remap(c, file_size) == 0) {
+        c->end = scan_records(c, file_size);
+        if (c->end < file_size) ftruncate(c->fd, (off_t)c->end);
+    } else if (ok && write_header(c, font_hash) == 0) {
+        c->end = sizeof(CacheHeader);
+    } else {
+        ok = 0;
+    }
+    flock(c->fd, LOCK_UN);
+
+    if (!ok) {
+        glyph_cache_close(c);
+        return NULL;
+    }
+    return c;
+}
+
+void glyph_cache_close(GlyphCache* c) {
+    if (!c) return;
+    remap(c, 0);
+    if (c->fd >= 0) close(c->fd);
+    free(c->slots);
+    free(c->scratch);
+    free(c);
+}
+
+int glyph_cache_get(
+    GlyphCache* c,
+    uint32_t glyph_id,
+    unsigned int kind,
+    uint32_t param,
+    const int* coords,
+    const float** out_data,
+    size_t* out_size
+) {
+    if (!c->count) return -1;
+    uint64_t h = key_hash(c, glyph_id, kind, param, coords);
+    unsigned int j = (unsigned int)h & c->slot_mask;
+    for (; c->slots[j].offset; j = (j + 1) & c->slot_mask) {
+        if (c->slots[j].hash != h) continue;
+
+        size_t offset = c->slots[j].offset;
+        /* Records appended since the last mapping need a remap before they can be read */
+        if (offset + sizeof(RecordHeader) + c->coords_bytes > c->map_size &&
+            remap(c, c->end) != 0) {
+            return -1;
+        }
+        const uint8_t* record = c->map + offset;
+        if (!record_matches(c, record, glyph_id, kind, param, coords)) continue;
+
+        RecordHeader rh;
+        memcpy(&rh, record, sizeof(rh));
+        if (offset + record_size(c, rh.num_floats) > c->map_size && remap(c, c->end) != 0) {
+            return -1;
+        }
+        *out_data = (const float*)(c->map + offset + sizeof(RecordHeader) + c->coords_bytes);
+        *out_size = rh.num_floats;
+        return 0;
+    }
+    return -1;
+}
+
+int glyph_cache_put(
+    GlyphCache* c,
+    uint32_t glyph_id,
+    unsigned int kind,
+    uint32_t param,
+    const int* coords,
+    const float* data,
+    size_t size
+) {
+    size_t len = record_size(c, (uint32_t)size);
+    if (size > UINT32_MAX || c->end + len > CACHE_MAX_BYTES) return -1;
+
+    if (len > c->scratch_capacity) {
+        uint8_t* grown = (uint8_t*)realloc(c->scratch, len);
+        if (!grown) return -1;
+        c->scratch = grown;
+        c->scratch_capacity = len;
+    }
+    RecordHeader rh = { glyph_id, (uint16_t)kind, 0, param, (uint32_t)size };
+    memcpy(c->scratch, &rh, sizeof(rh));
+    int16_t* stored = (int16_t*)(c->scratch + sizeof(RecordHeader));
+    memset(stored, 0, c->coords_bytes);
+    unsigned int i;
+    for (i = 0; i < c->axis_count; i++) stored[i] = coord_at(coords, i);
+    memcpy(c->scratch + sizeof(RecordHeader) + c->coords_bytes, data, size * sizeof(float));
+
+    /* Another process may have appended since open: write after whatever is there */
+    flock(c->fd, LOCK_EX);
+    struct stat st;
+    int result = -1;
+    if (fstat(c->fd, &st) == 0 && (size_t)st.st_size + len <= CACHE_MAX_BYTES) {
+        size_t offset = (size_t)st.st_size;
+        if (pwrite(c->fd, c->scratch, len, (off_t)offset) == (ssize_t)len) {
+            c->end = offset + len;
+            result = index_insert(c, key_hash(c, glyph_id, kind, param, coords), offset);
+        } else {
+            ftruncate(c->fd, (off_t)offset);
+        }
+    }
+    flock(c->fd, LOCK_UN);
+    return result;
+}
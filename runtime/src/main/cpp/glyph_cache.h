@@ -0,0 +1,74 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Persistent outline cache: one append-only file per font content hash,
+ * mmapped read-only and indexed in memory at open. Records are keyed by
+ * glyph id, a record kind with a kind-specific parameter, and the variation
+ * as normalized 2.14 coords, so warm launches serve paths straight from the
+ * mapping without touching the font.
+ *
+ * File layout (native endianness; the cache never leaves the device):
+ *   header: magic u32, version u16, axis_count u16, font_hash u64
+ *   record: glyph_id u32, kind u16, reserved u16, param u32, num_floats u32,
+ *           coords i16[axis_count] padded to 4 bytes, floats f32[num_floats]
+ * A torn trailing record (crash mid-append) is truncated away at open.
+ */
+
+typedef struct GlyphCache GlyphCache;
+
+/* Record kinds */
+#define GLYPH_CACHE_OUTLINE  0
+#define GLYPH_CACHE_LOD      1 /* param: LOD level */
+#define GLYPH_CACHE_MORPH    2 /* param: target glyph id */
+#define GLYPH_CACHE_STROKE   3 /* param: width in 1/4096 em << 4 | join << 2 | cap */
+#define GLYPH_CACHE_EMBOLDEN 4 /* param: strength in 1/4096 em, as int32 */
+#define GLYPH_CACHE_COLOR    5 /* param: CPAL palette index */
+
+/* FNV-1a 64 over the font bytes; names the cache file */
+uint64_t glyph_cache_hash(const uint8_t* data, size_t size);
+
+/*
+ * Opens or creates <dir>/glyphcache-<font_hash>.bin. Returns NULL if the
+ * directory isn't writable; callers then simply run uncached.
+ */
+GlyphCache* glyph_cache_open(const char* dir, uint64_t font_hash, unsigned int axis_count);
+void glyph_cache_close(GlyphCache* cache);
+
+/*
+ * Looks up a record. On a hit, *out_data points into the mapping and stays
+ * valid until the next get/put on this cache. Returns 0 on a hit, -1 on a miss.
+ */
+int glyph_cache_get(
+    GlyphCache* cache,
+    uint32_t glyph_id,
+    unsigned int kind,
+    uint32_t param,
+    const int* coords,
+    const float** out_data,
+    size_t* out_size
+);
+
+/* Appends a record. Returns 0, or -1 if the cache is full or the write failed. */
+int glyph_cache_put(
+    GlyphCache* cache,
+    uint32_t glyph_id,
+    unsigned int kind,
+    uint32_t param,
+    const int* coords,
+    const float* data,
+    size_t size
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_CACHE_H */
@@ -0,0 +1,420 @@
+#include "glyph_chunks.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_MAGIC   0x4743484Bu /* "GCHK" */
+#define CHUNK_VERSION 1
+#define CHUNK_HEADER  16
+
+#define TAG_HEAD 0x68656164u
+#define TAG_MAXP 0x6D617870u
+#define TAG_LOCA 0x6C6F6361u
+#define TAG_GLYF 0x676C7966u
+#define TAG_GVAR 0x67766172u
+
+#define CHUNK_PENDING 0
+#define CHUNK_APPLIED 1
+#define CHUNK_FAILED  2
+
+typedef struct {
+    uint32_t name;        /* offset into names */
+    uint32_t first_glyph; /* offset into glyphs */
+    uint32_t glyph_count;
+} ChunkInfo;
+
+struct GlyphChunks {
+    uint32_t font_id;
+    unsigned int num_glyphs;
+    unsigned int count;
+    ChunkInfo* info;
+    char* names;      /* NUL-terminated names back to back */
+    uint16_t* glyphs; /* every chunk's glyph ids, chunk by chunk */
+    uint16_t* owner;  /* per glyph: pending chunk index + 1, 0 if the font has it */
+    uint8_t* state;   /* per chunk: CHUNK_* */
+};
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static uint32_t rd32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+static void wr16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+static void wr32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+GlyphChunks* glyph_chunks_create(const uint8_t* table, size_t length, unsigned int num_glyphs) {
+    if (!table || length < 8 || rd16(table) != 1 || num_glyphs == 0) return NULL;
+    unsigned int count = rd16(table + 2);
+    if (count == 0) return NULL;
+
+    GlyphChunks* chunks = (GlyphChunks*)calloc(1, sizeof(GlyphChunks));
+    if (!chunks) return NULL;
+    chunks->font_id = rd32(table + 4);
+    chunks->num_glyphs = num_glyphs;
+    chunks->count = count;
+    chunks->info = (ChunkInfo*)calloc(count, sizeof(ChunkInfo));
+    chunks->names = (char*)malloc(length);  /* names + terminators never exceed the table */
+    chunks->glyphs = (uint16_t*)malloc(length * sizeof(uint16_t) / 2);
+    chunks->owner = (uint16_t*)calloc(num_glyphs, sizeof(uint16_t));
+    chunks->state = (uint8_t*)calloc(count, 1);
+    if (!chunks->info || !chunks->names || !chunks->glyphs || !chunks->owner || !chunks->state) {
+        glyph_chunks_destroy(chunks);
+        return NULL;
+    }
+
+    size_t pos = 8, names = 0, glyphs = 0;
+    unsigned int i, g;
+    for (i = 0; i < count; i++) {
+        if (pos + 2 > length) goto malformed;
+        size_t name_length = rd16(table + pos);
+        pos += 2;
+        if (name_length == 0 || pos + name_length + 2 > length) goto malformed;
+        if (memchr(table + pos, '/', name_length) || memchr(table + pos, 0, name_length)) {
+            goto malformed;  /* a file name, never a path */
+        }
+        chunks->info[i].name = (uint32_t)names;
+        memcpy(chunks->names + names, table + pos, name_length);
+        names += name_length;
+        chunks->names[names++] = 0;
+        pos += name_length;
+
+        unsigned int glyph_count = rd16(table + pos);
+        pos += 2;
+        if (pos + (size_t)glyph_count * 2 > length) goto malformed;
+        chunks->info[i].first_glyph = (uint32_t)glyphs;
+        chunks->info[i].glyph_count = glyph_count;
+        for (g = 0; g < glyph_count; g++) {
+            uint16_t glyph = rd16(table + pos + g * 2);
+            /* Ascending, in range, and in one chunk only; glyph 0 always stays in the base */
+            if (glyph == 0 || glyph >= num_glyphs || chunks->owner[glyph] ||
+                (g && glyph <= chunks->glyphs[glyphs - 1])) {
+                goto malformed;
+            }
+            chunks->owner[glyph] = (uint16_t)(i + 1);
+            chunks->glyphs[glyphs++] = glyph;
+        }
+        pos += (size_t)glyph_count * 2;
+    }
+    return chunks;
+
+malformed:
+    glyph_chunks_destroy(chunks);
+    return NULL;
+}
+
+void glyph_chunks_destroy(GlyphChunks* chunks) {
+    if (!chunks) return;
+    free(chunks->info);
+    free(chunks->names);
+    free(chunks->glyphs);
+    free(chunks->owner);
+    free(chunks->state);
+    free(chunks);
+}
+
+unsigned int glyph_chunks_count(const GlyphChunks* chunks) {
+    return chunks ? chunks->count : 0;
+}
+
+const char* glyph_chunks_name(const GlyphChunks* chunks, unsigned int index) {
+    if (!chunks || index >= chunks->count) return NULL;
+    return chunks->names + chunks->info[index].name;
+}
+
+unsigned int glyph_chunks_pending(const GlyphChunks* chunks, uint32_t glyph_id) {
+    if (!chunks || glyph_id >= chunks->num_glyphs) return 0;
+    return chunks->owner[glyph_id];
+}
+
+void glyph_chunks_mark_applied(GlyphChunks* chunks, unsigned int index) {
+    if (!chunks || index >= chunks->count) return;
+    const ChunkInfo* info = &chunks->info[index];
+    uint32_t g;
+    for (g = 0; g < info->glyph_count; g++) {
+        chunks->owner[chunks->glyphs[info->first_glyph + g]] = 0;
+    }
+    chunks->state[index] = CHUNK_APPLIED;
+}
+
+void glyph_chunks_mark_failed(GlyphChunks* chunks, unsigned int index) {
+    if (chunks && index < chunks->count && chunks->state[index] == CHUNK_PENDING) {
+        chunks->state[index] = CHUNK_FAILED;
+    }
+}
+
+int glyph_chunks_failed(const GlyphChunks* chunks, unsigned int index) {
+    return chunks && index < chunks->count && chunks->state[index] == CHUNK_FAILED;
+}
+
+void glyph_chunks_reset_failures(GlyphChunks* chunks) {
+    unsigned int i;
+    if (!chunks) return;
+    for (i = 0; i < chunks->count; i++) {
+        if (chunks->state[i] == CHUNK_FAILED) chunks->state[i] = CHUNK_PENDING;
+    }
+}
+
+/* --- Patching --- */
+
+typedef struct {
+    uint32_t tag;
+    const uint8_t* data;
+    uint32_t length;
+} Table;
+
+/* One glyph's data block in a chunk: offsets[n + 1] then the data they index */
+typedef struct {
+    const uint8_t* offsets;
+    const uint8_t* data;
+} ChunkBlock;
+
+static const uint8_t* block_glyph(const ChunkBlock* block, unsigned int i, uint32_t* length) {
+    uint32_t start = rd32(block->offsets + (size_t)i * 4);
+    *length = rd32(block->offsets + (size_t)i * 4 + 4) - start;
+    return block->data + start;
+}
+
+/* Offsets must ascend and end inside the chunk */
+static int block_valid(const uint8_t* offsets, unsigned int count, size_t available) {
+    unsigned int i;
+    if (rd32(offsets) != 0) return 0;
+    for (i = 0; i < count; i++) {
+        if (rd32(offsets + (size_t)i * 4 + 4) < rd32(offsets + (size_t)i * 4)) return 0;
+    }
+    return rd32(offsets + (size_t)count * 4) <= available;
+}
+
+static Table* find_table(Table* tables, unsigned int count, uint32_t tag) {
+    unsigned int i;
+    for (i = 0; i < count; i++) {
+        if (tables[i].tag == tag) return &tables[i];
+    }
+    return NULL;
+}
+
+static uint32_t table_checksum(const uint8_t* data, size_t length) {
+    uint32_t sum = 0;
+    size_t i;
+    for (i = 0; i + 4 <= length; i += 4) sum += rd32(data + i);
+    if (i < length) {
+        uint8_t tail[4] = { 0, 0, 0, 0 };
+        memcpy(tail, data + i, length - i);
+        sum += rd32(tail);
+    }
+    return sum;
+}
+
+/* Glyph data of the old glyf/loca for |glyph| */
+static const uint8_t* loca_glyph(const Table* loca, const Table* glyf, int long_loca,
+                                 unsigned int glyph, uint32_t* length) {
+    uint32_t start, end;
+    if (long_loca) {
+        start = rd32(loca->data + (size_t)glyph * 4);
+        end = rd32(loca->data + (size_t)glyph * 4 + 4);
+    } else {
+        start = (uint32_t)rd16(loca->data + (size_t)glyph * 2) * 2;
+        end = (uint32_t)rd16(loca->data + (size_t)glyph * 2 + 2) * 2;
+    }
+    if (start > end || end > glyf->length) {
+        *length = 0;
+        return NULL;
+    }
+    *length = end - start;
+    return glyf->data + start;
+}
+
+/* Old GlyphVariationData for |glyph|; |offsets| and |array| from the gvar header */
+static const uint8_t* gvar_glyph(const Table* gvar, int long_offsets, uint32_t array,
+                                 unsigned int glyph, uint32_t* length) {
+    const uint8_t* p = gvar->data + 20;
+    uint32_t start = long_offsets ? rd32(p + (size_t)glyph * 4) : (uint32_t)rd16(p + (size_t)glyph * 2) * 2;
+    uint32_t end = long_offsets ? rd32(p + (size_t)glyph * 4 + 4) : (uint32_t)rd16(p + (size_t)glyph * 2 + 2) * 2;
+    if (start > end || (uint64_t)array + end > gvar->length) {
+        *length = 0;
+        return NULL;
+    }
+    *length = end - start;
+    return gvar->data + array + start;
+}
+
+uint8_t* glyph_chunks_patch(const GlyphChunks* chunks, const uint8_t* font, size_t font_size,
+                            const uint8_t* chunk, size_t chunk_size,
+                            size_t* out_size, unsigned int* out_index) {
+    if (!chunks || !chunk || chunk_size < CHUNK_HEADER) return NULL;
+    if (rd32(chunk) != CHUNK_MAGIC || rd16(chunk + 4) != CHUNK_VERSION) return NULL;
+    unsigned int index = rd16(chunk + 6);
+    if (index >= chunks->count || rd32(chunk + 8) != chunks->font_id) return NULL;
+
+    const ChunkInfo* info = &chunks->info[index];
+    const uint16_t* glyphs = chunks->glyphs + info->first_glyph;
+    unsigned int n = rd16(chunk + 12);
+    int has_gvar = rd16(chunk + 14) & 1;
+    if (n != info->glyph_count) return NULL;
+
+    size_t pos = CHUNK_HEADER;
+    size_t header = pos + (size_t)n * 2 + (size_t)(n + 1) * 4 * (has_gvar ? 2 : 1);
+    if (header > chunk_size) return NULL;
+    unsigned int i;
+    for (i = 0; i < n; i++) {
+        if (rd16(chunk + pos + i * 2) != glyphs[i]) return NULL;
+    }
+    pos += (size_t)n * 2;
+
+    ChunkBlock glyf_block, gvar_block = { NULL, NULL };
+    glyf_block.offsets = chunk + pos;
+    glyf_block.data = chunk + header;
+    if (!block_valid(glyf_block.offsets, n, chunk_size - header)) return NULL;
+    size_t glyf_size = rd32(glyf_block.offsets + (size_t)n * 4);
+    if (has_gvar) {
+        gvar_block.offsets = glyf_block.offsets + (size_t)(n + 1) * 4;
+        gvar_block.data = glyf_block.data + glyf_size;
+        if (!block_valid(gvar_block.offsets, n, chunk_size - header - glyf_size)) return NULL;
+    }
+
+    /* Table directory of the base */
+    if (font_size < 12) return NULL;
+    unsigned int num_tables = rd16(font + 4);
+    if (num_tables == 0 || 12 + (size_t)num_tables * 16 > font_size) return NULL;
+    Table* tables = (Table*)malloc(num_tables * sizeof(Table));
+    if (!tables) return NULL;
+    for (i = 0; i < num_tables; i++) {
+        const uint8_t* rec = font + 12 + i * 16;
+        uint32_t offset = rd32(rec + 8), length = rd32(rec + 12);
+        if ((uint64_t)offset + length > font_size) {
+            free(tables);
+            return NULL;
+        }
+        tables[i].tag = rd32(rec);
+        tables[i].data = font + offset;
+        tables[i].length = length;
+    }
+
+    Table* head = find_table(tables, num_tables, TAG_HEAD);
+    Table* maxp = find_table(tables, num_tables, TAG_MAXP);
+    Table* loca = find_table(tables, num_tables, TAG_LOCA);
+    Table* glyf = find_table(tables, num_tables, TAG_GLYF);
+    Table* gvar = find_table(tables, num_tables, TAG_GVAR);
+    uint8_t *new_head = NULL, *new_loca = NULL, *new_glyf = NULL, *new_gvar = NULL, *out = NULL;
+    if (!head || head->length < 54 || !maxp || maxp->length < 6 || !loca || !glyf) goto done;
+    if (has_gvar && (!gvar || gvar->length < 20)) goto done;
+
+    unsigned int num_glyphs = rd16(maxp->data + 4);
+    int long_loca = rd16(head->data + 50) != 0;
+    if (num_glyphs != chunks->num_glyphs ||
+        loca->length < (size_t)(num_glyphs + 1) * (long_loca ? 4 : 2)) {
+        goto done;
+    }
+
+    /* glyf and a long loca, each glyph padded to an even length */
+    size_t total = 0;
+    uint32_t length;
+    unsigned int g, j = 0;
+    for (g = 0; g < num_glyphs; g++) {
+        if (j < n && glyphs[j] == g) {
+            block_glyph(&glyf_block, j++, &length);
+        } else {
+            loca_glyph(loca, glyf, long_loca, g, &length);
+        }
+        total += ((size_t)length + 1) & ~(size_t)1;
+    }
+    if (total > UINT32_MAX) goto done;
+    new_glyf = (uint8_t*)calloc(total ? total : 1, 1);
+    new_loca = (uint8_t*)malloc((size_t)(num_glyphs + 1) * 4);
+    new_head = (uint8_t*)malloc(head->length);
+    if (!new_glyf || !new_loca || !new_head) goto done;
+    size_t offset = 0;
+    for (g = 0, j = 0; g < num_glyphs; g++) {
+        const uint8_t* data = (j < n && glyphs[j] == g) ? block_glyph(&glyf_block, j++, &length)
+                                                      : loca_glyph(loca, glyf, long_loca, g, &length);
+        wr32(new_loca + (size_t)g * 4, (uint32_t)offset);
+        if (length) memcpy(new_glyf + offset, data, length);
+        offset += ((size_t)length + 1) & ~(size_t)1;
+    }
+    wr32(new_loca + (size_t)num_glyphs * 4, (uint32_t)offset);
+    memcpy(new_head, head->data, head->length);
+    wr16(new_head + 50, 1);
+
+    /* gvar with long offsets; shared tuples move right behind the offsets */
+    size_t gvar_size = 0;
+    if (has_gvar) {
+        unsigned int axis_count = rd16(gvar->data + 4);
+        unsigned int shared_count = rd16(gvar->data + 6);
+        uint32_t shared_offset = rd32(gvar->data + 8);
+        int long_offsets = rd16(gvar->data + 14) & 1;
+        uint32_t array = rd32(gvar->data + 16);
+        size_t shared_size = (size_t)shared_count * axis_count * 2;
+        if (rd16(gvar->data + 12) != num_glyphs ||
+            20 + (size_t)(num_glyphs + 1) * (long_offsets ? 4 : 2) > gvar->length ||
+            (uint64_t)shared_offset + shared_size > gvar->length) {
+            goto done;
+        }
+
+        size_t data_size = 0;
+        for (g = 0, j = 0; g < num_glyphs; g++) {
+            if (j < n && glyphs[j] == g) {
+                block_glyph(&gvar_block, j++, &length);
+            } else {
+                gvar_glyph(gvar, long_offsets, array, g, &length);
+            }
+            data_size += length;
+        }
+        size_t new_shared = 20 + (size_t)(num_glyphs + 1) * 4;
+        size_t new_array = new_shared + shared_size;
+        gvar_size = new_array + data_size;
+        if (gvar_size > UINT32_MAX) goto done;
+        new_gvar = (uint8_t*)malloc(gvar_size);
+        if (!new_gvar) goto done;
+        memcpy(new_gvar, gvar->data, 20);
+        wr32(new_gvar + 8, (uint32_t)new_shared);
+        wr16(new_gvar + 14, (uint16_t)(rd16(gvar->data + 14) | 1));
+        wr32(new_gvar + 16, (uint32_t)new_array);
+        if (shared_size) memcpy(new_gvar + new_shared, gvar->data + shared_offset, shared_size);
+        offset = 0;
+        for (g = 0, j = 0; g < num_glyphs; g++) {
+            const uint8_t* data = (j < n && glyphs[j] == g)
+                ? block_glyph(&gvar_block, j++, &length)
+                : gvar_glyph(gvar, long_offsets, array, g, &length);
+            wr32(new_gvar + 20 + (size_t)g * 4, (uint32_t)offset);
+            if (length) memcpy(new_gvar + new_array + offset, data, length);
+            offset += length;
+        }
+        wr32(new_gvar + 20 + (size_t)num_glyphs * 4, (uint32_t)offset);
+    }
+
+    head->data = new_head;
+    loca->data = new_loca;
+    loca->length = (num_glyphs + 1) * 4;
+    glyf->data = new_glyf;
+    glyf->length = (uint32_t)total;
+    if (new_gvar) {
+        gvar->data = new_gvar;
+        gvar->length = (uint32_t)gvar_size;
+    }
+
+    /* Same directory order, fresh offsets and checksums */
+    size_t size = 12 + (size_t)num_tables * 16;
+    for (i = 0; i < num_tables; i++) size += ((size_t)tables[i].length + 3) & ~(size_t)3;
+    out = (uint8_t*)calloc(size, 1);
+    if (!out) goto done;
+    memcpy(out, font, 12);
+    offset = 12 + (size_t)num_tables * 16;
+    for (i = 0; i < num_tables; i++) {
+        uint8_t* rec = out + 12 + i * 16;
+        wr32(rec, tables[i].tag);
+        wr32(rec + 4, table_checksum(tables[i].data, tables[i].length));
+        wr32(rec + 8, (uint32_t)offset);
+        wr32(rec + 12, tables[i].length);
+        memcpy(out + offset, tables[i].data, tables[i].length);
+        offset += ((size_t)tables[i].length + 3) & ~(size_t)3;
+    }
+    *out_size = size;
+    *out_index = index;
+
+done:
+    free(new_head);
+    free(new_loca);
+    free(new_glyf);
+    free(new_gvar);
+    free(tables);
+    return out;
+}
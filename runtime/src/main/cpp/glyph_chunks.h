@@ -0,0 +1,71 @@
+#ifndef GLYPH_CHUNKS_H
+#define GLYPH_CHUNKS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Segmented fonts. The plugin can split a subset font into a base font and
+ * independent chunk files, one per icon group, in the spirit of Incremental
+ * Font Transfer's glyph-keyed patches. The base keeps every glyph id, with the
+ * chunked glyphs' glyf and gvar data left empty, and lists the chunks in its
+ * 'GCHK' table (big-endian):
+ *
+ *   table:  version u16 (1), chunk_count u16, font_id u32,
+ *           per chunk: name_length u16, name (UTF-8 file name),
+ *                      glyph_count u16, glyph ids u16[glyph_count] (ascending)
+ *   chunk:  magic u32 ("GCHK"), version u16 (1), index u16, font_id u32,
+ *           glyph_count u16, flags u16 (bit 0: gvar data present),
+ *           glyph ids u16[glyph_count], glyf offsets u32[glyph_count + 1],
+ *           gvar offsets u32[glyph_count + 1] if flagged, glyf data, gvar data
+ *
+ * Offsets are relative to the start of their data block. A chunk only applies
+ * to the base whose table carries the same font_id and lists the same glyphs.
+ */
+
+#define GLYPH_CHUNKS_TAG 0x4743484Bu /* 'GCHK' */
+
+typedef struct GlyphChunks GlyphChunks;
+
+/* Parses a 'GCHK' table of a font with |num_glyphs| glyphs; NULL if malformed. */
+GlyphChunks* glyph_chunks_create(const uint8_t* table, size_t length, unsigned int num_glyphs);
+void glyph_chunks_destroy(GlyphChunks* chunks);
+
+unsigned int glyph_chunks_count(const GlyphChunks* chunks);
+
+/* File name chunk |index| is loaded from */
+const char* glyph_chunks_name(const GlyphChunks* chunks, unsigned int index);
+
+/* Index + 1 of the not yet applied chunk holding |glyph_id|; 0 if the font has it */
+unsigned int glyph_chunks_pending(const GlyphChunks* chunks, uint32_t glyph_id);
+
+/*
+ * Validates |chunk| against the table and splices its glyphs into the glyf,
+ * loca and gvar tables of |font|. Returns the patched font (malloc'd, caller
+ * frees) and stores the chunk's index in |out_index|; NULL if the chunk is
+ * malformed, belongs to another font, or the font can't be patched.
+ */
+uint8_t* glyph_chunks_patch(const GlyphChunks* chunks, const uint8_t* font, size_t font_size,
+                            const uint8_t* chunk, size_t chunk_size,
+                            size_t* out_size, unsigned int* out_index);
+
+/* Marks chunk |index| applied: its glyphs are no longer pending. */
+void glyph_chunks_mark_applied(GlyphChunks* chunks, unsigned int index);
+
+/*
+ * Load failures are remembered so a missing file costs one open, not one per
+ * draw; glyph_chunks_reset_failures forgets them (e.g. after a download).
+ */
+void glyph_chunks_mark_failed(GlyphChunks* chunks, unsigned int index);
+int glyph_chunks_failed(const GlyphChunks* chunks, unsigned int index);
+void glyph_chunks_reset_failures(GlyphChunks* chunks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_CHUNKS_H */
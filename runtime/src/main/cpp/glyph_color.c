@@ -0,0 +1,308 @@
+#include "glyph_color.h"
+#include <math.h>
+
+#define COLOR_PI 3.14159265f
+
+/* Paint graphs are DAGs in well-formed fonts; these bound malformed or hostile ones */
+#define COLOR_MAX_DEPTH  16
+#define COLOR_MAX_LAYERS 1024
+#define COLOR_MAX_PAINTS 8192
+
+static inline uint16_t rd_u16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static inline int16_t rd_i16(const uint8_t* p) { return (int16_t)rd_u16(p); }
+static inline uint32_t rd_u24(const uint8_t* p) {
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+static inline uint32_t rd_u32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+static inline float rd_fixed(const uint8_t* p) { return (float)(int32_t)rd_u32(p) / 65536.0f; }
+static inline float rd_f2dot14(const uint8_t* p) { return (float)rd_i16(p) / 16384.0f; }
+
+typedef struct {
+    const uint8_t* colr;
+    size_t colr_length;
+    const uint8_t* cpal;
+    size_t cpal_length;
+    unsigned int palette;
+    size_t base_glyph_list; /* v1 offsets; 0 when absent */
+    size_t layer_list;
+    ColorLayerFunc layer;
+    void* ctx;
+    int layers;
+    unsigned int paints; /* paint tables visited, shared layers counted every time */
+} ColorWalk;
+
+static int in_colr(const ColorWalk* w, size_t offset, size_t length) {
+    return offset <= w->colr_length && length <= w->colr_length - offset;
+}
+
+/* Palette entry |index| with |alpha| applied; foreground when CPAL has no such entry */
+static void resolve_color(const ColorWalk* w, unsigned int index, float alpha, float rgba[4]) {
+    rgba[0] = rgba[1] = rgba[2] = -1.0f;
+    rgba[3] = alpha;
+    if (index == COLOR_FOREGROUND || !w->cpal || w->cpal_length < 12) return;
+
+    const uint8_t* cpal = w->cpal;
+    unsigned int entries = rd_u16(cpal + 2);
+    unsigned int palettes = rd_u16(cpal + 4);
+    unsigned int records = rd_u16(cpal + 6);
+    size_t records_offset = rd_u32(cpal + 8);
+    if (index >= entries || palettes == 0 || w->cpal_length < 12 + (size_t)palettes * 2) return;
+
+    unsigned int palette = w->palette < palettes ? w->palette : 0;
+    unsigned int record = rd_u16(cpal + 12 + palette * 2) + index;
+    size_t at = records_offset + (size_t)record * 4;
+    if (record >= records || at + 4 > w->cpal_length) return;
+
+    /* Records are BGRA */
+    rgba[0] = cpal[at + 2] / 255.0f;
+    rgba[1] = cpal[at + 1] / 255.0f;
+    rgba[2] = cpal[at] / 255.0f;
+    rgba[3] = cpal[at + 3] / 255.0f * alpha;
+}
+
+/* r = m * a: |a| applies first */
+static void concat(const float m[6], const float a[6], float r[6]) {
+    r[0] = m[0] * a[0] + m[2] * a[1];
+    r[1] = m[1] * a[0] + m[3] * a[1];
+    r[2] = m[0] * a[2] + m[2] * a[3];
+    r[3] = m[1] * a[2] + m[3] * a[3];
+    r[4] = m[0] * a[4] + m[2] * a[5] + m[4];
+    r[5] = m[1] * a[4] + m[3] * a[5] + m[5];
+}
+
+/* |a| applied around (cx, cy) instead of the origin */
+static void around_center(float a[6], float cx, float cy) {
+    a[4] += cx - (a[0] * cx + a[2] * cy);
+    a[5] += cy - (a[1] * cx + a[3] * cy);
+}
+
+/*
+ * Matrix of transform paint |p| (formats 12-31) into |a|, and the offset of
+ * its child paint. Returns 0, or -1 for other formats or truncated data.
+ */
+static int paint_transform(const ColorWalk* w, size_t p, float a[6], size_t* child) {
+    const uint8_t* d = w->colr + p;
+    unsigned int format = d[0];
+    static const unsigned char sizes[] = {
+        /* 12-31, variable forms included; all start with a child Offset24 */
+        7, 7, 8, 12, 8, 12, 12, 16, 6, 10, 10, 14, 6, 10, 10, 14, 8, 12, 12, 16
+    };
+    if (format < 12 || format > 31 || !in_colr(w, p, sizes[format - 12])) return -1;
+
+    a[0] = a[3] = 1.0f;
+    a[1] = a[2] = a[4] = a[5] = 0.0f;
+    *child = p + rd_u24(d + 1);
+
+    float s, c;
+    switch (format) {
+        case 12: case 13: {
+            size_t t = p + rd_u24(d + 4);
+            if (!in_colr(w, t, 24)) return -1;
+            const uint8_t* m = w->colr + t;
+            a[0] = rd_fixed(m);
+            a[1] = rd_fixed(m + 4);
+            a[2] = rd_fixed(m + 8);
+            a[3] = rd_fixed(m + 12);
+            a[4] = rd_fixed(m + 16);
+            a[5] = rd_fixed(m + 20);
+            break;
+        }
+        case 14: case 15:
+            a[4] = rd_i16(d + 4);
+            a[5] = rd_i16(d + 6);
+            break;
+        case 16: case 17: case 18: case 19:
+            a[0] = rd_f2dot14(d + 4);
+            a[3] = rd_f2dot14(d + 6);
+            if (format >= 18) around_center(a, rd_i16(d + 8), rd_i16(d + 10));
+            break;
+        case 20: case 21: case 22: case 23:
+            a[0] = a[3] = rd_f2dot14(d + 4);
+            if (format >= 22) around_center(a, rd_i16(d + 6), rd_i16(d + 8));
+            break;
+        case 24: case 25: case 26: case 27:
+            s = sinf(rd_f2dot14(d + 4) * COLOR_PI);
+            c = cosf(rd_f2dot14(d + 4) * COLOR_PI);
+            a[0] = c;
+            a[1] = s;
+            a[2] = -s;
+            a[3] = c;
+            if (format >= 26) around_center(a, rd_i16(d + 6), rd_i16(d + 8));
+            break;
+        default: /* 28-31: skew */
+            a[2] = tanf(-rd_f2dot14(d + 4) * COLOR_PI);
+            a[1] = tanf(rd_f2dot14(d + 6) * COLOR_PI);
+            if (format >= 30) around_center(a, rd_i16(d + 8), rd_i16(d + 10));
+            break;
+    }
+    return 0;
+}
+
+/* The color a PaintGlyph's child fills with; anything without one draws in the foreground */
+static void paint_color(const ColorWalk* w, size_t p, float rgba[4], int depth) {
+    resolve_color(w, COLOR_FOREGROUND, 1.0f, rgba);
+    if (depth > COLOR_MAX_DEPTH || !in_colr(w, p, 1)) return;
+
+    const uint8_t* d = w->colr + p;
+    unsigned int format = d[0];
+    if ((format == 2 || format == 3) && in_colr(w, p, 5)) {
+        resolve_color(w, rd_u16(d + 1), rd_f2dot14(d + 3), rgba);
+    } else if (format >= 4 && format <= 9 && in_colr(w, p, 4)) {
+        /* ColorLine: extend u8, numStops u16, stops { offset, paletteIndex, alpha, ... } */
+        size_t line = p + rd_u24(d + 1);
+        if (in_colr(w, line, 9) && rd_u16(w->colr + line + 1) > 0) {
+            const uint8_t* stop = w->colr + line + 3;
+            resolve_color(w, rd_u16(stop + 2), rd_f2dot14(stop + 4), rgba);
+        }
+    } else if (format >= 12 && format <= 31) {
+        float a[6];
+        size_t child;
+        if (paint_transform(w, p, a, &child) == 0) paint_color(w, child, rgba, depth + 1);
+    } else if (format == 32 && in_colr(w, p, 4)) {
+        paint_color(w, p + rd_u24(d + 1), rgba, depth + 1);
+    }
+}
+
+/* v1 BaseGlyphPaintRecord for |glyph_id|: the absolute offset of its paint, or 0 */
+static size_t find_base_paint(const ColorWalk* w, uint32_t glyph_id) {
+    if (!w->base_glyph_list || !in_colr(w, w->base_glyph_list, 4)) return 0;
+    const uint8_t* list = w->colr + w->base_glyph_list;
+    uint32_t count = rd_u32(list);
+    if (!in_colr(w, w->base_glyph_list + 4, (size_t)count * 6)) return 0;
+
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const uint8_t* record = list + 4 + (size_t)mid * 6;
+        uint32_t gid = rd_u16(record);
+        if (gid == glyph_id) return w->base_glyph_list + rd_u32(record + 2);
+        if (gid < glyph_id) lo = mid + 1;
+        else hi = mid;
+    }
+    return 0;
+}
+
+static int emit(ColorWalk* w, uint32_t glyph_id, const float m[6], const float rgba[4]) {
+    if (w->layers >= COLOR_MAX_LAYERS) return -1;
+    w->layers++;
+    return w->layer(w->ctx, glyph_id, m, rgba) ? -1 : 0;
+}
+
+static int paint(ColorWalk* w, size_t p, const float m[6], int depth) {
+    if (depth > COLOR_MAX_DEPTH || ++w->paints > COLOR_MAX_PAINTS || !in_colr(w, p, 1)) return -1;
+    const uint8_t* d = w->colr + p;
+    unsigned int format = d[0];
+
+    switch (format) {
+        case 1: { /* PaintColrLayers */
+            if (!in_colr(w, p, 6) || !w->layer_list || !in_colr(w, w->layer_list, 4)) return -1;
+            unsigned int count = d[1];
+            uint32_t first = rd_u32(d + 2);
+            uint32_t total = rd_u32(w->colr + w->layer_list);
+            if (first > total || count > total - first) return -1;
+            unsigned int i;
+            for (i = 0; i < count; i++) {
+                size_t at = w->layer_list + 4 + ((size_t)first + i) * 4;
+                if (!in_colr(w, at, 4)) return -1;
+                if (paint(w, w->layer_list + rd_u32(w->colr + at), m, depth + 1) != 0) return -1;
+            }
+            return 0;
+        }
+        case 10: { /* PaintGlyph */
+            if (!in_colr(w, p, 6)) return -1;
+            float rgba[4];
+            paint_color(w, p + rd_u24(d + 1), rgba, depth + 1);
+            return emit(w, rd_u16(d + 4), m, rgba);
+        }
+        case 11: { /* PaintColrGlyph */
+            if (!in_colr(w, p, 3)) return -1;
+            size_t base = find_base_paint(w, rd_u16(d + 1));
+            return base ? paint(w, base, m, depth + 1) : 0;
+        }
+        case 32: { /* PaintComposite */
+            if (!in_colr(w, p, 8)) return -1;
+            if (paint(w, p + rd_u24(d + 5), m, depth + 1) != 0) return -1;
+            return paint(w, p + rd_u24(d + 1), m, depth + 1);
+        }
+        default:
+            if (format >= 12 && format <= 31) {
+                float a[6], r[6];
+                size_t child;
+                if (paint_transform(w, p, a, &child) != 0) return -1;
+                concat(m, a, r);
+                return paint(w, child, r, depth + 1);
+            }
+            /* Fills outside any PaintGlyph would cover the whole clip box: nothing to draw as a path */
+            return 0;
+    }
+}
+
+/* COLRv0: BaseGlyphRecord { glyphID, firstLayerIndex, numLayers }, LayerRecord { glyphID, paletteIndex } */
+static int layers_v0(ColorWalk* w, uint32_t glyph_id) {
+    const uint8_t* colr = w->colr;
+    unsigned int count = rd_u16(colr + 2);
+    size_t records = rd_u32(colr + 4);
+    size_t layers = rd_u32(colr + 8);
+    unsigned int num_layers = rd_u16(colr + 12);
+    if (!in_colr(w, records, (size_t)count * 6)) return -1;
+
+    unsigned int lo = 0, hi = count;
+    while (lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        const uint8_t* record = colr + records + (size_t)mid * 6;
+        uint32_t gid = rd_u16(record);
+        if (gid < glyph_id) {
+            lo = mid + 1;
+        } else if (gid > glyph_id) {
+            hi = mid;
+        } else {
+            static const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+            unsigned int first = rd_u16(record + 2), n = rd_u16(record + 4), i;
+            if (first + n > num_layers || !in_colr(w, layers + (size_t)first * 4, (size_t)n * 4)) {
+                return -1;
+            }
+            for (i = 0; i < n; i++) {
+                const uint8_t* layer = colr + layers + ((size_t)first + i) * 4;
+                float rgba[4];
+                resolve_color(w, rd_u16(layer + 2), 1.0f, rgba);
+                if (emit(w, rd_u16(layer), identity, rgba) != 0) return -1;
+            }
+            return 0;
+        }
+    }
+    return 0;
+}
+
+int color_glyph_layers(const uint8_t* colr, size_t colr_length,
+                       const uint8_t* cpal, size_t cpal_length,
+                       uint32_t glyph_id, unsigned int palette,
+                       ColorLayerFunc layer, void* ctx) {
+    if (!colr || colr_length < 14) return 0;
+
+    ColorWalk w;
+    w.colr = colr;
+    w.colr_length = colr_length;
+    w.cpal = cpal;
+    w.cpal_length = cpal_length;
+    w.palette = palette;
+    w.base_glyph_list = 0;
+    w.layer_list = 0;
+    w.layer = layer;
+    w.ctx = ctx;
+    w.layers = 0;
+    w.paints = 0;
+
+    /* v1 paints take precedence over v0 records for the same glyph */
+    if (rd_u16(colr) >= 1 && colr_length >= 34) {
+        w.base_glyph_list = rd_u32(colr + 14);
+        w.layer_list = rd_u32(colr + 18);
+        size_t base = find_base_paint(&w, glyph_id);
+        if (base) {
+            static const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+            return paint(&w, base, identity, 0) == 0 ? w.layers : -1;
+        }
+    }
+    return layers_v0(&w, glyph_id) == 0 ? w.layers : -1;
+}
@@ -0,0 +1,52 @@
+#ifndef GLYPH_COLOR_H
+#define GLYPH_COLOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * COLR/CPAL reader for layered color glyphs, working on raw table bytes so
+ * either outline backend can feed it (HarfBuzz is built with HB_NO_COLOR).
+ *
+ * COLRv0 layers map directly. COLRv1 paint graphs are flattened into the
+ * same layer list: PaintColrLayers, PaintColrGlyph and every transform
+ * (including the variable forms, at their default values) are followed;
+ * each PaintGlyph becomes one layer, filled with the solid color beneath
+ * it. Gradients have no path-fill equivalent and use their first stop.
+ * PaintComposite draws the backdrop, then the source, with the source-over
+ * rule whatever its mode.
+ */
+
+/* Palette index reserved by COLR for the text (tint) color */
+#define COLOR_FOREGROUND 0xFFFF
+
+/*
+ * One filled layer, bottom to top. |transform| maps |glyph_id|'s outline in
+ * font units (Y-up): x' = xx * x + xy * y + dx, y' = yx * x + yy * y + dy,
+ * stored as { xx, yx, xy, yy, dx, dy }. |rgba| is unpremultiplied, 0..1;
+ * rgba[0] < 0 means the foreground color with alpha rgba[3]. Returns
+ * nonzero to stop the walk.
+ */
+typedef int (*ColorLayerFunc)(void* ctx, uint32_t glyph_id, const float transform[6],
+                              const float rgba[4]);
+
+/*
+ * Walks |glyph_id|'s color layers using CPAL palette |palette| (falling back
+ * to palette 0; entries that CPAL lacks draw in the foreground color).
+ * Returns the number of layers emitted, 0 if the glyph has no COLR entry,
+ * or -1 if the tables are malformed, nest too deeply or |layer| stopped.
+ */
+int color_glyph_layers(const uint8_t* colr, size_t colr_length,
+                       const uint8_t* cpal, size_t cpal_length,
+                       uint32_t glyph_id, unsigned int palette,
+                       ColorLayerFunc layer, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_COLOR_H */
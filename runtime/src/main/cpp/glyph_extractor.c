@@ -1,71 +1,172 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "glyph_extractor.h"
+#include "glyph_cache.h"
+#include "glyph_chunks.h"
+#include "glyph_color.h"
+#include "glyph_morph.h"
+#include "glyph_outline.h"
+#include "glyph_profile.h"
+#include "glyph_trace.h"
+#ifdef GLYPH_SFNT_READER
+#include "sfnt_reader.h"
+#else
 #include <hb-ot.h>
+#endif
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-/* --- FloatBuffer helpers --- */
+struct FontHandle {
+#ifdef GLYPH_SFNT_READER
+    SfntFont* sfnt;
+#else
+    hb_blob_t* blob;
+    hb_face_t* face;
+    hb_font_t* font;
+    hb_draw_funcs_t* draw_funcs;
+#endif
+    unsigned int upem;
+    float inv_upem;
+    FloatBuffer collector; /* reusable path buffer */
+    FloatBuffer lod_flat;  /* LOD scratch: flattened outline */
+    FloatBuffer lod_out;   /* LOD result */
+    FloatBuffer row;       /* combined glyph_extract_row output */
+    FloatBuffer morph;     /* glyph_extract_morph output */
+    FloatBuffer stroke;    /* glyph_extract_stroke output */
+    FloatBuffer embolden;  /* glyph_extract_embolden output */
+    FloatBuffer color;     /* glyph_extract_color output */
 
-static void fb_init(FloatBuffer* fb) {
-    fb->data = NULL;
-    fb->size = 0;
-    fb->capacity = 0;
-}
+    /* fvar axes, read once at load */
+    GlyphAxis* axes;
+    unsigned int axis_count;
 
-static void fb_clear(FloatBuffer* fb) {
-    fb->size = 0;
-}
+    /* Design coords last applied via the fixed-axis path */
+    float* current_coords;
+    int coords_valid;
 
-static void fb_ensure(FloatBuffer* fb, size_t additional) {
-    size_t needed = fb->size + additional;
-    if (needed <= fb->capacity) return;
-    size_t cap = fb->capacity ? fb->capacity * 2 : 256;
-    while (cap < needed) cap *= 2;
-    fb->data = (float*)realloc(fb->data, cap * sizeof(float));
-    fb->capacity = cap;
-}
+    /* Registered variations: axis_count normalized 2.14 coords per id; id 0 is the default */
+    int* variations;
+    unsigned int num_variations;
+    unsigned int cap_variations;
+    int current_variation; /* id currently applied to the font, -1 if none */
+
+    /* Contiguous codepoint run mapped to consecutive glyphs, dense_count 0 if none */
+    uint32_t dense_first;
+    uint32_t dense_count;
+    uint32_t dense_glyph;
+
+    GlyphChunks* chunks; /* glyphs still waiting for their chunk, NULL unless segmented */
+    char* chunk_dir;     /* where pending chunks are loaded from, NULL if not set */
+
+    GlyphCache* cache; /* persistent outlines, NULL when not attached */
+    GlyphProfile* profile; /* startup usage, NULL when not attached */
 
-static void fb_push(FloatBuffer* fb, float v) {
-    fb_ensure(fb, 1);
-    fb->data[fb->size++] = v;
+    GlyphStats stats;
+    GlyphBudget budget;
+};
+
+/* Allocates a handle with the backend-independent fields set up */
+static FontHandle* handle_alloc(unsigned int upem, unsigned int axis_count) {
+    FontHandle* handle = (FontHandle*)calloc(1, sizeof(FontHandle));
+    if (!handle) return NULL;
+    handle->upem = upem;
+    handle->inv_upem = 1.0f / (float)upem;
+    fb_init(&handle->collector);
+    fb_init(&handle->lod_flat);
+    fb_init(&handle->lod_out);
+    fb_init(&handle->row);
+    fb_init(&handle->morph);
+    fb_init(&handle->stroke);
+    fb_init(&handle->embolden);
+    fb_init(&handle->color);
+    handle->axis_count = axis_count;
+    handle->num_variations = 1; /* id 0: all-zero coords, already zeroed by calloc */
+    handle->current_variation = -1;
+    if (axis_count) {
+        handle->axes = (GlyphAxis*)malloc(axis_count * sizeof(GlyphAxis));
+        handle->current_coords = (float*)malloc(axis_count * sizeof(float));
+        if (!handle->axes || !handle->current_coords) {
+            free(handle->axes);
+            free(handle->current_coords);
+            free(handle);
+            return NULL;
+        }
+    }
+    return handle;
 }
 
-static void fb_free(FloatBuffer* fb) {
-    free(fb->data);
-    fb->data = NULL;
-    fb->size = 0;
-    fb->capacity = 0;
+static void handle_free(FontHandle* handle) {
+    glyph_chunks_destroy(handle->chunks);
+    free(handle->chunk_dir);
+    glyph_cache_close(handle->cache);
+    glyph_profile_close(handle->profile);
+    fb_free(&handle->collector);
+    fb_free(&handle->lod_flat);
+    fb_free(&handle->lod_out);
+    fb_free(&handle->row);
+    fb_free(&handle->morph);
+    fb_free(&handle->stroke);
+    fb_free(&handle->embolden);
+    fb_free(&handle->color);
+    free(handle->axes);
+    free(handle->current_coords);
+    free(handle->variations);
+    free(handle);
 }
 
-/* --- HarfBuzz draw callbacks --- */
+static void detect_dense_cmap(FontHandle* handle);
+static void detect_chunks(FontHandle* handle);
+
+/* --- Path emitters (shared by both backends) --- */
 
 typedef struct {
     FloatBuffer* buf;
     float inv_upem;
+    /* Budget: emitters turn into no-ops once either limit would be exceeded */
+    size_t float_limit;
+    unsigned int commands_left;
+    int over_budget;
 } PathCtx;
 
-static void move_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
-                        float x, float y, void* ud) {
-    PathCtx* c = (PathCtx*)user_data;
-    (void)df; (void)st; (void)ud;
+static void path_ctx_init(PathCtx* c, FloatBuffer* buf, float inv_upem) {
+    c->buf = buf;
+    c->inv_upem = inv_upem;
+    c->float_limit = SIZE_MAX;
+    c->commands_left = UINT_MAX;
+    c->over_budget = 0;
+}
+
+/* Admits one command of |floats| floats (marker included) against the budget */
+static int path_admit(PathCtx* c, size_t floats) {
+    if (c->over_budget) return 0;
+    if (c->commands_left == 0 || c->buf->size + floats > c->float_limit) {
+        c->over_budget = 1;
+        return 0;
+    }
+    c->commands_left--;
+    return 1;
+}
+
+static void emit_move_to(PathCtx* c, float x, float y) {
+    if (!path_admit(c, 3)) return;
     fb_push(c->buf, PATH_MOVE_TO);
     fb_push(c->buf, x * c->inv_upem);
     fb_push(c->buf, -y * c->inv_upem); /* Negate Y: font Y-up -> Android Y-down */
 }
 
-static void line_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
-                        float x, float y, void* ud) {
-    PathCtx* c = (PathCtx*)user_data;
-    (void)df; (void)st; (void)ud;
+static void emit_line_to(PathCtx* c, float x, float y) {
+    if (!path_admit(c, 3)) return;
     fb_push(c->buf, PATH_LINE_TO);
     fb_push(c->buf, x * c->inv_upem);
     fb_push(c->buf, -y * c->inv_upem);
 }
 
-static void quadratic_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
-                             float cx, float cy,
-                             float x, float y, void* ud) {
-    PathCtx* c = (PathCtx*)user_data;
-    (void)df; (void)st; (void)ud;
+static void emit_quad_to(PathCtx* c, float cx, float cy, float x, float y) {
+    if (!path_admit(c, 5)) return;
     fb_push(c->buf, PATH_QUAD_TO);
     fb_push(c->buf, cx * c->inv_upem);
     fb_push(c->buf, -cy * c->inv_upem);
@@ -73,12 +174,139 @@ static void quadratic_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_
     fb_push(c->buf, -y * c->inv_upem);
 }
 
+static void emit_close(PathCtx* c) {
+    if (!path_admit(c, 1)) return;
+    fb_push(c->buf, PATH_CLOSE);
+}
+
+#ifdef GLYPH_SFNT_READER
+
+/* --- sfnt reader backend --- */
+
+static void sfnt_move_to_cb(void* ctx, float x, float y) { emit_move_to((PathCtx*)ctx, x, y); }
+static void sfnt_line_to_cb(void* ctx, float x, float y) { emit_line_to((PathCtx*)ctx, x, y); }
+static void sfnt_quad_to_cb(void* ctx, float cx, float cy, float x, float y) {
+    emit_quad_to((PathCtx*)ctx, cx, cy, x, y);
+}
+static void sfnt_close_path_cb(void* ctx) { emit_close((PathCtx*)ctx); }
+
+static const SfntPen sfnt_pen = {
+    sfnt_move_to_cb, sfnt_line_to_cb, sfnt_quad_to_cb, sfnt_close_path_cb
+};
+
+_Static_assert(sizeof(GlyphVariation) == sizeof(SfntVariation), "GlyphVariation layout");
+_Static_assert(sizeof(GlyphAxis) == sizeof(SfntAxis), "GlyphAxis layout");
+
+FontHandle* font_create(const uint8_t* data, size_t size) {
+    GLYPH_TRACE_SCOPE("glyph:font_create");
+    SfntFont* sfnt = sfnt_create(data, size);
+    if (!sfnt) return NULL;
+
+    unsigned int axis_count = sfnt_get_axis_count(sfnt);
+    FontHandle* handle = handle_alloc(sfnt_get_upem(sfnt), axis_count);
+    if (!handle) {
+        sfnt_destroy(sfnt);
+        return NULL;
+    }
+    handle->sfnt = sfnt;
+    if (axis_count) memcpy(handle->axes, sfnt_get_axes(sfnt), axis_count * sizeof(GlyphAxis));
+    detect_dense_cmap(handle);
+    detect_chunks(handle);
+    return handle;
+}
+
+void font_destroy(FontHandle* handle) {
+    if (!handle) return;
+    sfnt_destroy(handle->sfnt);
+    handle_free(handle);
+}
+
+static void backend_set_variations(FontHandle* handle, const GlyphVariation* variations,
+                                   unsigned int num_variations) {
+    sfnt_set_variations(handle->sfnt, (const SfntVariation*)variations, num_variations);
+}
+
+static void backend_set_coords(FontHandle* handle, const float* coords, unsigned int num_coords) {
+    sfnt_set_design_coords(handle->sfnt, coords, num_coords);
+}
+
+static void backend_normalize(FontHandle* handle, const float* coords, unsigned int num_coords,
+                              int* out) {
+    sfnt_normalize_coords(handle->sfnt, coords, num_coords, out);
+}
+
+static void backend_set_normalized(FontHandle* handle, const int* coords, unsigned int num_coords) {
+    sfnt_set_normalized_coords(handle->sfnt, coords, num_coords);
+}
+
+static int backend_cmap_glyph(FontHandle* handle, uint32_t codepoint, uint32_t* glyph_id) {
+    return sfnt_get_nominal_glyph(handle->sfnt, codepoint, glyph_id);
+}
+
+static void backend_draw(FontHandle* handle, uint32_t glyph_id, PathCtx* ctx) {
+    size_t start = ctx->buf->size;
+    /* Malformed glyph data draws nothing rather than a partial outline */
+    int result = sfnt_draw_glyph(handle->sfnt, glyph_id, &sfnt_pen, ctx);
+    if (result == SFNT_OVER_LIMIT) ctx->over_budget = 1;
+    if (result != 0) ctx->buf->size = start;
+}
+
+static void backend_set_limits(FontHandle* handle, const GlyphBudget* budget) {
+    sfnt_set_limits(handle->sfnt, budget->max_composite_depth, budget->max_commands);
+}
+
+static int backend_glyph_bounds(FontHandle* handle, uint32_t glyph_id, float bounds[4]) {
+    return sfnt_get_glyph_bounds(handle->sfnt, glyph_id, bounds);
+}
+
+static const uint8_t* backend_table(FontHandle* handle, uint32_t tag, size_t* length) {
+    return sfnt_get_table(handle->sfnt, tag, length);
+}
+
+static const uint8_t* backend_font_data(FontHandle* handle, size_t* size) {
+    return sfnt_get_data(handle->sfnt, size);
+}
+
+/* Replaces the font with |data| (malloc'd, always freed here); -1 keeps the old one */
+static int backend_reload(FontHandle* handle, uint8_t* data, size_t size) {
+    SfntFont* sfnt = sfnt_create(data, size);
+    free(data);
+    if (!sfnt) return -1;
+    sfnt_destroy(handle->sfnt);
+    handle->sfnt = sfnt;
+    return 0;
+}
+
+#else
+
+/* --- HarfBuzz backend --- */
+
+static void move_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
+                        float x, float y, void* ud) {
+    (void)df; (void)st; (void)ud;
+    emit_move_to((PathCtx*)user_data, x, y);
+}
+
+static void line_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
+                        float x, float y, void* ud) {
+    (void)df; (void)st; (void)ud;
+    emit_line_to((PathCtx*)user_data, x, y);
+}
+
+static void quadratic_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
+                             float cx, float cy,
+                             float x, float y, void* ud) {
+    (void)df; (void)st; (void)ud;
+    emit_quad_to((PathCtx*)user_data, cx, cy, x, y);
+}
+
 static void cubic_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
                          float cx1, float cy1,
                          float cx2, float cy2,
                          float x, float y, void* ud) {
     PathCtx* c = (PathCtx*)user_data;
     (void)df; (void)st; (void)ud;
+    if (!path_admit(c, 7)) return;
     fb_push(c->buf, PATH_CUBIC_TO);
     fb_push(c->buf, cx1 * c->inv_upem);
     fb_push(c->buf, -cy1 * c->inv_upem);
@@ -90,14 +318,14 @@ static void cubic_to_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* s
 
 static void close_path_cb(hb_draw_funcs_t* df, void* user_data, hb_draw_state_t* st,
                            void* ud) {
-    PathCtx* c = (PathCtx*)user_data;
     (void)df; (void)st; (void)ud;
-    fb_push(c->buf, PATH_CLOSE);
+    emit_close((PathCtx*)user_data);
 }
 
-/* --- Public API --- */
+_Static_assert(sizeof(GlyphVariation) == sizeof(hb_variation_t), "GlyphVariation layout");
 
 FontHandle* font_create(const uint8_t* data, size_t size) {
+    GLYPH_TRACE_SCOPE("glyph:font_create");
     hb_blob_t* blob = hb_blob_create(
         (const char*)data,
         (unsigned int)size,
@@ -129,15 +357,33 @@ FontHandle* font_create(const uint8_t* data, size_t size) {
     hb_draw_funcs_make_immutable(draw_funcs);
 
     unsigned int upem = hb_face_get_upem(face);
+    unsigned int axis_count = hb_ot_var_get_axis_count(face);
 
-    FontHandle* handle = (FontHandle*)malloc(sizeof(FontHandle));
+    FontHandle* handle = handle_alloc(upem, axis_count);
+    if (!handle) {
+        hb_draw_funcs_destroy(draw_funcs);
+        hb_font_destroy(font);
+        hb_face_destroy(face);
+        hb_blob_destroy(blob);
+        return NULL;
+    }
     handle->blob = blob;
     handle->face = face;
     handle->font = font;
     handle->draw_funcs = draw_funcs;
-    handle->upem = upem;
-    handle->inv_upem = 1.0f / (float)upem;
-    fb_init(&handle->collector);
+
+    unsigned int i;
+    for (i = 0; i < axis_count; i++) {
+        hb_ot_var_axis_info_t info;
+        unsigned int one = 1;
+        hb_ot_var_get_axis_infos(face, i, &one, &info);
+        handle->axes[i].tag = info.tag;
+        handle->axes[i].min_value = info.min_value;
+        handle->axes[i].default_value = info.default_value;
+        handle->axes[i].max_value = info.max_value;
+    }
+    detect_dense_cmap(handle);
+    detect_chunks(handle);
 
     return handle;
 }
@@ -148,77 +394,1315 @@ void font_destroy(FontHandle* handle) {
     hb_font_destroy(handle->font);
     hb_face_destroy(handle->face);
     hb_blob_destroy(handle->blob);
-    fb_free(&handle->collector);
-    free(handle);
+    handle_free(handle);
+}
+
+static void backend_set_variations(FontHandle* handle, const GlyphVariation* variations,
+                                   unsigned int num_variations) {
+    hb_font_set_variations(handle->font, (const hb_variation_t*)variations, num_variations);
+}
+
+static void backend_set_coords(FontHandle* handle, const float* coords, unsigned int num_coords) {
+    hb_font_set_var_coords_design(handle->font, coords, num_coords);
+}
+
+/* Goes through the font (design coords in, normalized out); callers reset current state */
+static void backend_normalize(FontHandle* handle, const float* coords, unsigned int num_coords,
+                              int* out) {
+    hb_font_set_var_coords_design(handle->font, coords, num_coords);
+    unsigned int length = 0;
+    const int* normalized = hb_font_get_var_coords_normalized(handle->font, &length);
+    unsigned int i;
+    for (i = 0; i < handle->axis_count; i++) {
+        out[i] = i < length ? normalized[i] : 0;
+    }
+}
+
+static void backend_set_normalized(FontHandle* handle, const int* coords, unsigned int num_coords) {
+    hb_font_set_var_coords_normalized(handle->font, coords, num_coords);
+}
+
+static int backend_cmap_glyph(FontHandle* handle, uint32_t codepoint, uint32_t* glyph_id) {
+    hb_codepoint_t gid;
+    if (!hb_font_get_nominal_glyph(handle->font, codepoint, &gid)) return 0;
+    *glyph_id = gid;
+    return 1;
+}
+
+static void backend_draw(FontHandle* handle, uint32_t glyph_id, PathCtx* ctx) {
+    hb_font_draw_glyph(handle->font, glyph_id, handle->draw_funcs, ctx);
+}
+
+/* HarfBuzz applies its own fixed nesting limit; only the emitter budget applies */
+static void backend_set_limits(FontHandle* handle, const GlyphBudget* budget) {
+    (void)handle; (void)budget;
+}
+
+static int backend_glyph_bounds(FontHandle* handle, uint32_t glyph_id, float bounds[4]) {
+    hb_glyph_extents_t ext;
+    if (!hb_font_get_glyph_extents(handle->font, glyph_id, &ext)) return -1;
+    bounds[0] = (float)ext.x_bearing;
+    bounds[1] = (float)(ext.y_bearing + ext.height);
+    bounds[2] = (float)(ext.x_bearing + ext.width);
+    bounds[3] = (float)ext.y_bearing;
+    return 0;
+}
+
+/* Tables of a blob-backed face point into handle->blob, which outlives the sub-blob */
+static const uint8_t* backend_table(FontHandle* handle, uint32_t tag, size_t* length) {
+    hb_blob_t* blob = hb_face_reference_table(handle->face, tag);
+    unsigned int size = 0;
+    const char* data = hb_blob_get_data(blob, &size);
+    hb_blob_destroy(blob);
+    *length = size;
+    return size ? (const uint8_t*)data : NULL;
+}
+
+static const uint8_t* backend_font_data(FontHandle* handle, size_t* size) {
+    unsigned int length = 0;
+    const char* data = hb_blob_get_data(handle->blob, &length);
+    *size = length;
+    return (const uint8_t*)data;
+}
+
+/* Replaces the face and font with ones over |data| (malloc'd, owned by the new
+ * blob); -1 keeps the old ones */
+static int backend_reload(FontHandle* handle, uint8_t* data, size_t size) {
+    hb_blob_t* blob = hb_blob_create((const char*)data, (unsigned int)size,
+                                     HB_MEMORY_MODE_READONLY, data, free);
+    hb_face_t* face = hb_face_create(blob, 0);
+    if (hb_face_get_glyph_count(face) == 0) {
+        hb_face_destroy(face);
+        hb_blob_destroy(blob);
+        return -1;
+    }
+    hb_font_destroy(handle->font);
+    hb_face_destroy(handle->face);
+    hb_blob_destroy(handle->blob);
+    handle->blob = blob;
+    handle->face = face;
+    handle->font = hb_font_create(face);
+    return 0;
+}
+
+#endif /* GLYPH_SFNT_READER */
+
+/* --- Shared helpers --- */
+
+#define TAG_CMAP 0x636D6170u
+#define TAG_MAXP 0x6D617870u
+
+static uint16_t be16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* The run one Unicode subtable maps, if it is a single delta-only format 4
+ * segment or a single format 12 group; 0 otherwise */
+static int cmap_single_run(const uint8_t* t, size_t length, uint32_t* first, uint32_t* count,
+                           uint32_t* glyph) {
+    if (length < 4) return 0;
+    unsigned int format = be16(t);
+    if (format == 4) {
+        /* One segment plus the 0xFFFF terminator */
+        if (length < 32 || be16(t + 6) != 4) return 0;
+        uint32_t end = be16(t + 14), start = be16(t + 20);
+        if (be16(t + 16) != 0xFFFF || end < start || be16(t + 28) != 0) return 0;
+        *first = start;
+        *count = end - start + 1;
+        *glyph = (start + be16(t + 24)) & 0xFFFF;
+        return 1;
+    }
+    if (format == 12) {
+        if (length < 28 || be32(t + 12) != 1) return 0;
+        uint32_t start = be32(t + 16), end = be32(t + 20);
+        if (end < start) return 0;
+        *first = start;
+        *count = end - start + 1;
+        *glyph = be32(t + 24);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Fonts remapped by the plugin's dense codepoint option map one contiguous
+ * run to consecutive glyphs in every Unicode subtable; lookups then become a
+ * subtraction instead of a cmap search.
+ */
+static void detect_dense_cmap(FontHandle* handle) {
+    size_t length = 0, maxp_length = 0;
+    const uint8_t* cmap = backend_table(handle, TAG_CMAP, &length);
+    const uint8_t* maxp = backend_table(handle, TAG_MAXP, &maxp_length);
+    if (!cmap || length < 4 || !maxp || maxp_length < 6) return;
+    unsigned int records = be16(cmap + 2);
+    if (4 + (size_t)records * 8 > length) return;
+
+    uint32_t first = 0, count = 0, glyph = 0;
+    int found = 0;
+    unsigned int i;
+    for (i = 0; i < records; i++) {
+        const uint8_t* rec = cmap + 4 + i * 8;
+        unsigned int platform = be16(rec), encoding = be16(rec + 2);
+        if (!(platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10)))) continue;
+        if (platform == 0 && encoding == 5) continue; /* variation sequences */
+        uint32_t offset = be32(rec + 4);
+        if (offset >= length) return;
+        uint32_t f, c, g;
+        if (!cmap_single_run(cmap + offset, length - offset, &f, &c, &g)) return;
+        if (found && (f != first || c != count || g != glyph)) return;
+        first = f;
+        count = c;
+        glyph = g;
+        found = 1;
+    }
+    if (!found || glyph == 0 || (uint64_t)glyph + count > be16(maxp + 4)) return;
+    handle->dense_first = first;
+    handle->dense_count = count;
+    handle->dense_glyph = glyph;
+}
+
+#define TAG_GCHK GLYPH_CHUNKS_TAG
+
+/* Segmented fonts list their chunks in a GCHK table; see glyph_chunks.h */
+static void detect_chunks(FontHandle* handle) {
+    size_t length = 0, maxp_length = 0;
+    const uint8_t* table = backend_table(handle, TAG_GCHK, &length);
+    const uint8_t* maxp = backend_table(handle, TAG_MAXP, &maxp_length);
+    if (!table || !maxp || maxp_length < 6) return;
+    handle->chunks = glyph_chunks_create(table, length, be16(maxp + 4));
+}
+
+static int lookup_glyph(FontHandle* handle, uint32_t codepoint, uint32_t* glyph_id) {
+    uint32_t index = codepoint - handle->dense_first;
+    if (index < handle->dense_count) {
+        *glyph_id = handle->dense_glyph + index;
+        return 1;
+    }
+    return backend_cmap_glyph(handle, codepoint, glyph_id);
+}
+
+/* Reads <chunk_dir>/<name> of chunk |index| and applies it; 0 on success */
+static int load_chunk(FontHandle* handle, unsigned int index) {
+    GLYPH_TRACE_SCOPE("glyph:load_chunk");
+    const char* name = glyph_chunks_name(handle->chunks, index);
+    size_t dir_length = strlen(handle->chunk_dir);
+    char* path = (char*)malloc(dir_length + strlen(name) + 2);
+    if (!path) return -1;
+    memcpy(path, handle->chunk_dir, dir_length);
+    path[dir_length] = '/';
+    strcpy(path + dir_length + 1, name);
+    FILE* file = fopen(path, "rb");
+    free(path);
+    if (!file) return -1;
+
+    uint8_t* data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = (uint8_t*)malloc((size_t)size);
+        if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    if (!data) return -1;
+
+    int result = glyph_apply_chunk(handle, data, (size_t)size);
+    free(data);
+    return result;
+}
+
+/*
+ * Maps a codepoint to its glyph, first applying the chunk the glyph waits
+ * for in a segmented font. Glyphs whose chunk can't be loaded count as
+ * missing; a failed load isn't retried until glyph_set_chunk_dir.
+ */
+static int backend_nominal_glyph(FontHandle* handle, uint32_t codepoint, uint32_t* glyph_id) {
+    if (!lookup_glyph(handle, codepoint, glyph_id)) return 0;
+    if (!handle->chunks) return 1;
+
+    unsigned int pending = glyph_chunks_pending(handle->chunks, *glyph_id);
+    if (!pending) return 1;
+    if (!handle->chunk_dir || glyph_chunks_failed(handle->chunks, pending - 1)) return 0;
+    if (load_chunk(handle, pending - 1) != 0 || glyph_chunks_pending(handle->chunks, *glyph_id)) {
+        glyph_chunks_mark_failed(handle->chunks, pending - 1);
+        return 0;
+    }
+    return 1;
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*
+ * backend_draw under the handle's budget, plus draw counters. Appends to |out|.
+ * Returns 0, DRAW_FALLBACK if the budget was exceeded and the bounding box was
+ * drawn instead, or GLYPH_OVER_BUDGET if it was exceeded and nothing was drawn.
+ */
+#define DRAW_FALLBACK 1
+
+static int draw_glyph(FontHandle* handle, uint32_t glyph_id, FloatBuffer* out) {
+    const GlyphBudget* budget = &handle->budget;
+    PathCtx ctx;
+    path_ctx_init(&ctx, out, handle->inv_upem);
+    size_t start = out->size;
+    if (budget->max_floats) ctx.float_limit = start + budget->max_floats;
+    if (budget->max_commands) ctx.commands_left = budget->max_commands;
+
+    int64_t t0 = now_ns();
+    backend_draw(handle, glyph_id, &ctx);
+    handle->stats.draws++;
+    handle->stats.draw_ns += (uint64_t)(now_ns() - t0);
+    if (!ctx.over_budget) return 0;
+
+    handle->stats.over_budget++;
+    out->size = start;
+    float b[4];
+    if (!budget->fallback_bounds || backend_glyph_bounds(handle, glyph_id, b) != 0) {
+        return GLYPH_OVER_BUDGET;
+    }
+    path_ctx_init(&ctx, out, handle->inv_upem);
+    emit_move_to(&ctx, b[0], b[1]);
+    emit_line_to(&ctx, b[2], b[1]);
+    emit_line_to(&ctx, b[2], b[3]);
+    emit_line_to(&ctx, b[0], b[3]);
+    emit_close(&ctx);
+    return DRAW_FALLBACK;
+}
+
+/* Keeps the slowest distinct (codepoint, variation) pairs, slowest first */
+static void stats_note_slow(GlyphStats* stats, uint32_t codepoint, int variation_id, int64_t ns) {
+    unsigned int n = stats->num_slowest;
+    if (n == GLYPH_STATS_SLOWEST && ns <= stats->slowest[n - 1].ns) return;
+
+    unsigned int i;
+    for (i = 0; i < n; i++) {
+        if (stats->slowest[i].codepoint == codepoint &&
+            stats->slowest[i].variation_id == variation_id) {
+            break;
+        }
+    }
+    if (i < n) {
+        if (ns <= stats->slowest[i].ns) return;
+    } else {
+        i = n < GLYPH_STATS_SLOWEST ? n++ : n - 1;
+    }
+
+    /* Bubble the updated entry up to its place */
+    GlyphSlowEntry entry = { codepoint, (int32_t)variation_id, ns };
+    while (i > 0 && stats->slowest[i - 1].ns < ns) {
+        stats->slowest[i] = stats->slowest[i - 1];
+        i--;
+    }
+    stats->slowest[i] = entry;
+    stats->num_slowest = n;
+}
+
+static void stats_record(FontHandle* handle, uint32_t codepoint, int variation_id,
+                         int64_t start, size_t out_size) {
+    GlyphStats* stats = &handle->stats;
+    int64_t ns = now_ns() - start;
+    stats->extractions++;
+    stats->extract_ns += (uint64_t)ns;
+    stats->output_floats += out_size;
+    unsigned int bucket = ns > 1 ? 63 - (unsigned int)__builtin_clzll((unsigned long long)ns) : 0;
+    stats->histogram[bucket < GLYPH_STATS_BUCKETS ? bucket : GLYPH_STATS_BUCKETS - 1]++;
+    stats_note_slow(stats, codepoint, variation_id, ns);
+}
+
+/* Applies design coords unless they match what the font already has set */
+static void apply_coords(FontHandle* handle, const float* coords, unsigned int num_coords) {
+    if (handle->coords_valid &&
+        memcmp(handle->current_coords, coords, num_coords * sizeof(float)) == 0) {
+        return;
+    }
+    backend_set_coords(handle, coords, num_coords);
+    if (num_coords) memcpy(handle->current_coords, coords, num_coords * sizeof(float));
+    handle->coords_valid = 1;
+    handle->current_variation = -1;
+}
+
+/* Normalized coords of a registered variation; NULL (all default) before any registration */
+static const int* variation_coords(const FontHandle* handle, int variation_id) {
+    if (!handle->variations) return NULL;
+    return handle->variations + (size_t)variation_id * handle->axis_count;
+}
+
+static void apply_variation_id(FontHandle* handle, int variation_id) {
+    if (handle->current_variation == variation_id) return;
+    const int* coords = variation_coords(handle, variation_id);
+    backend_set_normalized(handle, coords, coords ? handle->axis_count : 0);
+    handle->current_variation = variation_id;
+    handle->coords_valid = 0;
+}
+
+static void apply_variations(FontHandle* handle, const GlyphVariation* variations,
+                             unsigned int num_variations) {
+    backend_set_variations(handle, variations, num_variations);
+    handle->coords_valid = 0;
+    handle->current_variation = -1;
+}
+
+/* Appends [count, ...path...] for |glyph_id| to the collector; returns draw_glyph's result */
+static int append_counted(FontHandle* handle, uint32_t glyph_id) {
+    FloatBuffer* out = &handle->collector;
+    size_t count_index = out->size;
+    fb_push(out, 0.0f);
+    int drawn = draw_glyph(handle, glyph_id, out);
+    out->data[count_index] = (float)(out->size - count_index - 1);
+    return drawn;
+}
+
+/* Appends [count, ...path...] at a registered variation, through the cache when attached */
+static int append_variation(FontHandle* handle, uint32_t glyph_id, int variation_id) {
+    FloatBuffer* out = &handle->collector;
+    const int* coords = variation_coords(handle, variation_id);
+    const float* cached;
+    size_t cached_size;
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, glyph_id, GLYPH_CACHE_OUTLINE, 0, coords,
+                        &cached, &cached_size) == 0) {
+        handle->stats.cache_hits++;
+        fb_ensure(out, cached_size + 1);
+        out->data[out->size++] = (float)cached_size;
+        memcpy(out->data + out->size, cached, cached_size * sizeof(float));
+        out->size += cached_size;
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    apply_variation_id(handle, variation_id);
+    size_t start = out->size;
+    int drawn = append_counted(handle, glyph_id);
+    /* Fallback boxes aren't persisted: the budget may change */
+    if (handle->cache && drawn == 0) {
+        glyph_cache_put(handle->cache, glyph_id, GLYPH_CACHE_OUTLINE, 0, coords,
+                        out->data + start + 1, out->size - start - 1);
+    }
+    return drawn;
 }
 
+/* --- Public API --- */
+
 int glyph_extract(
     FontHandle* handle,
     uint32_t codepoint,
-    const hb_variation_t* variations,
+    const GlyphVariation* variations,
     unsigned int num_variations,
     const float** out_data,
     size_t* out_size
 ) {
-    /* Apply variation axes */
-    hb_font_set_variations(handle->font, variations, num_variations);
-
-    /* Map codepoint to glyph ID */
-    hb_codepoint_t glyph_id;
-    if (!hb_font_get_nominal_glyph(handle->font, codepoint, &glyph_id)) {
+    GLYPH_TRACE_SCOPE("glyph:extract");
+    int64_t start = now_ns();
+    /* Map codepoint to glyph ID; may apply a chunk, which resets the variation */
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
         return -1;
     }
 
+    /* Apply variation axes */
+    apply_variations(handle, variations, num_variations);
+
     /* Extract outline into reusable buffer */
     fb_clear(&handle->collector);
-    PathCtx ctx = { &handle->collector, handle->inv_upem };
-    hb_font_draw_glyph(handle->font, glyph_id, handle->draw_funcs, &ctx);
+    if (draw_glyph(handle, glyph_id, &handle->collector) == GLYPH_OVER_BUDGET) {
+        return GLYPH_OVER_BUDGET;
+    }
 
     *out_data = handle->collector.data;
     *out_size = handle->collector.size;
+    stats_record(handle, codepoint, -1, start, *out_size);
     return 0;
 }
 
 int glyph_extract_batch(
     FontHandle* handle,
     uint32_t codepoint,
-    const hb_variation_t* variations,
+    const GlyphVariation* variations,
     unsigned int num_axes,
     unsigned int num_sets,
     const float** out_data,
     size_t* out_size
 ) {
+    GLYPH_TRACE_SCOPE("glyph:extract_batch");
+    int64_t start = now_ns();
     /* Map codepoint to glyph ID (same for all variations) */
-    hb_codepoint_t glyph_id;
-    if (!hb_font_get_nominal_glyph(handle->font, codepoint, &glyph_id)) {
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
         return -1;
     }
 
-    /* Use a separate temporary buffer for per-set extraction */
-    FloatBuffer tmp;
-    fb_init(&tmp);
-
     /* Accumulate all sets into the main collector */
     fb_clear(&handle->collector);
 
     unsigned int i;
     for (i = 0; i < num_sets; i++) {
-        hb_font_set_variations(handle->font, variations + (i * num_axes), num_axes);
+        apply_variations(handle, variations + (i * num_axes), num_axes);
+        if (append_counted(handle, glyph_id) == GLYPH_OVER_BUDGET) return GLYPH_OVER_BUDGET;
+    }
+
+    *out_data = handle->collector.data;
+    *out_size = handle->collector.size;
+    stats_record(handle, codepoint, -1, start, *out_size);
+    return 0;
+}
+
+unsigned int glyph_get_axes(const FontHandle* handle, const GlyphAxis** out_axes) {
+    *out_axes = handle->axes;
+    return handle->axis_count;
+}
 
-        fb_clear(&tmp);
-        PathCtx ctx = { &tmp, handle->inv_upem };
-        hb_font_draw_glyph(handle->font, glyph_id, handle->draw_funcs, &ctx);
+int glyph_extract_coords(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const float* coords,
+    unsigned int num_coords,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_coords");
+    int64_t start = now_ns();
+    if (num_coords != handle->axis_count) return -1;
 
-        /* Append: [count, ...path_data...] */
-        fb_push(&handle->collector, (float)tmp.size);
-        fb_ensure(&handle->collector, tmp.size);
-        memcpy(handle->collector.data + handle->collector.size, tmp.data, tmp.size * sizeof(float));
-        handle->collector.size += tmp.size;
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
     }
 
-    fb_free(&tmp);
+    apply_coords(handle, coords, num_coords);
+
+    fb_clear(&handle->collector);
+    if (draw_glyph(handle, glyph_id, &handle->collector) == GLYPH_OVER_BUDGET) {
+        return GLYPH_OVER_BUDGET;
+    }
 
     *out_data = handle->collector.data;
     *out_size = handle->collector.size;
+    stats_record(handle, codepoint, -1, start, *out_size);
     return 0;
 }
+
+int glyph_extract_coords_batch(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const float* coords,
+    unsigned int num_coords,
+    unsigned int num_sets,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_coords_batch");
+    int64_t start = now_ns();
+    if (num_coords != handle->axis_count) return -1;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    fb_clear(&handle->collector);
+
+    unsigned int i;
+    for (i = 0; i < num_sets; i++) {
+        apply_coords(handle, coords + (i * num_coords), num_coords);
+        if (append_counted(handle, glyph_id) == GLYPH_OVER_BUDGET) return GLYPH_OVER_BUDGET;
+    }
+
+    *out_data = handle->collector.data;
+    *out_size = handle->collector.size;
+    stats_record(handle, codepoint, -1, start, *out_size);
+    return 0;
+}
+
+void glyph_set_budget(FontHandle* handle, const GlyphBudget* budget) {
+    handle->budget = *budget;
+    backend_set_limits(handle, budget);
+}
+
+int glyph_set_chunk_dir(FontHandle* handle, const char* dir) {
+    if (!handle->chunks) return -1;
+    char* copy = NULL;
+    if (dir) {
+        copy = (char*)malloc(strlen(dir) + 1);
+        if (!copy) return -1;
+        strcpy(copy, dir);
+    }
+    free(handle->chunk_dir);
+    handle->chunk_dir = copy;
+    glyph_chunks_reset_failures(handle->chunks);
+    return 0;
+}
+
+int glyph_apply_chunk(FontHandle* handle, const uint8_t* data, size_t size) {
+    if (!handle->chunks) return -1;
+    size_t font_size = 0, patched_size = 0;
+    const uint8_t* font = backend_font_data(handle, &font_size);
+    unsigned int index;
+    uint8_t* patched = glyph_chunks_patch(handle->chunks, font, font_size, data, size,
+                                          &patched_size, &index);
+    if (!patched || backend_reload(handle, patched, patched_size) != 0) return -1;
+
+    /* Fresh backend font: limits and variation state have to be applied again */
+    glyph_chunks_mark_applied(handle->chunks, index);
+    backend_set_limits(handle, &handle->budget);
+    handle->current_variation = -1;
+    handle->coords_valid = 0;
+    return 0;
+}
+
+const char* glyph_pending_chunk(FontHandle* handle, uint32_t codepoint) {
+    uint32_t glyph_id;
+    if (!handle->chunks || !lookup_glyph(handle, codepoint, &glyph_id)) return NULL;
+    unsigned int pending = glyph_chunks_pending(handle->chunks, glyph_id);
+    return pending ? glyph_chunks_name(handle->chunks, pending - 1) : NULL;
+}
+
+int glyph_attach_cache(FontHandle* handle, const char* dir, uint64_t font_hash) {
+    if (handle->cache) return 0;
+    handle->cache = glyph_cache_open(dir, font_hash, handle->axis_count);
+    return handle->cache ? 0 : -1;
+}
+
+/* Reserves the next variation slot; its storage doubles as scratch until committed */
+static int* reserve_variation(FontHandle* handle) {
+    if (handle->num_variations >= handle->cap_variations) {
+        unsigned int cap = handle->cap_variations ? handle->cap_variations * 2 : 16;
+        int* grown = (int*)realloc(handle->variations,
+                                   (size_t)cap * handle->axis_count * sizeof(int));
+        if (!grown) return NULL;
+        if (!handle->cap_variations) memset(grown, 0, handle->axis_count * sizeof(int));
+        handle->variations = grown;
+        handle->cap_variations = cap;
+    }
+    return handle->variations + (size_t)handle->num_variations * handle->axis_count;
+}
+
+/* Returns the id of the coords in the reserved slot, committing the slot if they're new */
+static int commit_variation(FontHandle* handle) {
+    size_t stride = handle->axis_count;
+    const int* slot = handle->variations + (size_t)handle->num_variations * stride;
+    unsigned int i;
+    for (i = 0; i < handle->num_variations; i++) {
+        if (memcmp(handle->variations + i * stride, slot, stride * sizeof(int)) == 0) {
+            return (int)i;
+        }
+    }
+    return (int)handle->num_variations++;
+}
+
+int glyph_register_variation(FontHandle* handle, const float* coords, unsigned int num_coords) {
+    if (num_coords != handle->axis_count) return -1;
+    if (!handle->axis_count) return 0;
+
+    int* slot = reserve_variation(handle);
+    if (!slot) return -1;
+    backend_normalize(handle, coords, num_coords, slot);
+    handle->coords_valid = 0;
+    handle->current_variation = -1;
+
+    /* Different design values can normalize to the same coords; share the id */
+    return commit_variation(handle);
+}
+
+/* Single-path extraction at a registered variation, through the cache when attached */
+static int extract_variation(FontHandle* handle, uint32_t glyph_id, int variation_id,
+                             const float** out_data, size_t* out_size) {
+    /* Warm path: served straight from the cache mapping */
+    const int* coords = variation_coords(handle, variation_id);
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, glyph_id, GLYPH_CACHE_OUTLINE, 0, coords,
+                        out_data, out_size) == 0) {
+        handle->stats.cache_hits++;
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    apply_variation_id(handle, variation_id);
+
+    fb_clear(&handle->collector);
+    int drawn = draw_glyph(handle, glyph_id, &handle->collector);
+    if (drawn == GLYPH_OVER_BUDGET) return GLYPH_OVER_BUDGET;
+
+    if (handle->cache && drawn == 0) {
+        glyph_cache_put(handle->cache, glyph_id, GLYPH_CACHE_OUTLINE, 0, coords,
+                        handle->collector.data, handle->collector.size);
+    }
+
+    *out_data = handle->collector.data;
+    *out_size = handle->collector.size;
+    return 0;
+}
+
+int glyph_extract_variation(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_variation");
+    int64_t start = now_ns();
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    if (handle->profile) {
+        glyph_profile_record(handle->profile, codepoint, variation_id,
+                             variation_coords(handle, variation_id));
+    }
+    if (extract_variation(handle, glyph_id, variation_id, out_data, out_size) != 0) {
+        return GLYPH_OVER_BUDGET;
+    }
+    stats_record(handle, codepoint, variation_id, start, *out_size);
+    return 0;
+}
+
+/* --- Level of detail --- */
+
+int glyph_lod_level(float pixel_size) {
+    if (!(pixel_size > 0.0f)) return 0;
+    float allowed = GLYPH_LOD_MAX_ERROR_PX / pixel_size;
+    int level = 0;
+    while (level < GLYPH_LOD_LEVELS && glyph_lod_tolerance(level + 1) <= allowed) level++;
+    return level;
+}
+
+float glyph_lod_tolerance(int level) {
+    return level <= 0 ? 0.0f : GLYPH_LOD_FINEST_TOLERANCE * (float)(1 << (level - 1));
+}
+
+int glyph_extract_lod(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    float pixel_size,
+    const float** out_data,
+    size_t* out_size
+) {
+    int level = glyph_lod_level(pixel_size);
+    if (level == 0) return glyph_extract_variation(handle, codepoint, variation_id, out_data, out_size);
+
+    GLYPH_TRACE_SCOPE("glyph:extract_lod");
+    int64_t start = now_ns();
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    const int* coords = variation_coords(handle, variation_id);
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, glyph_id, GLYPH_CACHE_LOD, (uint32_t)level, coords,
+                        out_data, out_size) == 0) {
+        handle->stats.cache_hits++;
+        stats_record(handle, codepoint, variation_id, start, *out_size);
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    const float* full;
+    size_t full_size;
+    if (extract_variation(handle, glyph_id, variation_id, &full, &full_size) != 0) {
+        return GLYPH_OVER_BUDGET;
+    }
+
+    /* Half the error budget each for flattening and point reduction */
+    float tolerance = glyph_lod_tolerance(level);
+    fb_clear(&handle->lod_flat);
+    fb_clear(&handle->lod_out);
+    outline_flatten(full, full_size, tolerance * 0.5f, &handle->lod_flat);
+    outline_simplify(handle->lod_flat.data, handle->lod_flat.size, tolerance * 0.5f,
+                     &handle->lod_out);
+
+    /* Keep the full outline where simplifying doesn't pay off */
+    if (handle->lod_out.size >= full_size) {
+        fb_clear(&handle->lod_out);
+        fb_ensure(&handle->lod_out, full_size);
+        if (full_size) memcpy(handle->lod_out.data, full, full_size * sizeof(float));
+        handle->lod_out.size = full_size;
+    }
+
+    if (handle->cache) {
+        glyph_cache_put(handle->cache, glyph_id, GLYPH_CACHE_LOD, (uint32_t)level, coords,
+                        handle->lod_out.data, handle->lod_out.size);
+    }
+
+    *out_data = handle->lod_out.data;
+    *out_size = handle->lod_out.size;
+    stats_record(handle, codepoint, variation_id, start, *out_size);
+    return 0;
+}
+
+/* --- Rows: many glyphs, one path --- */
+
+/* Appends |path| mapped from em space into the |size| box at |x|, |y| */
+static void append_transformed(FloatBuffer* out, const float* path, size_t path_size,
+                               float x, float y, float size) {
+    fb_ensure(out, path_size);
+    float* dst = out->data + out->size;
+    size_t i = 0;
+    while (i < path_size) {
+        int command = (int)path[i];
+        int arity = command == 0 || command == 1 ? 2 : command == 2 ? 4 : command == 3 ? 6 : 0;
+        if (i + 1 + (size_t)arity > path_size) break;
+        *dst++ = path[i];
+        int k;
+        /* Paths are em-normalized with the baseline at y = 0 and Y down; the box's bottom is the baseline */
+        for (k = 0; k < arity; k += 2) {
+            *dst++ = x + path[i + 1 + k] * size;
+            *dst++ = y + (path[i + 2 + k] + 1.0f) * size;
+        }
+        i += 1 + (size_t)arity;
+    }
+    out->size = (size_t)(dst - out->data);
+}
+
+int glyph_extract_row(
+    FontHandle* handle,
+    const uint32_t* codepoints,
+    const float* positions,
+    const float* sizes,
+    unsigned int count,
+    int variation_id,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_row");
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+
+    int drawn = 0;
+    unsigned int i;
+    fb_clear(&handle->row);
+    for (i = 0; i < count; i++) {
+        const float* path;
+        size_t path_size;
+        if (glyph_extract_lod(handle, codepoints[i], variation_id, sizes[i], &path, &path_size) != 0) {
+            continue;
+        }
+        append_transformed(&handle->row, path, path_size,
+                           positions[i * 2], positions[i * 2 + 1], sizes[i]);
+        drawn++;
+    }
+
+    *out_data = handle->row.data;
+    *out_size = handle->row.size;
+    return drawn;
+}
+
+/* --- Stroked outlines --- */
+
+/* Flattening tolerance for strokes, in em: well under a pixel at any icon size */
+#define STROKE_TOLERANCE (1.0f / 1024.0f)
+
+/* Stroke widths are keyed (and computed) in 1/4096 em steps */
+#define STROKE_WIDTH_STEPS 4096.0f
+
+int glyph_extract_stroke(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    float width,
+    int join,
+    int cap,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_stroke");
+    int64_t start = now_ns();
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+    if (join < GLYPH_JOIN_MITER || join > GLYPH_JOIN_BEVEL ||
+        cap < GLYPH_CAP_BUTT || cap > GLYPH_CAP_SQUARE) {
+        return -1;
+    }
+    uint32_t steps = width > 0.0f ? (uint32_t)(width * STROKE_WIDTH_STEPS + 0.5f) : 0;
+    if (steps == 0 || steps >= (1u << 28)) return -1;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    const int* coords = variation_coords(handle, variation_id);
+    uint32_t param = steps << 4 | (uint32_t)join << 2 | (uint32_t)cap;
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, glyph_id, GLYPH_CACHE_STROKE, param, coords,
+                        out_data, out_size) == 0) {
+        handle->stats.cache_hits++;
+        stats_record(handle, codepoint, variation_id, start, *out_size);
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    const float* path;
+    size_t size;
+    if (extract_variation(handle, glyph_id, variation_id, &path, &size) != 0) {
+        return GLYPH_OVER_BUDGET;
+    }
+    fb_clear(&handle->stroke);
+    outline_stroke(path, size, (float)steps / STROKE_WIDTH_STEPS, join, cap, STROKE_TOLERANCE,
+                   &handle->stroke);
+
+    if (handle->cache) {
+        glyph_cache_put(handle->cache, glyph_id, GLYPH_CACHE_STROKE, param, coords,
+                        handle->stroke.data, handle->stroke.size);
+    }
+
+    *out_data = handle->stroke.data;
+    *out_size = handle->stroke.size;
+    stats_record(handle, codepoint, variation_id, start, *out_size);
+    return 0;
+}
+
+/* --- Synthetic emboldening --- */
+
+/* Strengths are keyed (and computed) in 1/4096 em steps, up to a quarter em either way */
+#define EMBOLDEN_STEPS 4096.0f
+#define EMBOLDEN_MAX_STEPS 1024
+
+int glyph_extract_embolden(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    float strength,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_embolden");
+    int64_t start = now_ns();
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+    if (!(strength > -1.0f && strength < 1.0f)) return -1;
+    int32_t steps = (int32_t)(strength * EMBOLDEN_STEPS + (strength < 0.0f ? -0.5f : 0.5f));
+    if (steps == 0 || steps > EMBOLDEN_MAX_STEPS || steps < -EMBOLDEN_MAX_STEPS) return -1;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    const int* coords = variation_coords(handle, variation_id);
+    uint32_t param = (uint32_t)steps;
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, glyph_id, GLYPH_CACHE_EMBOLDEN, param, coords,
+                        out_data, out_size) == 0) {
+        handle->stats.cache_hits++;
+        stats_record(handle, codepoint, variation_id, start, *out_size);
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    const float* path;
+    size_t size;
+    if (extract_variation(handle, glyph_id, variation_id, &path, &size) != 0) {
+        return GLYPH_OVER_BUDGET;
+    }
+    fb_clear(&handle->embolden);
+    outline_embolden(path, size, (float)steps / EMBOLDEN_STEPS, &handle->embolden);
+
+    if (handle->cache) {
+        glyph_cache_put(handle->cache, glyph_id, GLYPH_CACHE_EMBOLDEN, param, coords,
+                        handle->embolden.data, handle->embolden.size);
+    }
+
+    *out_data = handle->embolden.data;
+    *out_size = handle->embolden.size;
+    stats_record(handle, codepoint, variation_id, start, *out_size);
+    return 0;
+}
+
+/* --- Color glyphs --- */
+
+#define TAG_COLR 0x434F4C52u
+#define TAG_CPAL 0x4350414Cu
+
+typedef struct {
+    FontHandle* handle;
+    int variation_id;
+    int over_budget;
+} ColorCtx;
+
+/* Appends one layer record: r, g, b, a, path size, then the transformed path */
+static int color_layer(void* user, uint32_t glyph_id, const float m[6], const float rgba[4]) {
+    ColorCtx* c = (ColorCtx*)user;
+    FontHandle* handle = c->handle;
+    const float* path;
+    size_t size;
+    if (extract_variation(handle, glyph_id, c->variation_id, &path, &size) != 0) {
+        c->over_budget = 1;
+        return 1;
+    }
+
+    FloatBuffer* out = &handle->color;
+    fb_ensure(out, 5 + size);
+    out->data[out->size++] = rgba[0];
+    out->data[out->size++] = rgba[1];
+    out->data[out->size++] = rgba[2];
+    out->data[out->size++] = rgba[3];
+    out->data[out->size++] = (float)size;
+
+    /* |m| works in font units with Y up; paths are em-normalized with Y down */
+    float dx = m[4] * handle->inv_upem, dy = -m[5] * handle->inv_upem;
+    size_t i = 0;
+    while (i < size) {
+        int command = (int)path[i];
+        int pairs = command == 0 || command == 1 ? 1 : command == 2 ? 2 : command == 3 ? 3 : 0;
+        out->data[out->size++] = path[i++];
+        int k;
+        for (k = 0; k < pairs; k++, i += 2) {
+            float x = path[i], y = path[i + 1];
+            out->data[out->size++] = m[0] * x - m[2] * y + dx;
+            out->data[out->size++] = -m[1] * x + m[3] * y + dy;
+        }
+    }
+    return 0;
+}
+
+int glyph_extract_color(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    unsigned int palette,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_color");
+    int64_t start = now_ns();
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    const int* coords = variation_coords(handle, variation_id);
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, glyph_id, GLYPH_CACHE_COLOR, palette, coords,
+                        out_data, out_size) == 0) {
+        handle->stats.cache_hits++;
+        stats_record(handle, codepoint, variation_id, start, *out_size);
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    size_t colr_length = 0, cpal_length = 0;
+    const uint8_t* colr = backend_table(handle, TAG_COLR, &colr_length);
+    const uint8_t* cpal = backend_table(handle, TAG_CPAL, &cpal_length);
+
+    ColorCtx ctx = { handle, variation_id, 0 };
+    fb_clear(&handle->color);
+    fb_push(&handle->color, 0.0f);
+    int layers = color_glyph_layers(colr, colr_length, cpal, cpal_length, glyph_id, palette,
+                                    color_layer, &ctx);
+    if (ctx.over_budget) return GLYPH_OVER_BUDGET;
+    if (layers <= 0) {
+        /* No (usable) color data: the plain outline as one foreground layer */
+        static const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+        static const float foreground[4] = { -1.0f, -1.0f, -1.0f, 1.0f };
+        handle->color.size = 1;
+        if (color_layer(&ctx, glyph_id, identity, foreground) != 0) return GLYPH_OVER_BUDGET;
+        layers = 1;
+    }
+    handle->color.data[0] = (float)layers;
+
+    if (handle->cache) {
+        glyph_cache_put(handle->cache, glyph_id, GLYPH_CACHE_COLOR, palette, coords,
+                        handle->color.data, handle->color.size);
+    }
+
+    *out_data = handle->color.data;
+    *out_size = handle->color.size;
+    stats_record(handle, codepoint, variation_id, start, *out_size);
+    return 0;
+}
+
+/* --- Morphing between glyphs --- */
+
+int glyph_extract_morph(
+    FontHandle* handle,
+    uint32_t from_codepoint,
+    uint32_t to_codepoint,
+    int variation_id,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_morph");
+    int64_t start = now_ns();
+    if (variation_id < 0 || (unsigned int)variation_id >= handle->num_variations) return -1;
+
+    uint32_t from_id, to_id;
+    if (!backend_nominal_glyph(handle, from_codepoint, &from_id) ||
+        !backend_nominal_glyph(handle, to_codepoint, &to_id)) {
+        return -1;
+    }
+
+    const int* coords = variation_coords(handle, variation_id);
+    if (handle->cache &&
+        glyph_cache_get(handle->cache, from_id, GLYPH_CACHE_MORPH, to_id, coords,
+                        out_data, out_size) == 0) {
+        handle->stats.cache_hits++;
+        stats_record(handle, from_codepoint, variation_id, start, *out_size);
+        return 0;
+    }
+    if (handle->cache) handle->stats.cache_misses++;
+
+    /* The second extraction may reuse the first one's buffer or remap the cache */
+    const float* path;
+    size_t size;
+    FloatBuffer from;
+    fb_init(&from);
+    int result = extract_variation(handle, from_id, variation_id, &path, &size);
+    if (result == 0) {
+        fb_ensure(&from, size);
+        if (size) memcpy(from.data, path, size * sizeof(float));
+        from.size = size;
+        result = extract_variation(handle, to_id, variation_id, &path, &size);
+    }
+    if (result == 0) {
+        fb_clear(&handle->morph);
+        result = morph_build(from.data, from.size, path, size, &handle->morph);
+    }
+    fb_free(&from);
+    if (result != 0) return result;
+
+    if (handle->cache) {
+        glyph_cache_put(handle->cache, from_id, GLYPH_CACHE_MORPH, to_id, coords,
+                        handle->morph.data, handle->morph.size);
+    }
+
+    *out_data = handle->morph.data;
+    *out_size = handle->morph.size;
+    stats_record(handle, from_codepoint, variation_id, start, *out_size);
+    return 0;
+}
+
+int glyph_start_profile(FontHandle* handle, const char* dir, uint64_t font_hash,
+                        int64_t window_ns) {
+    if (handle->profile) return 0;
+    handle->profile = glyph_profile_open(dir, font_hash, handle->axis_count, window_ns);
+    return handle->profile ? 0 : -1;
+}
+
+unsigned int glyph_prewarm_count(const FontHandle* handle) {
+    return handle->profile ? glyph_profile_previous_count(handle->profile) : 0;
+}
+
+int glyph_prewarm(FontHandle* handle, unsigned int index) {
+    GLYPH_TRACE_SCOPE("glyph:prewarm");
+    if (!handle->cache || index >= glyph_prewarm_count(handle)) return -1;
+
+    /* Stored coords go through the variation table so later lookups share the id */
+    int* slot = NULL;
+    if (handle->axis_count && !(slot = reserve_variation(handle))) return -1;
+    uint32_t codepoint = glyph_profile_previous_entry(handle->profile, index, slot);
+    int id = slot ? commit_variation(handle) : 0;
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) return -1;
+    const float* data;
+    size_t size;
+    return extract_variation(handle, glyph_id, id, &data, &size);
+}
+
+int glyph_extract_variation_batch(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const int* variation_ids,
+    unsigned int num_sets,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_variation_batch");
+    int64_t start = now_ns();
+    unsigned int i;
+    for (i = 0; i < num_sets; i++) {
+        int id = variation_ids[i];
+        if (id < 0 || (unsigned int)id >= handle->num_variations) return -1;
+    }
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    fb_clear(&handle->collector);
+    for (i = 0; i < num_sets; i++) {
+        if (append_variation(handle, glyph_id, variation_ids[i]) == GLYPH_OVER_BUDGET) {
+            return GLYPH_OVER_BUDGET;
+        }
+    }
+
+    *out_data = handle->collector.data;
+    *out_size = handle->collector.size;
+    stats_record(handle, codepoint, num_sets ? variation_ids[0] : -1, start, *out_size);
+    return 0;
+}
+
+/* --- Animations: shared topology + per-keyframe coordinates --- */
+
+/* Number of coordinate floats after a command marker, or -1 if unknown */
+static int command_arity(float command) {
+    switch ((int)command) {
+    case 0: case 1: return 2;
+    case 2: return 4;
+    case 3: return 6;
+    case 4: return 0;
+    default: return -1;
+    }
+}
+
+/* Splits |path| into markers (appended to |commands|) and coordinates (appended to |coords|) */
+static int split_path(const float* path, size_t size, FloatBuffer* commands, FloatBuffer* coords) {
+    size_t i = 0;
+    while (i < size) {
+        int arity = command_arity(path[i]);
+        if (arity < 0 || i + 1 + (size_t)arity > size) return -1;
+        fb_push(commands, path[i]);
+        fb_ensure(coords, (size_t)arity);
+        memcpy(coords->data + coords->size, path + i + 1, (size_t)arity * sizeof(float));
+        coords->size += (size_t)arity;
+        i += 1 + (size_t)arity;
+    }
+    return 0;
+}
+
+/* Appends |path|'s coordinates to |coords| if its markers match |commands| exactly */
+static int match_path(const float* path, size_t size, const FloatBuffer* commands,
+                      FloatBuffer* coords) {
+    size_t i = 0, c = 0;
+    while (i < size) {
+        if (c >= commands->size || path[i] != commands->data[c]) return -1;
+        int arity = command_arity(path[i]);
+        if (i + 1 + (size_t)arity > size) return -1;
+        fb_ensure(coords, (size_t)arity);
+        memcpy(coords->data + coords->size, path + i + 1, (size_t)arity * sizeof(float));
+        coords->size += (size_t)arity;
+        i += 1 + (size_t)arity;
+        c++;
+    }
+    return c == commands->size ? 0 : -1;
+}
+
+/* True if every frame strictly between |a| and |b| is within |tolerance| of their lerp */
+static int lerp_fits(const float* matrix, size_t stride, unsigned int a, unsigned int b,
+                     float tolerance) {
+    const float* fa = matrix + (size_t)a * stride;
+    const float* fb = matrix + (size_t)b * stride;
+    unsigned int i;
+    for (i = a + 1; i < b; i++) {
+        const float* fi = matrix + (size_t)i * stride;
+        float t = (float)(i - a) / (float)(b - a);
+        size_t p;
+        for (p = 0; p < stride; p++) {
+            float d = fa[p] + (fb[p] - fa[p]) * t - fi[p];
+            if (d > tolerance || d < -tolerance) return 0;
+        }
+    }
+    return 1;
+}
+
+int glyph_extract_animation(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const int* variation_ids,
+    unsigned int num_frames,
+    float tolerance,
+    const float** out_data,
+    size_t* out_size
+) {
+    GLYPH_TRACE_SCOPE("glyph:extract_animation");
+    int64_t start = now_ns();
+    if (num_frames == 0) return -1;
+    unsigned int i;
+    for (i = 0; i < num_frames; i++) {
+        int id = variation_ids[i];
+        if (id < 0 || (unsigned int)id >= handle->num_variations) return -1;
+    }
+
+    uint32_t glyph_id;
+    if (!backend_nominal_glyph(handle, codepoint, &glyph_id)) {
+        return -1;
+    }
+
+    FloatBuffer commands, matrix, keys;
+    fb_init(&commands);
+    fb_init(&matrix);
+    fb_init(&keys);
+    int result = -2;
+
+    /* Draw every frame; all must share frame 0's command sequence */
+    size_t stride = 0;
+    for (i = 0; i < num_frames; i++) {
+        apply_variation_id(handle, variation_ids[i]);
+        fb_clear(&handle->collector);
+        if (draw_glyph(handle, glyph_id, &handle->collector) == GLYPH_OVER_BUDGET) {
+            result = GLYPH_OVER_BUDGET;
+            goto done;
+        }
+
+        int ok = i == 0
+            ? split_path(handle->collector.data, handle->collector.size, &commands, &matrix)
+            : match_path(handle->collector.data, handle->collector.size, &commands, &matrix);
+        if (ok != 0) goto done;
+        if (i == 0) stride = matrix.size;
+    }
+
+    /* Greedy keyframe reduction: extend each span while linear interpolation holds */
+    {
+        unsigned int key = 0;
+        fb_push(&keys, 0.0f);
+        while (key + 1 < num_frames) {
+            unsigned int next = key + 1;
+            while (next + 1 < num_frames && lerp_fits(matrix.data, stride, key, next + 1, tolerance)) {
+                next++;
+            }
+            fb_push(&keys, (float)next);
+            key = next;
+        }
+    }
+
+    /* Output: [C, P, K, commands(C), keyframe indices(K), K * P coordinates] */
+    fb_clear(&handle->collector);
+    fb_ensure(&handle->collector, 3 + commands.size + keys.size * (1 + stride));
+    fb_push(&handle->collector, (float)commands.size);
+    fb_push(&handle->collector, (float)stride);
+    fb_push(&handle->collector, (float)keys.size);
+    memcpy(handle->collector.data + handle->collector.size, commands.data,
+           commands.size * sizeof(float));
+    handle->collector.size += commands.size;
+    memcpy(handle->collector.data + handle->collector.size, keys.data, keys.size * sizeof(float));
+    handle->collector.size += keys.size;
+    for (i = 0; i < keys.size; i++) {
+        const float* row = matrix.data + (size_t)keys.data[i] * stride;
+        if (stride) memcpy(handle->collector.data + handle->collector.size, row, stride * sizeof(float));
+        handle->collector.size += stride;
+    }
+
+    *out_data = handle->collector.data;
+    *out_size = handle->collector.size;
+    result = 0;
+    stats_record(handle, codepoint, variation_ids[0], start, *out_size);
+
+done:
+    fb_free(&commands);
+    fb_free(&matrix);
+    fb_free(&keys);
+    return result;
+}
+
+/* --- Telemetry --- */
+
+void glyph_get_stats(const FontHandle* handle, GlyphStats* out) {
+    *out = handle->stats;
+}
+
+void glyph_reset_stats(FontHandle* handle) {
+    memset(&handle->stats, 0, sizeof(handle->stats));
+}
@@ -3,7 +3,6 @@
 
 #include <stdint.h>
 #include <stddef.h>
-#include <hb.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,15 +22,34 @@ typedef struct {
     size_t capacity;
 } FloatBuffer;
 
+/* OpenType tag, same packing as hb_tag_t */
+typedef uint32_t glyph_tag_t;
+#define GLYPH_TAG(c1, c2, c3, c4) \
+    ((glyph_tag_t)((((uint32_t)(c1) & 0xFF) << 24) | (((uint32_t)(c2) & 0xFF) << 16) | \
+                   (((uint32_t)(c3) & 0xFF) << 8) | ((uint32_t)(c4) & 0xFF)))
+
+/* Extraction result when the handle's GlyphBudget is exceeded without fallback */
+#define GLYPH_OVER_BUDGET -3
+
+/* Axis setting; layout-compatible with hb_variation_t */
 typedef struct {
-    hb_blob_t* blob;
-    hb_face_t* face;
-    hb_font_t* font;
-    hb_draw_funcs_t* draw_funcs;
-    unsigned int upem;
-    float inv_upem;
-    FloatBuffer collector; /* reusable path buffer */
-} FontHandle;
+    glyph_tag_t tag;
+    float value;
+} GlyphVariation;
+
+/* Variation axis as declared in fvar; layout-compatible with SfntAxis */
+typedef struct {
+    glyph_tag_t tag;
+    float min_value;
+    float default_value;
+    float max_value;
+} GlyphAxis;
+
+/*
+ * Opaque font handle. Backed by HarfBuzz by default, or by the minimal
+ * glyf/gvar reader in sfnt_reader.c when built with GLYPH_SFNT_READER.
+ */
+typedef struct FontHandle FontHandle;
 
 FontHandle* font_create(const uint8_t* data, size_t size);
 void font_destroy(FontHandle* handle);
@@ -40,12 +58,12 @@ void font_destroy(FontHandle* handle);
  * Extract a single glyph path for the given codepoint and variation axes.
  * Returns path commands via out_data/out_size (em-normalized coordinates).
  * Caller must NOT free out_data — it points into the FontHandle's reusable buffer.
- * Returns 0 on success, -1 if codepoint not found.
+ * Returns 0 on success, -1 if codepoint not found, or GLYPH_OVER_BUDGET (see GlyphBudget).
  */
 int glyph_extract(
     FontHandle* handle,
     uint32_t codepoint,
-    const hb_variation_t* variations,
+    const GlyphVariation* variations,
     unsigned int num_variations,
     const float** out_data,
     size_t* out_size
@@ -61,13 +79,333 @@ int glyph_extract(
 int glyph_extract_batch(
     FontHandle* handle,
     uint32_t codepoint,
-    const hb_variation_t* variations,
+    const GlyphVariation* variations,
     unsigned int num_axes,
     unsigned int num_sets,
     const float** out_data,
     size_t* out_size
 );
 
+/*
+ * Per-handle complexity budget bounding the worst-case cost of one glyph.
+ * Zero fields are unlimited (the default). Commands and floats are enforced
+ * in the path emitters, which stop buffering at the limit; the sfnt reader
+ * additionally rejects glyphs with more points than max_commands or deeper
+ * composites than max_composite_depth before applying any deltas. HarfBuzz
+ * keeps its own fixed nesting limit.
+ *
+ * A glyph over budget makes extraction return GLYPH_OVER_BUDGET, or with
+ * |fallback_bounds| draw its bounding box as a rectangle instead. Fallback
+ * paths aren't written to the outline cache.
+ */
+typedef struct {
+    unsigned int max_commands;
+    unsigned int max_floats;
+    unsigned int max_composite_depth;
+    int fallback_bounds;
+} GlyphBudget;
+
+void glyph_set_budget(FontHandle* handle, const GlyphBudget* budget);
+
+/*
+ * Axes in fvar order, read once in font_create. Returns the axis count;
+ * *out_axes stays valid for the lifetime of the handle.
+ */
+unsigned int glyph_get_axes(const FontHandle* handle, const GlyphAxis** out_axes);
+
+/*
+ * Fixed-axis fast path: |coords| holds exactly one design-space value per axis
+ * in fvar order (see glyph_get_axes). Skips tag matching, and re-applies the
+ * variation only when the coords differ from the previous fixed-axis call.
+ * Returns 0 on success, -1 if codepoint not found or num_coords mismatches.
+ */
+int glyph_extract_coords(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const float* coords,
+    unsigned int num_coords,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * Batch variant of glyph_extract_coords. |coords| is num_coords * num_sets
+ * values; output uses the same [count, ...path...] framing as
+ * glyph_extract_batch.
+ */
+int glyph_extract_coords_batch(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const float* coords,
+    unsigned int num_coords,
+    unsigned int num_sets,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * Registers a variation (design coords in fvar order, one per axis) and returns
+ * its id, or -1 on mismatch/allocation failure. Coordinates are normalized once
+ * here; variations that normalize identically share an id. Id 0 is always the
+ * font's default instance.
+ */
+int glyph_register_variation(FontHandle* handle, const float* coords, unsigned int num_coords);
+
+/*
+ * Attaches the persistent outline cache in |dir| (see glyph_cache.h), keyed by
+ * |font_hash| of the font bytes. Registered-variation extraction then serves
+ * outlines from the cache and persists misses. Returns 0, or -1 if the cache
+ * can't be opened; extraction keeps working uncached either way.
+ */
+int glyph_attach_cache(FontHandle* handle, const char* dir, uint64_t font_hash);
+
+/*
+ * Segmented fonts (see glyph_chunks.h): glyphs the plugin moved into chunk
+ * files are missing until their chunk is applied. With a chunk directory set,
+ * the first request for such a glyph loads <dir>/<chunk name> and applies it;
+ * if that fails the glyph stays missing (-1) and the file isn't tried again
+ * until the next glyph_set_chunk_dir. Both return 0, or -1 if the font has
+ * no chunks, or (glyph_apply_chunk) |data| isn't one of its chunks.
+ */
+int glyph_set_chunk_dir(FontHandle* handle, const char* dir);
+int glyph_apply_chunk(FontHandle* handle, const uint8_t* data, size_t size);
+
+/* File name of the chunk |codepoint| still waits for; NULL if the font has its glyph or none */
+const char* glyph_pending_chunk(FontHandle* handle, uint32_t codepoint);
+
+/*
+ * Starts recording the startup profile (see glyph_profile.h) in |dir| for
+ * |window_ns|, and loads the previous session's profile for glyph_prewarm.
+ * Returns 0, or -1 if the profile can't be allocated.
+ */
+int glyph_start_profile(FontHandle* handle, const char* dir, uint64_t font_hash,
+                        int64_t window_ns);
+
+/* Number of entries glyph_prewarm can warm: the previous session's startup profile. */
+unsigned int glyph_prewarm_count(const FontHandle* handle);
+
+/*
+ * Extracts previous-profile entry |index| into the attached cache, so the
+ * first draw finds it there. Returns 0, or -1 without a cache or if the
+ * codepoint is gone from the font.
+ */
+int glyph_prewarm(FontHandle* handle, unsigned int index);
+
+/* Extract a glyph at a registered variation. Same output contract as glyph_extract. */
+int glyph_extract_variation(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    const float** out_data,
+    size_t* out_size
+);
+
+/* Batch over registered variation ids, with glyph_extract_batch's framing. */
+int glyph_extract_variation_batch(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const int* variation_ids,
+    unsigned int num_sets,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * Level of detail: simplified outlines for small sizes. Level k > 0 flattens
+ * curves and drops points so the outline stays within
+ * glyph_lod_tolerance(k) em of the original; level 0 is the full outline.
+ * Tolerances double per level, starting at GLYPH_LOD_FINEST_TOLERANCE.
+ */
+#define GLYPH_LOD_LEVELS 4
+#define GLYPH_LOD_FINEST_TOLERANCE (1.0f / 256.0f)
+#define GLYPH_LOD_MAX_ERROR_PX 0.5f
+
+/* Coarsest level whose error stays within GLYPH_LOD_MAX_ERROR_PX at |pixel_size| per em. */
+int glyph_lod_level(float pixel_size);
+
+/* Maximum deviation of |level| in em units; 0 for level 0. */
+float glyph_lod_tolerance(int level);
+
+/*
+ * glyph_extract_variation at the level glyph_lod_level picks for |pixel_size|.
+ * Levels are cached like full outlines, i.e. only while glyph_attach_cache
+ * has a cache open. A level that wouldn't be smaller than the full outline
+ * returns the full outline instead.
+ */
+int glyph_extract_lod(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    float pixel_size,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * Combined path for a row or grid of icons sharing one variation, so the
+ * caller draws them all with a single drawPath. Icon i is |codepoints[i]|
+ * scaled to a |sizes[i]| pixel em box whose top-left corner is at
+ * (positions[2i], positions[2i + 1]), i.e. drawn the way GlyphPainter draws
+ * a square glyph, at the level of detail for its size. Outlines come through
+ * the same caches as glyph_extract_lod.
+ *
+ * Returns the number of icons in the path; codepoints that are missing or
+ * over budget are skipped. Returns -1 for an invalid variation id.
+ * Caller must NOT free out_data.
+ */
+int glyph_extract_row(
+    FontHandle* handle,
+    const uint32_t* codepoints,
+    const float* positions,
+    const float* sizes,
+    unsigned int count,
+    int variation_id,
+    const float** out_data,
+    size_t* out_size
+);
+
+/* Stroke joins and caps; same order as android.graphics.Paint.Join and Paint.Cap */
+#define GLYPH_JOIN_MITER 0
+#define GLYPH_JOIN_ROUND 1
+#define GLYPH_JOIN_BEVEL 2
+#define GLYPH_CAP_BUTT   0
+#define GLYPH_CAP_ROUND  1
+#define GLYPH_CAP_SQUARE 2
+
+/*
+ * The glyph's outline stroked at |width| em (centered on the outline), as
+ * a path to fill with the nonzero rule instead of stroking every frame.
+ * |cap| only matters for open contours, which glyph outlines rarely have.
+ * Widths are rounded to 1/4096 em; with a cache attached, results are kept
+ * per glyph, variation, width, join and cap. Returns 0, -1 if the codepoint
+ * is missing or an argument is out of range, or GLYPH_OVER_BUDGET.
+ */
+int glyph_extract_stroke(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    float width,
+    int join,
+    int cap,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * The glyph synthetically emboldened by |strength| em: every contour is
+ * offset outward by half of it, so stems grow |strength| wider while the
+ * glyph stays centered; negative strengths thin it. Meant for fonts subset
+ * with wght pinned, where this stands in for the dropped axis at a fraction
+ * of the size. Strengths are rounded to 1/4096 em and must stay within a
+ * quarter em; with a cache attached, results are kept per glyph, variation
+ * and strength.
+ * Returns 0, -1 if the codepoint is missing or an argument is out of range,
+ * or GLYPH_OVER_BUDGET.
+ */
+int glyph_extract_embolden(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    float strength,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * All layers of a color glyph in one buffer, bottom to top, walking COLR
+ * (v0, or the v1 subset described in glyph_color.h) and CPAL |palette|:
+ *
+ *   [L, then per layer: r, g, b, a, n, path(n)]
+ *
+ * Colors are unpremultiplied, 0..1; r < 0 marks the foreground (tint)
+ * color at alpha a. Layer paths use the outline format, COLRv1 transforms
+ * applied. Glyphs without color data come back as one foreground layer.
+ * With a cache attached, results are kept per glyph, variation and palette.
+ * Returns 0, -1 if the codepoint is missing or the id is invalid, or
+ * GLYPH_OVER_BUDGET.
+ */
+int glyph_extract_color(
+    FontHandle* handle,
+    uint32_t codepoint,
+    int variation_id,
+    unsigned int palette,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * Morph from |from_codepoint| to |to_codepoint| at one registered variation,
+ * in glyph_extract_animation's format with keyframes 0 (from) and 1 (to);
+ * see glyph_morph.h for how points are matched. Pairs are cached like
+ * outlines, i.e. only with a cache attached. Returns 0, -1 if either
+ * codepoint is missing, the id is invalid or both glyphs are empty, or
+ * GLYPH_OVER_BUDGET.
+ */
+int glyph_extract_morph(
+    FontHandle* handle,
+    uint32_t from_codepoint,
+    uint32_t to_codepoint,
+    int variation_id,
+    const float** out_data,
+    size_t* out_size
+);
+
+/*
+ * Animation format: variable-font frames differ only in coordinates, so the
+ * command sequence is stored once alongside a keyframes x coordinates matrix.
+ * Frames that linear interpolation between their neighbouring keyframes
+ * reproduces within |tolerance| (em units, per coordinate) are dropped.
+ *
+ * Output: [C, P, K, commands(C), keyframe frame indices(K), K * P coordinates]
+ * where commands are the PATH_* markers and coordinates follow them in order.
+ * Returns 0 on success, -1 if codepoint not found or an id is invalid, and -2
+ * if the frames don't share one command sequence (caller falls back to
+ * glyph_extract_variation_batch).
+ */
+int glyph_extract_animation(
+    FontHandle* handle,
+    uint32_t codepoint,
+    const int* variation_ids,
+    unsigned int num_frames,
+    float tolerance,
+    const float** out_data,
+    size_t* out_size
+);
+
+/* --- Telemetry --- */
+
+#define GLYPH_STATS_BUCKETS 32 /* histogram bucket i counts latencies in [2^i, 2^(i+1)) ns */
+#define GLYPH_STATS_SLOWEST 8
+
+typedef struct {
+    uint32_t codepoint;
+    int32_t variation_id; /* -1 for extraction by axis values or design coords */
+    int64_t ns;
+} GlyphSlowEntry;
+
+/*
+ * Per-handle counters, updated by every successful extraction call (a batch
+ * or animation counts once). draws/draw_ns cover outline generation only,
+ * i.e. cache misses; extract_ns is the full call. |slowest| holds the
+ * slowest distinct (codepoint, variation) pairs, slowest first.
+ */
+typedef struct {
+    uint64_t extractions;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t draws;
+    uint64_t draw_ns;
+    uint64_t extract_ns;
+    uint64_t output_floats;
+    uint64_t over_budget; /* draws that exceeded the GlyphBudget */
+    uint64_t histogram[GLYPH_STATS_BUCKETS];
+    unsigned int num_slowest;
+    GlyphSlowEntry slowest[GLYPH_STATS_SLOWEST];
+} GlyphStats;
+
+void glyph_get_stats(const FontHandle* handle, GlyphStats* out);
+void glyph_reset_stats(FontHandle* handle);
+
 #ifdef __cplusplus
 }
 #endif
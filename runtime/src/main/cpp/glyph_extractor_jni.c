@@ -1,6 +1,10 @@
 #include <jni.h>
 #include <stdlib.h>
 #include "glyph_extractor.h"
+#include "glyph_cache.h"
+#include "glyph_scheduler.h"
+#include "glyph_trace.h"
+#include "font_delta.h"
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -18,18 +22,72 @@
 #define JNI_EXPORT __attribute__((visibility("default")))
 #endif
 
-static hb_tag_t tag_from_string(const char* s) {
-    return HB_TAG(s[0], s[1], s[2], s[3]);
+static glyph_tag_t tag_from_string(const char* s) {
+    return GLYPH_TAG(s[0], s[1], s[2], s[3]);
 }
 
 /* Stack buffer size for typical icon font axes (Material Symbols has 4) */
 #define STACK_AXES 4
 
+static JavaVM* g_vm;
+
+/* Scheduler callbacks deliver results to this extractor instance */
+typedef struct {
+    jobject extractor; /* global ref */
+    jmethodID on_result;
+} CallbackContext;
+
+JNI_EXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    (void)reserved;
+    g_vm = vm;
+    return JNI_VERSION_1_6;
+}
+
+static jfloatArray to_float_array(JNIEnv* env, const float* data, size_t size) {
+    if (size == 0) return NULL;
+    jfloatArray arr = (*env)->NewFloatArray(env, (jsize)size);
+    if (arr) (*env)->SetFloatArrayRegion(env, arr, 0, (jsize)size, data);
+    return arr;
+}
+
+static JNIEnv* worker_env(void) {
+    JNIEnv* env = NULL;
+    if ((*g_vm)->GetEnv(g_vm, (void**)&env, JNI_VERSION_1_6) == JNI_OK) return env;
+#ifdef __ANDROID__
+    if ((*g_vm)->AttachCurrentThreadAsDaemon(g_vm, &env, NULL) != JNI_OK) return NULL;
+#else
+    if ((*g_vm)->AttachCurrentThreadAsDaemon(g_vm, (void**)&env, NULL) != JNI_OK) return NULL;
+#endif
+    return env;
+}
+
+static void on_scheduler_result(void* user, int64_t request_id, int status,
+                                const float* data, size_t size) {
+    CallbackContext* ctx = (CallbackContext*)user;
+    JNIEnv* env = worker_env();
+    if (!env) {
+        LOGE("Failed to attach scheduler thread");
+        return;
+    }
+    jfloatArray arr = status == SCHED_OK ? to_float_array(env, data, size) : NULL;
+    (*env)->CallVoidMethod(env, ctx->extractor, ctx->on_result,
+                           (jlong)request_id, (jint)status, arr);
+    if ((*env)->ExceptionCheck(env)) {
+        LOGE("Exception delivering result for request %lld", (long long)request_id);
+        (*env)->ExceptionClear(env);
+    }
+    if (arr) (*env)->DeleteLocalRef(env, arr);
+}
+
+static void on_scheduler_worker_exit(void* user) {
+    (void)user;
+    (*g_vm)->DetachCurrentThread(g_vm);
+}
+
 JNI_EXPORT jlong JNICALL
 Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeCreateFont(
-    JNIEnv* env, jobject thiz, jbyteArray fontData
+    JNIEnv* env, jobject thiz, jbyteArray fontData, jstring cacheDir, jlong profileWindowMillis
 ) {
-    (void)thiz;
     jsize len = (*env)->GetArrayLength(env, fontData);
     jbyte* bytes = (*env)->GetByteArrayElements(env, fontData, NULL);
     if (!bytes) {
@@ -38,6 +96,19 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeCreat
     }
 
     FontHandle* handle = font_create((const uint8_t*)bytes, (size_t)len);
+    if (handle && cacheDir) {
+        const char* dir = (*env)->GetStringUTFChars(env, cacheDir, NULL);
+        if (dir) {
+            uint64_t hash = glyph_cache_hash((const uint8_t*)bytes, (size_t)len);
+            if (glyph_attach_cache(handle, dir, hash) != 0) {
+                LOGE("Outline cache unavailable in %s", dir);
+            }
+            if (profileWindowMillis > 0) {
+                glyph_start_profile(handle, dir, hash, (int64_t)profileWindowMillis * 1000000LL);
+            }
+            (*env)->ReleaseStringUTFChars(env, cacheDir, dir);
+        }
+    }
     (*env)->ReleaseByteArrayElements(env, fontData, bytes, JNI_ABORT);
 
     if (!handle) {
@@ -45,15 +116,47 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeCreat
         return 0;
     }
 
-    return (jlong)(intptr_t)handle;
+    CallbackContext* ctx = (CallbackContext*)malloc(sizeof(CallbackContext));
+    if (!ctx) {
+        font_destroy(handle);
+        return 0;
+    }
+    jclass cls = (*env)->GetObjectClass(env, thiz);
+    ctx->on_result = (*env)->GetMethodID(env, cls, "onNativeResult", "(JI[F)V");
+    (*env)->DeleteLocalRef(env, cls);
+    if (!ctx->on_result) {
+        LOGE("onNativeResult callback not found");
+        free(ctx);
+        font_destroy(handle);
+        return 0;
+    }
+    ctx->extractor = (*env)->NewGlobalRef(env, thiz);
+
+    GlyphSchedulerCallbacks callbacks = { on_scheduler_result, on_scheduler_worker_exit, ctx };
+    GlyphScheduler* sched = scheduler_create(handle, &callbacks);
+    if (!sched) {
+        (*env)->DeleteGlobalRef(env, ctx->extractor);
+        free(ctx);
+        font_destroy(handle);
+        return 0;
+    }
+
+    return (jlong)(intptr_t)sched;
 }
 
 JNI_EXPORT void JNICALL
 Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeDestroyFont(
     JNIEnv* env, jobject thiz, jlong handlePtr
 ) {
-    (void)env; (void)thiz;
-    font_destroy((FontHandle*)(intptr_t)handlePtr);
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return;
+
+    /* Joins the worker; queued jobs are reported as cancelled before the context goes */
+    CallbackContext* ctx = (CallbackContext*)scheduler_get_user(sched);
+    scheduler_destroy(sched);
+    (*env)->DeleteGlobalRef(env, ctx->extractor);
+    free(ctx);
 }
 
 JNI_EXPORT jfloatArray JNICALL
@@ -62,14 +165,14 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
     jobjectArray axisTags, jfloatArray axisValues
 ) {
     (void)thiz;
-    FontHandle* handle = (FontHandle*)(intptr_t)handlePtr;
-    if (!handle) return NULL;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
 
     /* Parse variation axes with stack allocation for common case */
     jsize numAxes = axisTags ? (*env)->GetArrayLength(env, axisTags) : 0;
-    hb_variation_t stack_vars[STACK_AXES];
-    hb_variation_t* variations = numAxes <= STACK_AXES ? stack_vars :
-        (hb_variation_t*)malloc((size_t)numAxes * sizeof(hb_variation_t));
+    GlyphVariation stack_vars[STACK_AXES];
+    GlyphVariation* variations = numAxes <= STACK_AXES ? stack_vars :
+        (GlyphVariation*)malloc((size_t)numAxes * sizeof(GlyphVariation));
 
     if (numAxes > 0) {
         jfloat* values = (*env)->GetFloatArrayElements(env, axisValues, NULL);
@@ -87,6 +190,7 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
 
     const float* pathData;
     size_t pathSize;
+    FontHandle* handle = scheduler_acquire(sched);
     int result = glyph_extract(
         handle,
         (uint32_t)codepoint,
@@ -98,10 +202,9 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
 
     if (numAxes > STACK_AXES) free(variations);
 
-    if (result != 0 || pathSize == 0) return NULL;
-
-    jfloatArray arr = (*env)->NewFloatArray(env, (jsize)pathSize);
-    (*env)->SetFloatArrayRegion(env, arr, 0, (jsize)pathSize, pathData);
+    /* Copy out before releasing: |pathData| points into the font's buffer */
+    jfloatArray arr = result == 0 ? to_float_array(env, pathData, pathSize) : NULL;
+    scheduler_release(sched);
     return arr;
 }
 
@@ -111,15 +214,15 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
     jobjectArray axisTags, jfloatArray axisValues, jint numSets
 ) {
     (void)thiz;
-    FontHandle* handle = (FontHandle*)(intptr_t)handlePtr;
-    if (!handle) return NULL;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
 
     jsize numAxes = axisTags ? (*env)->GetArrayLength(env, axisTags) : 0;
 
     /* Parse tags (same for all sets) — stack allocate */
-    hb_tag_t stack_tags[STACK_AXES];
-    hb_tag_t* tags = numAxes <= STACK_AXES ? stack_tags :
-        (hb_tag_t*)malloc((size_t)numAxes * sizeof(hb_tag_t));
+    glyph_tag_t stack_tags[STACK_AXES];
+    glyph_tag_t* tags = numAxes <= STACK_AXES ? stack_tags :
+        (glyph_tag_t*)malloc((size_t)numAxes * sizeof(glyph_tag_t));
 
     jsize i;
     for (i = 0; i < numAxes; i++) {
@@ -132,7 +235,7 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
 
     /* Build flattened variations array: numAxes * numSets */
     size_t totalVars = (size_t)numAxes * (size_t)numSets;
-    hb_variation_t* variations = (hb_variation_t*)malloc(totalVars * sizeof(hb_variation_t));
+    GlyphVariation* variations = (GlyphVariation*)malloc(totalVars * sizeof(GlyphVariation));
 
     jfloat* values = (*env)->GetFloatArrayElements(env, axisValues, NULL);
     jint s;
@@ -150,6 +253,7 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
 
     const float* batchData;
     size_t batchSize;
+    FontHandle* handle = scheduler_acquire(sched);
     int result = glyph_extract_batch(
         handle,
         (uint32_t)codepoint,
@@ -162,9 +266,648 @@ Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtra
 
     free(variations);
 
-    if (result != 0 || batchSize == 0) return NULL;
+    jfloatArray arr = result == 0 ? to_float_array(env, batchData, batchSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jintArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeGetAxisTags(
+    JNIEnv* env, jobject thiz, jlong handlePtr
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const GlyphAxis* axes;
+    FontHandle* handle = scheduler_acquire(sched);
+    unsigned int count = glyph_get_axes(handle, &axes);
+    scheduler_release(sched); /* axes are immutable after load */
+
+    jintArray arr = (*env)->NewIntArray(env, (jsize)count);
+    if (!arr) return NULL;
+    unsigned int i;
+    for (i = 0; i < count; i++) {
+        jint tag = (jint)axes[i].tag;
+        (*env)->SetIntArrayRegion(env, arr, (jsize)i, 1, &tag);
+    }
+    return arr;
+}
+
+/* Returns [min, default, max] per axis, in fvar order */
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeGetAxisRanges(
+    JNIEnv* env, jobject thiz, jlong handlePtr
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const GlyphAxis* axes;
+    FontHandle* handle = scheduler_acquire(sched);
+    unsigned int count = glyph_get_axes(handle, &axes);
+    scheduler_release(sched);
+
+    jfloatArray arr = (*env)->NewFloatArray(env, (jsize)(count * 3));
+    if (!arr) return NULL;
+    unsigned int i;
+    for (i = 0; i < count; i++) {
+        jfloat range[3] = { axes[i].min_value, axes[i].default_value, axes[i].max_value };
+        (*env)->SetFloatArrayRegion(env, arr, (jsize)(i * 3), 3, range);
+    }
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphCoords(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jfloatArray coords
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    /* Copy coords without pinning — Material Symbols fits on the stack */
+    jsize numCoords = coords ? (*env)->GetArrayLength(env, coords) : 0;
+    jfloat stack_coords[STACK_AXES];
+    jfloat* values = numCoords <= STACK_AXES ? stack_coords :
+        (jfloat*)malloc((size_t)numCoords * sizeof(jfloat));
+    if (numCoords > 0) (*env)->GetFloatArrayRegion(env, coords, 0, numCoords, values);
+
+    const float* pathData;
+    size_t pathSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_coords(
+        handle,
+        (uint32_t)codepoint,
+        values,
+        (unsigned int)numCoords,
+        &pathData,
+        &pathSize
+    );
+
+    if (numCoords > STACK_AXES) free(values);
+
+    jfloatArray arr = result == 0 ? to_float_array(env, pathData, pathSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphCoordsBatch(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jfloatArray coords, jint numSets
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched || numSets <= 0) return NULL;
+
+    jsize total = (*env)->GetArrayLength(env, coords);
+    jfloat* values = (*env)->GetFloatArrayElements(env, coords, NULL);
+    if (!values) return NULL;
+
+    const float* batchData;
+    size_t batchSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_coords_batch(
+        handle,
+        (uint32_t)codepoint,
+        values,
+        (unsigned int)(total / numSets),
+        (unsigned int)numSets,
+        &batchData,
+        &batchSize
+    );
+
+    (*env)->ReleaseFloatArrayElements(env, coords, values, JNI_ABORT);
+
+    jfloatArray arr = result == 0 ? to_float_array(env, batchData, batchSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jint JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeRegisterVariation(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jfloatArray coords
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return -1;
+
+    jsize numCoords = coords ? (*env)->GetArrayLength(env, coords) : 0;
+    jfloat stack_coords[STACK_AXES];
+    jfloat* values = numCoords <= STACK_AXES ? stack_coords :
+        (jfloat*)malloc((size_t)numCoords * sizeof(jfloat));
+    if (numCoords > 0) (*env)->GetFloatArrayRegion(env, coords, 0, numCoords, values);
+
+    FontHandle* handle = scheduler_acquire(sched);
+    int id = glyph_register_variation(handle, values, (unsigned int)numCoords);
+    scheduler_release(sched);
+
+    if (numCoords > STACK_AXES) free(values);
+    return id;
+}
+
+/* Primitive-only signature: no per-call object marshalling on the way in */
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphVariation(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jint variationId
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const float* pathData;
+    size_t pathSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_variation(
+        handle,
+        (uint32_t)codepoint,
+        (int)variationId,
+        &pathData,
+        &pathSize
+    );
+
+    jfloatArray arr = result == 0 ? to_float_array(env, pathData, pathSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphLod(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jint variationId, jfloat pixelSize
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const float* pathData;
+    size_t pathSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_lod(
+        handle,
+        (uint32_t)codepoint,
+        (int)variationId,
+        (float)pixelSize,
+        &pathData,
+        &pathSize
+    );
+
+    jfloatArray arr = result == 0 ? to_float_array(env, pathData, pathSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphVariationBatch(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jintArray variationIds
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    jsize numSets = (*env)->GetArrayLength(env, variationIds);
+    if (numSets <= 0) return NULL;
+    jint* ids = (*env)->GetIntArrayElements(env, variationIds, NULL);
+    if (!ids) return NULL;
+
+    const float* batchData;
+    size_t batchSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_variation_batch(
+        handle,
+        (uint32_t)codepoint,
+        (const int*)ids,
+        (unsigned int)numSets,
+        &batchData,
+        &batchSize
+    );
+
+    (*env)->ReleaseIntArrayElements(env, variationIds, ids, JNI_ABORT);
+
+    jfloatArray arr = result == 0 ? to_float_array(env, batchData, batchSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphStroke(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jint variationId,
+    jfloat width, jint join, jint cap
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const float* pathData;
+    size_t pathSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_stroke(
+        handle,
+        (uint32_t)codepoint,
+        (int)variationId,
+        (float)width,
+        (int)join,
+        (int)cap,
+        &pathData,
+        &pathSize
+    );
+
+    jfloatArray arr = result == 0 ? to_float_array(env, pathData, pathSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphEmbolden(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jint variationId, jfloat strength
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const float* pathData;
+    size_t pathSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_embolden(
+        handle,
+        (uint32_t)codepoint,
+        (int)variationId,
+        (float)strength,
+        &pathData,
+        &pathSize
+    );
+
+    jfloatArray arr = result == 0 ? to_float_array(env, pathData, pathSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphColor(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jint variationId, jint palette
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched || palette < 0) return NULL;
+
+    const float* layerData;
+    size_t layerSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_color(
+        handle,
+        (uint32_t)codepoint,
+        (int)variationId,
+        (unsigned int)palette,
+        &layerData,
+        &layerSize
+    );
+
+    jfloatArray arr = result == 0 ? to_float_array(env, layerData, layerSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphRow(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jintArray codepoints, jfloatArray positions,
+    jfloatArray sizes, jint variationId
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    jsize count = (*env)->GetArrayLength(env, codepoints);
+    if (count <= 0 || (*env)->GetArrayLength(env, sizes) < count ||
+        (*env)->GetArrayLength(env, positions) < count * 2) {
+        return NULL;
+    }
+    jint* cps = (*env)->GetIntArrayElements(env, codepoints, NULL);
+    jfloat* pos = (*env)->GetFloatArrayElements(env, positions, NULL);
+    jfloat* sz = (*env)->GetFloatArrayElements(env, sizes, NULL);
+
+    jfloatArray arr = NULL;
+    if (cps && pos && sz) {
+        const float* rowData;
+        size_t rowSize;
+        FontHandle* handle = scheduler_acquire(sched);
+        int result = glyph_extract_row(
+            handle,
+            (const uint32_t*)cps,
+            (const float*)pos,
+            (const float*)sz,
+            (unsigned int)count,
+            (int)variationId,
+            &rowData,
+            &rowSize
+        );
+        arr = result >= 0 ? to_float_array(env, rowData, rowSize) : NULL;
+        scheduler_release(sched);
+    }
+
+    if (sz) (*env)->ReleaseFloatArrayElements(env, sizes, sz, JNI_ABORT);
+    if (pos) (*env)->ReleaseFloatArrayElements(env, positions, pos, JNI_ABORT);
+    if (cps) (*env)->ReleaseIntArrayElements(env, codepoints, cps, JNI_ABORT);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphMorph(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint fromCodepoint, jint toCodepoint,
+    jint variationId
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const float* morphData;
+    size_t morphSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_morph(
+        handle,
+        (uint32_t)fromCodepoint,
+        (uint32_t)toCodepoint,
+        (int)variationId,
+        &morphData,
+        &morphSize
+    );
+
+    jfloatArray arr = result == 0 ? to_float_array(env, morphData, morphSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+JNI_EXPORT jfloatArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeExtractGlyphAnimation(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint, jintArray variationIds,
+    jfloat tolerance
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    jsize numFrames = (*env)->GetArrayLength(env, variationIds);
+    if (numFrames <= 0) return NULL;
+    jint* ids = (*env)->GetIntArrayElements(env, variationIds, NULL);
+    if (!ids) return NULL;
+
+    const float* animData;
+    size_t animSize;
+    FontHandle* handle = scheduler_acquire(sched);
+    int result = glyph_extract_animation(
+        handle,
+        (uint32_t)codepoint,
+        (const int*)ids,
+        (unsigned int)numFrames,
+        (float)tolerance,
+        &animData,
+        &animSize
+    );
+
+    (*env)->ReleaseIntArrayElements(env, variationIds, ids, JNI_ABORT);
+
+    jfloatArray arr = result == 0 ? to_float_array(env, animData, animSize) : NULL;
+    scheduler_release(sched);
+    return arr;
+}
+
+/* Stats snapshot layout, mirrored by GlyphExtractorStats.fromArray */
+#define STATS_FIELDS 8
+#define STATS_HEADER (STATS_FIELDS + GLYPH_STATS_BUCKETS + 1)
+
+JNI_EXPORT jlongArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeGetStats(
+    JNIEnv* env, jobject thiz, jlong handlePtr
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    GlyphStats stats;
+    FontHandle* handle = scheduler_acquire(sched);
+    glyph_get_stats(handle, &stats);
+    scheduler_release(sched);
+
+    /* [fields(8), histogram(32), n, (codepoint, variation id, ns) * n] */
+    jlong out[STATS_HEADER + 3 * GLYPH_STATS_SLOWEST];
+    out[0] = (jlong)stats.extractions;
+    out[1] = (jlong)stats.cache_hits;
+    out[2] = (jlong)stats.cache_misses;
+    out[3] = (jlong)stats.draws;
+    out[4] = (jlong)stats.draw_ns;
+    out[5] = (jlong)stats.extract_ns;
+    out[6] = (jlong)stats.output_floats;
+    out[7] = (jlong)stats.over_budget;
+    unsigned int i;
+    for (i = 0; i < GLYPH_STATS_BUCKETS; i++) out[STATS_FIELDS + i] = (jlong)stats.histogram[i];
+    out[STATS_HEADER - 1] = (jlong)stats.num_slowest;
+    for (i = 0; i < stats.num_slowest; i++) {
+        out[STATS_HEADER + i * 3] = (jlong)stats.slowest[i].codepoint;
+        out[STATS_HEADER + i * 3 + 1] = (jlong)stats.slowest[i].variation_id;
+        out[STATS_HEADER + i * 3 + 2] = (jlong)stats.slowest[i].ns;
+    }
 
-    jfloatArray arr = (*env)->NewFloatArray(env, (jsize)batchSize);
-    (*env)->SetFloatArrayRegion(env, arr, 0, (jsize)batchSize, batchData);
+    jsize size = (jsize)(STATS_HEADER + 3 * stats.num_slowest);
+    jlongArray arr = (*env)->NewLongArray(env, size);
+    if (arr) (*env)->SetLongArrayRegion(env, arr, 0, size, out);
     return arr;
 }
+
+JNI_EXPORT void JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeResetStats(
+    JNIEnv* env, jobject thiz, jlong handlePtr
+) {
+    (void)env; (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return;
+    glyph_reset_stats(scheduler_acquire(sched));
+    scheduler_release(sched);
+}
+
+JNI_EXPORT void JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeSetBudget(
+    JNIEnv* env, jobject thiz, jlong handlePtr,
+    jint maxCommands, jint maxFloats, jint maxCompositeDepth, jboolean fallbackToBounds
+) {
+    (void)env; (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return;
+
+    GlyphBudget budget = {
+        (unsigned int)maxCommands, (unsigned int)maxFloats,
+        (unsigned int)maxCompositeDepth, fallbackToBounds == JNI_TRUE
+    };
+    glyph_set_budget(scheduler_acquire(sched), &budget);
+    scheduler_release(sched);
+}
+
+JNI_EXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeSetChunkDirectory(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jstring chunkDir
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return JNI_FALSE;
+
+    const char* dir = (*env)->GetStringUTFChars(env, chunkDir, NULL);
+    if (!dir) return JNI_FALSE;
+    int result = glyph_set_chunk_dir(scheduler_acquire(sched), dir);
+    scheduler_release(sched);
+    (*env)->ReleaseStringUTFChars(env, chunkDir, dir);
+    return result == 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeApplyChunk(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jbyteArray chunkData
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return JNI_FALSE;
+
+    jsize len = (*env)->GetArrayLength(env, chunkData);
+    jbyte* bytes = (*env)->GetByteArrayElements(env, chunkData, NULL);
+    if (!bytes) return JNI_FALSE;
+    int result = glyph_apply_chunk(scheduler_acquire(sched), (const uint8_t*)bytes, (size_t)len);
+    scheduler_release(sched);
+    (*env)->ReleaseByteArrayElements(env, chunkData, bytes, JNI_ABORT);
+    return result == 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT jstring JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativePendingChunk(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint codepoint
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return NULL;
+
+    const char* name = glyph_pending_chunk(scheduler_acquire(sched), (uint32_t)codepoint);
+    /* Names live as long as the font, but copy while it is held */
+    jstring result = name ? (*env)->NewStringUTF(env, name) : NULL;
+    scheduler_release(sched);
+    return result;
+}
+
+JNI_EXPORT jint JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativePrewarmCount(
+    JNIEnv* env, jobject thiz, jlong handlePtr
+) {
+    (void)env; (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return 0;
+
+    unsigned int count = glyph_prewarm_count(scheduler_acquire(sched));
+    scheduler_release(sched);
+    return (jint)count;
+}
+
+JNI_EXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativePrewarmGlyph(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jint index
+) {
+    (void)env; (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched || index < 0) return JNI_FALSE;
+
+    int result = glyph_prewarm(scheduler_acquire(sched), (unsigned int)index);
+    scheduler_release(sched);
+    return result == 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeSubmit(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jlong requestId, jint priority, jint kind,
+    jint codepoint, jintArray variationIds, jfloat tolerance, jlong deadlineMillis
+) {
+    (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (!sched) return JNI_FALSE;
+
+    jsize numIds = (*env)->GetArrayLength(env, variationIds);
+    if (numIds <= 0) return JNI_FALSE;
+    jint* ids = (*env)->GetIntArrayElements(env, variationIds, NULL);
+    if (!ids) return JNI_FALSE;
+
+    int64_t deadline = deadlineMillis > 0 ?
+        scheduler_now_ns() + (int64_t)deadlineMillis * 1000000LL : 0;
+    int result = scheduler_submit(
+        sched,
+        (int64_t)requestId,
+        (int)priority,
+        (int)kind,
+        (uint32_t)codepoint,
+        (const int*)ids,
+        (unsigned int)numIds,
+        (float)tolerance,
+        deadline
+    );
+
+    (*env)->ReleaseIntArrayElements(env, variationIds, ids, JNI_ABORT);
+    return result == 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNI_EXPORT void JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeCancel(
+    JNIEnv* env, jobject thiz, jlong handlePtr, jlong requestId
+) {
+    (void)env; (void)thiz;
+    GlyphScheduler* sched = (GlyphScheduler*)(intptr_t)handlePtr;
+    if (sched) scheduler_cancel(sched, (int64_t)requestId);
+}
+
+JNI_EXPORT jboolean JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeWriteTrace(
+    JNIEnv* env, jclass clazz, jstring path
+) {
+    (void)clazz;
+#if defined(GLYPHRUNTIME_TRACING) && !defined(__ANDROID__)
+    const char* chars = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!chars) return JNI_FALSE;
+    int result = glyph_trace_write(chars);
+    (*env)->ReleaseStringUTFChars(env, path, chars);
+    return result == 0 ? JNI_TRUE : JNI_FALSE;
+#else
+    /* Compiled out, or on Android where slices go to ATrace */
+    (void)env; (void)path;
+    return JNI_FALSE;
+#endif
+}
+
+JNI_EXPORT jbyteArray JNICALL
+Java_com_davidmedenjak_fontsubsetting_runtime_HarfBuzzGlyphExtractor_nativeApplyFontDelta(
+    JNIEnv* env, jclass clazz, jbyteArray previous, jbyteArray delta
+) {
+    (void)clazz;
+    if (!previous || !delta) return NULL;
+    jsize previous_size = (*env)->GetArrayLength(env, previous);
+    jsize delta_size = (*env)->GetArrayLength(env, delta);
+
+    /* The header bounds the one allocation: the result array */
+    jbyte header[28];
+    if (delta_size < (jsize)sizeof(header)) return NULL;
+    (*env)->GetByteArrayRegion(env, delta, 0, (jsize)sizeof(header), header);
+    size_t size = font_delta_output_size((const uint8_t*)header, sizeof(header));
+    if (size == 0) return NULL;
+    jbyteArray result = (*env)->NewByteArray(env, (jsize)size);
+    if (!result) return NULL;
+
+    /* Pinned, not copied: font_delta_apply makes no JNI calls */
+    void* old_bytes = (*env)->GetPrimitiveArrayCritical(env, previous, NULL);
+    void* delta_bytes = (*env)->GetPrimitiveArrayCritical(env, delta, NULL);
+    void* out_bytes = (*env)->GetPrimitiveArrayCritical(env, result, NULL);
+    int status = -1;
+    if (old_bytes && delta_bytes && out_bytes) {
+        status = font_delta_apply((const uint8_t*)old_bytes, (size_t)previous_size,
+                                  (const uint8_t*)delta_bytes, (size_t)delta_size,
+                                  (uint8_t*)out_bytes, size);
+    }
+    if (out_bytes) (*env)->ReleasePrimitiveArrayCritical(env, result, out_bytes, 0);
+    if (delta_bytes) (*env)->ReleasePrimitiveArrayCritical(env, delta, delta_bytes, JNI_ABORT);
+    if (old_bytes) (*env)->ReleasePrimitiveArrayCritical(env, previous, old_bytes, JNI_ABORT);
+
+    if (status != 0) {
+        LOGE("Font delta does not apply to this font");
+        (*env)->DeleteLocalRef(env, result);
+        return NULL;
+    }
+    return result;
+}
@@ -0,0 +1,292 @@
+#include "glyph_morph.h"
+#include "glyph_outline.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Flattening tolerance and target point spacing, in em */
+#define MORPH_TOLERANCE (1.0f / 1024.0f)
+#define MORPH_SPACING   (1.0f / 64.0f)
+#define MORPH_MIN_POINTS 16
+#define MORPH_MAX_POINTS 256
+
+/* Contours enclosing less than this (em^2) don't fill anything visible */
+#define MORPH_MIN_AREA 1e-7f
+
+typedef struct {
+    size_t first; /* index of the first point in Shape.points (x, y pairs) */
+    size_t count;
+    float area;   /* signed: the sign is the winding */
+    float cx, cy;
+    float length;
+} Contour;
+
+typedef struct {
+    FloatBuffer points;
+    Contour* contours;
+    unsigned int count;
+    unsigned int capacity;
+} Shape;
+
+static void shape_free(Shape* s) {
+    fb_free(&s->points);
+    free(s->contours);
+}
+
+/* Measures the contour ending at the last point; drops it if it encloses nothing */
+static int finish_contour(Shape* s, size_t first) {
+    const float* p = s->points.data;
+    size_t count = s->points.size / 2 - first;
+    /* The closing point repeats the first one */
+    if (count > 1 && p[first * 2] == p[(first + count - 1) * 2] &&
+        p[first * 2 + 1] == p[(first + count - 1) * 2 + 1]) {
+        count--;
+    }
+
+    float area = 0.0f, cx = 0.0f, cy = 0.0f, length = 0.0f;
+    size_t i;
+    for (i = 0; i < count; i++) {
+        const float* a = p + (first + i) * 2;
+        const float* b = p + (first + (i + 1) % count) * 2;
+        float cross = a[0] * b[1] - b[0] * a[1];
+        area += cross;
+        cx += (a[0] + b[0]) * cross;
+        cy += (a[1] + b[1]) * cross;
+        length += hypotf(b[0] - a[0], b[1] - a[1]);
+    }
+    area *= 0.5f;
+    s->points.size = (first + count) * 2;
+    if (count < 3 || fabsf(area) < MORPH_MIN_AREA) {
+        s->points.size = first * 2;
+        return 0;
+    }
+
+    if (s->count == s->capacity) {
+        unsigned int cap = s->capacity ? s->capacity * 2 : 8;
+        Contour* contours = (Contour*)realloc(s->contours, cap * sizeof(Contour));
+        if (!contours) return -1;
+        s->contours = contours;
+        s->capacity = cap;
+    }
+    Contour* c = &s->contours[s->count++];
+    c->first = first;
+    c->count = count;
+    c->area = area;
+    c->cx = cx / (6.0f * area);
+    c->cy = cy / (6.0f * area);
+    c->length = length;
+    return 0;
+}
+
+/* Splits a path into closed polygonal contours */
+static int shape_parse(const float* path, size_t size, Shape* s) {
+    FloatBuffer flat;
+    fb_init(&flat);
+    outline_flatten(path, size, MORPH_TOLERANCE, &flat);
+
+    int result = 0;
+    size_t first = 0, i = 0;
+    int open = 0;
+    while (i < flat.size && result == 0) {
+        int command = (int)flat.data[i];
+        if (command == 0 || command == 1) {
+            if (command == 0 && open) result = finish_contour(s, first);
+            if (command == 0 || !open) {
+                first = s->points.size / 2;
+                open = 1;
+            }
+            fb_push(&s->points, flat.data[i + 1]);
+            fb_push(&s->points, flat.data[i + 2]);
+            i += 3;
+        } else {
+            if (open) result = finish_contour(s, first);
+            open = 0;
+            i += 1;
+        }
+    }
+    if (open && result == 0) result = finish_contour(s, first);
+    fb_free(&flat);
+    return result;
+}
+
+/* Writes |n| points evenly spaced by arc length around contour |c| into |dst| */
+static void resample(const Shape* s, const Contour* c, unsigned int n, float* dst) {
+    const float* p = s->points.data + c->first * 2;
+    float step = c->length / (float)n;
+    float walked = 0.0f; /* arc length at the start of segment |seg| */
+    size_t seg = 0;
+    unsigned int k;
+    for (k = 0; k < n; k++) {
+        float target = step * (float)k;
+        const float* a = p + seg * 2;
+        const float* b = p + ((seg + 1) % c->count) * 2;
+        float len = hypotf(b[0] - a[0], b[1] - a[1]);
+        while (walked + len < target && seg + 1 < c->count) {
+            walked += len;
+            seg++;
+            a = p + seg * 2;
+            b = p + ((seg + 1) % c->count) * 2;
+            len = hypotf(b[0] - a[0], b[1] - a[1]);
+        }
+        float t = len > 0.0f ? (target - walked) / len : 0.0f;
+        if (t > 1.0f) t = 1.0f;
+        dst[k * 2] = a[0] + (b[0] - a[0]) * t;
+        dst[k * 2 + 1] = a[1] + (b[1] - a[1]) * t;
+    }
+}
+
+static unsigned int point_count(float length) {
+    float n = ceilf(length / MORPH_SPACING);
+    if (!(n >= MORPH_MIN_POINTS)) return MORPH_MIN_POINTS;
+    return n > MORPH_MAX_POINTS ? MORPH_MAX_POINTS : (unsigned int)n;
+}
+
+/* Start offset into |b| that minimizes the summed squared distance to |a| */
+static unsigned int best_rotation(const float* a, const float* b, unsigned int n) {
+    unsigned int best = 0, k, i;
+    float best_cost = INFINITY;
+    for (k = 0; k < n; k++) {
+        float cost = 0.0f;
+        for (i = 0; i < n && cost < best_cost; i++) {
+            const float* q = b + ((i + k) % n) * 2;
+            float dx = a[i * 2] - q[0], dy = a[i * 2 + 1] - q[1];
+            cost += dx * dx + dy * dy;
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = k;
+        }
+    }
+    return best;
+}
+
+static void push_points(FloatBuffer* out, const float* points, unsigned int n, unsigned int rotation) {
+    unsigned int i;
+    fb_ensure(out, (size_t)n * 2);
+    for (i = 0; i < n; i++) {
+        const float* q = points + ((i + rotation) % n) * 2;
+        out->data[out->size++] = q[0];
+        out->data[out->size++] = q[1];
+    }
+}
+
+static void push_collapsed(FloatBuffer* out, float x, float y, unsigned int n) {
+    unsigned int i;
+    fb_ensure(out, (size_t)n * 2);
+    for (i = 0; i < n; i++) {
+        out->data[out->size++] = x;
+        out->data[out->size++] = y;
+    }
+}
+
+static void push_commands(FloatBuffer* commands, unsigned int n) {
+    unsigned int i;
+    fb_push(commands, PATH_MOVE_TO);
+    for (i = 1; i < n; i++) fb_push(commands, PATH_LINE_TO);
+    fb_push(commands, PATH_CLOSE);
+}
+
+int morph_build(const float* from, size_t from_size, const float* to, size_t to_size,
+                FloatBuffer* out) {
+    Shape a, b;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    FloatBuffer commands, coords_a, coords_b;
+    fb_init(&commands);
+    fb_init(&coords_a);
+    fb_init(&coords_b);
+    int* partner = NULL;
+    unsigned char* taken = NULL;
+    float* ra = (float*)malloc(MORPH_MAX_POINTS * 2 * sizeof(float));
+    float* rb = (float*)malloc(MORPH_MAX_POINTS * 2 * sizeof(float));
+    int result = -1;
+
+    if (!ra || !rb || shape_parse(from, from_size, &a) != 0 || shape_parse(to, to_size, &b) != 0) {
+        goto done;
+    }
+    if (a.count + b.count == 0) goto done;
+
+    partner = (int*)malloc((a.count ? a.count : 1) * sizeof(int));
+    taken = (unsigned char*)calloc(b.count ? b.count : 1, 1);
+    if (!partner || !taken) goto done;
+
+    /* Greedy matching: repeatedly pair the closest centroids of equal winding */
+    unsigned int i, j;
+    for (i = 0; i < a.count; i++) partner[i] = -1;
+    for (;;) {
+        float best = INFINITY;
+        int bi = -1, bj = -1;
+        for (i = 0; i < a.count; i++) {
+            if (partner[i] >= 0) continue;
+            for (j = 0; j < b.count; j++) {
+                if (taken[j] || (a.contours[i].area > 0.0f) != (b.contours[j].area > 0.0f)) continue;
+                float dx = a.contours[i].cx - b.contours[j].cx;
+                float dy = a.contours[i].cy - b.contours[j].cy;
+                float d = dx * dx + dy * dy;
+                if (d < best) {
+                    best = d;
+                    bi = (int)i;
+                    bj = (int)j;
+                }
+            }
+        }
+        if (bi < 0) break;
+        partner[bi] = bj;
+        taken[bj] = 1;
+    }
+
+    for (i = 0; i < a.count; i++) {
+        const Contour* ca = &a.contours[i];
+        if (partner[i] < 0) {
+            unsigned int n = point_count(ca->length);
+            resample(&a, ca, n, ra);
+            push_commands(&commands, n);
+            push_points(&coords_a, ra, n, 0);
+            push_collapsed(&coords_b, ca->cx, ca->cy, n);
+            continue;
+        }
+        const Contour* cb = &b.contours[partner[i]];
+        unsigned int n = point_count(ca->length > cb->length ? ca->length : cb->length);
+        resample(&a, ca, n, ra);
+        resample(&b, cb, n, rb);
+        push_commands(&commands, n);
+        push_points(&coords_a, ra, n, 0);
+        push_points(&coords_b, rb, n, best_rotation(ra, rb, n));
+    }
+    for (j = 0; j < b.count; j++) {
+        if (taken[j]) continue;
+        const Contour* cb = &b.contours[j];
+        unsigned int n = point_count(cb->length);
+        resample(&b, cb, n, rb);
+        push_commands(&commands, n);
+        push_collapsed(&coords_a, cb->cx, cb->cy, n);
+        push_points(&coords_b, rb, n, 0);
+    }
+
+    /* [C, P, K = 2, commands(C), keyframes 0 and 1, from coords(P), to coords(P)] */
+    fb_ensure(out, 5 + commands.size + coords_a.size * 2);
+    fb_push(out, (float)commands.size);
+    fb_push(out, (float)coords_a.size);
+    fb_push(out, 2.0f);
+    memcpy(out->data + out->size, commands.data, commands.size * sizeof(float));
+    out->size += commands.size;
+    fb_push(out, 0.0f);
+    fb_push(out, 1.0f);
+    memcpy(out->data + out->size, coords_a.data, coords_a.size * sizeof(float));
+    out->size += coords_a.size;
+    memcpy(out->data + out->size, coords_b.data, coords_b.size * sizeof(float));
+    out->size += coords_b.size;
+    result = 0;
+
+done:
+    free(ra);
+    free(rb);
+    free(partner);
+    free(taken);
+    fb_free(&commands);
+    fb_free(&coords_a);
+    fb_free(&coords_b);
+    shape_free(&a);
+    shape_free(&b);
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef GLYPH_MORPH_H
+#define GLYPH_MORPH_H
+
+#include "glyph_extractor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Point correspondence between two outlines, for morphing one glyph into
+ * another. Both paths are flattened and every contour is resampled to
+ * evenly spaced points. Contours are then paired by nearest centroid among
+ * those of the same winding, so holes only morph into holes. Each pair
+ * gets a common point count and the rotation that minimizes the total
+ * travel distance. A contour left without a partner grows from, or
+ * shrinks into, its own centroid.
+ *
+ * Appends the result to |out| in glyph_extract_animation's format with two
+ * keyframes, 0 (|from|) and 1 (|to|), so any fraction in between is a plain
+ * lerp of the coordinates. Returns 0, or -1 if both paths are empty.
+ */
+int morph_build(const float* from, size_t from_size, const float* to, size_t to_size,
+                FloatBuffer* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_MORPH_H */
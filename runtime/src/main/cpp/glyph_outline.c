@@ -0,0 +1,550 @@
+#include "glyph_outline.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Upper bound on segments per curve, whatever the tolerance */
+#define FLATTEN_MAX_SEGMENTS 256
+
+/* --- FloatBuffer helpers --- */
+
+void fb_init(FloatBuffer* fb) {
+    fb->data = NULL;
+    fb->size = 0;
+    fb->capacity = 0;
+}
+
+void fb_clear(FloatBuffer* fb) {
+    fb->size = 0;
+}
+
+void fb_ensure(FloatBuffer* fb, size_t additional) {
+    size_t needed = fb->size + additional;
+    if (needed <= fb->capacity) return;
+    size_t cap = fb->capacity ? fb->capacity * 2 : 256;
+    while (cap < needed) cap *= 2;
+    fb->data = (float*)realloc(fb->data, cap * sizeof(float));
+    fb->capacity = cap;
+}
+
+void fb_push(FloatBuffer* fb, float v) {
+    fb_ensure(fb, 1);
+    fb->data[fb->size++] = v;
+}
+
+void fb_free(FloatBuffer* fb) {
+    free(fb->data);
+    fb->data = NULL;
+    fb->size = 0;
+    fb->capacity = 0;
+}
+
+/* --- Flattening --- */
+
+static void push_command(FloatBuffer* out, float command, float x, float y) {
+    fb_ensure(out, 3);
+    out->data[out->size++] = command;
+    out->data[out->size++] = x;
+    out->data[out->size++] = y;
+}
+
+/*
+ * Segments needed so uniform chords stay within |tolerance|: a chord over a
+ * parameter step h deviates at most h^2/8 * max|B''| from the curve.
+ */
+static int segment_count(float second_diff, float scale, float tolerance) {
+    float n = ceilf(sqrtf(second_diff * scale / tolerance));
+    if (!(n >= 1.0f)) return 1;
+    return n > FLATTEN_MAX_SEGMENTS ? FLATTEN_MAX_SEGMENTS : (int)n;
+}
+
+void outline_flatten(const float* path, size_t size, float tolerance, FloatBuffer* out) {
+    float x = 0.0f, y = 0.0f;
+    size_t i = 0;
+    while (i < size) {
+        int command = (int)path[i];
+        const float* p = path + i + 1;
+        if (command == 0 || command == 1) {
+            if (i + 3 > size) return;
+            push_command(out, path[i], p[0], p[1]);
+            x = p[0];
+            y = p[1];
+            i += 3;
+        } else if (command == 2) {
+            if (i + 5 > size) return;
+            float dx = x - 2.0f * p[0] + p[2];
+            float dy = y - 2.0f * p[1] + p[3];
+            int n = segment_count(hypotf(dx, dy), 0.25f, tolerance);
+            int k;
+            for (k = 1; k <= n; k++) {
+                float t = (float)k / (float)n, u = 1.0f - t;
+                push_command(out, PATH_LINE_TO,
+                             u * u * x + 2.0f * u * t * p[0] + t * t * p[2],
+                             u * u * y + 2.0f * u * t * p[1] + t * t * p[3]);
+            }
+            x = p[2];
+            y = p[3];
+            i += 5;
+        } else if (command == 3) {
+            if (i + 7 > size) return;
+            float d1 = hypotf(x - 2.0f * p[0] + p[2], y - 2.0f * p[1] + p[3]);
+            float d2 = hypotf(p[0] - 2.0f * p[2] + p[4], p[1] - 2.0f * p[3] + p[5]);
+            int n = segment_count(d1 > d2 ? d1 : d2, 0.75f, tolerance);
+            int k;
+            for (k = 1; k <= n; k++) {
+                float t = (float)k / (float)n, u = 1.0f - t;
+                float a = u * u * u, b = 3.0f * u * u * t, c = 3.0f * u * t * t, d = t * t * t;
+                push_command(out, PATH_LINE_TO,
+                             a * x + b * p[0] + c * p[2] + d * p[4],
+                             a * y + b * p[1] + c * p[3] + d * p[5]);
+            }
+            x = p[4];
+            y = p[5];
+            i += 7;
+        } else if (command == 4) {
+            fb_push(out, PATH_CLOSE);
+            i += 1;
+        } else {
+            return;
+        }
+    }
+}
+
+/* --- Simplification --- */
+
+typedef struct {
+    float* points; /* x, y pairs of the current contour, first point repeated at the end */
+    size_t count;
+    size_t capacity;
+    unsigned char* keep;
+    size_t* stack;
+} Simplifier;
+
+static int simplifier_reserve(Simplifier* s, size_t points) {
+    if (points <= s->capacity) return 0;
+    size_t cap = s->capacity ? s->capacity * 2 : 128;
+    while (cap < points) cap *= 2;
+    float* pts = (float*)realloc(s->points, cap * 2 * sizeof(float));
+    if (pts) s->points = pts;
+    unsigned char* keep = (unsigned char*)realloc(s->keep, cap);
+    if (keep) s->keep = keep;
+    size_t* stack = (size_t*)realloc(s->stack, cap * 2 * sizeof(size_t));
+    if (stack) s->stack = stack;
+    if (!pts || !keep || !stack) return -1;
+    s->capacity = cap;
+    return 0;
+}
+
+/* Squared distance from point |p| to segment |a|-|b| */
+static float segment_dist2(const float* p, const float* a, const float* b) {
+    float vx = b[0] - a[0], vy = b[1] - a[1];
+    float wx = p[0] - a[0], wy = p[1] - a[1];
+    float len2 = vx * vx + vy * vy;
+    float t = len2 > 0.0f ? (wx * vx + wy * vy) / len2 : 0.0f;
+    if (t < 0.0f) t = 0.0f;
+    else if (t > 1.0f) t = 1.0f;
+    float dx = wx - t * vx, dy = wy - t * vy;
+    return dx * dx + dy * dy;
+}
+
+/* Marks the points of span [first, last] that RDP keeps; iterative to bound stack use */
+static void rdp(Simplifier* s, size_t first, size_t last, float tolerance2) {
+    size_t top = 0;
+    s->stack[top++] = first;
+    s->stack[top++] = last;
+    while (top) {
+        size_t b = s->stack[--top];
+        size_t a = s->stack[--top];
+        const float* pa = s->points + a * 2;
+        const float* pb = s->points + b * 2;
+        float worst = tolerance2;
+        size_t split = 0;
+        size_t i;
+        for (i = a + 1; i < b; i++) {
+            float d = segment_dist2(s->points + i * 2, pa, pb);
+            if (d > worst) {
+                worst = d;
+                split = i;
+            }
+        }
+        if (!split) continue;
+        s->keep[split] = 1;
+        s->stack[top++] = a;
+        s->stack[top++] = split;
+        s->stack[top++] = split;
+        s->stack[top++] = b;
+    }
+}
+
+static void flush_contour(Simplifier* s, float tolerance, FloatBuffer* out) {
+    size_t n = s->count;
+    /* Drop the explicit closing point; the contour is closed implicitly */
+    if (n > 1 && s->points[0] == s->points[(n - 1) * 2] &&
+        s->points[1] == s->points[(n - 1) * 2 + 1]) {
+        n--;
+    }
+    s->count = 0;
+    if (n < 3) return;
+
+    /* Split the ring at the point farthest from the start, then RDP both halves */
+    size_t far = 0, i;
+    float far_d = -1.0f;
+    for (i = 1; i < n; i++) {
+        float dx = s->points[i * 2] - s->points[0];
+        float dy = s->points[i * 2 + 1] - s->points[1];
+        float d = dx * dx + dy * dy;
+        if (d > far_d) {
+            far_d = d;
+            far = i;
+        }
+    }
+    s->points[n * 2] = s->points[0];
+    s->points[n * 2 + 1] = s->points[1];
+    memset(s->keep, 0, n + 1);
+    s->keep[0] = s->keep[far] = 1;
+    float tolerance2 = tolerance * tolerance;
+    rdp(s, 0, far, tolerance2);
+    rdp(s, far, n, tolerance2);
+
+    size_t kept = 0;
+    for (i = 0; i < n; i++) kept += s->keep[i];
+    if (kept < 3) return;
+
+    int first = 1;
+    for (i = 0; i < n; i++) {
+        if (!s->keep[i]) continue;
+        push_command(out, first ? PATH_MOVE_TO : PATH_LINE_TO, s->points[i * 2], s->points[i * 2 + 1]);
+        first = 0;
+    }
+    fb_push(out, PATH_CLOSE);
+}
+
+void outline_simplify(const float* path, size_t size, float tolerance, FloatBuffer* out) {
+    Simplifier s;
+    memset(&s, 0, sizeof(s));
+    size_t i = 0;
+    while (i < size) {
+        int command = (int)path[i];
+        if (command == 0 || command == 1) {
+            if (i + 3 > size) break;
+            if (command == 0) flush_contour(&s, tolerance, out);
+            /* One spare slot for the ring's closing copy of the first point */
+            if (simplifier_reserve(&s, s.count + 2) != 0) break;
+            s.points[s.count * 2] = path[i + 1];
+            s.points[s.count * 2 + 1] = path[i + 2];
+            s.count++;
+            i += 3;
+        } else if (command == 4) {
+            flush_contour(&s, tolerance, out);
+            i += 1;
+        } else {
+            break; /* not flattened */
+        }
+    }
+    flush_contour(&s, tolerance, out);
+    free(s.points);
+    free(s.keep);
+    free(s.stack);
+}
+
+/* --- Stroking --- */
+
+/* Android's default Paint stroke miter */
+#define STROKE_MITER_LIMIT 4.0f
+
+typedef struct {
+    FloatBuffer* out;
+    float half;      /* half the stroke width */
+    int join;
+    float tolerance;
+    int first;       /* next point starts the contour */
+} Stroker;
+
+static void stroke_point(Stroker* k, float x, float y) {
+    push_command(k->out, k->first ? PATH_MOVE_TO : PATH_LINE_TO, x, y);
+    k->first = 0;
+}
+
+/* Arc around |cx|, |cy| at radius k->half from unit normal |a| to |b|, turning by |sweep| radians */
+static void stroke_arc(Stroker* k, float cx, float cy, const float* a, float sweep) {
+    float step = 2.0f * acosf(1.0f - (k->tolerance < k->half ? k->tolerance / k->half : 1.0f));
+    int n = step > 0.0f ? (int)ceilf(fabsf(sweep) / step) : 1;
+    if (n < 1) n = 1;
+    if (n > FLATTEN_MAX_SEGMENTS) n = FLATTEN_MAX_SEGMENTS;
+    float start = atan2f(a[1], a[0]);
+    int i;
+    for (i = 1; i <= n; i++) {
+        float angle = start + sweep * (float)i / (float)n;
+        stroke_point(k, cx + cosf(angle) * k->half, cy + sinf(angle) * k->half);
+    }
+}
+
+/* Unit normal to the left of |a| -> |b| */
+static void left_normal(const float* a, const float* b, float* n) {
+    float dx = b[0] - a[0], dy = b[1] - a[1];
+    float len = hypotf(dx, dy);
+    n[0] = -dy / len;
+    n[1] = dx / len;
+}
+
+/* Left-side offset points around vertex |v| joining incoming normal |n1| to outgoing |n2| */
+static void stroke_join(Stroker* k, const float* v, const float* n1, const float* n2) {
+    float d = k->half;
+    float cross = n1[0] * n2[1] - n1[1] * n2[0];
+    float dot = n1[0] * n2[0] + n1[1] * n2[1];
+    if (fabsf(cross) < 1e-6f && dot > 0.0f) {
+        stroke_point(k, v[0] + n1[0] * d, v[1] + n1[1] * d);
+        return;
+    }
+    stroke_point(k, v[0] + n1[0] * d, v[1] + n1[1] * d);
+    if (cross > 0.0f) {
+        /* Inner side of the turn: pivot through the vertex so the corner stays covered */
+        stroke_point(k, v[0], v[1]);
+    } else if (k->join == GLYPH_JOIN_ROUND) {
+        stroke_arc(k, v[0], v[1], n1, -acosf(dot < -1.0f ? -1.0f : dot > 1.0f ? 1.0f : dot));
+        return;
+    } else if (k->join == GLYPH_JOIN_MITER && 1.0f + dot > 2.0f / (STROKE_MITER_LIMIT * STROKE_MITER_LIMIT)) {
+        /* Miter length is d / cos(theta / 2); cos^2(theta / 2) = (1 + dot) / 2 */
+        float m = d / (1.0f + dot);
+        stroke_point(k, v[0] + (n1[0] + n2[0]) * m, v[1] + (n1[1] + n2[1]) * m);
+    }
+    stroke_point(k, v[0] + n2[0] * d, v[1] + n2[1] * d);
+}
+
+/* Cap at the end |e| of a segment with unit left normal |n|, from the left side to the right */
+static void stroke_cap(Stroker* k, const float* e, const float* n, int cap) {
+    float d = k->half;
+    float ux = n[1], uy = -n[0]; /* segment direction */
+    if (cap == GLYPH_CAP_ROUND) {
+        stroke_arc(k, e[0], e[1], n, -3.14159265f);
+        return;
+    }
+    if (cap == GLYPH_CAP_SQUARE) {
+        stroke_point(k, e[0] + (n[0] + ux) * d, e[1] + (n[1] + uy) * d);
+        stroke_point(k, e[0] + (-n[0] + ux) * d, e[1] + (-n[1] + uy) * d);
+    }
+    stroke_point(k, e[0] - n[0] * d, e[1] - n[1] * d);
+}
+
+/* Left offset of |pts| traversed forward (|dir| 1) or backward (-1) */
+static void stroke_side(Stroker* k, const float* pts, size_t n, int closed, int dir) {
+    size_t i;
+    float n1[2], n2[2];
+#define PT(j) (pts + (dir > 0 ? (j) : n - 1 - (j)) * 2)
+    if (closed) {
+        left_normal(PT(n - 1), PT(0), n1);
+        for (i = 0; i < n; i++) {
+            left_normal(PT(i), PT((i + 1) % n), n2);
+            stroke_join(k, PT(i), n1, n2);
+            n1[0] = n2[0];
+            n1[1] = n2[1];
+        }
+        return;
+    }
+    left_normal(PT(0), PT(1), n1);
+    if (k->first) stroke_point(k, PT(0)[0] + n1[0] * k->half, PT(0)[1] + n1[1] * k->half);
+    for (i = 1; i + 1 < n; i++) {
+        left_normal(PT(i), PT(i + 1), n2);
+        stroke_join(k, PT(i), n1, n2);
+        n1[0] = n2[0];
+        n1[1] = n2[1];
+    }
+    stroke_point(k, PT(n - 1)[0] + n1[0] * k->half, PT(n - 1)[1] + n1[1] * k->half);
+#undef PT
+}
+
+static void stroke_contour(Stroker* k, float* pts, size_t n, int closed, int cap) {
+    /* Drop repeated points: zero-length segments have no direction */
+    size_t i, m = 0;
+    for (i = 0; i < n; i++) {
+        if (m && pts[i * 2] == pts[(m - 1) * 2] && pts[i * 2 + 1] == pts[(m - 1) * 2 + 1]) continue;
+        pts[m * 2] = pts[i * 2];
+        pts[m * 2 + 1] = pts[i * 2 + 1];
+        m++;
+    }
+    if (closed && m > 1 && pts[0] == pts[(m - 1) * 2] && pts[1] == pts[(m - 1) * 2 + 1]) m--;
+    if (m < 2) return;
+    if (m == 2) closed = 0;
+
+    if (closed) {
+        /* Both sides as separate rings; the second runs backward so nonzero fill leaves the inside empty */
+        k->first = 1;
+        stroke_side(k, pts, m, 1, 1);
+        fb_push(k->out, PATH_CLOSE);
+        k->first = 1;
+        stroke_side(k, pts, m, 1, -1);
+        fb_push(k->out, PATH_CLOSE);
+        return;
+    }
+
+    float n_end[2], n_start[2];
+    left_normal(pts + (m - 2) * 2, pts + (m - 1) * 2, n_end);
+    left_normal(pts + 2, pts, n_start);
+    k->first = 1;
+    stroke_side(k, pts, m, 0, 1);
+    stroke_cap(k, pts + (m - 1) * 2, n_end, cap);
+    stroke_side(k, pts, m, 0, -1);
+    stroke_cap(k, pts, n_start, cap);
+    fb_push(k->out, PATH_CLOSE);
+}
+
+void outline_stroke(const float* path, size_t size, float width, int join, int cap,
+                    float tolerance, FloatBuffer* out) {
+    FloatBuffer flat, pts;
+    fb_init(&flat);
+    fb_init(&pts);
+    outline_flatten(path, size, tolerance, &flat);
+
+    Stroker k = { out, width * 0.5f, join, tolerance, 1 };
+    size_t i = 0;
+    while (i < flat.size) {
+        int command = (int)flat.data[i];
+        if (command == 0 || command == 1) {
+            if (command == 0 && pts.size) {
+                stroke_contour(&k, pts.data, pts.size / 2, 0, cap);
+                fb_clear(&pts);
+            }
+            fb_push(&pts, flat.data[i + 1]);
+            fb_push(&pts, flat.data[i + 2]);
+            i += 3;
+        } else {
+            if (pts.size) stroke_contour(&k, pts.data, pts.size / 2, 1, cap);
+            fb_clear(&pts);
+            i += 1;
+        }
+    }
+    if (pts.size) stroke_contour(&k, pts.data, pts.size / 2, 0, cap);
+    fb_free(&flat);
+    fb_free(&pts);
+}
+
+/* --- Emboldening --- */
+
+/* Corners sharper than this (cosine of the turn) are left in place instead of spiking */
+#define EMBOLDEN_MIN_COS -0.9375f
+
+typedef struct {
+    size_t* at;   /* offset of each contour point's x in the output */
+    size_t count;
+    size_t capacity;
+} PointList;
+
+static int point_list_push(PointList* l, size_t at) {
+    if (l->count == l->capacity) {
+        size_t cap = l->capacity ? l->capacity * 2 : 64;
+        size_t* grown = (size_t*)realloc(l->at, cap * sizeof(size_t));
+        if (!grown) return -1;
+        l->at = grown;
+        l->capacity = cap;
+    }
+    l->at[l->count++] = at;
+    return 0;
+}
+
+/* Twice the signed shoelace area of the control polygon through |n| points */
+static float polygon_area2(const float* data, const size_t* at, size_t n) {
+    float area = 0.0f;
+    size_t i;
+    for (i = 0; i < n; i++) {
+        const float* a = data + at[i];
+        const float* b = data + at[(i + 1) % n];
+        area += a[0] * b[1] - b[0] * a[1];
+    }
+    return area;
+}
+
+/* Nearest point before (|step| -1) or after (1) point |i| with different coordinates */
+static const float* distinct_neighbour(const float* src, const size_t* at, size_t n, size_t i, int step) {
+    const float* p = src + at[i];
+    size_t j = i, k;
+    for (k = 1; k < n; k++) {
+        j = step > 0 ? (j + 1) % n : (j + n - 1) % n;
+        const float* q = src + at[j];
+        if (q[0] != p[0] || q[1] != p[1]) return q;
+    }
+    return NULL;
+}
+
+/*
+ * Moves every point of one contour, read from |src| and written to |dst| at
+ * the same offsets, |half| along the miter of its two edges. |outward| is
+ * 1 when the outside lies to the right of the direction of travel.
+ */
+static void embolden_contour(const float* src, float* dst, const size_t* at, size_t n,
+                             float half, float outward) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        const float* p = src + at[i];
+        const float* prev = distinct_neighbour(src, at, n, i, -1);
+        const float* next = distinct_neighbour(src, at, n, i, 1);
+        if (!prev || !next) continue;
+
+        float ix = p[0] - prev[0], iy = p[1] - prev[1];
+        float ox = next[0] - p[0], oy = next[1] - p[1];
+        float l_in = hypotf(ix, iy), l_out = hypotf(ox, oy);
+        ix /= l_in;
+        iy /= l_in;
+        ox /= l_out;
+        oy /= l_out;
+
+        float d = ix * ox + iy * oy;
+        if (d <= EMBOLDEN_MIN_COS) continue;
+        d += 1.0f;
+
+        /* Sum of both outward normals; scaled by 1 / (1 + cos) it reaches |half| from each edge */
+        float sx = (iy + oy) * outward, sy = -(ix + ox) * outward;
+        float q = fabsf(ox * iy - oy * ix);
+        float l = l_in < l_out ? l_in : l_out;
+        float scale = fabsf(half) * q <= l * d ? half / d : (half < 0.0f ? -l : l) / q;
+        dst[at[i]] += sx * scale;
+        dst[at[i] + 1] += sy * scale;
+    }
+}
+
+void outline_embolden(const float* path, size_t size, float strength, FloatBuffer* out) {
+    size_t base = out->size;
+    fb_ensure(out, size);
+    memcpy(out->data + base, path, size * sizeof(float));
+    out->size += size;
+
+    /* Offsets of every on- and off-curve point, contour by contour */
+    PointList points = { NULL, 0, 0 };
+    PointList starts = { NULL, 0, 0 };
+    size_t i = 0;
+    int open = 0;
+    while (i < size) {
+        int command = (int)path[i];
+        int coords = command == 0 || command == 1 ? 1 : command == 2 ? 2 : command == 3 ? 3 : 0;
+        if (command == 0 || (coords && !open)) {
+            if (point_list_push(&starts, points.count) != 0) goto done;
+            open = 1;
+        } else if (!coords) {
+            open = 0;
+        }
+        int k;
+        for (k = 0; k < coords; k++) {
+            if (point_list_push(&points, i + 1 + (size_t)k * 2) != 0) goto done;
+        }
+        i += 1 + (size_t)coords * 2;
+    }
+    if (point_list_push(&starts, points.count) != 0) goto done;
+
+    /* Outer contours and holes wind in opposite directions, so one overall orientation decides outward */
+    float area = 0.0f;
+    size_t c;
+    for (c = 0; c + 1 < starts.count; c++) {
+        area += polygon_area2(path, points.at + starts.at[c], starts.at[c + 1] - starts.at[c]);
+    }
+    float outward = area > 0.0f ? 1.0f : -1.0f;
+    for (c = 0; c + 1 < starts.count; c++) {
+        size_t n = starts.at[c + 1] - starts.at[c];
+        if (n >= 3) {
+            embolden_contour(path, out->data + base, points.at + starts.at[c], n,
+                             strength * 0.5f, outward);
+        }
+    }
+
+done:
+    free(points.at);
+    free(starts.at);
+}
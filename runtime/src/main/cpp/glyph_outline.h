@@ -0,0 +1,60 @@
+#ifndef GLYPH_OUTLINE_H
+#define GLYPH_OUTLINE_H
+
+#include "glyph_extractor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Geometry on extracted path streams (the PATH_* float format, em units):
+ * the FloatBuffer helpers shared by the runtime, curve flattening and
+ * polyline simplification. Nothing here touches a font.
+ */
+
+void fb_init(FloatBuffer* fb);
+void fb_clear(FloatBuffer* fb);
+void fb_ensure(FloatBuffer* fb, size_t additional);
+void fb_push(FloatBuffer* fb, float v);
+void fb_free(FloatBuffer* fb);
+
+/*
+ * Appends |path| to |out| with every quad and cubic replaced by line segments
+ * that stay within |tolerance| of the curve. Moves and closes pass through.
+ */
+void outline_flatten(const float* path, size_t size, float tolerance, FloatBuffer* out);
+
+/*
+ * Ramer-Douglas-Peucker over each contour of a flattened |path| (moves, lines
+ * and closes only), treating contours as closed. Every dropped point lies
+ * within |tolerance| of the simplified outline; contours that collapse below
+ * three points are dropped. Appends closed contours to |out|.
+ */
+void outline_simplify(const float* path, size_t size, float tolerance, FloatBuffer* out);
+
+/*
+ * Appends the outline of |path| stroked at |width| as a path to fill with
+ * the nonzero rule. Curves are flattened to |tolerance| first. A closed
+ * contour becomes two rings, one per side, the inner one reversed. An open
+ * contour becomes one ring with |cap| at both ends. |join| and |cap| are
+ * GLYPH_JOIN_* and GLYPH_CAP_*; miters past Paint's default miter limit of 4
+ * fall back to bevels.
+ */
+void outline_stroke(const float* path, size_t size, float width, int join, int cap,
+                    float tolerance, FloatBuffer* out);
+
+/*
+ * Appends |path| with every contour offset outward by |strength| / 2, so
+ * stems grow |strength| wider (thinner when negative) and the glyph keeps
+ * its center. Each point, control points included, moves along the miter of
+ * its two edges, capped by the shorter edge; curves keep their commands, as
+ * in FreeType's FT_Outline_Embolden. Holes shrink as outer contours grow.
+ */
+void outline_embolden(const float* path, size_t size, float strength, FloatBuffer* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_OUTLINE_H */
@@ -0,0 +1,222 @@
+#define _POSIX_C_SOURCE 200809L
+
+/*
+ * Host-only check that the HarfBuzz and sfnt reader backends emit the same
+ * path streams. CMake builds it once per backend with GLYPHRUNTIME_PARITY_CHECK:
+ *
+ *   glyph_parity_harfbuzz dump <font> <codepoints> <out>
+ *   glyph_parity_sfnt compare <font> <codepoints> <dump>
+ *
+ * Every PARITY_STRIDE-th icon of the .codepoints file is extracted at the
+ * default instance and with all axes at their minimum, halfway and maximum.
+ * Both modes print the best-of-five time per extraction, so the same run
+ * measures the two backends on the same sample.
+ */
+
+#include "glyph_extractor.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PARITY_STRIDE     16
+#define PARITY_SETS       4
+#define PARITY_PASSES     5
+#define PARITY_MAX_AXES   16
+#define PARITY_MAX_ERRORS 10
+
+/* Path coordinates are em-normalized; well under a unit at any upem */
+#define PARITY_TOLERANCE (1.0f / 16384.0f)
+
+#ifdef GLYPH_SFNT_READER
+#define PARITY_BACKEND "sfnt reader"
+#else
+#define PARITY_BACKEND "HarfBuzz"
+#endif
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static uint8_t* read_file(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    uint8_t* data = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long length = ftell(f);
+        if (length > 0 && fseek(f, 0, SEEK_SET) == 0) {
+            data = (uint8_t*)malloc((size_t)length);
+            if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+                free(data);
+                data = NULL;
+            }
+            *size = (size_t)length;
+        }
+    }
+    fclose(f);
+    return data;
+}
+
+/* Every PARITY_STRIDE-th codepoint of a .codepoints file ("name hex" lines) */
+static uint32_t* sample_codepoints(const char* path, unsigned int* count) {
+    FILE* f = fopen(path, "r");
+    if (!f) return NULL;
+    uint32_t* codepoints = NULL;
+    unsigned int capacity = 0, line = 0;
+    char name[256];
+    unsigned int codepoint;
+    *count = 0;
+    while (fscanf(f, "%255s %x", name, &codepoint) == 2) {
+        if (line++ % PARITY_STRIDE != 0) continue;
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            uint32_t* grown = (uint32_t*)realloc(codepoints, capacity * sizeof(uint32_t));
+            if (!grown) break;
+            codepoints = grown;
+        }
+        codepoints[(*count)++] = codepoint;
+    }
+    fclose(f);
+    return codepoints;
+}
+
+/* Set 0 is the default instance; 1..3 put every axis at min, halfway, max */
+static void set_coords(const GlyphAxis* axes, unsigned int num_axes, int set, float* coords) {
+    unsigned int a;
+    for (a = 0; a < num_axes; a++) {
+        switch (set) {
+        case 0: coords[a] = axes[a].default_value; break;
+        case 1: coords[a] = axes[a].min_value; break;
+        case 2: coords[a] = (axes[a].min_value + axes[a].max_value) / 2; break;
+        default: coords[a] = axes[a].max_value; break;
+        }
+    }
+}
+
+/* Best-of-PARITY_PASSES microseconds per extraction over the sample */
+static double time_extraction(FontHandle* font, const uint32_t* codepoints, unsigned int count,
+                              const GlyphAxis* axes, unsigned int num_axes) {
+    float coords[PARITY_MAX_AXES];
+    double best = 0;
+    int pass, set;
+    for (pass = 0; pass < PARITY_PASSES; pass++) {
+        double start = now_us();
+        for (set = 0; set < PARITY_SETS; set++) {
+            set_coords(axes, num_axes, set, coords);
+            unsigned int i;
+            for (i = 0; i < count; i++) {
+                const float* data;
+                size_t size;
+                glyph_extract_coords(font, codepoints[i], coords, num_axes, &data, &size);
+            }
+        }
+        double elapsed = now_us() - start;
+        if (pass == 0 || elapsed < best) best = elapsed;
+    }
+    return best / ((double)count * PARITY_SETS);
+}
+
+static int usage(void) {
+    fprintf(stderr, "usage: glyph_parity dump|compare <font> <codepoints> <dump file>\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 5) return usage();
+    const int dump = strcmp(argv[1], "dump") == 0;
+    if (!dump && strcmp(argv[1], "compare") != 0) return usage();
+
+    size_t font_size = 0;
+    uint8_t* font_data = read_file(argv[2], &font_size);
+    unsigned int count = 0;
+    uint32_t* codepoints = sample_codepoints(argv[3], &count);
+    FontHandle* font = font_data ? font_create(font_data, font_size) : NULL;
+    if (!font || !codepoints || count == 0) {
+        fprintf(stderr, "cannot load %s with %s\n", argv[2], argv[3]);
+        return 2;
+    }
+    const GlyphAxis* axes;
+    unsigned int num_axes = glyph_get_axes(font, &axes);
+    if (num_axes > PARITY_MAX_AXES) num_axes = PARITY_MAX_AXES;
+
+    FILE* f = fopen(argv[4], dump ? "wb" : "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", argv[4]);
+        return 2;
+    }
+
+    /* Per stream: i32 status, u32 float count, the floats */
+    float coords[PARITY_MAX_AXES];
+    float* expected = NULL;
+    size_t expected_capacity = 0;
+    unsigned int streams = 0, errors = 0;
+    float max_difference = 0;
+    int set;
+    for (set = 0; set < PARITY_SETS; set++) {
+        set_coords(axes, num_axes, set, coords);
+        unsigned int i;
+        for (i = 0; i < count; i++) {
+            const float* data = NULL;
+            size_t size = 0;
+            int32_t status = glyph_extract_coords(font, codepoints[i], coords, num_axes, &data, &size);
+            uint32_t length = status == 0 ? (uint32_t)size : 0;
+            streams++;
+
+            if (dump) {
+                fwrite(&status, sizeof(status), 1, f);
+                fwrite(&length, sizeof(length), 1, f);
+                if (length) fwrite(data, sizeof(float), length, f);
+                continue;
+            }
+
+            int32_t expected_status;
+            uint32_t expected_length;
+            if (fread(&expected_status, sizeof(expected_status), 1, f) != 1 ||
+                fread(&expected_length, sizeof(expected_length), 1, f) != 1) {
+                fprintf(stderr, "%s ends before U+%04X\n", argv[4], codepoints[i]);
+                return 1;
+            }
+            if (expected_length > expected_capacity) {
+                float* grown = (float*)realloc(expected, expected_length * sizeof(float));
+                if (!grown) return 2;
+                expected = grown;
+                expected_capacity = expected_length;
+            }
+            if (expected_length && fread(expected, sizeof(float), expected_length, f) != expected_length) {
+                fprintf(stderr, "%s is truncated at U+%04X\n", argv[4], codepoints[i]);
+                return 1;
+            }
+
+            float difference = 0;
+            uint32_t k;
+            if (status == expected_status && length == expected_length) {
+                for (k = 0; k < length; k++) {
+                    float d = fabsf(data[k] - expected[k]);
+                    if (d > difference) difference = d;
+                }
+                if (difference > max_difference) max_difference = difference;
+            }
+            if (status != expected_status || length != expected_length || difference > PARITY_TOLERANCE) {
+                if (errors++ < PARITY_MAX_ERRORS) {
+                    fprintf(stderr, "U+%04X set %d: status %d/%d, %u/%u floats, max difference %g\n",
+                            codepoints[i], set, (int)status, (int)expected_status,
+                            (unsigned)length, (unsigned)expected_length, difference);
+                }
+            }
+        }
+    }
+    fclose(f);
+
+    printf("%s: %u streams, %.2f us per extraction\n", PARITY_BACKEND, streams,
+           time_extraction(font, codepoints, count, axes, num_axes));
+    if (!dump) printf("%u mismatches, max difference %g em\n", errors, max_difference);
+
+    free(expected);
+    font_destroy(font);
+    free(codepoints);
+    free(font_data);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "glyph_profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PROFILE_MAGIC   0x50594C47u /* "GLYP" */
+#define PROFILE_VERSION 1
+
+/* A first screen rarely shows more than a few dozen icons */
+#define PROFILE_MAX_ENTRIES 256
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t axis_count;
+    uint64_t font_hash;
+    uint32_t count;
+    uint32_t reserved;
+} ProfileHeader;
+
+_Static_assert(sizeof(ProfileHeader) == 24, "ProfileHeader layout");
+
+/* Entries as stored: codepoint + axis_count i16 coords each */
+typedef struct {
+    uint32_t* codepoints;
+    int16_t* coords;
+    unsigned int count;
+} EntryList;
+
+struct GlyphProfile {
+    char path[1024];
+    uint64_t font_hash;
+    unsigned int axis_count;
+
+    EntryList previous;
+
+    EntryList current;
+    int* current_keys;
+    int64_t deadline_ns;
+    int recording;
+};
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int list_alloc(EntryList* list, unsigned int capacity, unsigned int axis_count) {
+    list->count = 0;
+    list->codepoints = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    list->coords = (int16_t*)malloc((size_t)capacity * (axis_count ? axis_count : 1) * sizeof(int16_t));
+    return list->codepoints && list->coords ? 0 : -1;
+}
+
+static void list_free(EntryList* list) {
+    free(list->codepoints);
+    free(list->coords);
+}
+
+static void load_previous(GlyphProfile* p) {
+    FILE* f = fopen(p->path, "rb");
+    if (!f) return;
+    ProfileHeader header;
+    if (fread(&header, sizeof(header), 1, f) == 1 &&
+        header.magic == PROFILE_MAGIC && header.version == PROFILE_VERSION &&
+        header.axis_count == p->axis_count && header.font_hash == p->font_hash &&
+        header.count <= PROFILE_MAX_ENTRIES) {
+        size_t n = header.count;
+        if (fread(p->previous.codepoints, sizeof(uint32_t), n, f) == n &&
+            fread(p->previous.coords, sizeof(int16_t), n * p->axis_count, f) ==
+                n * p->axis_count) {
+            p->previous.count = header.count;
+        }
+    }
+    fclose(f);
+}
+
+static void write_current(const GlyphProfile* p) {
+    char tmp[sizeof(p->path) + 4];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", p->path);
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return;
+
+    const EntryList* list = &p->current;
+    ProfileHeader header = {
+        PROFILE_MAGIC, PROFILE_VERSION, (uint16_t)p->axis_count, p->font_hash, list->count, 0
+    };
+    size_t n = list->count;
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(list->codepoints, sizeof(uint32_t), n, f) == n &&
+             fwrite(list->coords, sizeof(int16_t), n * p->axis_count, f) == n * p->axis_count;
+    ok = fclose(f) == 0 && ok;
+    /* Readers only ever see a complete file */
+    if (ok) ok = rename(tmp, p->path) == 0;
+    if (!ok) remove(tmp);
+}
+
+static void stop_recording(GlyphProfile* p) {
+    p->recording = 0;
+    if (p->current.count) write_current(p);
+}
+
+GlyphProfile* glyph_profile_open(const char* dir, uint64_t font_hash,
+                                 unsigned int axis_count, int64_t window_ns) {
+    GlyphProfile* p = (GlyphProfile*)calloc(1, sizeof(GlyphProfile));
+    if (!p) return NULL;
+    int n = snprintf(p->path, sizeof(p->path), "%s/glyphprofile-%016llx.bin",
+                     dir, (unsigned long long)font_hash);
+    p->font_hash = font_hash;
+    p->axis_count = axis_count;
+    p->current_keys = (int*)malloc(PROFILE_MAX_ENTRIES * sizeof(int));
+    if (n < 0 || (size_t)n >= sizeof(p->path) || !p->current_keys ||
+        list_alloc(&p->previous, PROFILE_MAX_ENTRIES, axis_count) != 0 ||
+        list_alloc(&p->current, PROFILE_MAX_ENTRIES, axis_count) != 0) {
+        glyph_profile_close(p);
+        return NULL;
+    }
+
+    load_previous(p);
+    p->deadline_ns = now_ns() + window_ns;
+    p->recording = 1;
+    return p;
+}
+
+void glyph_profile_close(GlyphProfile* p) {
+    if (!p) return;
+    if (p->recording) stop_recording(p);
+    list_free(&p->previous);
+    list_free(&p->current);
+    free(p->current_keys);
+    free(p);
+}
+
+void glyph_profile_record(GlyphProfile* p, uint32_t codepoint, int key, const int* coords) {
+    if (!p->recording) return;
+    if (now_ns() > p->deadline_ns) {
+        stop_recording(p);
+        return;
+    }
+
+    EntryList* list = &p->current;
+    unsigned int i;
+    for (i = 0; i < list->count; i++) {
+        if (list->codepoints[i] == codepoint && p->current_keys[i] == key) return;
+    }
+    if (list->count == PROFILE_MAX_ENTRIES) return;
+
+    int16_t* dst = list->coords + (size_t)list->count * p->axis_count;
+    for (i = 0; i < p->axis_count; i++) dst[i] = coords ? (int16_t)coords[i] : 0;
+    list->codepoints[list->count] = codepoint;
+    p->current_keys[list->count] = key;
+    list->count++;
+}
+
+unsigned int glyph_profile_previous_count(const GlyphProfile* p) {
+    return p->previous.count;
+}
+
+uint32_t glyph_profile_previous_entry(const GlyphProfile* p, unsigned int index, int* coords) {
+    const int16_t* src = p->previous.coords + (size_t)index * p->axis_count;
+    unsigned int i;
+    for (i = 0; i < p->axis_count; i++) coords[i] = src[i];
+    return p->previous.codepoints[index];
+}
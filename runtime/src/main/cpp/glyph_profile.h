@@ -0,0 +1,44 @@
+#ifndef GLYPH_PROFILE_H
+#define GLYPH_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Startup usage profile: the distinct (codepoint, variation) pairs extracted
+ * during the first seconds of a session, stored as normalized 2.14 coords in
+ * <dir>/glyphprofile-<font_hash>.bin. Opening loads the previous session's
+ * list for prewarming and starts recording the current one, which is written
+ * (atomically, via rename) once the window has passed or on close.
+ */
+
+typedef struct GlyphProfile GlyphProfile;
+
+/* Returns NULL on allocation failure; a missing or stale file just means no previous entries. */
+GlyphProfile* glyph_profile_open(const char* dir, uint64_t font_hash,
+                                 unsigned int axis_count, int64_t window_ns);
+
+/* Writes the recording if it's still running and non-empty. */
+void glyph_profile_close(GlyphProfile* profile);
+
+/*
+ * Records one extraction. |key| identifies the variation within this session
+ * (the registered id) so repeats are skipped without comparing coords.
+ */
+void glyph_profile_record(GlyphProfile* profile, uint32_t codepoint, int key, const int* coords);
+
+/* Entries loaded from the previous session */
+unsigned int glyph_profile_previous_count(const GlyphProfile* profile);
+
+/* Writes entry |index|'s axis_count normalized coords into |coords| and returns its codepoint. */
+uint32_t glyph_profile_previous_entry(const GlyphProfile* profile, unsigned int index, int* coords);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_PROFILE_H */
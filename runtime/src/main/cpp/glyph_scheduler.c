@@ -0,0 +1,334 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "glyph_scheduler.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct Job {
+    int64_t request_id;
+    int priority;
+    int kind;
+    uint32_t codepoint;
+    int* variation_ids;
+    unsigned int num_ids;
+    float tolerance;
+    int64_t deadline_ns;
+    struct Job* next;
+} Job;
+
+typedef struct {
+    Job* head;
+    Job* tail;
+} JobQueue;
+
+struct GlyphScheduler {
+    FontHandle* font;
+    GlyphSchedulerCallbacks callbacks;
+
+    pthread_mutex_t font_lock;      /* exclusive access to |font| */
+    atomic_int visible_waiters;     /* sync callers waiting for or holding font_lock */
+
+    pthread_mutex_t queue_lock;     /* guards everything below */
+    pthread_cond_t work_cond;       /* signalled on submit and stop */
+    pthread_cond_t visible_idle;    /* signalled when visible_waiters drops to 0 */
+    JobQueue queues[2];             /* indexed by priority */
+    int64_t running_id;
+    int running_cancelled;
+    int worker_started;
+    int stopping;
+    pthread_t worker;
+
+    float* result;                  /* worker-only copy of the last result */
+    size_t result_capacity;
+};
+
+int64_t scheduler_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void job_free(Job* job) {
+    free(job->variation_ids);
+    free(job);
+}
+
+static void queue_push(JobQueue* q, Job* job) {
+    job->next = NULL;
+    if (q->tail) q->tail->next = job;
+    else q->head = job;
+    q->tail = job;
+}
+
+static Job* queue_pop(JobQueue* q) {
+    Job* job = q->head;
+    if (job) {
+        q->head = job->next;
+        if (!q->head) q->tail = NULL;
+    }
+    return job;
+}
+
+static Job* queue_remove(JobQueue* q, int64_t request_id) {
+    Job* prev = NULL;
+    Job* job = q->head;
+    while (job) {
+        if (job->request_id == request_id) {
+            if (prev) prev->next = job->next;
+            else q->head = job->next;
+            if (q->tail == job) q->tail = prev;
+            return job;
+        }
+        prev = job;
+        job = job->next;
+    }
+    return NULL;
+}
+
+static void report(GlyphScheduler* s, int64_t request_id, int status,
+                   const float* data, size_t size) {
+    s->callbacks.on_result(s->callbacks.user, request_id, status, data, size);
+}
+
+/* Blocks until no synchronous caller is waiting; prefetch must not contend with them */
+static void wait_for_visible_idle(GlyphScheduler* s) {
+    pthread_mutex_lock(&s->queue_lock);
+    while (atomic_load(&s->visible_waiters) > 0 && !s->stopping) {
+        pthread_cond_wait(&s->visible_idle, &s->queue_lock);
+    }
+    pthread_mutex_unlock(&s->queue_lock);
+}
+
+/* Copies |data| into the worker's result buffer; 0 if it can't grow */
+static int copy_result(GlyphScheduler* s, const float* data, size_t size) {
+    if (size > s->result_capacity) {
+        float* grown = (float*)realloc(s->result, size * sizeof(float));
+        if (!grown) return 0;
+        s->result = grown;
+        s->result_capacity = size;
+    }
+    memcpy(s->result, data, size * sizeof(float));
+    return 1;
+}
+
+static int run_job(FontHandle* font, const Job* job, const float** data, size_t* size) {
+    int result;
+    switch (job->kind) {
+    case SCHED_JOB_PATH:
+        result = glyph_extract_variation(font, job->codepoint, job->variation_ids[0], data, size);
+        break;
+    case SCHED_JOB_BATCH:
+        result = glyph_extract_variation_batch(font, job->codepoint, job->variation_ids,
+                                               job->num_ids, data, size);
+        break;
+    case SCHED_JOB_ANIMATION:
+        result = glyph_extract_animation(font, job->codepoint, job->variation_ids,
+                                         job->num_ids, job->tolerance, data, size);
+        break;
+    default:
+        result = -1;
+        break;
+    }
+    if (result == -2) return SCHED_TOPOLOGY_MISMATCH;
+    if (result == GLYPH_OVER_BUDGET) return SCHED_OVER_BUDGET;
+    return result == 0 ? SCHED_OK : SCHED_NOT_FOUND;
+}
+
+static void* worker_main(void* arg) {
+    GlyphScheduler* s = (GlyphScheduler*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&s->queue_lock);
+        Job* job = NULL;
+        while (!s->stopping) {
+            job = queue_pop(&s->queues[SCHED_PRIORITY_VISIBLE]);
+            if (!job) job = queue_pop(&s->queues[SCHED_PRIORITY_PREFETCH]);
+            if (job) break;
+            pthread_cond_wait(&s->work_cond, &s->queue_lock);
+        }
+        if (!job) {
+            pthread_mutex_unlock(&s->queue_lock);
+            break;
+        }
+        s->running_id = job->request_id;
+        s->running_cancelled = 0;
+        pthread_mutex_unlock(&s->queue_lock);
+
+        if (job->deadline_ns && scheduler_now_ns() > job->deadline_ns) {
+            report(s, job->request_id, SCHED_DEADLINE_MISSED, NULL, 0);
+            job_free(job);
+            continue;
+        }
+
+        /* Prefetch yields to synchronous callers, re-checking after taking the lock */
+        for (;;) {
+            if (job->priority == SCHED_PRIORITY_PREFETCH) wait_for_visible_idle(s);
+            pthread_mutex_lock(&s->font_lock);
+            if (job->priority != SCHED_PRIORITY_PREFETCH ||
+                atomic_load(&s->visible_waiters) == 0 || s->stopping) {
+                break;
+            }
+            pthread_mutex_unlock(&s->font_lock);
+        }
+
+        /* Waiting for visible callers and the lock may have used up the deadline */
+        const float* data = NULL;
+        size_t size = 0;
+        int status = job->deadline_ns && scheduler_now_ns() > job->deadline_ns
+                         ? SCHED_DEADLINE_MISSED
+                         : run_job(s->font, job, &data, &size);
+
+        pthread_mutex_lock(&s->queue_lock);
+        if (s->running_cancelled) status = SCHED_CANCELLED;
+        s->running_id = 0;
+        pthread_mutex_unlock(&s->queue_lock);
+
+        /*
+         * |data| points into the font's buffer. Report a copy after releasing
+         * font_lock so synchronous callers don't wait on the callback; a copy
+         * that can't be allocated is over budget like a path that can't grow.
+         */
+        if (status == SCHED_OK && size > 0 && !copy_result(s, data, size)) status = SCHED_OVER_BUDGET;
+        pthread_mutex_unlock(&s->font_lock);
+        if (status != SCHED_OK) {
+            report(s, job->request_id, status, NULL, 0);
+        } else {
+            report(s, job->request_id, status, s->result, size);
+        }
+
+        job_free(job);
+    }
+
+    if (s->callbacks.on_worker_exit) s->callbacks.on_worker_exit(s->callbacks.user);
+    return NULL;
+}
+
+GlyphScheduler* scheduler_create(FontHandle* font, const GlyphSchedulerCallbacks* callbacks) {
+    GlyphScheduler* s = (GlyphScheduler*)calloc(1, sizeof(GlyphScheduler));
+    if (!s) return NULL;
+    s->font = font;
+    s->callbacks = *callbacks;
+    atomic_init(&s->visible_waiters, 0);
+    pthread_mutex_init(&s->font_lock, NULL);
+    pthread_mutex_init(&s->queue_lock, NULL);
+    pthread_cond_init(&s->work_cond, NULL);
+    pthread_cond_init(&s->visible_idle, NULL);
+    return s;
+}
+
+void* scheduler_get_user(const GlyphScheduler* s) {
+    return s->callbacks.user;
+}
+
+void scheduler_destroy(GlyphScheduler* s) {
+    if (!s) return;
+
+    pthread_mutex_lock(&s->queue_lock);
+    s->stopping = 1;
+    s->running_cancelled = 1;
+    pthread_cond_broadcast(&s->work_cond);
+    pthread_cond_broadcast(&s->visible_idle);
+    int started = s->worker_started;
+    pthread_mutex_unlock(&s->queue_lock);
+
+    if (started) pthread_join(s->worker, NULL);
+
+    /* Anything still queued never ran */
+    int p;
+    for (p = 0; p < 2; p++) {
+        Job* job;
+        while ((job = queue_pop(&s->queues[p])) != NULL) {
+            report(s, job->request_id, SCHED_CANCELLED, NULL, 0);
+            job_free(job);
+        }
+    }
+
+    pthread_cond_destroy(&s->visible_idle);
+    pthread_cond_destroy(&s->work_cond);
+    pthread_mutex_destroy(&s->queue_lock);
+    pthread_mutex_destroy(&s->font_lock);
+    font_destroy(s->font);
+    free(s->result);
+    free(s);
+}
+
+FontHandle* scheduler_acquire(GlyphScheduler* s) {
+    atomic_fetch_add(&s->visible_waiters, 1);
+    pthread_mutex_lock(&s->font_lock);
+    return s->font;
+}
+
+void scheduler_release(GlyphScheduler* s) {
+    pthread_mutex_unlock(&s->font_lock);
+    if (atomic_fetch_sub(&s->visible_waiters, 1) == 1) {
+        pthread_mutex_lock(&s->queue_lock);
+        pthread_cond_broadcast(&s->visible_idle);
+        pthread_mutex_unlock(&s->queue_lock);
+    }
+}
+
+int scheduler_submit(
+    GlyphScheduler* s,
+    int64_t request_id,
+    int priority,
+    int kind,
+    uint32_t codepoint,
+    const int* variation_ids,
+    unsigned int num_ids,
+    float tolerance,
+    int64_t deadline_ns
+) {
+    if (priority != SCHED_PRIORITY_VISIBLE && priority != SCHED_PRIORITY_PREFETCH) return -1;
+    if (num_ids == 0) return -1;
+
+    Job* job = (Job*)calloc(1, sizeof(Job));
+    if (!job) return -1;
+    job->variation_ids = (int*)malloc(num_ids * sizeof(int));
+    if (!job->variation_ids) {
+        free(job);
+        return -1;
+    }
+    memcpy(job->variation_ids, variation_ids, num_ids * sizeof(int));
+    job->request_id = request_id;
+    job->priority = priority;
+    job->kind = kind;
+    job->codepoint = codepoint;
+    job->num_ids = num_ids;
+    job->tolerance = tolerance;
+    job->deadline_ns = deadline_ns;
+
+    pthread_mutex_lock(&s->queue_lock);
+    if (s->stopping) {
+        pthread_mutex_unlock(&s->queue_lock);
+        job_free(job);
+        return -1;
+    }
+    if (!s->worker_started) {
+        if (pthread_create(&s->worker, NULL, worker_main, s) != 0) {
+            pthread_mutex_unlock(&s->queue_lock);
+            job_free(job);
+            return -1;
+        }
+        s->worker_started = 1;
+    }
+    queue_push(&s->queues[priority], job);
+    pthread_cond_signal(&s->work_cond);
+    pthread_mutex_unlock(&s->queue_lock);
+    return 0;
+}
+
+void scheduler_cancel(GlyphScheduler* s, int64_t request_id) {
+    pthread_mutex_lock(&s->queue_lock);
+    Job* job = queue_remove(&s->queues[SCHED_PRIORITY_VISIBLE], request_id);
+    if (!job) job = queue_remove(&s->queues[SCHED_PRIORITY_PREFETCH], request_id);
+    if (!job && s->running_id == request_id) s->running_cancelled = 1;
+    pthread_mutex_unlock(&s->queue_lock);
+
+    if (job) {
+        report(s, request_id, SCHED_CANCELLED, NULL, 0);
+        job_free(job);
+    }
+}
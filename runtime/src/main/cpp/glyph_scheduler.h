@@ -0,0 +1,93 @@
+#ifndef GLYPH_SCHEDULER_H
+#define GLYPH_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "glyph_extractor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Owns a FontHandle and arbitrates access to it between synchronous callers
+ * (always "visible" priority) and a lazily started worker thread draining two
+ * queues: visible-now and prefetch. Prefetch jobs only start while no visible
+ * caller is waiting, so on-screen glyphs are delayed by at most the job that
+ * is already running.
+ */
+
+typedef struct GlyphScheduler GlyphScheduler;
+
+#define SCHED_PRIORITY_VISIBLE  0
+#define SCHED_PRIORITY_PREFETCH 1
+
+#define SCHED_JOB_PATH      0 /* one path, variation_ids[0] */
+#define SCHED_JOB_BATCH     1 /* glyph_extract_variation_batch framing */
+#define SCHED_JOB_ANIMATION 2 /* glyph_extract_animation format */
+
+/* Result status passed to on_result */
+#define SCHED_OK                 0
+#define SCHED_NOT_FOUND         -1
+#define SCHED_TOPOLOGY_MISMATCH -2
+#define SCHED_CANCELLED         -3
+#define SCHED_DEADLINE_MISSED   -4
+#define SCHED_OVER_BUDGET       -5
+
+typedef struct {
+    /*
+     * Called once per submitted job, on the worker thread — or on the thread
+     * calling scheduler_cancel/scheduler_destroy for jobs that never ran.
+     * |data| is only valid for the duration of the call; SCHED_OVER_BUDGET
+     * also covers a result that couldn't be copied out of the font. The font
+     * is never locked during the call, so it may use scheduler_acquire.
+     */
+    void (*on_result)(void* user, int64_t request_id, int status, const float* data, size_t size);
+    /* Called on the worker thread right before it exits */
+    void (*on_worker_exit)(void* user);
+    void* user;
+} GlyphSchedulerCallbacks;
+
+/* Takes ownership of |font|; it is destroyed with the scheduler. */
+GlyphScheduler* scheduler_create(FontHandle* font, const GlyphSchedulerCallbacks* callbacks);
+
+/* The |user| pointer from the callbacks passed to scheduler_create */
+void* scheduler_get_user(const GlyphScheduler* scheduler);
+
+/* Cancels queued jobs, joins the worker and destroys the font. */
+void scheduler_destroy(GlyphScheduler* scheduler);
+
+/* Exclusive synchronous access to the font at visible priority. Pair with scheduler_release. */
+FontHandle* scheduler_acquire(GlyphScheduler* scheduler);
+void scheduler_release(GlyphScheduler* scheduler);
+
+/*
+ * Queues a job. |variation_ids| is copied. |deadline_ns| is an absolute
+ * CLOCK_MONOTONIC time after which the job is dropped with
+ * SCHED_DEADLINE_MISSED instead of run, checked again once a prefetch job
+ * has waited for the font; 0 means no deadline.
+ * Returns 0, or -1 if the job could not be queued (no callback follows).
+ */
+int scheduler_submit(
+    GlyphScheduler* scheduler,
+    int64_t request_id,
+    int priority,
+    int kind,
+    uint32_t codepoint,
+    const int* variation_ids,
+    unsigned int num_ids,
+    float tolerance,
+    int64_t deadline_ns
+);
+
+/* Cancels a queued or running job; its result is reported as SCHED_CANCELLED. */
+void scheduler_cancel(GlyphScheduler* scheduler, int64_t request_id);
+
+/* CLOCK_MONOTONIC in nanoseconds, for building deadlines */
+int64_t scheduler_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_SCHEDULER_H */
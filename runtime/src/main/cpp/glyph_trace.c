@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "glyph_trace.h"
+
+#ifdef __ANDROID__
+
+#include <android/trace.h>
+
+int glyph_trace_begin(const char* name) {
+    ATrace_beginSection(name);
+    return 1;
+}
+
+void glyph_trace_end(void) {
+    ATrace_endSection();
+}
+
+#else
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Further slices are dropped once full; glyph_trace_write empties the buffer */
+#define TRACE_MAX_EVENTS 65536
+
+typedef struct {
+    const char* name; /* NULL for an end event */
+    int64_t ts_ns;
+    uint32_t tid;
+} TraceEvent;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceEvent* trace_events;
+static size_t trace_count;
+static size_t trace_open; /* begun slices whose end event is still due */
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint32_t thread_id(void) {
+    pthread_t self = pthread_self();
+    uint32_t h = 2166136261u;
+    const unsigned char* p = (const unsigned char*)&self;
+    size_t i;
+    for (i = 0; i < sizeof(self); i++) h = (h ^ p[i]) * 16777619u;
+    return h & 0x7fffffff;
+}
+
+int glyph_trace_begin(const char* name) {
+    TraceEvent event = { name, now_ns(), thread_id() };
+    int opened = 0;
+    pthread_mutex_lock(&trace_lock);
+    if (!trace_events) trace_events = (TraceEvent*)malloc(TRACE_MAX_EVENTS * sizeof(TraceEvent));
+    /* Only open a slice if its end, and those of all open slices, still fit */
+    if (trace_events && trace_count + trace_open + 2 <= TRACE_MAX_EVENTS) {
+        trace_events[trace_count++] = event;
+        trace_open++;
+        opened = 1;
+    }
+    pthread_mutex_unlock(&trace_lock);
+    return opened;
+}
+
+void glyph_trace_end(void) {
+    TraceEvent event = { NULL, now_ns(), thread_id() };
+    pthread_mutex_lock(&trace_lock);
+    trace_events[trace_count++] = event;
+    trace_open--;
+    pthread_mutex_unlock(&trace_lock);
+}
+
+int glyph_trace_write(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    pthread_mutex_lock(&trace_lock);
+    fputs("{\"traceEvents\":[\n", f);
+    size_t i;
+    for (i = 0; i < trace_count; i++) {
+        const TraceEvent* e = &trace_events[i];
+        double ts_us = (double)e->ts_ns / 1000.0;
+        if (e->name) {
+            fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"glyph\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                    i ? ",\n" : "", e->name, ts_us, (unsigned)e->tid);
+        } else {
+            fprintf(f, "%s{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                    i ? ",\n" : "", ts_us, (unsigned)e->tid);
+        }
+    }
+    fputs("\n]}\n", f);
+    trace_count = 0;
+    pthread_mutex_unlock(&trace_lock);
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+#endif /* __ANDROID__ */
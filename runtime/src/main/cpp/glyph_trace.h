@@ -0,0 +1,52 @@
+#ifndef GLYPH_TRACE_H
+#define GLYPH_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Begin/end trace slices around native work. Built only with
+ * GLYPHRUNTIME_TRACING (CMake option of the same name); otherwise every hook
+ * expands to nothing. On Android slices go to ATrace and show up next to
+ * Compose frames in Perfetto/systrace; on host they are collected in memory
+ * and written as Chrome trace-event JSON by glyph_trace_write.
+ *
+ * Slice names must be string literals: the host backend keeps the pointer.
+ */
+
+#ifdef GLYPHRUNTIME_TRACING
+
+/* Returns 1 if the slice was opened; only then must glyph_trace_end follow */
+int glyph_trace_begin(const char* name);
+void glyph_trace_end(void);
+
+static inline void glyph_trace_scope_end(int* opened) {
+    if (*opened) glyph_trace_end();
+}
+
+/* Slice from here to the end of the enclosing scope, whichever way it is left */
+#define GLYPH_TRACE_SCOPE(name) \
+    __attribute__((cleanup(glyph_trace_scope_end), unused)) int glyph_trace_scope_ = \
+        glyph_trace_begin(name)
+
+#ifndef __ANDROID__
+/*
+ * Writes the slices recorded so far as {"traceEvents": [...]} to |path| and
+ * clears them. Returns 0, or -1 if the file can't be written. Open the result
+ * in chrome://tracing or ui.perfetto.dev.
+ */
+int glyph_trace_write(const char* path);
+#endif
+
+#else
+
+#define GLYPH_TRACE_SCOPE(name) ((void)0)
+
+#endif /* GLYPHRUNTIME_TRACING */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_TRACE_H */
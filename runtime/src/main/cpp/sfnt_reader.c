@@ -0,0 +1,1176 @@
+#include "sfnt_reader.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SFNT_TAG(a, b, c, d) \
+    (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+/* Matches HarfBuzz's composite recursion guard closely enough for icon fonts */
+#define SFNT_MAX_COMPONENT_DEPTH 16
+
+/* Composite components kept on the stack before falling back to malloc */
+#define STACK_COMPONENTS 16
+
+/* --- Big-endian readers (callers bounds-check) --- */
+
+static inline uint16_t rd_u16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static inline int16_t rd_i16(const uint8_t* p) { return (int16_t)rd_u16(p); }
+static inline uint32_t rd_u32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+static inline float rd_fixed(const uint8_t* p) { return (float)(int32_t)rd_u32(p) / 65536.0f; }
+static inline float rd_f2dot14(const uint8_t* p) { return (float)rd_i16(p) / 16384.0f; }
+
+/* --- Outline storage (struct-of-arrays) --- */
+
+typedef struct {
+    float* x;
+    float* y;
+    uint8_t* on_curve;
+    unsigned int num_points;
+    unsigned int cap_points;
+    unsigned int* ends; /* absolute index of each contour's last point */
+    unsigned int num_contours;
+    unsigned int cap_contours;
+} Outline;
+
+static int outline_reserve_points(Outline* o, unsigned int additional) {
+    unsigned int needed = o->num_points + additional;
+    if (needed <= o->cap_points) return 0;
+    unsigned int cap = o->cap_points ? o->cap_points * 2 : 128;
+    while (cap < needed) cap *= 2;
+    float* x = (float*)realloc(o->x, cap * sizeof(float));
+    if (!x) return -1;
+    o->x = x;
+    float* y = (float*)realloc(o->y, cap * sizeof(float));
+    if (!y) return -1;
+    o->y = y;
+    uint8_t* on = (uint8_t*)realloc(o->on_curve, cap);
+    if (!on) return -1;
+    o->on_curve = on;
+    o->cap_points = cap;
+    return 0;
+}
+
+static int outline_reserve_contours(Outline* o, unsigned int additional) {
+    unsigned int needed = o->num_contours + additional;
+    if (needed <= o->cap_contours) return 0;
+    unsigned int cap = o->cap_contours ? o->cap_contours * 2 : 32;
+    while (cap < needed) cap *= 2;
+    unsigned int* ends = (unsigned int*)realloc(o->ends, cap * sizeof(unsigned int));
+    if (!ends) return -1;
+    o->ends = ends;
+    o->cap_contours = cap;
+    return 0;
+}
+
+static void outline_free(Outline* o) {
+    free(o->x);
+    free(o->y);
+    free(o->on_curve);
+    free(o->ends);
+    memset(o, 0, sizeof(*o));
+}
+
+/* --- Font --- */
+
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+} Table;
+
+struct SfntFont {
+    uint8_t* data;
+    size_t size;
+
+    unsigned int upem;
+    unsigned int num_glyphs;
+    int long_loca;
+    Table loca;
+    Table glyf;
+
+    const uint8_t* cmap; /* selected subtable */
+    size_t cmap_length;
+    unsigned int cmap_format;
+
+    unsigned int axis_count;
+    SfntAxis* axes;
+    const uint8_t** avar_maps; /* per-axis segment map, NULL if identity */
+    unsigned int* avar_counts;
+    float* neg_scale;          /* 1 / (default - min), 0 if degenerate */
+    float* pos_scale;          /* 1 / (max - default), 0 if degenerate */
+    int* coords;               /* normalized 2.14 coordinates */
+    int has_variations;        /* any coordinate non-zero */
+
+    Table gvar;
+    const uint8_t* gvar_shared_tuples;
+    unsigned int gvar_shared_count;
+    unsigned int gvar_glyph_count;
+    int gvar_long_offsets;
+    size_t gvar_data_offset;
+
+    Outline outline;
+    unsigned int max_depth;    /* composite nesting limit, <= SFNT_MAX_COMPONENT_DEPTH */
+    unsigned int max_points;   /* 0 = unlimited */
+
+    /* Per-tuple scratch, never live across recursion */
+    float* dx;
+    float* dy;
+    float* orig_x;
+    float* orig_y;
+    float* packed_x;
+    float* packed_y;
+    uint8_t* touched;
+    uint16_t* point_numbers;
+    uint16_t* shared_points;
+    unsigned int scratch_cap;
+};
+
+static int find_table(const uint8_t* data, size_t size, uint32_t tag, Table* out) {
+    if (size < 12) return 0;
+    unsigned int num_tables = rd_u16(data + 4);
+    if (12 + (size_t)num_tables * 16 > size) return 0;
+    unsigned int i;
+    for (i = 0; i < num_tables; i++) {
+        const uint8_t* rec = data + 12 + i * 16;
+        if (rd_u32(rec) != tag) continue;
+        uint32_t offset = rd_u32(rec + 8);
+        uint32_t length = rd_u32(rec + 12);
+        if ((size_t)offset > size || (size_t)length > size - offset) return 0;
+        out->data = data + offset;
+        out->length = length;
+        return 1;
+    }
+    return 0;
+}
+
+static void select_cmap(SfntFont* f, Table cmap) {
+    if (cmap.length < 4) return;
+    unsigned int count = rd_u16(cmap.data + 2);
+    if (4 + (size_t)count * 8 > cmap.length) return;
+
+    /* Prefer a full-repertoire format 12, then any BMP format 4 */
+    const uint8_t* best = NULL;
+    unsigned int best_format = 0;
+    unsigned int i;
+    for (i = 0; i < count; i++) {
+        const uint8_t* rec = cmap.data + 4 + i * 8;
+        unsigned int platform = rd_u16(rec);
+        unsigned int encoding = rd_u16(rec + 2);
+        uint32_t offset = rd_u32(rec + 4);
+        if ((size_t)offset + 4 > cmap.length) continue;
+        int unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        if (!unicode) continue;
+        unsigned int format = rd_u16(cmap.data + offset);
+        if (format == 12 && best_format != 12) {
+            best = cmap.data + offset;
+            best_format = 12;
+        } else if (format == 4 && !best) {
+            best = cmap.data + offset;
+            best_format = 4;
+        }
+    }
+    if (!best) return;
+
+    size_t remaining = cmap.length - (size_t)(best - cmap.data);
+    size_t length = best_format == 12 ? (remaining >= 8 ? rd_u32(best + 4) : 0) : rd_u16(best + 2);
+    if (length > remaining) length = remaining;
+    f->cmap = best;
+    f->cmap_length = length;
+    f->cmap_format = best_format;
+}
+
+static void parse_fvar_avar(SfntFont* f) {
+    Table fvar;
+    if (!find_table(f->data, f->size, SFNT_TAG('f', 'v', 'a', 'r'), &fvar) || fvar.length < 16) return;
+    unsigned int axes_offset = rd_u16(fvar.data + 4);
+    unsigned int axis_count = rd_u16(fvar.data + 8);
+    unsigned int axis_size = rd_u16(fvar.data + 10);
+    if (!axis_count || axis_size < 20) return;
+    if ((size_t)axes_offset + (size_t)axis_count * axis_size > fvar.length) return;
+
+    f->axes = (SfntAxis*)calloc(axis_count, sizeof(SfntAxis));
+    f->coords = (int*)calloc(axis_count, sizeof(int));
+    f->neg_scale = (float*)calloc(axis_count, sizeof(float));
+    f->pos_scale = (float*)calloc(axis_count, sizeof(float));
+    f->avar_maps = (const uint8_t**)calloc(axis_count, sizeof(const uint8_t*));
+    f->avar_counts = (unsigned int*)calloc(axis_count, sizeof(unsigned int));
+    if (!f->axes || !f->coords || !f->neg_scale || !f->pos_scale ||
+        !f->avar_maps || !f->avar_counts) return;
+
+    unsigned int i;
+    for (i = 0; i < axis_count; i++) {
+        const uint8_t* rec = fvar.data + axes_offset + i * axis_size;
+        f->axes[i].tag = rd_u32(rec);
+        f->axes[i].min_value = rd_fixed(rec + 4);
+        f->axes[i].default_value = rd_fixed(rec + 8);
+        f->axes[i].max_value = rd_fixed(rec + 12);
+        if (f->axes[i].default_value > f->axes[i].min_value) {
+            f->neg_scale[i] = 1.0f / (f->axes[i].default_value - f->axes[i].min_value);
+        }
+        if (f->axes[i].max_value > f->axes[i].default_value) {
+            f->pos_scale[i] = 1.0f / (f->axes[i].max_value - f->axes[i].default_value);
+        }
+    }
+    f->axis_count = axis_count;
+
+    Table avar;
+    if (!find_table(f->data, f->size, SFNT_TAG('a', 'v', 'a', 'r'), &avar) || avar.length < 8) return;
+    if (rd_u16(avar.data) != 1 || rd_u16(avar.data + 6) != axis_count) return;
+    const uint8_t* p = avar.data + 8;
+    const uint8_t* end = avar.data + avar.length;
+    for (i = 0; i < axis_count; i++) {
+        if (p + 2 > end) return;
+        unsigned int count = rd_u16(p);
+        p += 2;
+        if (p + (size_t)count * 4 > end) return;
+        f->avar_maps[i] = p;
+        f->avar_counts[i] = count;
+        p += (size_t)count * 4;
+    }
+}
+
+static void parse_gvar(SfntFont* f) {
+    Table gvar;
+    if (!f->axis_count) return;
+    if (!find_table(f->data, f->size, SFNT_TAG('g', 'v', 'a', 'r'), &gvar) || gvar.length < 20) return;
+    if (rd_u16(gvar.data) != 1 || rd_u16(gvar.data + 4) != f->axis_count) return;
+
+    unsigned int shared_count = rd_u16(gvar.data + 6);
+    uint32_t shared_offset = rd_u32(gvar.data + 8);
+    unsigned int glyph_count = rd_u16(gvar.data + 12);
+    int long_offsets = rd_u16(gvar.data + 14) & 1;
+    uint32_t data_offset = rd_u32(gvar.data + 16);
+
+    size_t offsets_size = ((size_t)glyph_count + 1) * (long_offsets ? 4 : 2);
+    if (20 + offsets_size > gvar.length) return;
+    if ((size_t)shared_offset + (size_t)shared_count * f->axis_count * 2 > gvar.length) return;
+    if (data_offset > gvar.length) return;
+
+    f->gvar = gvar;
+    f->gvar_shared_tuples = gvar.data + shared_offset;
+    f->gvar_shared_count = shared_count;
+    f->gvar_glyph_count = glyph_count;
+    f->gvar_long_offsets = long_offsets;
+    f->gvar_data_offset = data_offset;
+}
+
+SfntFont* sfnt_create(const uint8_t* data, size_t size) {
+    SfntFont* f = (SfntFont*)calloc(1, sizeof(SfntFont));
+    if (!f) return NULL;
+    f->max_depth = SFNT_MAX_COMPONENT_DEPTH;
+    f->data = (uint8_t*)malloc(size ? size : 1);
+    if (!f->data) {
+        free(f);
+        return NULL;
+    }
+    memcpy(f->data, data, size);
+    f->size = size;
+
+    Table head, maxp, cmap;
+    if (!find_table(f->data, size, SFNT_TAG('h', 'e', 'a', 'd'), &head) || head.length < 54 ||
+        !find_table(f->data, size, SFNT_TAG('m', 'a', 'x', 'p'), &maxp) || maxp.length < 6 ||
+        !find_table(f->data, size, SFNT_TAG('l', 'o', 'c', 'a'), &f->loca) ||
+        !find_table(f->data, size, SFNT_TAG('g', 'l', 'y', 'f'), &f->glyf) ||
+        !find_table(f->data, size, SFNT_TAG('c', 'm', 'a', 'p'), &cmap)) {
+        sfnt_destroy(f);
+        return NULL;
+    }
+
+    f->upem = rd_u16(head.data + 18);
+    if (f->upem < 16 || f->upem > 16384) f->upem = 1000;
+    f->long_loca = rd_i16(head.data + 50) != 0;
+    f->num_glyphs = rd_u16(maxp.data + 4);
+
+    /* Clamp glyph count to what loca can actually address */
+    size_t loca_entries = f->loca.length / (f->long_loca ? 4 : 2);
+    if (loca_entries == 0) {
+        f->num_glyphs = 0;
+    } else if (f->num_glyphs > loca_entries - 1) {
+        f->num_glyphs = (unsigned int)(loca_entries - 1);
+    }
+
+    select_cmap(f, cmap);
+    parse_fvar_avar(f);
+    parse_gvar(f);
+    return f;
+}
+
+void sfnt_destroy(SfntFont* f) {
+    if (!f) return;
+    outline_free(&f->outline);
+    free(f->dx);
+    free(f->dy);
+    free(f->orig_x);
+    free(f->orig_y);
+    free(f->packed_x);
+    free(f->packed_y);
+    free(f->touched);
+    free(f->point_numbers);
+    free(f->shared_points);
+    free(f->axes);
+    free(f->coords);
+    free(f->neg_scale);
+    free(f->pos_scale);
+    free(f->avar_maps);
+    free(f->avar_counts);
+    free(f->data);
+    free(f);
+}
+
+unsigned int sfnt_get_upem(const SfntFont* f) { return f->upem; }
+unsigned int sfnt_get_glyph_count(const SfntFont* f) { return f->num_glyphs; }
+unsigned int sfnt_get_axis_count(const SfntFont* f) { return f->axis_count; }
+const SfntAxis* sfnt_get_axes(const SfntFont* f) { return f->axes; }
+
+const uint8_t* sfnt_get_data(const SfntFont* f, size_t* size) {
+    *size = f->size;
+    return f->data;
+}
+
+const uint8_t* sfnt_get_table(const SfntFont* f, uint32_t tag, size_t* length) {
+    Table t;
+    if (!find_table(f->data, f->size, tag, &t)) {
+        *length = 0;
+        return NULL;
+    }
+    *length = t.length;
+    return t.data;
+}
+
+/* --- cmap --- */
+
+static uint32_t cmap4_lookup(const uint8_t* t, size_t len, uint32_t cp) {
+    if (cp > 0xFFFF || len < 14) return 0;
+    unsigned int seg_count = rd_u16(t + 6) / 2;
+    const uint8_t* end_codes = t + 14;
+    const uint8_t* start_codes = end_codes + seg_count * 2 + 2;
+    const uint8_t* deltas = start_codes + seg_count * 2;
+    const uint8_t* range_offsets = deltas + seg_count * 2;
+    if ((size_t)(range_offsets + seg_count * 2 - t) > len) return 0;
+
+    unsigned int lo = 0, hi = seg_count;
+    while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (rd_u16(end_codes + mid * 2) < cp) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo >= seg_count) return 0;
+    unsigned int start = rd_u16(start_codes + lo * 2);
+    if (cp < start) return 0;
+    unsigned int delta = rd_u16(deltas + lo * 2);
+    unsigned int range_offset = rd_u16(range_offsets + lo * 2);
+    if (!range_offset) return (cp + delta) & 0xFFFF;
+
+    const uint8_t* g = range_offsets + lo * 2 + range_offset + (cp - start) * 2;
+    if (g + 2 > t + len) return 0;
+    unsigned int gid = rd_u16(g);
+    return gid ? ((gid + delta) & 0xFFFF) : 0;
+}
+
+static uint32_t cmap12_lookup(const uint8_t* t, size_t len, uint32_t cp) {
+    if (len < 16) return 0;
+    uint32_t num_groups = rd_u32(t + 12);
+    if (num_groups > (len - 16) / 12) num_groups = (uint32_t)((len - 16) / 12);
+    uint32_t lo = 0, hi = num_groups;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const uint8_t* g = t + 16 + (size_t)mid * 12;
+        if (cp < rd_u32(g)) hi = mid;
+        else if (cp > rd_u32(g + 4)) lo = mid + 1;
+        else return rd_u32(g + 8) + (cp - rd_u32(g));
+    }
+    return 0;
+}
+
+int sfnt_get_nominal_glyph(const SfntFont* f, uint32_t codepoint, uint32_t* glyph_id) {
+    uint32_t gid = 0;
+    if (f->cmap_format == 12) gid = cmap12_lookup(f->cmap, f->cmap_length, codepoint);
+    else if (f->cmap_format == 4) gid = cmap4_lookup(f->cmap, f->cmap_length, codepoint);
+    if (!gid || gid >= f->num_glyphs) return 0;
+    *glyph_id = gid;
+    return 1;
+}
+
+/* --- Variations --- */
+
+static int avar_map(const uint8_t* map, unsigned int count, int value) {
+#define FROM(i) rd_i16(map + (i) * 4)
+#define TO(i) rd_i16(map + (i) * 4 + 2)
+    if (count < 2) return count ? value - FROM(0) + TO(0) : value;
+    if (value <= FROM(0)) return value - FROM(0) + TO(0);
+    unsigned int i;
+    for (i = 1; i < count - 1 && value > FROM(i); i++) {
+    }
+    if (value >= FROM(i)) return value - FROM(i) + TO(i);
+    if (FROM(i - 1) == FROM(i)) return TO(i - 1);
+    int denom = FROM(i) - FROM(i - 1);
+    return (int)roundf(TO(i - 1) + ((float)(TO(i) - TO(i - 1)) * (value - FROM(i - 1))) / denom);
+#undef FROM
+#undef TO
+}
+
+/* Design value -> normalized 2.14 through fvar (precomputed scales) and avar */
+static int normalize_axis(const SfntFont* f, unsigned int a, float v) {
+    const SfntAxis* axis = &f->axes[a];
+    if (v < axis->min_value) v = axis->min_value;
+    if (v > axis->max_value) v = axis->max_value;
+
+    float n = 0.0f;
+    if (v < axis->default_value) n = (v - axis->default_value) * f->neg_scale[a];
+    else if (v > axis->default_value) n = (v - axis->default_value) * f->pos_scale[a];
+    int coord = (int)roundf(n * 16384.0f);
+    if (f->avar_maps[a]) coord = avar_map(f->avar_maps[a], f->avar_counts[a], coord);
+    return coord;
+}
+
+void sfnt_set_variations(SfntFont* f, const SfntVariation* variations, unsigned int count) {
+    unsigned int a, i;
+    f->has_variations = 0;
+    for (a = 0; a < f->axis_count; a++) {
+        float v = f->axes[a].default_value;
+        for (i = 0; i < count; i++) {
+            if (variations[i].tag == f->axes[a].tag) v = variations[i].value;
+        }
+        f->coords[a] = normalize_axis(f, a, v);
+        if (f->coords[a]) f->has_variations = 1;
+    }
+}
+
+void sfnt_set_design_coords(SfntFont* f, const float* coords, unsigned int count) {
+    sfnt_normalize_coords(f, coords, count, f->coords);
+    sfnt_set_normalized_coords(f, f->coords, f->axis_count);
+}
+
+void sfnt_normalize_coords(const SfntFont* f, const float* coords, unsigned int count, int* out) {
+    unsigned int a;
+    for (a = 0; a < f->axis_count; a++) {
+        out[a] = normalize_axis(f, a, a < count ? coords[a] : f->axes[a].default_value);
+    }
+}
+
+void sfnt_set_normalized_coords(SfntFont* f, const int* coords, unsigned int count) {
+    unsigned int a;
+    f->has_variations = 0;
+    for (a = 0; a < f->axis_count; a++) {
+        f->coords[a] = a < count ? coords[a] : 0;
+        if (f->coords[a]) f->has_variations = 1;
+    }
+}
+
+static float tuple_scalar(const SfntFont* f, const uint8_t* peak,
+                          const uint8_t* start, const uint8_t* end) {
+    float scalar = 1.0f;
+    unsigned int i;
+    for (i = 0; i < f->axis_count; i++) {
+        int p = rd_i16(peak + i * 2);
+        if (!p) continue;
+        int v = f->coords[i];
+        if (v == p) continue;
+
+        if (start) {
+            int s = rd_i16(start + i * 2);
+            int e = rd_i16(end + i * 2);
+            if (s > p || p > e || (s < 0 && e > 0 && p)) continue;
+            if (v < s || v > e) return 0.0f;
+            if (v < p) {
+                if (p != s) scalar *= (float)(v - s) / (float)(p - s);
+            } else {
+                if (p != e) scalar *= (float)(e - v) / (float)(e - p);
+            }
+        } else {
+            if (!v || v < (p < 0 ? p : 0) || v > (p > 0 ? p : 0)) return 0.0f;
+            scalar *= (float)v / (float)p;
+        }
+    }
+    return scalar;
+}
+
+static int ensure_scratch(SfntFont* f, unsigned int n) {
+    if (n <= f->scratch_cap) return 0;
+    unsigned int cap = f->scratch_cap ? f->scratch_cap : 128;
+    while (cap < n) cap *= 2;
+    float* dx = (float*)realloc(f->dx, cap * sizeof(float));
+    if (!dx) return -1;
+    f->dx = dx;
+    float* dy = (float*)realloc(f->dy, cap * sizeof(float));
+    if (!dy) return -1;
+    f->dy = dy;
+    float* ox = (float*)realloc(f->orig_x, cap * sizeof(float));
+    if (!ox) return -1;
+    f->orig_x = ox;
+    float* oy = (float*)realloc(f->orig_y, cap * sizeof(float));
+    if (!oy) return -1;
+    f->orig_y = oy;
+    float* qx = (float*)realloc(f->packed_x, cap * sizeof(float));
+    if (!qx) return -1;
+    f->packed_x = qx;
+    float* qy = (float*)realloc(f->packed_y, cap * sizeof(float));
+    if (!qy) return -1;
+    f->packed_y = qy;
+    uint8_t* t = (uint8_t*)realloc(f->touched, cap);
+    if (!t) return -1;
+    f->touched = t;
+    uint16_t* pn = (uint16_t*)realloc(f->point_numbers, cap * sizeof(uint16_t));
+    if (!pn) return -1;
+    f->point_numbers = pn;
+    uint16_t* sp = (uint16_t*)realloc(f->shared_points, cap * sizeof(uint16_t));
+    if (!sp) return -1;
+    f->shared_points = sp;
+    f->scratch_cap = cap;
+    return 0;
+}
+
+/*
+ * Packed point numbers. Sets *count = 0 for "all points".
+ * Returns the advanced pointer, or NULL on malformed data.
+ */
+static const uint8_t* read_points(const uint8_t* p, const uint8_t* end,
+                                  uint16_t* out, unsigned int max, unsigned int* count) {
+    if (p >= end) return NULL;
+    unsigned int n = *p++;
+    if (n & 0x80) {
+        if (p >= end) return NULL;
+        n = ((n & 0x7F) << 8) | *p++;
+    }
+    *count = n;
+    if (!n) return p;
+    if (n > max) return NULL;
+
+    unsigned int i = 0, last = 0;
+    while (i < n) {
+        if (p >= end) return NULL;
+        unsigned int control = *p++;
+        unsigned int run = (control & 0x7F) + 1;
+        int words = control & 0x80;
+        unsigned int j;
+        for (j = 0; j < run && i < n; j++) {
+            if (words) {
+                if (p + 2 > end) return NULL;
+                last += rd_u16(p);
+                p += 2;
+            } else {
+                if (p >= end) return NULL;
+                last += *p++;
+            }
+            out[i++] = (uint16_t)last;
+        }
+    }
+    return p;
+}
+
+static const uint8_t* read_deltas(const uint8_t* p, const uint8_t* end, float* out, unsigned int n) {
+    unsigned int i = 0;
+    while (i < n) {
+        if (p >= end) return NULL;
+        unsigned int control = *p++;
+        unsigned int run = (control & 0x3F) + 1;
+        unsigned int kind = control & 0xC0;
+        unsigned int j;
+        if (kind == 0x80) {
+            for (j = 0; j < run && i < n; j++) out[i++] = 0.0f;
+        } else if (kind == 0x40) {
+            if (p + (size_t)run * 2 > end) return NULL;
+            for (j = 0; j < run && i < n; j++, p += 2) out[i++] = (float)rd_i16(p);
+        } else if (kind == 0xC0) {
+            if (p + (size_t)run * 4 > end) return NULL;
+            for (j = 0; j < run && i < n; j++, p += 4) out[i++] = (float)(int32_t)rd_u32(p);
+        } else {
+            if (p + run > end) return NULL;
+            for (j = 0; j < run && i < n; j++) out[i++] = (float)(int8_t)*p++;
+        }
+    }
+    return p;
+}
+
+/* Interpolate deltas for untouched points of one axis between two references */
+static void iup_segment(const float* coords, float* deltas, unsigned int from, unsigned int to,
+                        unsigned int ref1, unsigned int ref2, unsigned int wrap) {
+    float c1 = coords[ref1], c2 = coords[ref2];
+    float d1 = deltas[ref1], d2 = deltas[ref2];
+    unsigned int i = from;
+    if (c1 == c2) {
+        float d = d1 == d2 ? d1 : 0.0f;
+        for (; i != to; i = i + 1 == wrap ? 0 : i + 1) deltas[i] = d;
+        return;
+    }
+    if (c1 > c2) {
+        float t = c1; c1 = c2; c2 = t;
+        t = d1; d1 = d2; d2 = t;
+    }
+    float scale = (d2 - d1) / (c2 - c1);
+    for (; i != to; i = i + 1 == wrap ? 0 : i + 1) {
+        float c = coords[i];
+        if (c <= c1) deltas[i] = d1;
+        else if (c >= c2) deltas[i] = d2;
+        else deltas[i] = d1 + (c - c1) * scale;
+    }
+}
+
+/*
+ * Infer deltas for untouched points, contour by contour. Indices are relative
+ * to the glyph; |ends| holds relative contour end points.
+ */
+static void iup_contours(SfntFont* f, const unsigned int* ends, unsigned int num_contours) {
+    unsigned int start = 0, c;
+    for (c = 0; c < num_contours; c++) {
+        unsigned int end = ends[c];
+        unsigned int n = end - start + 1;
+        unsigned int first_touched = n, i;
+        for (i = 0; i < n; i++) {
+            if (f->touched[start + i]) { first_touched = i; break; }
+        }
+        if (first_touched == n) {
+            /* Nothing touched: the whole contour stays put */
+            start = end + 1;
+            continue;
+        }
+
+        /* Walk touched references cyclically; local indices are 0..n-1 */
+        float* xs = f->orig_x + start;
+        float* ys = f->orig_y + start;
+        float* dx = f->dx + start;
+        float* dy = f->dy + start;
+        const uint8_t* t = f->touched + start;
+        unsigned int ref = first_touched;
+        do {
+            unsigned int next = ref + 1 == n ? 0 : ref + 1;
+            while (!t[next]) next = next + 1 == n ? 0 : next + 1;
+            unsigned int gap_start = ref + 1 == n ? 0 : ref + 1;
+            if (gap_start != next) {
+                iup_segment(xs, dx, gap_start, next, ref, next, n);
+                iup_segment(ys, dy, gap_start, next, ref, next, n);
+            }
+            ref = next;
+        } while (ref != first_touched);
+
+        start = end + 1;
+    }
+}
+
+/*
+ * Apply gvar deltas for |glyph_id| to n points at (xs, ys). |total| includes
+ * the four phantom points, which we decode but do not store. For simple glyphs
+ * |ends| drives IUP; composites pass NULL (untouched offsets keep zero delta).
+ */
+static int apply_gvar(SfntFont* f, uint32_t glyph_id, float* xs, float* ys, unsigned int n,
+                      unsigned int total, const unsigned int* ends, unsigned int num_contours) {
+    if (!f->has_variations || !f->gvar.data || glyph_id >= f->gvar_glyph_count) return 0;
+
+    const uint8_t* offsets = f->gvar.data + 20;
+    size_t off0, off1;
+    if (f->gvar_long_offsets) {
+        off0 = rd_u32(offsets + glyph_id * 4);
+        off1 = rd_u32(offsets + glyph_id * 4 + 4);
+    } else {
+        off0 = (size_t)rd_u16(offsets + glyph_id * 2) * 2;
+        off1 = (size_t)rd_u16(offsets + glyph_id * 2 + 2) * 2;
+    }
+    if (off1 <= off0) return 0;
+    if (f->gvar_data_offset + off1 > f->gvar.length) return -1;
+
+    const uint8_t* gvd = f->gvar.data + f->gvar_data_offset + off0;
+    const uint8_t* gvd_end = f->gvar.data + f->gvar_data_offset + off1;
+    if (gvd + 4 > gvd_end) return -1;
+
+    unsigned int tuple_count = rd_u16(gvd);
+    int shared_points_flag = tuple_count & 0x8000;
+    tuple_count &= 0x0FFF;
+    const uint8_t* serialized = gvd + rd_u16(gvd + 2);
+    if (serialized > gvd_end) return -1;
+
+    if (ensure_scratch(f, total) != 0) return -1;
+
+    unsigned int shared_count = 0;
+    if (shared_points_flag) {
+        serialized = read_points(serialized, gvd_end, f->shared_points, total, &shared_count);
+        if (!serialized) return -1;
+    }
+
+    /* IUP interpolates against the default outline, not the partially varied one */
+    if (ends) {
+        memcpy(f->orig_x, xs, n * sizeof(float));
+        memcpy(f->orig_y, ys, n * sizeof(float));
+    }
+
+    const uint8_t* header = gvd + 4;
+    unsigned int axis_bytes = f->axis_count * 2;
+    unsigned int t;
+    for (t = 0; t < tuple_count; t++) {
+        if (header + 4 > gvd_end) return -1;
+        unsigned int data_size = rd_u16(header);
+        unsigned int tuple_index = rd_u16(header + 2);
+        header += 4;
+
+        const uint8_t* peak;
+        if (tuple_index & 0x8000) {
+            if (header + axis_bytes > gvd_end) return -1;
+            peak = header;
+            header += axis_bytes;
+        } else {
+            unsigned int idx = tuple_index & 0x0FFF;
+            if (idx >= f->gvar_shared_count) return -1;
+            peak = f->gvar_shared_tuples + idx * axis_bytes;
+        }
+        const uint8_t* start = NULL;
+        const uint8_t* end = NULL;
+        if (tuple_index & 0x4000) {
+            if (header + axis_bytes * 2 > gvd_end) return -1;
+            start = header;
+            end = header + axis_bytes;
+            header += axis_bytes * 2;
+        }
+
+        const uint8_t* data = serialized;
+        const uint8_t* data_end = serialized + data_size;
+        serialized = data_end;
+        if (data_end > gvd_end) return -1;
+
+        float scalar = tuple_scalar(f, peak, start, end);
+        if (scalar == 0.0f) continue;
+
+        const uint16_t* points = f->shared_points;
+        unsigned int point_count = shared_count;
+        if (tuple_index & 0x2000) {
+            data = read_points(data, data_end, f->point_numbers, total, &point_count);
+            if (!data) return -1;
+            points = f->point_numbers;
+        }
+
+        unsigned int i;
+        if (point_count == 0) {
+            /* Every point, phantoms included, in order */
+            data = read_deltas(data, data_end, f->dx, total);
+            if (!data) return -1;
+            data = read_deltas(data, data_end, f->dy, total);
+            if (!data) return -1;
+        } else {
+            data = read_deltas(data, data_end, f->packed_x, point_count);
+            if (!data) return -1;
+            data = read_deltas(data, data_end, f->packed_y, point_count);
+            if (!data) return -1;
+
+            /* Scatter packed deltas into dense arrays */
+            memset(f->dx, 0, total * sizeof(float));
+            memset(f->dy, 0, total * sizeof(float));
+            memset(f->touched, 0, total);
+            for (i = 0; i < point_count; i++) {
+                unsigned int pt = points[i];
+                if (pt >= total) continue;
+                f->dx[pt] += f->packed_x[i];
+                f->dy[pt] += f->packed_y[i];
+                f->touched[pt] = 1;
+            }
+
+            if (ends) iup_contours(f, ends, num_contours);
+        }
+
+        /* SoA axpy — the hot loop; vectorizes cleanly */
+        {
+            float* restrict ox = xs;
+            float* restrict oy = ys;
+            const float* restrict ddx = f->dx;
+            const float* restrict ddy = f->dy;
+            for (i = 0; i < n; i++) {
+                ox[i] += scalar * ddx[i];
+                oy[i] += scalar * ddy[i];
+            }
+        }
+    }
+    return 0;
+}
+
+/* --- glyf decoding --- */
+
+static int glyph_range(const SfntFont* f, uint32_t glyph_id, const uint8_t** out, size_t* len) {
+    if (glyph_id >= f->num_glyphs) return -1;
+    size_t start, end;
+    if (f->long_loca) {
+        start = rd_u32(f->loca.data + glyph_id * 4);
+        end = rd_u32(f->loca.data + glyph_id * 4 + 4);
+    } else {
+        start = (size_t)rd_u16(f->loca.data + glyph_id * 2) * 2;
+        end = (size_t)rd_u16(f->loca.data + glyph_id * 2 + 2) * 2;
+    }
+    if (end < start || end > f->glyf.length) return -1;
+    *out = f->glyf.data + start;
+    *len = end - start;
+    return 0;
+}
+
+static int load_simple(SfntFont* f, uint32_t glyph_id, const uint8_t* g, size_t len,
+                       unsigned int num_contours) {
+    Outline* o = &f->outline;
+    const uint8_t* end = g + len;
+    const uint8_t* p = g + 10;
+    if (p + (size_t)num_contours * 2 + 2 > end) return -1;
+
+    unsigned int base_contour = o->num_contours;
+    unsigned int base_point = o->num_points;
+    if (outline_reserve_contours(o, num_contours) != 0) return -1;
+
+    unsigned int c;
+    int last = -1;
+    for (c = 0; c < num_contours; c++) {
+        int e = rd_u16(p + c * 2);
+        if (e <= last) return -1;
+        o->ends[base_contour + c] = (unsigned int)e; /* relative for now */
+        last = e;
+    }
+    unsigned int n = (unsigned int)last + 1;
+    if (f->max_points && o->num_points + n > f->max_points) return SFNT_OVER_LIMIT;
+    p += (size_t)num_contours * 2;
+    unsigned int instruction_length = rd_u16(p);
+    p += 2 + instruction_length;
+    if (p > end) return -1;
+
+    if (outline_reserve_points(o, n) != 0) return -1;
+    uint8_t* flags = o->on_curve + base_point;
+    float* xs = o->x + base_point;
+    float* ys = o->y + base_point;
+
+    unsigned int i = 0;
+    while (i < n) {
+        if (p >= end) return -1;
+        uint8_t flag = *p++;
+        flags[i++] = flag;
+        if (flag & 0x08) {
+            if (p >= end) return -1;
+            unsigned int repeat = *p++;
+            while (repeat-- && i < n) flags[i++] = flag;
+        }
+    }
+
+    int v = 0;
+    for (i = 0; i < n; i++) {
+        uint8_t flag = flags[i];
+        if (flag & 0x02) {
+            if (p >= end) return -1;
+            v += (flag & 0x10) ? *p : -(int)*p;
+            p++;
+        } else if (!(flag & 0x10)) {
+            if (p + 2 > end) return -1;
+            v += rd_i16(p);
+            p += 2;
+        }
+        xs[i] = (float)v;
+    }
+    v = 0;
+    for (i = 0; i < n; i++) {
+        uint8_t flag = flags[i];
+        if (flag & 0x04) {
+            if (p >= end) return -1;
+            v += (flag & 0x20) ? *p : -(int)*p;
+            p++;
+        } else if (!(flag & 0x20)) {
+            if (p + 2 > end) return -1;
+            v += rd_i16(p);
+            p += 2;
+        }
+        ys[i] = (float)v;
+    }
+    for (i = 0; i < n; i++) flags[i] &= 0x01;
+
+    if (apply_gvar(f, glyph_id, xs, ys, n, n + 4, o->ends + base_contour, num_contours) != 0) {
+        return -1;
+    }
+
+    for (c = 0; c < num_contours; c++) o->ends[base_contour + c] += base_point;
+    o->num_points += n;
+    o->num_contours += num_contours;
+    return 0;
+}
+
+typedef struct {
+    uint16_t flags;
+    uint16_t glyph_id;
+    int arg1;
+    int arg2;
+    float xx, xy, yx, yy;
+} Component;
+
+static int load_glyph(SfntFont* f, uint32_t glyph_id, int depth);
+
+static int load_composite(SfntFont* f, uint32_t glyph_id, const uint8_t* g, size_t len, int depth) {
+    const uint8_t* end = g + len;
+    const uint8_t* p = g + 10;
+
+    /* First pass: count components */
+    unsigned int count = 0;
+    const uint8_t* q = p;
+    for (;;) {
+        if (q + 4 > end) return -1;
+        unsigned int flags = rd_u16(q);
+        q += 4 + ((flags & 0x0001) ? 4 : 2);
+        if (flags & 0x0008) q += 2;
+        else if (flags & 0x0040) q += 4;
+        else if (flags & 0x0080) q += 8;
+        count++;
+        if (!(flags & 0x0020)) break;
+    }
+    if (q > end) return -1;
+
+    Component stack_components[STACK_COMPONENTS];
+    float stack_offsets[STACK_COMPONENTS * 2];
+    Component* comps = count <= STACK_COMPONENTS ? stack_components :
+        (Component*)malloc(count * sizeof(Component));
+    float* offsets = count <= STACK_COMPONENTS ? stack_offsets :
+        (float*)malloc((size_t)count * 2 * sizeof(float));
+    int result = -1;
+    if (!comps || !offsets) goto done;
+
+    unsigned int i;
+    for (i = 0; i < count; i++) {
+        Component* c = &comps[i];
+        c->flags = rd_u16(p);
+        c->glyph_id = rd_u16(p + 2);
+        p += 4;
+        if (c->flags & 0x0001) {
+            if (c->flags & 0x0002) { c->arg1 = rd_i16(p); c->arg2 = rd_i16(p + 2); }
+            else { c->arg1 = rd_u16(p); c->arg2 = rd_u16(p + 2); }
+            p += 4;
+        } else {
+            if (c->flags & 0x0002) { c->arg1 = (int8_t)p[0]; c->arg2 = (int8_t)p[1]; }
+            else { c->arg1 = p[0]; c->arg2 = p[1]; }
+            p += 2;
+        }
+        c->xx = c->yy = 1.0f;
+        c->xy = c->yx = 0.0f;
+        if (c->flags & 0x0008) {
+            c->xx = c->yy = rd_f2dot14(p);
+            p += 2;
+        } else if (c->flags & 0x0040) {
+            c->xx = rd_f2dot14(p);
+            c->yy = rd_f2dot14(p + 2);
+            p += 4;
+        } else if (c->flags & 0x0080) {
+            c->xx = rd_f2dot14(p);
+            c->xy = rd_f2dot14(p + 2);
+            c->yx = rd_f2dot14(p + 4);
+            c->yy = rd_f2dot14(p + 6);
+            p += 8;
+        }
+        offsets[i] = (c->flags & 0x0002) ? (float)c->arg1 : 0.0f;
+        offsets[count + i] = (c->flags & 0x0002) ? (float)c->arg2 : 0.0f;
+    }
+
+    /* Component offsets are the composite's gvar "points" */
+    if (apply_gvar(f, glyph_id, offsets, offsets + count, count, count + 4, NULL, 0) != 0) goto done;
+
+    Outline* o = &f->outline;
+    unsigned int composite_start = o->num_points;
+    for (i = 0; i < count; i++) {
+        const Component* c = &comps[i];
+        unsigned int first = o->num_points;
+        int loaded = load_glyph(f, c->glyph_id, depth + 1);
+        if (loaded != 0) {
+            result = loaded;
+            goto done;
+        }
+        unsigned int last = o->num_points;
+        unsigned int k;
+
+        int transformed = c->xx != 1.0f || c->yy != 1.0f || c->xy != 0.0f || c->yx != 0.0f;
+        if (transformed) {
+            for (k = first; k < last; k++) {
+                float x = o->x[k], y = o->y[k];
+                o->x[k] = c->xx * x + c->yx * y;
+                o->y[k] = c->xy * x + c->yy * y;
+            }
+        }
+
+        float tx, ty;
+        if (c->flags & 0x0002) {
+            tx = offsets[i];
+            ty = offsets[count + i];
+            if (transformed && (c->flags & 0x0800) && !(c->flags & 0x1000)) {
+                float sx = tx, sy = ty;
+                tx = c->xx * sx + c->yx * sy;
+                ty = c->xy * sx + c->yy * sy;
+            }
+            if (c->flags & 0x0004) {
+                tx = roundf(tx);
+                ty = roundf(ty);
+            }
+        } else {
+            /* Point matching: parent point arg1 aligns with child point arg2 */
+            unsigned int parent = composite_start + (unsigned int)c->arg1;
+            unsigned int child = first + (unsigned int)c->arg2;
+            if (parent >= first || child >= last) goto done;
+            tx = o->x[parent] - o->x[child];
+            ty = o->y[parent] - o->y[child];
+        }
+        if (tx != 0.0f || ty != 0.0f) {
+            for (k = first; k < last; k++) {
+                o->x[k] += tx;
+                o->y[k] += ty;
+            }
+        }
+    }
+    result = 0;
+
+done:
+    if (comps != stack_components) free(comps);
+    if (offsets != stack_offsets) free(offsets);
+    return result;
+}
+
+static int load_glyph(SfntFont* f, uint32_t glyph_id, int depth) {
+    if (depth > SFNT_MAX_COMPONENT_DEPTH) return -1;
+    if ((unsigned int)depth > f->max_depth) return SFNT_OVER_LIMIT;
+    const uint8_t* g;
+    size_t len;
+    if (glyph_range(f, glyph_id, &g, &len) != 0) return -1;
+    if (len == 0) return 0; /* empty glyph */
+    if (len < 10) return -1;
+
+    int num_contours = rd_i16(g);
+    if (num_contours > 0) return load_simple(f, glyph_id, g, len, (unsigned int)num_contours);
+    if (num_contours < 0) return load_composite(f, glyph_id, g, len, depth);
+    return 0;
+}
+
+/* --- Outline to path, mirroring HarfBuzz's glyf path builder --- */
+
+typedef struct {
+    const SfntPen* pen;
+    void* ctx;
+    int open;
+    float start_x, start_y;
+    float cur_x, cur_y;
+} DrawState;
+
+static void ds_move_to(DrawState* s, float x, float y);
+
+static void ds_close(DrawState* s) {
+    if (s->open) {
+        if (s->start_x != s->cur_x || s->start_y != s->cur_y) {
+            s->pen->line_to(s->ctx, s->start_x, s->start_y);
+        }
+        s->pen->close_path(s->ctx);
+    }
+    s->open = 0;
+    s->cur_x = s->start_x;
+    s->cur_y = s->start_y;
+}
+
+static void ds_move_to(DrawState* s, float x, float y) {
+    if (s->open) ds_close(s);
+    s->start_x = s->cur_x = x;
+    s->start_y = s->cur_y = y;
+}
+
+static void ds_open(DrawState* s) {
+    if (!s->open) {
+        s->pen->move_to(s->ctx, s->cur_x, s->cur_y);
+        s->open = 1;
+    }
+}
+
+static void ds_line_to(DrawState* s, float x, float y) {
+    ds_open(s);
+    s->pen->line_to(s->ctx, x, y);
+    s->cur_x = x;
+    s->cur_y = y;
+}
+
+static void ds_quad_to(DrawState* s, float cx, float cy, float x, float y) {
+    ds_open(s);
+    s->pen->quad_to(s->ctx, cx, cy, x, y);
+    s->cur_x = x;
+    s->cur_y = y;
+}
+
+static void emit_outline(const Outline* o, DrawState* s) {
+    unsigned int start = 0, c;
+    for (c = 0; c < o->num_contours; c++) {
+        unsigned int end = o->ends[c];
+        int have_first_on = 0, have_first_off = 0, have_last_off = 0;
+        float first_on_x = 0, first_on_y = 0;
+        float first_off_x = 0, first_off_y = 0;
+        float last_off_x = 0, last_off_y = 0;
+        unsigned int i;
+
+        for (i = start; i <= end; i++) {
+            float x = o->x[i], y = o->y[i];
+            int on = o->on_curve[i];
+            if (!have_first_on) {
+                if (on) {
+                    first_on_x = x; first_on_y = y; have_first_on = 1;
+                    ds_move_to(s, x, y);
+                } else if (have_first_off) {
+                    float mx = (first_off_x + x) * 0.5f, my = (first_off_y + y) * 0.5f;
+                    first_on_x = mx; first_on_y = my; have_first_on = 1;
+                    last_off_x = x; last_off_y = y; have_last_off = 1;
+                    ds_move_to(s, mx, my);
+                } else {
+                    first_off_x = x; first_off_y = y; have_first_off = 1;
+                }
+            } else if (have_last_off) {
+                if (on) {
+                    ds_quad_to(s, last_off_x, last_off_y, x, y);
+                    have_last_off = 0;
+                } else {
+                    float mx = (last_off_x + x) * 0.5f, my = (last_off_y + y) * 0.5f;
+                    ds_quad_to(s, last_off_x, last_off_y, mx, my);
+                    last_off_x = x; last_off_y = y;
+                }
+            } else if (on) {
+                ds_line_to(s, x, y);
+            } else {
+                last_off_x = x; last_off_y = y; have_last_off = 1;
+            }
+        }
+
+        if (have_first_off && have_last_off) {
+            float mx = (last_off_x + first_off_x) * 0.5f, my = (last_off_y + first_off_y) * 0.5f;
+            ds_quad_to(s, last_off_x, last_off_y, mx, my);
+            have_last_off = 0;
+        }
+        if (have_first_off && have_first_on) {
+            ds_quad_to(s, first_off_x, first_off_y, first_on_x, first_on_y);
+        } else if (have_last_off && have_first_on) {
+            ds_quad_to(s, last_off_x, last_off_y, first_on_x, first_on_y);
+        } else if (have_first_on) {
+            ds_line_to(s, first_on_x, first_on_y);
+        } else if (have_first_off) {
+            ds_move_to(s, first_off_x, first_off_y);
+            ds_quad_to(s, first_off_x, first_off_y, first_off_x, first_off_y);
+        }
+        ds_close(s);
+        start = end + 1;
+    }
+}
+
+void sfnt_set_limits(SfntFont* f, unsigned int max_depth, unsigned int max_points) {
+    f->max_depth = max_depth && max_depth < SFNT_MAX_COMPONENT_DEPTH
+        ? max_depth : SFNT_MAX_COMPONENT_DEPTH;
+    f->max_points = max_points;
+}
+
+int sfnt_get_glyph_bounds(const SfntFont* f, uint32_t glyph_id, float bounds[4]) {
+    const uint8_t* g;
+    size_t len;
+    if (glyph_range(f, glyph_id, &g, &len) != 0 || len < 10) return -1;
+    bounds[0] = (float)rd_i16(g + 2);
+    bounds[1] = (float)rd_i16(g + 4);
+    bounds[2] = (float)rd_i16(g + 6);
+    bounds[3] = (float)rd_i16(g + 8);
+    return 0;
+}
+
+int sfnt_draw_glyph(SfntFont* f, uint32_t glyph_id, const SfntPen* pen, void* ctx) {
+    Outline* o = &f->outline;
+    o->num_points = 0;
+    o->num_contours = 0;
+    int loaded = load_glyph(f, glyph_id, 0);
+    if (loaded != 0) return loaded;
+
+    DrawState s;
+    memset(&s, 0, sizeof(s));
+    s.pen = pen;
+    s.ctx = ctx;
+    emit_outline(o, &s);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#ifndef SFNT_READER_H
+#define SFNT_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Minimal TrueType outline reader: cmap (format 4/12), head, maxp, loca, glyf,
+ * fvar, avar (v1) and gvar. Replaces HarfBuzz when the runtime is built with
+ * GLYPHRUNTIME_SFNT_READER=ON. Only what the icon runtime needs — no hinting,
+ * no CFF, no layout, no metrics beyond upem.
+ */
+
+typedef struct SfntFont SfntFont;
+
+typedef struct {
+    uint32_t tag;
+    float value;
+} SfntVariation;
+
+typedef struct {
+    uint32_t tag;
+    float min_value;
+    float default_value;
+    float max_value;
+} SfntAxis;
+
+/* Outline sink. Coordinates are in font units, Y-up. */
+typedef struct {
+    void (*move_to)(void* ctx, float x, float y);
+    void (*line_to)(void* ctx, float x, float y);
+    void (*quad_to)(void* ctx, float cx, float cy, float x, float y);
+    void (*close_path)(void* ctx);
+} SfntPen;
+
+/* Copies |data|; returns NULL if the font has no usable glyf/loca/cmap. */
+SfntFont* sfnt_create(const uint8_t* data, size_t size);
+void sfnt_destroy(SfntFont* font);
+
+unsigned int sfnt_get_upem(const SfntFont* font);
+unsigned int sfnt_get_glyph_count(const SfntFont* font);
+unsigned int sfnt_get_axis_count(const SfntFont* font);
+const SfntAxis* sfnt_get_axes(const SfntFont* font);
+
+/* The whole font as copied by sfnt_create. Valid for the lifetime of |font|. */
+const uint8_t* sfnt_get_data(const SfntFont* font, size_t* size);
+
+/* Raw table bytes (or NULL). Valid for the lifetime of |font|. */
+const uint8_t* sfnt_get_table(const SfntFont* font, uint32_t tag, size_t* length);
+
+int sfnt_get_nominal_glyph(const SfntFont* font, uint32_t codepoint, uint32_t* glyph_id);
+
+/*
+ * Sets design-space axis values; unspecified axes fall back to their default.
+ * Values are normalized through fvar + avar into 2.14 coordinates.
+ */
+void sfnt_set_variations(SfntFont* font, const SfntVariation* variations, unsigned int count);
+
+/* Same, but with one design value per axis in fvar order — no tag matching. */
+void sfnt_set_design_coords(SfntFont* font, const float* coords, unsigned int count);
+
+/* Normalizes design values (fvar order) into |out|, which holds one int per axis. */
+void sfnt_normalize_coords(const SfntFont* font, const float* coords, unsigned int count, int* out);
+
+/* Sets already-normalized 2.14 coordinates; missing axes are 0 (default). */
+void sfnt_set_normalized_coords(SfntFont* font, const int* coords, unsigned int count);
+
+/* sfnt_draw_glyph result when a limit from sfnt_set_limits is exceeded */
+#define SFNT_OVER_LIMIT -2
+
+/*
+ * Caps composite nesting and total outline points per glyph; 0 keeps the
+ * built-in nesting limit / leaves points unlimited. Checked while loading,
+ * before any variation deltas are applied or anything is drawn.
+ */
+void sfnt_set_limits(SfntFont* font, unsigned int max_depth, unsigned int max_points);
+
+/* Font-unit bounds from the glyf header (default instance). Returns 0, or -1 for empty/missing glyphs. */
+int sfnt_get_glyph_bounds(const SfntFont* font, uint32_t glyph_id, float bounds[4]);
+
+/*
+ * Draws |glyph_id| with the current variation. Returns 0 on success, -1 on
+ * malformed data, SFNT_OVER_LIMIT if a limit was exceeded (nothing is drawn).
+ */
+int sfnt_draw_glyph(SfntFont* font, uint32_t glyph_id, const SfntPen* pen, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SFNT_READER_H */
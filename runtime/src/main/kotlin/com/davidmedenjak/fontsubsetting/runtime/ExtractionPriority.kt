@@ -0,0 +1,13 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+/**
+ * Queue for asynchronous extraction on the native scheduler thread.
+ *
+ * Synchronous extraction always counts as [Visible]; [Prefetch] work only starts
+ * while no visible request is waiting, so warming animation frames never delays
+ * a glyph that is about to be drawn by more than the job already running.
+ */
+enum class ExtractionPriority {
+    Visible,
+    Prefetch,
+}
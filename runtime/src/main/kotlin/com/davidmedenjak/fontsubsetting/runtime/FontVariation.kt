@@ -13,6 +13,8 @@ class FontVariation internal constructor(
     internal val values: FloatArray,
     // All animation frames for batch pre-extraction, or null for static variations.
     internal val allFrames: Array<FontVariation>? = null,
+    // Index of this variation within allFrames, or -1 for static variations.
+    internal val frameIndex: Int = -1,
 ) {
 
     override fun equals(other: Any?): Boolean {
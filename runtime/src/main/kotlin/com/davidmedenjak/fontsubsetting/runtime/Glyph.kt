@@ -22,17 +22,24 @@ import kotlinx.coroutines.withContext
  * library can't be loaded (Compose preview / Paparazzi / plain JVM unit tests),
  * the font falls back to an [android.graphics.Typeface] so previews still draw the
  * real glyph through the platform Paint stack.
+ *
+ * For a font split into chunks by the plugin, [chunkDirectory] is where chunk files
+ * are loaded from when one of their icons is first drawn.
  */
 @Composable
-fun rememberGlyphFont(@FontRes resourceId: Int): GlyphFont {
+fun rememberGlyphFont(@FontRes resourceId: Int, chunkDirectory: File? = null): GlyphFont {
     val context = LocalContext.current
-    val font = remember(resourceId) {
+    val font = remember(resourceId, chunkDirectory) {
         @Suppress("ResourceType")
         val bytes = runCatching {
             context.resources.openRawResource(resourceId).use { it.readBytes() }
         }.getOrNull() ?: return@remember GlyphFont(extractor = null)
 
-        runCatching { GlyphFont(extractor = HarfBuzzGlyphExtractor(bytes)) }
+        runCatching {
+            val extractor = HarfBuzzGlyphExtractor(bytes, context.cacheDir)
+            chunkDirectory?.let { extractor.setChunkDirectory(it) }
+            GlyphFont(extractor = extractor)
+        }
             .getOrElse {
                 GlyphFont(
                     extractor = null,
@@ -43,6 +50,10 @@ fun rememberGlyphFont(@FontRes resourceId: Int): GlyphFont {
     DisposableEffect(font) {
         onDispose { font.extractor?.close() }
     }
+    LaunchedEffect(font) {
+        val extractor = font.extractor ?: return@LaunchedEffect
+        withContext(Dispatchers.Default) { extractor.prewarm() }
+    }
     return font
 }
 
@@ -69,7 +80,12 @@ private fun loadPreviewTypeface(context: Context, resourceId: Int, bytes: ByteAr
  * Remembers a [Painter] for rendering a font glyph.
  *
  * Only the first Unicode codepoint of [text] is used, matching the plugin-generated
- * icon constants which are single-codepoint strings.
+ * icon constants which are single-codepoint strings. With a [stroke] the glyph's
+ * outline is drawn instead of its fill.
+ *
+ * [embolden] widens every stem by that fraction of the icon size, or thins it when
+ * negative, for weight changes on fonts subset with `wght` pinned. It is ignored
+ * while a [stroke] is set.
  */
 @Composable
 fun rememberGlyphPainter(
@@ -77,6 +93,8 @@ fun rememberGlyphPainter(
     font: GlyphFont,
     tint: Color = Color.Black,
     variation: FontVariation = FontVariation.Empty,
+    stroke: GlyphStroke? = null,
+    embolden: Float = 0f,
 ): Painter {
     val codepoint = remember(text) { text.codePointAt(0) }
     val glyphText = remember(codepoint) { String(Character.toChars(codepoint)) }
@@ -85,6 +103,8 @@ fun rememberGlyphPainter(
     }.also {
         it.tint = tint
         it.variation = variation
+        it.stroke = stroke
+        it.embolden = embolden
     }
 
     val extractor = font.extractor
@@ -95,19 +115,24 @@ fun rememberGlyphPainter(
         val axisTags = allFrames[0].axes
         if (axisTags.isEmpty()) return@LaunchedEffect
 
-        // Skip first frame — it will be extracted lazily on first render
-        val remainingFrames = allFrames.copyOfRange(1, allFrames.size)
-        val flatValues = FloatArray(axisTags.size * remainingFrames.size)
-        remainingFrames.forEachIndexed { i, frame ->
-            frame.values.copyInto(flatValues, i * axisTags.size)
+        val ids = withContext(Dispatchers.Default) {
+            IntArray(allFrames.size) { extractor.variationId(allFrames[it]) }
+        }
+        // Prefetch priority: never holds up glyphs that are being drawn right now
+        val animation = extractor.extractAnimationAsync(codepoint, ids)
+        if (animation != null) {
+            painter.setAnimation(allFrames, animation)
+            return@LaunchedEffect
         }
 
-        val paths = withContext(Dispatchers.Default) {
-            extractor.extractPathBatch(codepoint, axisTags, flatValues, remainingFrames.size)
-        } ?: return@LaunchedEffect
+        // Command sequence differs between frames: fall back to one path per frame.
+        // Skip first frame — it will be extracted lazily on first render
+        val remainingIds = ids.copyOfRange(1, ids.size)
+        val paths = extractor.extractPathBatchAsync(codepoint, remainingIds)
+            ?: return@LaunchedEffect
 
         paths.forEachIndexed { i, path ->
-            painter.putPath(remainingFrames[i], path)
+            painter.putPath(allFrames[i + 1], path)
         }
     }
 
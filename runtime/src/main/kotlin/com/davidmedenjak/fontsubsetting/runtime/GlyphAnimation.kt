@@ -81,6 +81,7 @@ fun animateFontVariationAsState(
                 axes = framesArray[i].axes,
                 values = framesArray[i].values,
                 allFrames = framesArray,
+                frameIndex = i,
             )
         }
         linked
@@ -0,0 +1,86 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+import android.graphics.Path
+
+/**
+ * Glyph outlines for a whole animation, in the native animation format: one command
+ * sequence shared by every frame plus coordinates at a reduced set of keyframes.
+ *
+ * [pathAt] linearly interpolates between the nearest keyframes into a reused buffer and
+ * rebuilds a single reused [Path], so any frame rate costs the same memory. Glyph morphs
+ * use the same format with keyframes 0 and 1. Not thread-safe — call it from the draw
+ * thread only.
+ */
+internal class GlyphAnimationPaths private constructor(
+    private val commands: ByteArray,
+    private val keyframes: IntArray,
+    private val coords: FloatArray,
+    private val stride: Int,
+) {
+    private val buffer = FloatArray(stride)
+    private val path = Path()
+    private var currentPosition = Float.NaN
+
+    fun pathAt(frame: Int): Path = pathAt(frame.toFloat())
+
+    /**
+     * Path at a fractional frame [position], e.g. a morph's progress between its
+     * keyframes 0 and 1.
+     */
+    fun pathAt(position: Float): Path {
+        if (position == currentPosition) return path
+        currentPosition = position
+
+        val last = keyframes.size - 1
+        val f = position.coerceIn(keyframes[0].toFloat(), keyframes[last].toFloat())
+        var k = keyframes.binarySearch(f.toInt())
+        if (k < 0) k = -k - 2 // keyframe before f
+        if (k == last || f == keyframes[k].toFloat()) {
+            coords.copyInto(buffer, 0, k * stride, k * stride + stride)
+        } else {
+            val a = k * stride
+            val b = a + stride
+            val t = (f - keyframes[k]) / (keyframes[k + 1] - keyframes[k])
+            for (i in 0 until stride) {
+                val from = coords[a + i]
+                buffer[i] = from + (coords[b + i] - from) * t
+            }
+        }
+
+        path.rewind()
+        var c = 0
+        for (command in commands) {
+            when (command.toInt()) {
+                0 -> { path.moveTo(buffer[c], buffer[c + 1]); c += 2 }
+                1 -> { path.lineTo(buffer[c], buffer[c + 1]); c += 2 }
+                2 -> { path.quadTo(buffer[c], buffer[c + 1], buffer[c + 2], buffer[c + 3]); c += 4 }
+                3 -> {
+                    path.cubicTo(
+                        buffer[c], buffer[c + 1],
+                        buffer[c + 2], buffer[c + 3],
+                        buffer[c + 4], buffer[c + 5],
+                    )
+                    c += 6
+                }
+                4 -> path.close()
+            }
+        }
+        return path
+    }
+
+    companion object {
+        /** Parses `[C, P, K, commands(C), keyframes(K), K * P coordinates]`. */
+        fun parse(data: FloatArray): GlyphAnimationPaths {
+            val numCommands = data[0].toInt()
+            val stride = data[1].toInt()
+            val numKeyframes = data[2].toInt()
+            var offset = 3
+            val commands = ByteArray(numCommands) { data[offset + it].toInt().toByte() }
+            offset += numCommands
+            val keyframes = IntArray(numKeyframes) { data[offset + it].toInt() }
+            offset += numKeyframes
+            val coords = data.copyOfRange(offset, offset + numKeyframes * stride)
+            return GlyphAnimationPaths(commands, keyframes, coords, stride)
+        }
+    }
+}
@@ -0,0 +1,120 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+import android.graphics.Paint
+import android.graphics.Path
+import androidx.compose.runtime.Composable
+import androidx.compose.runtime.Stable
+import androidx.compose.runtime.mutableStateOf
+import androidx.compose.runtime.remember
+import androidx.compose.ui.geometry.Size
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.graphics.drawscope.DrawScope
+import androidx.compose.ui.graphics.nativeCanvas
+import androidx.compose.ui.graphics.painter.Painter
+import androidx.compose.ui.graphics.toArgb
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * Remembers a [Painter] for a multicolor (COLR) glyph, drawn from CPAL [palette].
+ *
+ * All layers are read natively in one pass and cached per [variation] like plain
+ * outlines, so a color icon costs one fill per layer instead of a VectorDrawable.
+ * Layers in the font's foreground color take [tint]. COLRv1 gradients are drawn in
+ * their first stop's color. Without the native extractor the painter falls back to
+ * [rememberGlyphPainter]'s preview rendering.
+ */
+@Composable
+fun rememberColorGlyphPainter(
+    text: String,
+    font: GlyphFont,
+    tint: Color = Color.Black,
+    variation: FontVariation = FontVariation.Empty,
+    palette: Int = 0,
+): Painter {
+    val fallback = rememberGlyphPainter(text, font, tint, variation)
+    val codepoint = remember(text) { text.codePointAt(0) }
+    return remember(codepoint, font, palette, fallback) {
+        ColorGlyphPainter(codepoint, font, palette, fallback)
+    }.also {
+        it.tint = tint
+        it.variation = variation
+    }
+}
+
+/** Layer paths bottom to top; [tinted] layers use the tint's color at the alpha in [colors]. */
+internal class GlyphColorLayers(
+    val paths: Array<Path>,
+    val colors: IntArray,
+    val tinted: BooleanArray,
+)
+
+@Stable
+internal class ColorGlyphPainter(
+    private val codepoint: Int,
+    private val font: GlyphFont,
+    private val palette: Int,
+    private val fallback: Painter,
+) : Painter() {
+
+    private val drawPaint = Paint(Paint.ANTI_ALIAS_FLAG)
+    private val layerCache = ConcurrentHashMap<FontVariation, GlyphColorLayers>()
+
+    private var _tint = mutableStateOf(Color.Black)
+    var tint: Color
+        get() = _tint.value
+        set(value) {
+            if (_tint.value != value) {
+                _tint.value = value
+            }
+        }
+
+    private var _variation = mutableStateOf(FontVariation.Empty)
+    var variation: FontVariation
+        get() = _variation.value
+        set(value) {
+            if (_variation.value != value) {
+                _variation.value = value
+            }
+        }
+
+    override val intrinsicSize: Size get() = Size.Unspecified
+
+    override fun DrawScope.onDraw() {
+        val extractor = font.extractor
+        if (extractor == null) {
+            with(fallback) { draw(size) }
+            return
+        }
+
+        val w = size.width
+        val h = size.height
+        if (w <= 0f || h <= 0f) return
+
+        val v = _variation.value
+        val layers = layerCache[v]
+            ?: extractor.extractColorLayers(codepoint, extractor.variationId(v), palette)
+                ?.also { layerCache.putIfAbsent(v, it) }
+            ?: return
+
+        val tint = _tint.value.toArgb()
+        val s = minOf(w, h)
+        drawPaint.style = Paint.Style.FILL
+        with(drawContext.canvas.nativeCanvas) {
+            save()
+            translate(w / 2f, h / 2f)
+            scale(s, s)
+            translate(-0.5f, 0.5f)
+            for (i in layers.paths.indices) {
+                val color = layers.colors[i]
+                drawPaint.color = if (layers.tinted[i]) {
+                    val alpha = (tint ushr 24) * (color ushr 24) / 255
+                    (alpha shl 24) or (tint and 0xFFFFFF)
+                } else {
+                    color
+                }
+                drawPath(layers.paths[i], drawPaint)
+            }
+            restore()
+        }
+    }
+}
@@ -0,0 +1,63 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+/**
+ * Snapshot of a [HarfBuzzGlyphExtractor]'s native counters since creation or the
+ * last [HarfBuzzGlyphExtractor.resetStats].
+ *
+ * Every successful extraction call counts once, batches and animations included.
+ * [draws]/[drawNanos] cover outline generation only, i.e. cache misses, while
+ * [extractNanos] is the full native call.
+ */
+class GlyphExtractorStats internal constructor(
+    val extractions: Long,
+    val cacheHits: Long,
+    val cacheMisses: Long,
+    val draws: Long,
+    val drawNanos: Long,
+    val extractNanos: Long,
+    val outputFloats: Long,
+    /** Draws that exceeded the budget set with [HarfBuzzGlyphExtractor.setBudget]. */
+    val overBudget: Long,
+    /** `latencyHistogram[i]` counts extractions that took [2^i, 2^(i+1)) ns. */
+    val latencyHistogram: LongArray,
+    /** Slowest distinct (codepoint, variation) pairs, slowest first. */
+    val slowest: List<SlowGlyph>,
+) {
+
+    /**
+     * [variation] is null when the glyph was extracted by axis values or design
+     * coordinates rather than through [HarfBuzzGlyphExtractor.variationId].
+     */
+    class SlowGlyph(val codepoint: Int, val variation: FontVariation?, val nanos: Long)
+
+    internal companion object {
+        private const val FIELDS = 8
+        private const val BUCKETS = 32
+
+        // Layout written by nativeGetStats in glyph_extractor_jni.c
+        fun fromArray(data: LongArray, variation: (Int) -> FontVariation?): GlyphExtractorStats {
+            val header = FIELDS + BUCKETS + 1
+            val numSlowest = data[header - 1].toInt()
+            return GlyphExtractorStats(
+                extractions = data[0],
+                cacheHits = data[1],
+                cacheMisses = data[2],
+                draws = data[3],
+                drawNanos = data[4],
+                extractNanos = data[5],
+                outputFloats = data[6],
+                overBudget = data[7],
+                latencyHistogram = data.copyOfRange(FIELDS, FIELDS + BUCKETS),
+                slowest = List(numSlowest) {
+                    val base = header + it * 3
+                    val id = data[base + 1].toInt()
+                    SlowGlyph(
+                        codepoint = data[base].toInt(),
+                        variation = if (id < 0) null else variation(id),
+                        nanos = data[base + 2],
+                    )
+                },
+            )
+        }
+    }
+}
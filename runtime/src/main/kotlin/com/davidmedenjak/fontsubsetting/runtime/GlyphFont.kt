@@ -7,4 +7,12 @@ import androidx.compose.runtime.Immutable
 class GlyphFont internal constructor(
     internal val extractor: HarfBuzzGlyphExtractor?,
     internal val previewTypeface: Typeface? = null,
-)
+) {
+    /**
+     * Adds the glyphs of a chunk the plugin split off this font, e.g. the one a
+     * feature module ships in its assets, read once the module is installed.
+     * Returns false if [data] is not a chunk of this font or the font has no
+     * native extractor.
+     */
+    fun applyChunk(data: ByteArray): Boolean = extractor?.applyChunk(data) ?: false
+}
@@ -0,0 +1,119 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+import android.graphics.Paint
+import androidx.compose.runtime.Composable
+import androidx.compose.runtime.LaunchedEffect
+import androidx.compose.runtime.Stable
+import androidx.compose.runtime.mutableStateOf
+import androidx.compose.runtime.remember
+import androidx.compose.ui.geometry.Size
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.graphics.drawscope.DrawScope
+import androidx.compose.ui.graphics.nativeCanvas
+import androidx.compose.ui.graphics.painter.Painter
+import androidx.compose.ui.graphics.toArgb
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.withContext
+
+/**
+ * Remembers a [Painter] that morphs the glyph of [from] into the glyph of [to] as
+ * [fraction] goes from 0 to 1, e.g. play into pause driven by `animateFloatAsState`.
+ *
+ * The point correspondence between both outlines is computed natively once per pair
+ * and [variation], off the main thread; each frame is then a single lerp into a reused
+ * path. Until it is ready, and wherever the native extractor is unavailable, the
+ * painter cuts from [from] to [to] halfway through.
+ */
+@Composable
+fun rememberGlyphMorphPainter(
+    from: String,
+    to: String,
+    fraction: Float,
+    font: GlyphFont,
+    tint: Color = Color.Black,
+    variation: FontVariation = FontVariation.Empty,
+): Painter {
+    val fromPainter = rememberGlyphPainter(from, font, tint, variation)
+    val toPainter = rememberGlyphPainter(to, font, tint, variation)
+    val fromCodepoint = remember(from) { from.codePointAt(0) }
+    val toCodepoint = remember(to) { to.codePointAt(0) }
+    val painter = remember(fromPainter, toPainter) {
+        GlyphMorphPainter(fromPainter, toPainter)
+    }.also {
+        it.tint = tint
+        it.fraction = fraction
+    }
+
+    val extractor = font.extractor
+    LaunchedEffect(painter, fromCodepoint, toCodepoint, variation) {
+        if (extractor == null) return@LaunchedEffect
+        painter.morph = null
+        painter.morph = withContext(Dispatchers.Default) {
+            extractor.extractMorph(fromCodepoint, toCodepoint, extractor.variationId(variation))
+        }
+    }
+
+    return painter
+}
+
+@Stable
+internal class GlyphMorphPainter(
+    private val from: Painter,
+    private val to: Painter,
+) : Painter() {
+
+    private val drawPaint = Paint(Paint.ANTI_ALIAS_FLAG)
+
+    private var _tint = mutableStateOf(Color.Black)
+    var tint: Color
+        get() = _tint.value
+        set(value) {
+            if (_tint.value != value) {
+                _tint.value = value
+            }
+        }
+
+    private var _fraction = mutableStateOf(0f)
+    var fraction: Float
+        get() = _fraction.value
+        set(value) {
+            if (_fraction.value != value) {
+                _fraction.value = value
+            }
+        }
+
+    private var _morph = mutableStateOf<GlyphAnimationPaths?>(null)
+    var morph: GlyphAnimationPaths?
+        get() = _morph.value
+        set(value) {
+            _morph.value = value
+        }
+
+    override val intrinsicSize: Size get() = Size.Unspecified
+
+    override fun DrawScope.onDraw() {
+        val t = _fraction.value
+        val m = _morph.value
+        if (m == null) {
+            with(if (t < 0.5f) from else to) { draw(size) }
+            return
+        }
+
+        val w = size.width
+        val h = size.height
+        if (w <= 0f || h <= 0f) return
+
+        val path = m.pathAt(t.coerceIn(0f, 1f))
+        val s = minOf(w, h)
+        drawPaint.color = _tint.value.toArgb()
+        drawPaint.style = Paint.Style.FILL
+        with(drawContext.canvas.nativeCanvas) {
+            save()
+            translate(w / 2f, h / 2f)
+            scale(s, s)
+            translate(-0.5f, 0.5f)
+            drawPath(path, drawPaint)
+            restore()
+        }
+    }
+}
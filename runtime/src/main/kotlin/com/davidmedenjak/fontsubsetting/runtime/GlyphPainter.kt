@@ -19,7 +19,9 @@ import java.util.concurrent.ConcurrentHashMap
  * A [Painter] that renders a font glyph using HarfBuzz-extracted [Path] outlines.
  *
  * Glyph paths are cached per variation setting and drawn in em-normalized coordinates,
- * scaled to the target size.
+ * scaled to the target size. Small sizes draw a simplified outline that stays within
+ * half a pixel of the full one. A stroke takes precedence over emboldening, and both
+ * over the simplified and animated outlines.
  *
  * When the HarfBuzz extractor is unavailable (Compose preview / host JVM without native
  * libs) the painter falls back to [GlyphFont.previewTypeface] and renders via Android's
@@ -35,6 +37,16 @@ class GlyphPainter internal constructor(
     private val drawPaint = Paint(Paint.ANTI_ALIAS_FLAG)
     private val pathCache = ConcurrentHashMap<FontVariation, Path>()
 
+    // Simplified outlines for small sizes, indexed by HarfBuzzGlyphExtractor.lodLevel
+    private val lodCache = ConcurrentHashMap<FontVariation, Array<Path?>>()
+
+    private val strokeCache = ConcurrentHashMap<GlyphStroke, ConcurrentHashMap<FontVariation, Path>>()
+
+    private val emboldenCache = ConcurrentHashMap<Float, ConcurrentHashMap<FontVariation, Path>>()
+
+    // Chunk generation the caches were filled at; a newer chunk may fill glyphs cached empty
+    private var cacheGeneration = 0
+
     private var _tint = mutableStateOf(Color.Black)
     internal var tint: Color
         get() = _tint.value
@@ -53,10 +65,37 @@ class GlyphPainter internal constructor(
             }
         }
 
+    private var _stroke = mutableStateOf<GlyphStroke?>(null)
+    internal var stroke: GlyphStroke?
+        get() = _stroke.value
+        set(value) {
+            if (_stroke.value != value) {
+                _stroke.value = value
+            }
+        }
+
+    private var _embolden = mutableStateOf(0f)
+    internal var embolden: Float
+        get() = _embolden.value
+        set(value) {
+            if (_embolden.value != value) {
+                _embolden.value = value
+            }
+        }
+
     internal fun putPath(variation: FontVariation, path: Path) {
         pathCache.putIfAbsent(variation, path)
     }
 
+    // Shared-topology outlines for the running animation; only touched on the main thread
+    private var animationFrames: Array<FontVariation>? = null
+    private var animation: GlyphAnimationPaths? = null
+
+    internal fun setAnimation(frames: Array<FontVariation>, animation: GlyphAnimationPaths) {
+        this.animationFrames = frames
+        this.animation = animation
+    }
+
     override val intrinsicSize: Size get() = Size.Unspecified
 
     override fun DrawScope.onDraw() {
@@ -69,14 +108,39 @@ class GlyphPainter internal constructor(
 
         val extractor = font.extractor
         if (extractor != null) {
-            val path = pathCache.getOrPut(v) {
-                extractor.extractPath(codepoint, v.axes, v.values) ?: run {
-                    Log.w("GlyphPainter", "Glyph not found for codepoint U+${codepoint.toString(16).uppercase()}")
-                    Path()
+            val generation = extractor.chunkGeneration
+            if (generation != cacheGeneration) {
+                pathCache.clear()
+                lodCache.clear()
+                strokeCache.clear()
+                emboldenCache.clear()
+                cacheGeneration = generation
+            }
+            val anim = animation
+            val s = minOf(w, h)
+            val level = HarfBuzzGlyphExtractor.lodLevel(s)
+            val stroke = _stroke.value
+            val embolden = _embolden.value
+            val path = if (stroke != null) {
+                strokeCache.getOrPut(stroke) { ConcurrentHashMap() }.getOrPut(v) {
+                    extractor.extractStrokePath(codepoint, extractor.variationId(v), stroke)
+                        ?: missingGlyph()
                 }
+            } else if (embolden != 0f) {
+                emboldenCache.getOrPut(embolden) { ConcurrentHashMap() }.getOrPut(v) {
+                    extractor.extractEmboldenedPath(codepoint, extractor.variationId(v), embolden)
+                        ?: missingGlyph()
+                }
+            } else if (anim != null && v.frameIndex >= 0 && v.allFrames === animationFrames) {
+                anim.pathAt(v.frameIndex)
+            } else if (level == 0) pathCache.getOrPut(v) {
+                extractor.extractPath(codepoint, extractor.variationId(v)) ?: missingGlyph()
+            } else {
+                val levels = lodCache.getOrPut(v) { arrayOfNulls(HarfBuzzGlyphExtractor.LOD_LEVELS + 1) }
+                levels[level] ?: (extractor.extractPath(codepoint, extractor.variationId(v), s)
+                    ?: missingGlyph()).also { levels[level] = it }
             }
 
-            val s = minOf(w, h)
             drawPaint.color = argb
             drawPaint.style = Paint.Style.FILL
             with(drawContext.canvas.nativeCanvas) {
@@ -92,19 +156,26 @@ class GlyphPainter internal constructor(
 
         val typeface = font.previewTypeface
         if (typeface != null) {
-            drawWithTypeface(typeface, w, h, argb, v)
+            drawWithTypeface(typeface, w, h, argb, v, _stroke.value, _embolden.value)
             return
         }
 
         drawPlaceholder(w, h, argb)
     }
 
+    private fun missingGlyph(): Path {
+        Log.w("GlyphPainter", "Glyph not found for codepoint U+${codepoint.toString(16).uppercase()}")
+        return Path()
+    }
+
     private fun DrawScope.drawWithTypeface(
         typeface: Typeface,
         w: Float,
         h: Float,
         argb: Int,
         variation: FontVariation,
+        stroke: GlyphStroke?,
+        embolden: Float,
     ) {
         val s = minOf(w, h)
         drawPaint.reset()
@@ -112,6 +183,16 @@ class GlyphPainter internal constructor(
         drawPaint.typeface = typeface
         drawPaint.color = argb
         drawPaint.style = Paint.Style.FILL
+        if (stroke != null) {
+            drawPaint.style = Paint.Style.STROKE
+            drawPaint.strokeWidth = stroke.width * s
+            drawPaint.strokeJoin = stroke.join
+            drawPaint.strokeCap = stroke.cap
+        } else if (embolden > 0f) {
+            // Paint can only grow the outline; thinning shows unchanged in previews
+            drawPaint.style = Paint.Style.FILL_AND_STROKE
+            drawPaint.strokeWidth = embolden * s
+        }
         drawPaint.textSize = s
         drawPaint.textAlign = Paint.Align.CENTER
 
@@ -0,0 +1,17 @@
+package com.davidmedenjak.fontsubsetting.runtime
+
+import android.graphics.Paint
+import androidx.compose.runtime.Immutable
+
+/**
+ * Draws a glyph's outline instead of filling it, for outlined or badge-ring styles.
+ *
+ * [width] is a fraction of the icon size, centered on the outline. The stroked outline
+ * is computed natively once per glyph, variation and stroke, then drawn as a plain fill.
+ */
+@Immutable
+data class GlyphStroke(
+    val width: Float,
+    val join: Paint.Join = Paint.Join.MITER,
+    val cap: Paint.Cap = Paint.Cap.BUTT,
+)
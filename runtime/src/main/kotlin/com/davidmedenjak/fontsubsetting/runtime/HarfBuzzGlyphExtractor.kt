@@ -1,8 +1,15 @@
 package com.davidmedenjak.fontsubsetting.runtime
 
 import android.graphics.Path
+import androidx.compose.runtime.mutableStateOf
+import java.io.File
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.locks.ReentrantLock
 import kotlin.concurrent.withLock
+import kotlin.coroutines.resume
+import kotlinx.coroutines.CancellableContinuation
+import kotlinx.coroutines.suspendCancellableCoroutine
 
 /**
  * Native HarfBuzz-based glyph outline extractor.
@@ -11,19 +18,367 @@ import kotlin.concurrent.withLock
  * bypassing Android's Paint/Typeface stack. Variable font axes work on all API levels.
  *
  * Thread-safe: extraction methods are synchronized, allowing background batch
- * extraction alongside main-thread rendering.
+ * extraction alongside main-thread rendering. The `Async` variants queue work on a
+ * native worker thread by [ExtractionPriority]; synchronous calls always go first.
+ *
+ * With a [cacheDir], outlines extracted by variation id are persisted there, keyed
+ * by a hash of [fontData], and served from a memory mapping on later launches.
+ * The glyphs used in the first seconds after creation are recorded there as well,
+ * for [prewarm] to load ahead of the next launch's first frame.
  */
-class HarfBuzzGlyphExtractor internal constructor(fontData: ByteArray) : AutoCloseable {
+class HarfBuzzGlyphExtractor internal constructor(
+    fontData: ByteArray,
+    cacheDir: File? = null,
+) : AutoCloseable {
 
     private var handle: Long
     private val lock = ReentrantLock()
 
+    /** Variation axis tags in the font's fvar order, read once at load. */
+    val axisTags: Array<String>
+    private val axisDefaults: FloatArray
+
     init {
         ensureLibraryLoaded()
-        handle = nativeCreateFont(fontData)
+        handle = nativeCreateFont(fontData, cacheDir?.path, STARTUP_PROFILE_MILLIS)
         check(handle != 0L) { "Failed to create HarfBuzz font from data" }
+
+        val tags = nativeGetAxisTags(handle) ?: IntArray(0)
+        val ranges = nativeGetAxisRanges(handle) ?: FloatArray(0)
+        axisTags = Array(tags.size) { tagToString(tags[it]) }
+        axisDefaults = FloatArray(tags.size) { ranges[it * 3 + 1] }
+    }
+
+    /**
+     * Writes design coordinates for [axes]/[values] into [dest] at [offset], in the
+     * font's fvar order as expected by the fixed-axis extraction methods. Axes the
+     * font doesn't have are ignored; axes not given use the font default.
+     */
+    fun designCoords(
+        axes: Array<String>,
+        values: FloatArray,
+        dest: FloatArray = FloatArray(axisTags.size),
+        offset: Int = 0,
+    ): FloatArray {
+        axisDefaults.copyInto(dest, offset)
+        for (i in axes.indices) {
+            val index = axisTags.indexOf(axes[i])
+            if (index >= 0) dest[offset + index] = values[i]
+        }
+        return dest
+    }
+
+    private val variationIds = ConcurrentHashMap<FontVariation, Int>()
+
+    // Bumped whenever chunks may have added glyphs; painters drop outlines cached before
+    private val _chunkGeneration = mutableStateOf(0)
+    internal val chunkGeneration: Int get() = _chunkGeneration.value
+
+    /**
+     * Interns [variation] and returns its native id. Registration normalizes the
+     * coordinates once; later extractions by id only pass primitives across JNI.
+     * [FontVariation.Empty] is always id 0, the font's default instance.
+     */
+    fun variationId(variation: FontVariation): Int {
+        if (variation.axes.isEmpty()) return 0
+        variationIds[variation]?.let { return it }
+        val id = lock.withLock {
+            nativeRegisterVariation(handle, designCoords(variation.axes, variation.values))
+        }
+        if (id < 0) return 0
+        return variationIds.putIfAbsent(variation, id) ?: id
+    }
+
+    /** Extracts [codepoint] at a variation registered via [variationId]. */
+    fun extractPath(codepoint: Int, variationId: Int): Path? = lock.withLock {
+        val data = nativeExtractGlyphVariation(handle, codepoint, variationId) ?: return null
+        data.toAndroidPath()
+    }
+
+    /**
+     * Extracts [codepoint] for drawing at [pixelSize] pixels per em: the coarsest
+     * simplified outline (see [lodLevel]) that stays within half a pixel of the
+     * full one. Sizes too large for any simplification get the full outline.
+     * With a cacheDir, levels are persisted with the outlines; otherwise each
+     * call simplifies again.
+     */
+    fun extractPath(codepoint: Int, variationId: Int, pixelSize: Float): Path? = lock.withLock {
+        val data = nativeExtractGlyphLod(handle, codepoint, variationId, pixelSize) ?: return null
+        data.toAndroidPath()
+    }
+
+    /**
+     * The outline of [codepoint] stroked with [stroke], as a [Path] to fill rather
+     * than stroke on every draw. With a cacheDir, results are persisted there per
+     * glyph, variation and stroke; otherwise every call strokes again.
+     */
+    fun extractStrokePath(codepoint: Int, variationId: Int, stroke: GlyphStroke): Path? =
+        lock.withLock {
+            val data = nativeExtractGlyphStroke(
+                handle, codepoint, variationId,
+                stroke.width, stroke.join.ordinal, stroke.cap.ordinal,
+            ) ?: return null
+            data.toAndroidPath()
+        }
+
+    /**
+     * [codepoint] synthetically emboldened: stems grow by [strength] em (thinner when
+     * negative) while the glyph stays centered, so a font subset with `wght` pinned
+     * can still offer weights. With a cacheDir, results are persisted there per
+     * glyph, variation and strength; otherwise every call emboldens again.
+     */
+    fun extractEmboldenedPath(codepoint: Int, variationId: Int, strength: Float): Path? =
+        lock.withLock {
+            val data = nativeExtractGlyphEmbolden(handle, codepoint, variationId, strength)
+                ?: return null
+            data.toAndroidPath()
+        }
+
+    /**
+     * One [Path] for a whole row or grid of icons at a single variation, so it can
+     * be drawn with one `drawPath` instead of a save/translate/scale/draw per icon.
+     * Icon i is [codepoints]`[i]` laid out in a [sizes]`[i]` pixel square whose
+     * top-left corner is at ([positions]`[2i]`, [positions]`[2i+1]`), the way
+     * [GlyphPainter] draws it, at the level of detail for its size. Codepoints
+     * missing from the font are left out.
+     */
+    fun extractRow(
+        codepoints: IntArray,
+        positions: FloatArray,
+        sizes: FloatArray,
+        variationId: Int,
+    ): Path? = lock.withLock {
+        val data = nativeExtractGlyphRow(handle, codepoints, positions, sizes, variationId)
+            ?: return null
+        data.toAndroidPath()
+    }
+
+    /** Batch variant of [extractPath] over registered variation ids. */
+    fun extractPathBatch(codepoint: Int, variationIds: IntArray): List<Path>? = lock.withLock {
+        val data = nativeExtractGlyphVariationBatch(handle, codepoint, variationIds)
+            ?: return null
+        parseBatchResult(data, variationIds.size)
+    }
+
+    /**
+     * Extracts [codepoint] at every frame in [variationIds] into the shared-topology
+     * animation format, dropping frames that interpolation reproduces within
+     * [tolerance] (em units). Returns null if the glyph's command sequence changes
+     * between frames; use [extractPathBatch] then.
+     */
+    internal fun extractAnimation(
+        codepoint: Int,
+        variationIds: IntArray,
+        tolerance: Float = ANIMATION_TOLERANCE,
+    ): GlyphAnimationPaths? = lock.withLock {
+        val data = nativeExtractGlyphAnimation(handle, codepoint, variationIds, tolerance)
+            ?: return null
+        GlyphAnimationPaths.parse(data)
+    }
+
+    /**
+     * Caps the work a single glyph may cost, so one pathological outline can't
+     * stall a frame. 0 leaves a limit off; all limits are off by default.
+     * Glyphs over budget extract as null, or as their bounding box with
+     * [fallbackToBounds]. [maxCompositeDepth] only applies to the built-in sfnt
+     * reader; HarfBuzz enforces its own nesting limit.
+     */
+    fun setBudget(
+        maxCommands: Int = 0,
+        maxFloats: Int = 0,
+        maxCompositeDepth: Int = 0,
+        fallbackToBounds: Boolean = false,
+    ) {
+        lock.withLock {
+            if (handle != 0L) {
+                nativeSetBudget(handle, maxCommands, maxFloats, maxCompositeDepth, fallbackToBounds)
+            }
+        }
+    }
+
+    /**
+     * Every COLR layer of [codepoint] in CPAL [palette], read natively in one pass and,
+     * with a cacheDir, persisted with the outlines. Glyphs without color data come back
+     * as a single layer in the tint color.
+     */
+    internal fun extractColorLayers(
+        codepoint: Int,
+        variationId: Int,
+        palette: Int,
+    ): GlyphColorLayers? = lock.withLock {
+        if (handle == 0L) return null
+        val data = nativeExtractGlyphColor(handle, codepoint, variationId, palette)
+            ?: return null
+        parseColorLayers(data)
+    }
+
+    /**
+     * Point correspondence for morphing [fromCodepoint] into [toCodepoint] at one
+     * variation, computed natively and, with a cacheDir, persisted per pair with
+     * the outlines.
+     * Draw fraction t with `pathAt(t)`.
+     */
+    internal fun extractMorph(
+        fromCodepoint: Int,
+        toCodepoint: Int,
+        variationId: Int,
+    ): GlyphAnimationPaths? = lock.withLock {
+        if (handle == 0L) return null
+        val data = nativeExtractGlyphMorph(handle, fromCodepoint, toCodepoint, variationId)
+            ?: return null
+        GlyphAnimationPaths.parse(data)
+    }
+
+    /**
+     * For fonts the plugin split into chunks (`chunkGroupsFile`): glyphs of a chunk
+     * that hasn't been applied are loaded from the chunk's file in [dir] the first
+     * time they are requested, e.g. once a feature module that ships them is
+     * installed. Until then they extract as null. Setting the directory again
+     * retries chunks that failed to load. Returns false if the font has no chunks.
+     */
+    fun setChunkDirectory(dir: File): Boolean = lock.withLock {
+        (handle != 0L && nativeSetChunkDirectory(handle, dir.path)).also { if (it) _chunkGeneration.value++ }
+    }
+
+    /**
+     * Applies a chunk read elsewhere, e.g. from a feature module's assets. Painters
+     * that already drew its icons empty redraw with the new outlines. Returns false
+     * if [data] is not a chunk of this font.
+     */
+    fun applyChunk(data: ByteArray): Boolean = lock.withLock {
+        (handle != 0L && nativeApplyChunk(handle, data)).also { if (it) _chunkGeneration.value++ }
+    }
+
+    /** File name of the chunk [codepoint]'s glyph still waits for, or null if the font has it. */
+    fun pendingChunk(codepoint: Int): String? = lock.withLock {
+        if (handle == 0L) null else nativePendingChunk(handle, codepoint)
+    }
+
+    /**
+     * Extracts the glyphs the previous session used at startup into the outline
+     * cache, so first draws find them there. Call off the main thread right after
+     * creation. The font is locked per glyph, so draws on other threads are held up
+     * by at most one extraction. Returns the number of glyphs warmed; 0 without a
+     * cache dir.
+     */
+    fun prewarm(): Int {
+        val count = lock.withLock { if (handle == 0L) 0 else nativePrewarmCount(handle) }
+        var warmed = 0
+        for (index in 0 until count) {
+            val done = lock.withLock { handle != 0L && nativePrewarmGlyph(handle, index) }
+            if (done) warmed++
+        }
+        return warmed
+    }
+
+    /**
+     * Native telemetry for this font: call counts, cache hit rate, time spent in
+     * outline generation, a latency histogram and the slowest glyphs seen.
+     */
+    fun stats(): GlyphExtractorStats? {
+        val data = lock.withLock { if (handle == 0L) null else nativeGetStats(handle) }
+            ?: return null
+        return GlyphExtractorStats.fromArray(data) { id ->
+            if (id == 0) FontVariation.Empty
+            else variationIds.entries.firstOrNull { it.value == id }?.key
+        }
+    }
+
+    fun resetStats() {
+        lock.withLock { if (handle != 0L) nativeResetStats(handle) }
     }
 
+    private val nextRequestId = AtomicLong(1)
+    private val pending = ConcurrentHashMap<Long, CancellableContinuation<FloatArray?>>()
+
+    /**
+     * Suspending variant of [extractPath] run on the native scheduler thread.
+     * With a positive [deadlineMillis] the request is dropped (returning null) if it
+     * hasn't started within that many milliseconds, e.g. because the frame it was
+     * meant for has passed. Cancelling the caller cancels the native job.
+     */
+    suspend fun extractPathAsync(
+        codepoint: Int,
+        variationId: Int,
+        priority: ExtractionPriority = ExtractionPriority.Visible,
+        deadlineMillis: Long = 0,
+    ): Path? {
+        val ids = intArrayOf(variationId)
+        val data = submit(priority, JOB_PATH, codepoint, ids, 0f, deadlineMillis) ?: return null
+        return data.toAndroidPath()
+    }
+
+    /** Suspending variant of [extractPathBatch]; see [extractPathAsync]. */
+    suspend fun extractPathBatchAsync(
+        codepoint: Int,
+        variationIds: IntArray,
+        priority: ExtractionPriority = ExtractionPriority.Prefetch,
+        deadlineMillis: Long = 0,
+    ): List<Path>? {
+        val data = submit(priority, JOB_BATCH, codepoint, variationIds, 0f, deadlineMillis)
+            ?: return null
+        return parseBatchResult(data, variationIds.size)
+    }
+
+    /** Suspending variant of [extractAnimation]; see [extractPathAsync]. */
+    internal suspend fun extractAnimationAsync(
+        codepoint: Int,
+        variationIds: IntArray,
+        priority: ExtractionPriority = ExtractionPriority.Prefetch,
+        tolerance: Float = ANIMATION_TOLERANCE,
+    ): GlyphAnimationPaths? {
+        val data = submit(priority, JOB_ANIMATION, codepoint, variationIds, tolerance, 0)
+            ?: return null
+        return GlyphAnimationPaths.parse(data)
+    }
+
+    private suspend fun submit(
+        priority: ExtractionPriority,
+        kind: Int,
+        codepoint: Int,
+        variationIds: IntArray,
+        tolerance: Float,
+        deadlineMillis: Long,
+    ): FloatArray? = suspendCancellableCoroutine { cont ->
+        val requestId = nextRequestId.getAndIncrement()
+        pending[requestId] = cont
+        val queued = lock.withLock {
+            handle != 0L && nativeSubmit(
+                handle, requestId, priority.ordinal, kind, codepoint,
+                variationIds, tolerance, deadlineMillis,
+            )
+        }
+        if (!queued) {
+            pending.remove(requestId)
+            cont.resume(null)
+            return@suspendCancellableCoroutine
+        }
+        cont.invokeOnCancellation {
+            lock.withLock { if (handle != 0L) nativeCancel(handle, requestId) }
+        }
+    }
+
+    // Called from native on the scheduler thread, or from nativeCancel/nativeDestroyFont
+    // for jobs that never ran. Anything but success resumes with null.
+    @Suppress("unused")
+    private fun onNativeResult(requestId: Long, status: Int, data: FloatArray?) {
+        pending.remove(requestId)?.resume(if (status == 0) data else null)
+    }
+
+    /** Fixed-axis fast path: [coords] holds one value per [axisTags] entry. */
+    fun extractPath(codepoint: Int, coords: FloatArray): Path? = lock.withLock {
+        val data = nativeExtractGlyphCoords(handle, codepoint, coords) ?: return null
+        data.toAndroidPath()
+    }
+
+    /** Batch variant of the fixed-axis fast path: [coords] holds [numSets] coordinate sets. */
+    fun extractPathBatch(codepoint: Int, coords: FloatArray, numSets: Int): List<Path>? =
+        lock.withLock {
+            val data = nativeExtractGlyphCoordsBatch(handle, codepoint, coords, numSets)
+                ?: return null
+            parseBatchResult(data, numSets)
+        }
+
     fun extractPath(codepoint: Int, axisTags: Array<String>, axisValues: FloatArray): Path? =
         lock.withLock {
             val data = nativeExtractGlyph(handle, codepoint, axisTags, axisValues) ?: return null
@@ -53,13 +408,43 @@ class HarfBuzzGlyphExtractor internal constructor(fontData: ByteArray) : AutoClo
     companion object {
         private val LOAD_LOCK = Any()
 
+        // 1/1024 em: well under half a pixel even for 144px icons
+        private const val ANIMATION_TOLERANCE = 1f / 1024f
+
+        // Long enough to cover the first screen, short enough to skip later navigation
+        private const val STARTUP_PROFILE_MILLIS = 5_000L
+
+        // Job kinds, see glyph_scheduler.h
+        private const val JOB_PATH = 0
+        private const val JOB_BATCH = 1
+        private const val JOB_ANIMATION = 2
+
         @Volatile
         private var loaded = false
 
         @Volatile
         private var loadError: Throwable? = null
 
-        fun create(fontData: ByteArray): HarfBuzzGlyphExtractor = HarfBuzzGlyphExtractor(fontData)
+        // Mirror GLYPH_LOD_* in glyph_extractor.h
+        internal const val LOD_LEVELS = 4
+        private const val LOD_FINEST_TOLERANCE = 1f / 256f
+        private const val LOD_MAX_ERROR_PX = 0.5f
+
+        /**
+         * Level of detail [extractPath] uses at [pixelSize] pixels per em: 0 is the
+         * full outline, each level above doubles the allowed deviation. Paths for
+         * different sizes at the same level are identical.
+         */
+        fun lodLevel(pixelSize: Float): Int {
+            if (!(pixelSize > 0f)) return 0
+            val allowed = LOD_MAX_ERROR_PX / pixelSize
+            var level = 0
+            while (level < LOD_LEVELS && LOD_FINEST_TOLERANCE * (1 shl level) <= allowed) level++
+            return level
+        }
+
+        fun create(fontData: ByteArray, cacheDir: File? = null): HarfBuzzGlyphExtractor =
+            HarfBuzzGlyphExtractor(fontData, cacheDir)
 
         /**
          * Returns true if the native library is available on this platform.
@@ -72,6 +457,34 @@ class HarfBuzzGlyphExtractor internal constructor(fontData: ByteArray) : AutoClo
             false
         }
 
+        /**
+         * Writes the native trace slices recorded so far to [file] as Chrome
+         * trace-event JSON and clears them. Only host builds of the runtime made
+         * with `-PglyphRuntimeTracing=true` record slices this way; on Android they
+         * go to ATrace instead. Returns false if nothing was written.
+         */
+        fun writeNativeTrace(file: File): Boolean {
+            ensureLibraryLoaded()
+            return nativeWriteTrace(file.path)
+        }
+
+        @JvmStatic
+        private external fun nativeWriteTrace(path: String): Boolean
+
+        /**
+         * Rebuilds an updated font from the [previous] version's bytes and the delta the
+         * plugin wrote for it (`previousFontFile`), so an update only downloads what
+         * changed. Returns null if [delta] was made from other bytes or is damaged; the
+         * rebuilt font is checked against the hash the delta carries.
+         */
+        fun applyFontDelta(previous: ByteArray, delta: ByteArray): ByteArray? {
+            ensureLibraryLoaded()
+            return nativeApplyFontDelta(previous, delta)
+        }
+
+        @JvmStatic
+        private external fun nativeApplyFontDelta(previous: ByteArray, delta: ByteArray): ByteArray?
+
         internal fun ensureLibraryLoaded() {
             if (loaded) return
             synchronized(LOAD_LOCK) {
@@ -92,7 +505,9 @@ class HarfBuzzGlyphExtractor internal constructor(fontData: ByteArray) : AutoClo
         }
     }
 
-    private external fun nativeCreateFont(data: ByteArray): Long
+    private external fun nativeCreateFont(
+        data: ByteArray, cacheDir: String?, profileWindowMillis: Long,
+    ): Long
     private external fun nativeDestroyFont(handle: Long)
     private external fun nativeExtractGlyph(
         handle: Long, codepoint: Int,
@@ -102,8 +517,70 @@ class HarfBuzzGlyphExtractor internal constructor(fontData: ByteArray) : AutoClo
         handle: Long, codepoint: Int,
         axisTags: Array<String>, axisValues: FloatArray, numSets: Int,
     ): FloatArray?
+    private external fun nativeGetAxisTags(handle: Long): IntArray?
+    private external fun nativeGetAxisRanges(handle: Long): FloatArray?
+    private external fun nativeExtractGlyphCoords(
+        handle: Long, codepoint: Int, coords: FloatArray,
+    ): FloatArray?
+    private external fun nativeExtractGlyphCoordsBatch(
+        handle: Long, codepoint: Int, coords: FloatArray, numSets: Int,
+    ): FloatArray?
+    private external fun nativeRegisterVariation(handle: Long, coords: FloatArray): Int
+    private external fun nativeExtractGlyphVariation(
+        handle: Long, codepoint: Int, variationId: Int,
+    ): FloatArray?
+    private external fun nativeExtractGlyphLod(
+        handle: Long, codepoint: Int, variationId: Int, pixelSize: Float,
+    ): FloatArray?
+    private external fun nativeExtractGlyphStroke(
+        handle: Long, codepoint: Int, variationId: Int, width: Float, join: Int, cap: Int,
+    ): FloatArray?
+    private external fun nativeExtractGlyphEmbolden(
+        handle: Long, codepoint: Int, variationId: Int, strength: Float,
+    ): FloatArray?
+    private external fun nativeExtractGlyphRow(
+        handle: Long, codepoints: IntArray, positions: FloatArray, sizes: FloatArray,
+        variationId: Int,
+    ): FloatArray?
+    private external fun nativeExtractGlyphVariationBatch(
+        handle: Long, codepoint: Int, variationIds: IntArray,
+    ): FloatArray?
+    private external fun nativeExtractGlyphAnimation(
+        handle: Long, codepoint: Int, variationIds: IntArray, tolerance: Float,
+    ): FloatArray?
+    private external fun nativeExtractGlyphColor(
+        handle: Long, codepoint: Int, variationId: Int, palette: Int,
+    ): FloatArray?
+    private external fun nativeExtractGlyphMorph(
+        handle: Long, fromCodepoint: Int, toCodepoint: Int, variationId: Int,
+    ): FloatArray?
+    private external fun nativePrewarmCount(handle: Long): Int
+    private external fun nativePrewarmGlyph(handle: Long, index: Int): Boolean
+    private external fun nativeSetChunkDirectory(handle: Long, chunkDir: String): Boolean
+    private external fun nativeApplyChunk(handle: Long, chunkData: ByteArray): Boolean
+    private external fun nativePendingChunk(handle: Long, codepoint: Int): String?
+    private external fun nativeGetStats(handle: Long): LongArray?
+    private external fun nativeResetStats(handle: Long)
+    private external fun nativeSetBudget(
+        handle: Long, maxCommands: Int, maxFloats: Int, maxCompositeDepth: Int,
+        fallbackToBounds: Boolean,
+    )
+    private external fun nativeSubmit(
+        handle: Long, requestId: Long, priority: Int, kind: Int, codepoint: Int,
+        variationIds: IntArray, tolerance: Float, deadlineMillis: Long,
+    ): Boolean
+    private external fun nativeCancel(handle: Long, requestId: Long)
 }
 
+private fun tagToString(tag: Int): String = String(
+    charArrayOf(
+        (tag ushr 24 and 0xFF).toChar(),
+        (tag ushr 16 and 0xFF).toChar(),
+        (tag ushr 8 and 0xFF).toChar(),
+        (tag and 0xFF).toChar(),
+    ),
+)
+
 private fun parseBatchResult(data: FloatArray, numSets: Int): List<Path> {
     val paths = ArrayList<Path>(numSets)
     var offset = 0
@@ -116,6 +593,31 @@ private fun parseBatchResult(data: FloatArray, numSets: Int): List<Path> {
     return paths
 }
 
+// [L, then per layer: r, g, b, a, n, path(n)]; r < 0 marks the tint color
+private fun parseColorLayers(data: FloatArray): GlyphColorLayers {
+    val count = data[0].toInt()
+    val colors = IntArray(count)
+    val tinted = BooleanArray(count)
+    var offset = 1
+    val paths = Array(count) { i ->
+        val alpha = (data[offset + 3] * 255f + 0.5f).toInt().coerceIn(0, 255)
+        tinted[i] = data[offset] < 0f
+        colors[i] = if (tinted[i]) {
+            alpha shl 24
+        } else {
+            (alpha shl 24) or
+                ((data[offset] * 255f + 0.5f).toInt() shl 16) or
+                ((data[offset + 1] * 255f + 0.5f).toInt() shl 8) or
+                (data[offset + 2] * 255f + 0.5f).toInt()
+        }
+        val length = data[offset + 4].toInt()
+        val path = data.toAndroidPath(offset + 5, length)
+        offset += 5 + length
+        path
+    }
+    return GlyphColorLayers(paths, colors, tinted)
+}
+
 private fun FloatArray.toAndroidPath(start: Int = 0, length: Int = size - start): Path {
     val path = Path()
     var i = start